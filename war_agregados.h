@@ -0,0 +1,88 @@
+/*
+ * Agregados por Cor do Sistema WAR
+ *
+ * Mantém, para cada cor, os totais usados pelas missões: territórios
+ * controlados, soma de tropas, maior tropa em um único território e
+ * territórios cujo nome começa com 'B'. O motor atualiza os agregados a
+ * cada batalha (retirando e recolocando os dois territórios envolvidos),
+ * então as missões consultam os valores em tempo constante em vez de
+ * percorrer o mapa inteiro.
+ *
+ * O máximo de tropas é o único valor que pode ficar desatualizado: quando
+ * o último território com o máximo perde tropas, ele é recalculado apenas
+ * na próxima consulta.
+ */
+
+#ifndef WAR_AGREGADOS_H
+#define WAR_AGREGADOS_H
+
+#include <string.h>
+
+#include "war_cores.h"
+
+// Totais de uma cor
+typedef struct {
+    int territorios;          // Territórios controlados
+    long long tropas;         // Soma das tropas
+    int tropasMaximas;        // Maior tropa em um único território
+    int noMaximo;             // Territórios com exatamente "tropasMaximas" tropas
+    int maximoDesatualizado;  // 1 se "tropasMaximas" precisa ser recalculado
+    int territoriosB;         // Territórios controlados com nome iniciado por 'B'
+} AgregadoCor;
+
+typedef struct {
+    AgregadoCor porCor[MAX_CORES];
+    int totalB;               // Territórios do mapa com nome iniciado por 'B'
+} AgregadosMapa;
+
+/*
+ * Função: comecaComB
+ * Retorna 1 se o nome do território começa com 'B' ou 'b'
+ */
+static inline int comecaComB(const char* nome) {
+    return nome[0] == 'B' || nome[0] == 'b';
+}
+
+/*
+ * Função: adicionarAoAgregado
+ * Soma a contribuição de um território aos totais da sua cor
+ */
+static inline void adicionarAoAgregado(AgregadosMapa* agregados, int inicialB, IdCor cor, int tropas) {
+    AgregadoCor* a = &agregados->porCor[cor];
+
+    a->territorios++;
+    a->tropas += tropas;
+    if (inicialB) {
+        a->territoriosB++;
+    }
+
+    if (tropas > a->tropasMaximas) {
+        a->tropasMaximas = tropas;
+        a->noMaximo = 1;
+        a->maximoDesatualizado = 0;
+    } else if (tropas == a->tropasMaximas) {
+        // Com o máximo desatualizado, nenhum outro território tem este valor
+        a->noMaximo = a->maximoDesatualizado ? 1 : a->noMaximo + 1;
+        a->maximoDesatualizado = 0;
+    }
+}
+
+/*
+ * Função: removerDoAgregado
+ * Retira a contribuição de um território dos totais da sua cor
+ */
+static inline void removerDoAgregado(AgregadosMapa* agregados, int inicialB, IdCor cor, int tropas) {
+    AgregadoCor* a = &agregados->porCor[cor];
+
+    a->territorios--;
+    a->tropas -= tropas;
+    if (inicialB) {
+        a->territoriosB--;
+    }
+
+    if (!a->maximoDesatualizado && tropas == a->tropasMaximas && --a->noMaximo == 0) {
+        a->maximoDesatualizado = 1;
+    }
+}
+
+#endif // WAR_AGREGADOS_H
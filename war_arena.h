@@ -0,0 +1,99 @@
+/*
+ * Arena de Memória por Partida do Sistema WAR
+ *
+ * Uma arena é um único bloco reservado de uma vez com o tamanho que a
+ * partida vai precisar (mapa, jogadores, buffers e rascunhos). As
+ * reservas só avançam um índice dentro do bloco e nunca são liberadas
+ * uma a uma: ao fim da partida a arena inteira é reiniciada (e pode ser
+ * reaproveitada pela próxima) ou devolvida com um único free().
+ *
+ * O bloco é entregue zerado, como calloc, e volta a ser zerado na
+ * reinicialização (apenas a parte usada).
+ */
+
+#ifndef WAR_ARENA_H
+#define WAR_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Alinhamento de cada reserva (suficiente para qualquer estrutura do jogo)
+#define ALINHAMENTO_ARENA 16
+
+typedef struct Arena {
+    size_t capacidade;       // Bytes disponíveis em "memoria"
+    size_t usado;            // Bytes já reservados
+    struct Arena* proxima;   // Encadeamento em listas de arenas livres
+    _Alignas(ALINHAMENTO_ARENA) unsigned char memoria[];
+} Arena;
+
+/*
+ * Função: tamanhoReserva
+ * Bytes que uma reserva de "bytes" ocupa na arena (com o alinhamento);
+ * some os tamanhos das reservas para dimensionar a arena
+ */
+static inline size_t tamanhoReserva(size_t bytes) {
+    return (bytes + ALINHAMENTO_ARENA - 1) & ~(size_t) (ALINHAMENTO_ARENA - 1);
+}
+
+/*
+ * Função: criarArena
+ * Reserva uma arena zerada com "capacidade" bytes
+ * Retorna a arena ou NULL se faltar memória
+ */
+static inline Arena* criarArena(size_t capacidade) {
+    capacidade = tamanhoReserva(capacidade);
+    Arena* arena = (Arena*) calloc(1, sizeof(Arena) + capacidade);
+    if (arena == NULL) {
+        return NULL;
+    }
+    arena->capacidade = capacidade;
+    return arena;
+}
+
+/*
+ * Função: reservarArena
+ * Reserva "bytes" bytes zerados e alinhados da arena
+ * Retorna o ponteiro ou NULL se a arena não comporta a reserva
+ */
+static inline void* reservarArena(Arena* arena, size_t bytes) {
+    size_t tamanho = tamanhoReserva(bytes);
+    if (arena == NULL || tamanho > arena->capacidade - arena->usado) {
+        return NULL;
+    }
+    void* p = arena->memoria + arena->usado;
+    arena->usado += tamanho;
+    return p;
+}
+
+/*
+ * Função: arenaContem
+ * Retorna 1 se o ponteiro aponta para dentro da arena
+ */
+static inline int arenaContem(const Arena* arena, const void* p) {
+    const unsigned char* c = (const unsigned char*) p;
+    return arena != NULL && c >= arena->memoria && c < arena->memoria + arena->capacidade;
+}
+
+/*
+ * Função: reiniciarArena
+ * Descarta todas as reservas de uma vez, deixando a arena pronta para
+ * outra partida
+ */
+static inline void reiniciarArena(Arena* arena) {
+    memset(arena->memoria, 0, arena->usado);
+    arena->usado = 0;
+    arena->proxima = NULL;
+}
+
+/*
+ * Função: liberarArena
+ * Devolve a arena (e tudo o que foi reservado nela) ao sistema
+ */
+static inline void liberarArena(Arena* arena) {
+    free(arena);
+}
+
+#endif
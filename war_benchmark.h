@@ -0,0 +1,369 @@
+/*
+ * Medições de Desempenho do Sistema WAR
+ *
+ * Infraestrutura do modo "--benchmark": cada caso é uma função que repete
+ * uma operação "n" vezes; medirBenchmark() dobra "n" até a medição durar
+ * o tempo mínimo e guarda a última rodada (ns por operação, operações por
+ * segundo e alocações). O relatório sai em JSON para ser comparado entre
+ * versões antes de publicar um binário novo.
+ *
+ * A contagem de alocações substitui malloc/calloc/realloc (e as variantes
+ * alinhadas) por versões que somam um contador e repassam à glibc, então
+ * não faz parte do binário normal: ela só existe em um binário próprio
+ * para medições, compilado com -DWAR_CONTAR_ALOCACOES. Mesmo assim fica
+ * desligada fora da glibc e com sanitizadores (que substituem o malloc
+ * por conta própria, no GCC ou no clang). Sem ela o relatório traz -1.
+ * Ligada, ela só conta durante a rodada medida; fora dela o custo é uma
+ * leitura relaxada.
+ *
+ * Como pode definir malloc, este arquivo deve ser incluído por um único
+ * arquivo .c do programa.
+ */
+
+#ifndef WAR_BENCHMARK_H
+#define WAR_BENCHMARK_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "war_engine.h"
+
+// Rodada mais longa aceita por caso (protege operações quase vazias)
+#define MAX_OPERACOES_BENCHMARK (1LL << 40)
+
+// Tamanho máximo do nome de um caso no relatório
+#define TAM_NOME_BENCHMARK 40
+
+// Sanitizadores do GCC (__SANITIZE_*__) e do clang (__has_feature)
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define WAR_SANITIZADOR 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer) || __has_feature(memory_sanitizer)
+#define WAR_SANITIZADOR 1
+#endif
+#endif
+
+#if defined(WAR_CONTAR_ALOCACOES) && defined(__GLIBC__) && !defined(WAR_SANITIZADOR)
+#define CONTAGEM_ALOCACOES 1
+#else
+#define CONTAGEM_ALOCACOES 0
+#endif
+
+// ==================== CONTAGEM DE ALOCAÇÕES ====================
+
+static _Atomic int contandoAlocacoes;
+static _Atomic long long totalAlocacoes;
+static _Atomic long long totalBytesAlocados;
+
+/*
+ * Função: contarAlocacao
+ * Soma uma alocação de "bytes" bytes, se a contagem estiver ligada
+ */
+static inline void contarAlocacao(size_t bytes) {
+    if (atomic_load_explicit(&contandoAlocacoes, memory_order_relaxed)) {
+        atomic_fetch_add_explicit(&totalAlocacoes, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&totalBytesAlocados, (long long) bytes, memory_order_relaxed);
+    }
+}
+
+#if CONTAGEM_ALOCACOES
+extern void* __libc_malloc(size_t bytes);
+extern void* __libc_calloc(size_t quantidade, size_t bytes);
+extern void* __libc_realloc(void* p, size_t bytes);
+extern void* __libc_memalign(size_t alinhamento, size_t bytes);
+extern void __libc_free(void* p);
+
+void* malloc(size_t bytes) {
+    contarAlocacao(bytes);
+    return __libc_malloc(bytes);
+}
+
+void* calloc(size_t quantidade, size_t bytes) {
+    contarAlocacao(quantidade * bytes);
+    return __libc_calloc(quantidade, bytes);
+}
+
+void* realloc(void* p, size_t bytes) {
+    contarAlocacao(bytes);
+    return __libc_realloc(p, bytes);
+}
+
+void* aligned_alloc(size_t alinhamento, size_t bytes) {
+    contarAlocacao(bytes);
+    return __libc_memalign(alinhamento, bytes);
+}
+
+int posix_memalign(void** p, size_t alinhamento, size_t bytes) {
+    if (alinhamento < sizeof(void*) || (alinhamento & (alinhamento - 1)) != 0) {
+        return EINVAL;
+    }
+    contarAlocacao(bytes);
+    *p = __libc_memalign(alinhamento, bytes);
+    return *p != NULL ? 0 : ENOMEM;
+}
+
+void free(void* p) {
+    __libc_free(p);
+}
+#endif
+
+/*
+ * Função: ligarContagemAlocacoes
+ * Zera os contadores e passa a contar (ou para de contar) as alocações
+ */
+static inline void ligarContagemAlocacoes(int ligar) {
+    if (ligar) {
+        atomic_store(&totalAlocacoes, 0);
+        atomic_store(&totalBytesAlocados, 0);
+    }
+    atomic_store(&contandoAlocacoes, ligar);
+}
+
+// ==================== RELATÓRIO ====================
+
+// Uma linha do relatório
+typedef struct {
+    char nome[TAM_NOME_BENCHMARK];
+    long long territorios;   // Tamanho do mapa do caso (0 = não se aplica)
+    long long operacoes;     // Operações da rodada medida
+    double segundos;
+    long long alocacoes;     // -1 se a contagem não está disponível
+    long long bytesAlocados;
+} ResultadoBenchmark;
+
+typedef struct {
+    ResultadoBenchmark* resultados;
+    int total;
+    int capacidade;
+    double tempoMinimo;      // Segundos que cada rodada medida deve durar
+    int saidaGuardada;       // Cópia do stdout enquanto ele aponta para /dev/null
+    int descarte;            // /dev/null aberto
+} RelatorioBenchmark;
+
+// Operação medida: repete a operação "operacoes" vezes
+typedef void (*FuncaoBenchmark)(void* contexto, long long operacoes);
+
+/*
+ * Função: criarRelatorio
+ * Prepara um relatório vazio com rodadas de "tempoMinimo" segundos
+ * Retorna 1 em caso de sucesso, 0 se /dev/null não puder ser aberto
+ */
+static inline int criarRelatorio(RelatorioBenchmark* relatorio, double tempoMinimo) {
+    memset(relatorio, 0, sizeof(*relatorio));
+    relatorio->tempoMinimo = tempoMinimo;
+    relatorio->saidaGuardada = -1;
+    relatorio->descarte = open("/dev/null", O_WRONLY);
+    return relatorio->descarte >= 0;
+}
+
+/*
+ * Função: liberarRelatorio
+ * Libera os resultados e fecha /dev/null
+ */
+static inline void liberarRelatorio(RelatorioBenchmark* relatorio) {
+    free(relatorio->resultados);
+    if (relatorio->descarte >= 0) {
+        close(relatorio->descarte);
+    }
+    memset(relatorio, 0, sizeof(*relatorio));
+}
+
+/*
+ * Função: silenciarSaida
+ * Desvia o stdout para /dev/null (as funções medidas imprimem no terminal)
+ */
+static inline void silenciarSaida(RelatorioBenchmark* relatorio) {
+    fflush(stdout);
+    relatorio->saidaGuardada = dup(STDOUT_FILENO);
+    dup2(relatorio->descarte, STDOUT_FILENO);
+}
+
+/*
+ * Função: restaurarSaida
+ * Devolve o stdout guardado por silenciarSaida()
+ */
+static inline void restaurarSaida(RelatorioBenchmark* relatorio) {
+    fflush(stdout);
+    if (relatorio->saidaGuardada >= 0) {
+        dup2(relatorio->saidaGuardada, STDOUT_FILENO);
+        close(relatorio->saidaGuardada);
+        relatorio->saidaGuardada = -1;
+    }
+}
+
+/*
+ * Função: segundosDesde
+ * Segundos decorridos desde "inicio" (relógio monotônico)
+ */
+static inline double segundosDesde(const struct timespec* inicio) {
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return (agora.tv_sec - inicio->tv_sec) + (agora.tv_nsec - inicio->tv_nsec) / 1e9;
+}
+
+/*
+ * Função: medirBenchmark
+ * Executa o caso com rodadas cada vez maiores até uma rodada durar o tempo
+ * mínimo (as rodadas curtas servem de aquecimento) e registra a última;
+ * "limite" restringe as operações por rodada (0 = sem limite)
+ * Retorna o resultado registrado ou NULL se faltar memória
+ */
+static inline const ResultadoBenchmark* medirBenchmark(RelatorioBenchmark* relatorio, const char* nome,
+                                                       long long territorios, long long limite,
+                                                       FuncaoBenchmark funcao, void* contexto) {
+    if (relatorio->total == relatorio->capacidade) {
+        int capacidade = relatorio->capacidade > 0 ? relatorio->capacidade * 2 : 32;
+        ResultadoBenchmark* resultados = (ResultadoBenchmark*)
+            realloc(relatorio->resultados, sizeof(ResultadoBenchmark) * (size_t) capacidade);
+        if (resultados == NULL) {
+            return NULL;
+        }
+        relatorio->resultados = resultados;
+        relatorio->capacidade = capacidade;
+    }
+    if (limite <= 0 || limite > MAX_OPERACOES_BENCHMARK) {
+        limite = MAX_OPERACOES_BENCHMARK;
+    }
+
+    long long operacoes = 1;
+    double segundos;
+    struct timespec inicio;
+    for (;;) {
+        silenciarSaida(relatorio);
+        ligarContagemAlocacoes(1);
+        clock_gettime(CLOCK_MONOTONIC, &inicio);
+        funcao(contexto, operacoes);
+        segundos = segundosDesde(&inicio);
+        ligarContagemAlocacoes(0);
+        restaurarSaida(relatorio);
+
+        if (segundos >= relatorio->tempoMinimo || operacoes >= limite) {
+            break;
+        }
+        // Estima a rodada que alcança o tempo mínimo (entre 2x e 100x a atual)
+        double fator = segundos > 0 ? 1.2 * relatorio->tempoMinimo / segundos : 100.0;
+        if (fator < 2.0) fator = 2.0;
+        if (fator > 100.0) fator = 100.0;
+        operacoes = (long long) (operacoes * fator);
+        if (operacoes > limite) {
+            operacoes = limite;
+        }
+    }
+
+    ResultadoBenchmark* r = &relatorio->resultados[relatorio->total++];
+    snprintf(r->nome, sizeof(r->nome), "%s", nome);
+    r->territorios = territorios;
+    r->operacoes = operacoes;
+    r->segundos = segundos;
+    r->alocacoes = CONTAGEM_ALOCACOES ? atomic_load(&totalAlocacoes) : -1;
+    r->bytesAlocados = CONTAGEM_ALOCACOES ? atomic_load(&totalBytesAlocados) : -1;
+    return r;
+}
+
+/*
+ * Função: exibirResultadoBenchmark
+ * Imprime uma linha legível do resultado
+ */
+static inline void exibirResultadoBenchmark(const ResultadoBenchmark* r) {
+    printf("%-24s %9lld territorios %14.1f ns/op %14.0f op/s %10lld alocacoes\n",
+           r->nome, r->territorios, 1e9 * r->segundos / r->operacoes,
+           r->segundos > 0 ? r->operacoes / r->segundos : 0.0, r->alocacoes);
+}
+
+/*
+ * Função: escreverRelatorioJSON
+ * Grava o relatório em JSON ("semente" e "threads" identificam a execução)
+ * Retorna 1 em caso de sucesso, 0 se a gravação falhar
+ */
+static inline int escreverRelatorioJSON(const RelatorioBenchmark* relatorio, const char* caminho,
+                                        uint64_t semente, int threads) {
+    FILE* arquivo = fopen(caminho, "w");
+    if (arquivo == NULL) {
+        return 0;
+    }
+
+    fprintf(arquivo, "{\n  \"semente\": %llu,\n  \"threads\": %d,\n  \"tempo_minimo_s\": %.3f,\n"
+                     "  \"contagem_alocacoes\": %s,\n  \"resultados\": [\n",
+            (unsigned long long) semente, threads, relatorio->tempoMinimo,
+            CONTAGEM_ALOCACOES ? "true" : "false");
+    for (int i = 0; i < relatorio->total; i++) {
+        const ResultadoBenchmark* r = &relatorio->resultados[i];
+        fprintf(arquivo,
+                "    {\"nome\": \"%s\", \"territorios\": %lld, \"operacoes\": %lld, "
+                "\"ns_por_op\": %.3f, \"ops_por_s\": %.1f, \"alocacoes\": %lld, "
+                "\"alocacoes_por_op\": %.4f, \"bytes_alocados\": %lld}%s\n",
+                r->nome, r->territorios, r->operacoes, 1e9 * r->segundos / r->operacoes,
+                r->segundos > 0 ? r->operacoes / r->segundos : 0.0, r->alocacoes,
+                r->alocacoes >= 0 ? (double) r->alocacoes / r->operacoes : -1.0,
+                r->bytesAlocados, i + 1 < relatorio->total ? "," : "");
+    }
+    fprintf(arquivo, "  ]\n}\n");
+    return fclose(arquivo) == 0;
+}
+
+// ==================== MAPAS SINTÉTICOS ====================
+
+// Cores dos mapas gerados (a "vermelha" é a cor da missão de eliminar)
+#define CORES_BENCHMARK 4
+static const char* const NOMES_CORES_BENCHMARK[CORES_BENCHMARK] = {
+    "azul", "verde", "vermelha", "amarela"
+};
+
+/*
+ * Função: gerarMapaBenchmark
+ * Monta em "jogo" um mapa de "quantidade" territórios com cores e tropas
+ * sorteadas pelo fluxo de dados do jogo (cerca de 1 em 8 nomes começa
+ * com 'B', para a missão de dominar a inicial)
+ * Retorna 1 em caso de sucesso, 0 se faltar memória
+ */
+static inline int gerarMapaBenchmark(Jogo* jogo, int quantidade) {
+    Territorio* mapa = (Territorio*) malloc(sizeof(Territorio) * (size_t) quantidade);
+    if (mapa == NULL) {
+        return 0;
+    }
+
+    // Os nomes gerados são todos distintos: entram no pool sem a busca por repetidos
+    PoolNomes pool;
+    if (!iniciarPool(&pool, (size_t) quantidade * 16)) {
+        free(mapa);
+        return 0;
+    }
+
+    IdCor cores[CORES_BENCHMARK];
+    for (int c = 0; c < CORES_BENCHMARK; c++) {
+        cores[c] = internarCor(&jogo->cores, NOMES_CORES_BENCHMARK[c]);
+    }
+    for (int i = 0; i < quantidade; i++) {
+        uint32_t sorteio = proximoU32(&jogo->dados);
+        char nome[32];
+        int tamanho = snprintf(nome, sizeof(nome), "%s %d", (sorteio & 7) == 0 ? "Bacia" : "Regiao", i + 1);
+        uint32_t deslocamento = acrescentarNome(&pool, nome, (size_t) tamanho);
+        if (deslocamento == POOL_ERRO) {
+            liberarPool(&pool);
+            free(mapa);
+            return 0;
+        }
+        nomearTerritorio(&mapa[i], &pool, deslocamento);
+        mapa[i].cor = cores[(sorteio >> 3) % CORES_BENCHMARK];
+        mapa[i].tropas = 1 + (int) ((sorteio >> 8) % 10);
+    }
+
+    encerrarPool(&pool);
+    jogo->mapa = mapa;
+    jogo->numTerritorios = quantidade;
+    jogo->pool = pool;
+    jogo->regiaoMapeada = NULL;
+    jogo->tamanhoRegiao = 0;
+    jogo->mapaExterno = 0;
+    recalcularAgregados(jogo);
+    return 1;
+}
+
+#endif // WAR_BENCHMARK_H
@@ -0,0 +1,869 @@
+/*
+ * Carregador de Mapas e Jogadores do Sistema WAR
+ *
+ * Monta a partida direto de arquivos, sem os prompts do cadastro:
+ *   - Mapa CSV: uma linha "nome,cor,tropas" por território
+ *   - Mapa binário: cabeçalho fixo + vetor de Territorio + fronteiras (CSR)
+ *     + pool de nomes, mapeado com mmap (cópia privada): a carga só confere
+ *     os registros e refaz os totais, sem copiar nem converter nada
+ *   - Fronteiras CSV: uma linha "a,b" (números dos territórios, a partir de 1)
+ *   - Continentes CSV: uma linha "continente,territorio" por território
+ *   - Jogadores CSV: uma linha "nome,cor[,missao]" por jogador
+ * Linhas vazias e iniciadas por '#' são ignoradas, assim como uma linha
+ * de cabeçalho ("nome,cor,tropas").
+ */
+
+#ifndef WAR_CARREGADOR_H
+#define WAR_CARREGADOR_H
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "war_engine.h"
+#include "war_missoes.h"
+
+// Identificação do formato binário de mapa
+#define MAGICA_MAPA "WARMAPA1"
+#define VERSAO_MAPA 3
+
+// Cabeçalho do mapa binário; os territórios vêm logo em seguida, depois,
+// se houver fronteiras, os vetores "inicio" (numTerritorios + 1) e
+// "vizinhos" do CSR e, no fim, o texto do pool de nomes
+typedef struct {
+    char magica[8];             // MAGICA_MAPA (sem '\0')
+    uint32_t versao;            // VERSAO_MAPA
+    uint32_t tamanhoRegistro;   // sizeof(Territorio) de quem gravou
+    uint64_t numTerritorios;
+    uint64_t numVizinhos;       // Entradas do vetor "vizinhos"
+    uint32_t temFronteiras;     // 1 se o CSR foi gravado
+    uint32_t reservado;
+    uint64_t tamanhoNomes;      // Bytes do pool de nomes (o último é '\0')
+    TabelaCores cores;          // Cores na ordem dos IDs usados nos registros
+    AgregadosMapa agregados;    // Totais por cor (refeitos na carga)
+} CabecalhoMapa;
+
+// Códigos devolvidos pelo carregador
+typedef enum {
+    CARGA_OK = 0,
+    CARGA_ERRO_ARQUIVO,   // Arquivo inexistente ou ilegível
+    CARGA_ERRO_FORMATO,   // Conteúdo fora do formato esperado
+    CARGA_ERRO_MEMORIA,   // Falha de alocação/mapeamento
+    CARGA_ERRO_CORES      // Mais cores do que a TabelaCores comporta
+} CodigoCarga;
+
+/*
+ * Função: mensagemCarga
+ * Retorna o texto correspondente a um código do carregador
+ */
+static inline const char* mensagemCarga(CodigoCarga codigo) {
+    switch (codigo) {
+        case CARGA_OK:           return "Arquivo carregado";
+        case CARGA_ERRO_ARQUIVO: return "Nao foi possivel ler o arquivo";
+        case CARGA_ERRO_FORMATO: return "Formato de arquivo invalido";
+        case CARGA_ERRO_MEMORIA: return "Memoria insuficiente para o arquivo";
+        case CARGA_ERRO_CORES:   return "Limite de cores atingido";
+    }
+    return "Erro desconhecido";
+}
+
+// ==================== LEITURA DE TEXTO ====================
+
+/*
+ * Função: lerArquivoInteiro
+ * Lê o arquivo todo para um buffer alocado (terminado em '\0')
+ */
+static inline CodigoCarga lerArquivoInteiro(const char* caminho, char** conteudo, size_t* tamanho) {
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) {
+        return CARGA_ERRO_ARQUIVO;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return CARGA_ERRO_ARQUIVO;
+    }
+
+    char* buffer = (char*) malloc((size_t) info.st_size + 1);
+    if (buffer == NULL) {
+        close(fd);
+        return CARGA_ERRO_MEMORIA;
+    }
+
+    size_t lidos = 0;
+    while (lidos < (size_t) info.st_size) {
+        ssize_t n = read(fd, buffer + lidos, (size_t) info.st_size - lidos);
+        if (n <= 0) {
+            free(buffer);
+            close(fd);
+            return CARGA_ERRO_ARQUIVO;
+        }
+        lidos += (size_t) n;
+    }
+    close(fd);
+
+    buffer[lidos] = '\0';
+    *conteudo = buffer;
+    *tamanho = lidos;
+    return CARGA_OK;
+}
+
+/*
+ * Função: proximaLinhaCSV
+ * Separa a próxima linha útil do texto em até 3 campos (sem espaços nas pontas)
+ * Parâmetros:
+ *   - cursor: posição atual no texto (avança para a linha seguinte)
+ *   - fim: fim do texto
+ *   - campos/tamanhos: início e comprimento de cada campo
+ * Retorna a quantidade de campos da linha ou 0 quando o texto acabou
+ */
+static inline int proximaLinhaCSV(const char** cursor, const char* fim,
+                                  const char* campos[3], int tamanhos[3]) {
+    while (*cursor < fim) {
+        const char* inicio = *cursor;
+        const char* quebra = (const char*) memchr(inicio, '\n', (size_t) (fim - inicio));
+        const char* fimLinha = quebra != NULL ? quebra : fim;
+        *cursor = quebra != NULL ? quebra + 1 : fim;
+
+        while (inicio < fimLinha && (*inicio == ' ' || *inicio == '\t')) inicio++;
+        if (inicio == fimLinha || *inicio == '#' || *inicio == '\r') {
+            continue; // Linha vazia ou comentário
+        }
+
+        int total = 0;
+        const char* campo = inicio;
+        while (total < 3) {
+            const char* virgula = total < 2 ? (const char*) memchr(campo, ',', (size_t) (fimLinha - campo)) : NULL;
+            const char* fimCampo = virgula != NULL ? virgula : fimLinha;
+            const char* a = campo;
+            const char* b = fimCampo;
+            while (a < b && (*a == ' ' || *a == '\t')) a++;
+            while (b > a && (b[-1] == ' ' || b[-1] == '\t' || b[-1] == '\r')) b--;
+            campos[total] = a;
+            tamanhos[total] = (int) (b - a);
+            total++;
+            if (virgula == NULL) break;
+            campo = virgula + 1;
+        }
+        return total;
+    }
+    return 0;
+}
+
+/*
+ * Função: copiarCampo
+ * Copia um campo para "destino" (com '\0'), truncando em "capacidade - 1"
+ */
+static inline void copiarCampo(char* destino, int capacidade, const char* campo, int tamanho) {
+    if (tamanho > capacidade - 1) tamanho = capacidade - 1;
+    memcpy(destino, campo, (size_t) tamanho);
+    destino[tamanho] = '\0';
+}
+
+/*
+ * Função: campoNumerico
+ * Retorna 1 se o campo é um inteiro (com sinal opcional)
+ */
+static inline int campoNumerico(const char* campo, int tamanho) {
+    int i = (tamanho > 0 && (campo[0] == '-' || campo[0] == '+')) ? 1 : 0;
+    if (i >= tamanho) return 0;
+    for (; i < tamanho; i++) {
+        if (campo[i] < '0' || campo[i] > '9') return 0;
+    }
+    return 1;
+}
+
+/*
+ * Função: converterCampo
+ * Converte um campo numérico já validado em inteiro
+ * Valores fora de long long saturam (e ficam fora de qualquer faixa conferida)
+ */
+static inline long long converterCampo(const char* campo, int tamanho) {
+    int negativo = tamanho > 0 && campo[0] == '-';
+    int i = (tamanho > 0 && (campo[0] == '-' || campo[0] == '+')) ? 1 : 0;
+    long long valor = 0;
+    for (; i < tamanho; i++) {
+        if (valor > (LLONG_MAX - 9) / 10) {
+            valor = LLONG_MAX;
+            break;
+        }
+        valor = valor * 10 + (campo[i] - '0');
+    }
+    return negativo ? -valor : valor;
+}
+
+/*
+ * Função: internarCampoCor
+ * Interna a cor de um campo, reaproveitando o ID da linha anterior quando
+ * o texto se repete (comum em mapas grandes)
+ */
+static inline IdCor internarCampoCor(TabelaCores* cores, const char* campo, int tamanho,
+                                     const char** ultimoCampo, int* ultimoTamanho, IdCor* ultimaCor) {
+    if (*ultimoCampo != NULL && *ultimoTamanho == tamanho &&
+        memcmp(*ultimoCampo, campo, (size_t) tamanho) == 0) {
+        return *ultimaCor;
+    }
+
+    char nome[TAM_COR];
+    copiarCampo(nome, TAM_COR, campo, tamanho);
+    *ultimaCor = internarCor(cores, nome);
+    *ultimoCampo = campo;
+    *ultimoTamanho = tamanho;
+    return *ultimaCor;
+}
+
+// ==================== MAPAS ====================
+
+/*
+ * Função: validarTerritorios
+ * Confere os territórios lidos de um arquivo antes do uso: cor internada
+ * (ela indexa os agregados e a posse), tropas não negativas e nome dentro
+ * do pool (que termina em '\0')
+ * Retorna 1 se todos são válidos
+ */
+static inline int validarTerritorios(const Territorio* mapa, int numTerritorios, int numCores,
+                                     uint64_t tamanhoNomes) {
+    for (int i = 0; i < numTerritorios; i++) {
+        if (mapa[i].cor >= numCores || mapa[i].tropas < 0 || mapa[i].nome >= tamanhoNomes) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Função: carregarMapaCSV
+ * Monta o mapa da partida a partir de um arquivo "nome,cor,tropas"
+ * Usa a TabelaCores já existente em "jogo" (as cores são acrescentadas)
+ */
+static inline CodigoCarga carregarMapaCSV(const char* caminho, Jogo* jogo) {
+    char* texto;
+    size_t tamanho;
+    CodigoCarga codigo = lerArquivoInteiro(caminho, &texto, &tamanho);
+    if (codigo != CARGA_OK) {
+        return codigo;
+    }
+
+    // Uma contagem de quebras de linha limita a quantidade de territórios
+    size_t linhas = 1;
+    for (const char* p = texto; (p = (const char*) memchr(p, '\n', (size_t) (texto + tamanho - p))) != NULL; p++) {
+        linhas++;
+    }
+
+    Territorio* mapa = (Territorio*) calloc(linhas, sizeof(Territorio));
+    PoolNomes pool;
+    if (!iniciarPool(&pool, tamanho / 2) || mapa == NULL || !reservarNomesPool(&pool, linhas)) {
+        liberarPool(&pool);
+        free(mapa);
+        free(texto);
+        return CARGA_ERRO_MEMORIA;
+    }
+
+    const char* cursor = texto;
+    const char* fim = texto + tamanho;
+    const char* campos[3];
+    int tamanhos[3];
+    const char* ultimoCampo = NULL;
+    int ultimoTamanho = 0;
+    IdCor ultimaCor = COR_INVALIDA;
+    int total = 0;
+    int camposLidos;
+
+    while ((camposLidos = proximaLinhaCSV(&cursor, fim, campos, tamanhos)) > 0) {
+        if (camposLidos < 3 || !campoNumerico(campos[2], tamanhos[2])) {
+            if (total == 0 && camposLidos == 3) {
+                continue; // Linha de cabeçalho
+            }
+            codigo = CARGA_ERRO_FORMATO;
+            break;
+        }
+
+        Territorio* t = &mapa[total++];
+        uint32_t nome = internarNome(&pool, campos[0], (size_t) tamanhos[0]);
+        if (nome == POOL_ERRO) {
+            codigo = CARGA_ERRO_MEMORIA;
+            break;
+        }
+        nomearTerritorio(t, &pool, nome);
+        t->cor = internarCampoCor(&jogo->cores, campos[1], tamanhos[1],
+                                  &ultimoCampo, &ultimoTamanho, &ultimaCor);
+        long long tropas = converterCampo(campos[2], tamanhos[2]);
+        if (t->cor == COR_INVALIDA) {
+            codigo = CARGA_ERRO_CORES;
+            break;
+        }
+        if (tropas < 0 || tropas > INT32_MAX) {
+            codigo = CARGA_ERRO_FORMATO;
+            break;
+        }
+        t->tropas = (int) tropas;
+    }
+    free(texto);
+
+    if (codigo == CARGA_OK && total == 0) {
+        codigo = CARGA_ERRO_FORMATO;
+    }
+    if (codigo != CARGA_OK) {
+        liberarPool(&pool);
+        free(mapa);
+        return codigo;
+    }
+
+    encerrarPool(&pool);
+    jogo->mapa = mapa;
+    jogo->numTerritorios = total;
+    jogo->pool = pool;
+    jogo->regiaoMapeada = NULL;
+    jogo->tamanhoRegiao = 0;
+    jogo->mapaExterno = 0;
+    recalcularAgregados(jogo);
+    return CARGA_OK;
+}
+
+/*
+ * Função: carregarMapaBinario
+ * Mapeia um mapa binário com mmap (cópia privada: as batalhas alteram
+ * apenas a memória do processo). As cores vêm do cabeçalho e o pool de
+ * nomes é usado direto da região; cores, territórios e fronteiras são
+ * conferidos em uma passada O(territórios + fronteiras) e os agregados
+ * são refeitos, então um arquivo truncado ou adulterado é recusado
+ */
+static inline CodigoCarga carregarMapaBinario(const char* caminho, Jogo* jogo) {
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) {
+        return CARGA_ERRO_ARQUIVO;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(CabecalhoMapa)) {
+        close(fd);
+        return CARGA_ERRO_FORMATO;
+    }
+
+    size_t tamanho = (size_t) info.st_size;
+    void* regiao = mmap(NULL, tamanho, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (regiao == MAP_FAILED) {
+        return CARGA_ERRO_MEMORIA;
+    }
+
+    const CabecalhoMapa* cabecalho = (const CabecalhoMapa*) regiao;
+    size_t tamanhoMapa = sizeof(CabecalhoMapa) + cabecalho->numTerritorios * sizeof(Territorio);
+    size_t tamanhoGrafo = cabecalho->temFronteiras
+                        ? sizeof(uint32_t) * (cabecalho->numTerritorios + 1 + cabecalho->numVizinhos)
+                        : 0;
+    PoolNomes pool;
+    if (memcmp(cabecalho->magica, MAGICA_MAPA, 8) != 0 ||
+        cabecalho->versao != VERSAO_MAPA ||
+        cabecalho->tamanhoRegistro != sizeof(Territorio) ||
+        cabecalho->numTerritorios > INT32_MAX || cabecalho->numVizinhos > UINT32_MAX ||
+        cabecalho->tamanhoNomes > UINT32_MAX ||
+        !validarCores(&cabecalho->cores) ||
+        tamanho < tamanhoMapa + tamanhoGrafo + cabecalho->tamanhoNomes ||
+        !apontarPool(&pool, (const char*) regiao + tamanhoMapa + tamanhoGrafo, cabecalho->tamanhoNomes) ||
+        !validarTerritorios((const Territorio*) ((const char*) regiao + sizeof(CabecalhoMapa)),
+                            (int) cabecalho->numTerritorios, cabecalho->cores.total, cabecalho->tamanhoNomes) ||
+        (cabecalho->temFronteiras &&
+         !validarGrafo((const uint32_t*) ((const char*) regiao + tamanhoMapa),
+                       (const uint32_t*) ((const char*) regiao + tamanhoMapa) + cabecalho->numTerritorios + 1,
+                       (int) cabecalho->numTerritorios, (uint32_t) cabecalho->numVizinhos))) {
+        munmap(regiao, tamanho);
+        return CARGA_ERRO_FORMATO;
+    }
+
+    inicializarGrafo(&jogo->grafo);
+    if (cabecalho->temFronteiras) {
+        const uint32_t* inicio = (const uint32_t*) ((const char*) regiao + tamanhoMapa);
+        jogo->grafo.numTerritorios = (int) cabecalho->numTerritorios;
+        jogo->grafo.numVizinhos = (uint32_t) cabecalho->numVizinhos;
+        jogo->grafo.inicio = inicio;
+        jogo->grafo.vizinhos = inicio + cabecalho->numTerritorios + 1;
+    }
+
+    jogo->mapa = (Territorio*) ((char*) regiao + sizeof(CabecalhoMapa));
+    jogo->numTerritorios = (int) cabecalho->numTerritorios;
+    jogo->pool = pool;
+    jogo->cores = cabecalho->cores;
+    jogo->regiaoMapeada = regiao;
+    jogo->tamanhoRegiao = tamanho;
+    jogo->mapaExterno = 0;
+    recalcularAgregados(jogo);
+    return CARGA_OK;
+}
+
+/*
+ * Função: carregarMapa
+ * Carrega um mapa binário (reconhecido pela assinatura) ou CSV
+ */
+static inline CodigoCarga carregarMapa(const char* caminho, Jogo* jogo) {
+    char magica[8] = {0};
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) {
+        return CARGA_ERRO_ARQUIVO;
+    }
+    ssize_t lidos = read(fd, magica, sizeof(magica));
+    close(fd);
+
+    if (lidos == (ssize_t) sizeof(magica) && memcmp(magica, MAGICA_MAPA, 8) == 0) {
+        return carregarMapaBinario(caminho, jogo);
+    }
+    return carregarMapaCSV(caminho, jogo);
+}
+
+/*
+ * Função: salvarMapaBinario
+ * Grava o mapa da partida no formato binário lido por carregarMapaBinario()
+ */
+static inline CodigoCarga salvarMapaBinario(const char* caminho, const Jogo* jogo) {
+    CabecalhoMapa cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.magica, MAGICA_MAPA, 8);
+    cabecalho.versao = VERSAO_MAPA;
+    cabecalho.tamanhoRegistro = sizeof(Territorio);
+    cabecalho.numTerritorios = (uint64_t) jogo->numTerritorios;
+    cabecalho.temFronteiras = grafoAtivo(&jogo->grafo) ? 1 : 0;
+    cabecalho.numVizinhos = cabecalho.temFronteiras ? jogo->grafo.numVizinhos : 0;
+    cabecalho.tamanhoNomes = tamanhoPool(&jogo->pool);
+    cabecalho.cores = jogo->cores;
+    cabecalho.agregados = jogo->agregados;
+
+    int fd = open(caminho, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return CARGA_ERRO_ARQUIVO;
+    }
+
+    const char* partes[5] = {
+        (const char*) &cabecalho, (const char*) jogo->mapa,
+        (const char*) jogo->grafo.inicio, (const char*) jogo->grafo.vizinhos,
+        textoPool(&jogo->pool)
+    };
+    size_t tamanhos[5] = {
+        sizeof(cabecalho), sizeof(Territorio) * (size_t) jogo->numTerritorios,
+        cabecalho.temFronteiras ? sizeof(uint32_t) * ((size_t) jogo->numTerritorios + 1) : 0,
+        sizeof(uint32_t) * (size_t) cabecalho.numVizinhos,
+        (size_t) cabecalho.tamanhoNomes
+    };
+    for (int i = 0; i < 5; i++) {
+        size_t escritos = 0;
+        while (escritos < tamanhos[i]) {
+            ssize_t n = write(fd, partes[i] + escritos, tamanhos[i] - escritos);
+            if (n <= 0) {
+                close(fd);
+                return CARGA_ERRO_ARQUIVO;
+            }
+            escritos += (size_t) n;
+        }
+    }
+    return close(fd) == 0 ? CARGA_OK : CARGA_ERRO_ARQUIVO;
+}
+
+/*
+ * Função: carregarFronteirasCSV
+ * Monta o grafo de fronteiras do mapa atual a partir de um arquivo "a,b"
+ * (números dos territórios, a partir de 1, como no menu)
+ */
+static inline CodigoCarga carregarFronteirasCSV(const char* caminho, Jogo* jogo) {
+    char* texto;
+    size_t tamanho;
+    CodigoCarga codigo = lerArquivoInteiro(caminho, &texto, &tamanho);
+    if (codigo != CARGA_OK) {
+        return codigo;
+    }
+
+    size_t linhas = 1;
+    for (const char* p = texto; (p = (const char*) memchr(p, '\n', (size_t) (texto + tamanho - p))) != NULL; p++) {
+        linhas++;
+    }
+
+    Fronteira* fronteiras = (Fronteira*) malloc(sizeof(Fronteira) * linhas);
+    if (fronteiras == NULL) {
+        free(texto);
+        return CARGA_ERRO_MEMORIA;
+    }
+
+    const char* cursor = texto;
+    const char* fim = texto + tamanho;
+    const char* campos[3];
+    int tamanhos[3];
+    size_t total = 0;
+    int camposLidos;
+
+    while ((camposLidos = proximaLinhaCSV(&cursor, fim, campos, tamanhos)) > 0) {
+        if (camposLidos < 2 || !campoNumerico(campos[0], tamanhos[0]) ||
+            !campoNumerico(campos[1], tamanhos[1])) {
+            if (total == 0 && camposLidos >= 2) {
+                continue; // Linha de cabeçalho
+            }
+            codigo = CARGA_ERRO_FORMATO;
+            break;
+        }
+
+        long long a = converterCampo(campos[0], tamanhos[0]);
+        long long b = converterCampo(campos[1], tamanhos[1]);
+        if (a < 1 || a > jogo->numTerritorios || b < 1 || b > jogo->numTerritorios) {
+            codigo = CARGA_ERRO_FORMATO;
+            break;
+        }
+        fronteiras[total].origem = (uint32_t) (a - 1);
+        fronteiras[total].destino = (uint32_t) (b - 1);
+        total++;
+    }
+    free(texto);
+
+    if (codigo == CARGA_OK) {
+        GrafoAdjacencia grafo;
+        if (construirGrafo(&grafo, jogo->numTerritorios, fronteiras, total)) {
+            liberarGrafo(&jogo->grafo);
+            jogo->grafo = grafo;
+        } else {
+            codigo = CARGA_ERRO_MEMORIA;
+        }
+    }
+    free(fronteiras);
+    return codigo;
+}
+
+/*
+ * Função: carregarContinentesCSV
+ * Monta os continentes do mapa atual a partir de um arquivo
+ * "continente,territorio" (número do território, a partir de 1) e ativa
+ * a posse por cor usada nas missões de continentes
+ */
+static inline CodigoCarga carregarContinentesCSV(const char* caminho, Jogo* jogo) {
+    char* texto;
+    size_t tamanho;
+    CodigoCarga codigo = lerArquivoInteiro(caminho, &texto, &tamanho);
+    if (codigo != CARGA_OK) {
+        return codigo;
+    }
+
+    size_t linhas = 1;
+    for (const char* p = texto; (p = (const char*) memchr(p, '\n', (size_t) (texto + tamanho - p))) != NULL; p++) {
+        linhas++;
+    }
+
+    MembroContinente* membros = (MembroContinente*) malloc(sizeof(MembroContinente) * linhas);
+    if (membros == NULL) {
+        free(texto);
+        return CARGA_ERRO_MEMORIA;
+    }
+
+    Continentes lidos;   // Só os nomes, na ordem em que aparecem
+    inicializarContinentes(&lidos);
+
+    const char* cursor = texto;
+    const char* fim = texto + tamanho;
+    const char* campos[3];
+    int tamanhos[3];
+    size_t total = 0;
+    int camposLidos;
+
+    while ((camposLidos = proximaLinhaCSV(&cursor, fim, campos, tamanhos)) > 0) {
+        if (camposLidos < 2 || tamanhos[0] == 0 || !campoNumerico(campos[1], tamanhos[1])) {
+            if (total == 0 && camposLidos >= 2) {
+                continue; // Linha de cabeçalho
+            }
+            codigo = CARGA_ERRO_FORMATO;
+            break;
+        }
+
+        long long territorio = converterCampo(campos[1], tamanhos[1]);
+        int continente = buscarContinente(&lidos, campos[0], (size_t) tamanhos[0]);
+        if (territorio < 1 || territorio > jogo->numTerritorios ||
+            (continente < 0 && (lidos.total >= MAX_CONTINENTES || tamanhos[0] >= TAM_CONTINENTE))) {
+            codigo = CARGA_ERRO_FORMATO;
+            break;
+        }
+        if (continente < 0) {
+            continente = lidos.total++;
+            copiarCampo(lidos.nomes[continente], TAM_CONTINENTE, campos[0], tamanhos[0]);
+        }
+        membros[total].continente = (uint32_t) continente;
+        membros[total].territorio = (uint32_t) (territorio - 1);
+        total++;
+    }
+    free(texto);
+
+    if (codigo == CARGA_OK && total == 0) {
+        codigo = CARGA_ERRO_FORMATO;
+    }
+    if (codigo == CARGA_OK) {
+        Continentes continentes;
+        if (construirContinentes(&continentes, jogo->numTerritorios, (const char (*)[TAM_CONTINENTE]) lidos.nomes,
+                                 lidos.total, membros, total)) {
+            liberarContinentes(&jogo->continentes);
+            jogo->continentes = continentes;
+            if (!ativarPosse(jogo)) {
+                liberarContinentes(&jogo->continentes);
+                codigo = CARGA_ERRO_MEMORIA;
+            }
+        } else {
+            codigo = CARGA_ERRO_MEMORIA;
+        }
+    }
+    free(membros);
+    return codigo;
+}
+
+/*
+ * Função: liberarMapa
+ * Libera o mapa da partida, seja ele alocado (calloc) ou mapeado (mmap),
+ * junto com as fronteiras, os continentes, a posse, os grupos de jogadas,
+ * o pool e o índice de nomes, o rascunho de buscas e as colunas (um mapa
+ * reservado em uma arena fica para a arena)
+ */
+static inline void liberarMapa(Jogo* jogo) {
+    liberarGrafo(&jogo->grafo);
+    liberarContinentes(&jogo->continentes);
+    liberarPosse(&jogo->posse);
+    liberarJogadas(&jogo->jogadas);
+    liberarPool(&jogo->pool);
+    liberarIndiceNomes(&jogo->nomes);
+    liberarBusca(&jogo->busca);
+    liberarMapaColunar(&jogo->colunas);
+    if (jogo->regiaoMapeada != NULL) {
+        munmap(jogo->regiaoMapeada, jogo->tamanhoRegiao);
+    } else if (!jogo->mapaExterno) {
+        free(jogo->mapa);
+    }
+    jogo->mapa = NULL;
+    jogo->mapaExterno = 0;
+    jogo->regiaoMapeada = NULL;
+    jogo->tamanhoRegiao = 0;
+    jogo->numTerritorios = 0;
+}
+
+/*
+ * Função: manterCores
+ * Faz um mapa recém-carregado usar os IDs de "anteriores" (a tabela da
+ * partida, à qual jogadores e missões se referem): as cores do arquivo
+ * são internadas nela e, se algum ID mudou, os territórios são traduzidos
+ * e os agregados refeitos. Um mapa CSV já foi lido sobre a tabela da
+ * partida e não muda; um binário traz a tabela de quem o gravou
+ * Retorna CARGA_OK ou CARGA_ERRO_CORES se as cores novas não couberem
+ */
+static inline CodigoCarga manterCores(Jogo* jogo, const TabelaCores* anteriores) {
+    TabelaCores cores = *anteriores;
+    IdCor traducao[MAX_CORES];
+    int mesmosIds = 1;
+    for (int c = 0; c < jogo->cores.total; c++) {
+        traducao[c] = internarCor(&cores, jogo->cores.nomes[c]);
+        if (traducao[c] == COR_INVALIDA) {
+            return CARGA_ERRO_CORES;
+        }
+        mesmosIds &= traducao[c] == c;
+    }
+
+    jogo->cores = cores;
+    if (!mesmosIds) {
+        for (int i = 0; i < jogo->numTerritorios; i++) {
+            jogo->mapa[i].cor = traducao[jogo->mapa[i].cor];
+        }
+        recalcularAgregados(jogo);
+    }
+    return CARGA_OK;
+}
+
+/*
+ * Função: substituirMapa
+ * Troca o mapa de uma partida em andamento pelo mapa do arquivo,
+ * mantendo cores (ver manterCores()), fluxo de dados e regra (as
+ * fronteiras e os continentes antigos são descartados; as colunas, os
+ * grupos de jogadas e o índice de nomes são refeitos se estavam ativos)
+ * Se a carga falhar, a partida continua com o mapa anterior; se faltar
+ * memória só para as colunas, as jogadas ou o índice, o novo mapa fica
+ * sem eles e o retorno é CARGA_ERRO_MEMORIA
+ */
+static inline CodigoCarga substituirMapa(const char* caminho, Jogo* jogo) {
+    Jogo novo = *jogo;
+    novo.mapa = NULL;
+    novo.numTerritorios = 0;
+    novo.regiaoMapeada = NULL;
+    novo.tamanhoRegiao = 0;
+    novo.mapaExterno = 0;
+    inicializarGrafo(&novo.grafo);
+    inicializarContinentes(&novo.continentes);
+    memset(&novo.posse, 0, sizeof(novo.posse));
+    memset(&novo.jogadas, 0, sizeof(novo.jogadas));
+    memset(&novo.pool, 0, sizeof(novo.pool));
+    memset(&novo.nomes, 0, sizeof(novo.nomes));
+    memset(&novo.busca, 0, sizeof(novo.busca));
+    memset(&novo.colunas, 0, sizeof(novo.colunas));
+
+    CodigoCarga codigo = carregarMapa(caminho, &novo);
+    if (codigo != CARGA_OK) {
+        return codigo;
+    }
+    codigo = manterCores(&novo, &jogo->cores);
+    if (codigo != CARGA_OK) {
+        liberarMapa(&novo);
+        return codigo;
+    }
+
+    int comColunas = jogo->colunas.donos != NULL;
+    int comJogadas = jogo->jogadas.numTerritorios > 0;
+    int comNomes = jogo->nomes.numTerritorios > 0;
+    liberarMapa(jogo);
+    *jogo = novo;
+    if ((comColunas && !ativarColunas(jogo)) || (comJogadas && !ativarJogadas(jogo)) ||
+        (comNomes && !ativarIndiceNomes(jogo))) {
+        return CARGA_ERRO_MEMORIA;
+    }
+    return CARGA_OK;
+}
+
+// ==================== JOGADORES ====================
+
+/*
+ * Função: lerMissaoContinente
+ * Reconhece em um campo uma missão de continentes: "continente NOME"
+ * (dominar o continente) ou "continentes N" (dominar N continentes inteiros)
+ * Retorna 1 se a missão foi lida, 0 se o campo não é uma missão de
+ * continentes e -1 se o continente não existe ou N é inválido
+ */
+static inline int lerMissaoContinente(const char* campo, int tamanho, const Continentes* continentes,
+                                      Missao* missao) {
+    int palavra = 0;
+    while (palavra < tamanho && campo[palavra] != ' ' && campo[palavra] != '\t') palavra++;
+    int resto = palavra;
+    while (resto < tamanho && (campo[resto] == ' ' || campo[resto] == '\t')) resto++;
+
+    int plural;
+    if (palavra == 10 && strncasecmp(campo, "continente", 10) == 0) {
+        plural = 0;
+    } else if (palavra == 11 && strncasecmp(campo, "continentes", 11) == 0) {
+        plural = 1;
+    } else {
+        return 0;
+    }
+
+    memset(missao, 0, sizeof(*missao));
+    missao->cor = COR_INVALIDA;
+    if (plural) {
+        if (!campoNumerico(campo + resto, tamanho - resto)) {
+            return -1;
+        }
+        long long quantidade = converterCampo(campo + resto, tamanho - resto);
+        if (quantidade < 1 || quantidade > continentes->total) {
+            return -1;
+        }
+        missao->tipo = MISSAO_CONTINENTES_COMPLETOS;
+        missao->quantidade = (int) quantidade;
+    } else {
+        int continente = buscarContinente(continentes, campo + resto, (size_t) (tamanho - resto));
+        if (resto == tamanho || continente < 0) {
+            return -1;
+        }
+        missao->tipo = MISSAO_DOMINAR_CONTINENTE;
+        missao->quantidade = continente;
+    }
+    return 1;
+}
+
+/*
+ * Função: carregarJogadoresCSV
+ * Cria o vetor de jogadores a partir de um arquivo "nome,cor[,missao]"
+ * A missão é o número (1 a TOTAL_MISSOES) no catálogo ou uma missão de
+ * continentes ("continente NOME", "continentes N"); sem ela, a missão é
+ * sorteada do catálogo com o fluxo de dados da partida. Um número fora do
+ * catálogo recusa o arquivo (CARGA_ERRO_FORMATO)
+ * Parâmetros:
+ *   - jogadores/numJogadores: recebem o vetor alocado (liberar com free) e o tamanho
+ *   - continentes: continentes já carregados do mapa (podem estar vazios)
+ */
+static inline CodigoCarga carregarJogadoresCSV(const char* caminho, Jogador** jogadores, int* numJogadores,
+                                               const Missao catalogo[], GeradorDados* dados,
+                                               TabelaCores* cores, const Continentes* continentes) {
+    char* texto;
+    size_t tamanho;
+    CodigoCarga codigo = lerArquivoInteiro(caminho, &texto, &tamanho);
+    if (codigo != CARGA_OK) {
+        return codigo;
+    }
+
+    size_t linhas = 1;
+    for (const char* p = texto; (p = (const char*) memchr(p, '\n', (size_t) (texto + tamanho - p))) != NULL; p++) {
+        linhas++;
+    }
+
+    Jogador* vetor = (Jogador*) calloc(linhas, sizeof(Jogador));
+    if (vetor == NULL) {
+        free(texto);
+        return CARGA_ERRO_MEMORIA;
+    }
+
+    const char* cursor = texto;
+    const char* fim = texto + tamanho;
+    const char* campos[3];
+    int tamanhos[3];
+    int total = 0;
+    int camposLidos;
+
+    while ((camposLidos = proximaLinhaCSV(&cursor, fim, campos, tamanhos)) > 0) {
+        if (camposLidos < 2) {
+            codigo = CARGA_ERRO_FORMATO;
+            break;
+        }
+        Missao lida;
+        int continente = camposLidos == 3 ? lerMissaoContinente(campos[2], tamanhos[2], continentes, &lida) : 0;
+        // Cabeçalho: "nome,cor[,missao]" (a cor não tem formato próprio, então
+        // o nome da coluna é comparado) ou uma terceira coluna que não é missão
+        int colunaCor = tamanhos[1] == 3 && strncasecmp(campos[1], "cor", 3) == 0;
+        if (total == 0 && (colunaCor || (camposLidos == 3 && tamanhos[2] > 0 &&
+                                         !campoNumerico(campos[2], tamanhos[2]) && continente == 0))) {
+            continue;
+        }
+
+        Jogador* j = &vetor[total++];
+        char nomeCorLido[TAM_COR];
+        copiarCampo(j->nome, (int) sizeof(j->nome), campos[0], tamanhos[0]);
+        copiarCampo(nomeCorLido, TAM_COR, campos[1], tamanhos[1]);
+        j->cor = internarCor(cores, nomeCorLido);
+        if (j->cor == COR_INVALIDA) {
+            codigo = CARGA_ERRO_CORES;
+            break;
+        }
+
+        if (continente != 0) {
+            if (continente < 0) {
+                codigo = CARGA_ERRO_FORMATO;
+                break;
+            }
+            j->missao = lida;
+            continue;
+        }
+
+        if (camposLidos == 3 && tamanhos[2] > 0) {
+            long long missao = campoNumerico(campos[2], tamanhos[2]) ? converterCampo(campos[2], tamanhos[2]) : 0;
+            if (missao < 1 || missao > TOTAL_MISSOES) {
+                codigo = CARGA_ERRO_FORMATO; // Missão fora do catálogo
+                break;
+            }
+            j->missao = catalogo[missao - 1];
+        } else {
+            j->missao = catalogo[sortearIntervalo(dados, TOTAL_MISSOES)];
+        }
+    }
+    free(texto);
+
+    if (codigo == CARGA_OK && total == 0) {
+        codigo = CARGA_ERRO_FORMATO;
+    }
+    if (codigo != CARGA_OK) {
+        free(vetor);
+        return codigo;
+    }
+
+    *jogadores = vetor;
+    *numJogadores = total;
+    return CARGA_OK;
+}
+
+#endif // WAR_CARREGADOR_H
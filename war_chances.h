@@ -0,0 +1,306 @@
+/*
+ * Chances Exatas de Batalha do Sistema WAR
+ *
+ * Responde, sem rolar dados, à chance de um atacante com A tropas
+ * conquistar um defensor com D tropas atacando até o fim (como o ataque
+ * relâmpago) e às perdas esperadas de cada lado. O valor de (A, D) depende
+ * só dos estados menores, então a tabela é preenchida de baixo para cima
+ * e cada célula é calculada uma única vez.
+ *
+ * A tabela é compartilhada entre threads: ela guarda um retângulo já
+ * calculado [2, atacantes] × [1, defensores], publicado em uma única
+ * palavra atômica. Consultas dentro do retângulo só leem memória (sem
+ * travas); uma consulta fora dele trava um mutex, calcula as células que
+ * faltam (que ninguém está lendo) e publica o retângulo maior. A memória
+ * é reservada para a capacidade máxima na criação, então as células nunca
+ * mudam de lugar.
+ *
+ * O retângulo calculado pode ser gravado em arquivo e recarregado, para
+ * que a próxima execução já comece com a tabela pronta.
+ */
+
+#ifndef WAR_CHANCES_H
+#define WAR_CHANCES_H
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "war_combate.h"
+
+// Identificação do arquivo da tabela
+#define MAGICA_CHANCES "WARCHAN1"
+#define VERSAO_CHANCES 1
+
+// Capacidade padrão (tropas de cada lado)
+#define LIMITE_CHANCES_PADRAO 1024
+
+// O retângulo cresce em passos deste tamanho (menos travas em consultas vizinhas)
+#define PASSO_CHANCES 64
+
+// Chance de conquista e perdas esperadas de um ataque até o fim
+typedef struct {
+    double vitoria;            // Probabilidade de conquistar o território
+    double perdasAtacante;     // Tropas que o atacante perde, em média
+    double perdasDefensor;     // Tropas que o defensor perde, em média
+} ChanceBatalha;
+
+typedef struct {
+    RegraBatalha regra;
+    int maxAtacante;           // Capacidade (tropas do atacante)
+    int maxDefensor;           // Capacidade (tropas do defensor)
+    ChanceBatalha* celulas;    // celulas[a * (maxDefensor + 1) + d]
+    _Atomic uint64_t limites;  // Retângulo calculado: (atacantes << 32) | defensores
+    pthread_mutex_t trava;     // Só para aumentar o retângulo
+    double chances[DADOS_ATAQUE + 1][DADOS_DEFESA + 1][DADOS_DEFESA + 1];
+} TabelaChances;
+
+// Cabeçalho do arquivo da tabela (seguido das linhas a = 2..atacantes, d = 1..defensores)
+typedef struct {
+    char magica[8];            // MAGICA_CHANCES (sem '\0')
+    uint32_t versao;           // VERSAO_CHANCES
+    uint32_t regra;            // RegraBatalha da tabela
+    uint32_t atacantes;        // Retângulo gravado
+    uint32_t defensores;
+} CabecalhoChances;
+
+/*
+ * Função: criarTabelaChances
+ * Reserva a tabela para até "maxAtacante" × "maxDefensor" tropas (as
+ * páginas só são ocupadas quando as células são calculadas)
+ * Retorna 1 em caso de sucesso, 0 se faltar memória
+ */
+static inline int criarTabelaChances(TabelaChances* tabela, RegraBatalha regra, int maxAtacante, int maxDefensor) {
+    memset(tabela, 0, sizeof(*tabela));
+    tabela->celulas = (ChanceBatalha*) calloc(((size_t) maxAtacante + 1) * ((size_t) maxDefensor + 1),
+                                              sizeof(ChanceBatalha));
+    if (tabela->celulas == NULL) {
+        return 0;
+    }
+    tabela->regra = regra;
+    tabela->maxAtacante = maxAtacante;
+    tabela->maxDefensor = maxDefensor;
+    atomic_init(&tabela->limites, 0);
+    pthread_mutex_init(&tabela->trava, NULL);
+    calcularChancesCombate(tabela->chances);
+    return 1;
+}
+
+/*
+ * Função: liberarTabelaChances
+ * Libera as células da tabela
+ */
+static inline void liberarTabelaChances(TabelaChances* tabela) {
+    free(tabela->celulas);
+    pthread_mutex_destroy(&tabela->trava);
+    memset(tabela, 0, sizeof(*tabela));
+}
+
+/*
+ * Função: celulaChance
+ * Endereço da célula (a, d)
+ */
+static inline ChanceBatalha* celulaChance(const TabelaChances* tabela, int a, int d) {
+    return &tabela->celulas[(size_t) a * ((size_t) tabela->maxDefensor + 1) + (size_t) d];
+}
+
+/*
+ * Função: valorChance
+ * Valor de um estado durante o preenchimento: defensor sem tropas é
+ * conquista, atacante com 1 tropa é derrota (nada mais a perder)
+ */
+static inline ChanceBatalha valorChance(const TabelaChances* tabela, int a, int d) {
+    ChanceBatalha terminal = { d <= 0 ? 1.0 : 0.0, 0.0, 0.0 };
+    if (d <= 0 || a <= 1) {
+        return terminal;
+    }
+    return *celulaChance(tabela, a, d);
+}
+
+/*
+ * Função: calcularCelulaChance
+ * Calcula a célula (a, d) a partir dos estados seguintes, já calculados
+ */
+static inline void calcularCelulaChance(TabelaChances* tabela, int a, int d) {
+    ChanceBatalha c = { 0.0, 0.0, 0.0 };
+
+    if (tabela->regra == REGRA_SIMPLES) {
+        // Vence com 15/36 e conquista na hora (o defensor perde todas as tropas)
+        ChanceBatalha seguinte = valorChance(tabela, a - 1, d);
+        c.vitoria = 15.0 / 36.0 + 21.0 / 36.0 * seguinte.vitoria;
+        c.perdasAtacante = 21.0 / 36.0 * (1.0 + seguinte.perdasAtacante);
+        c.perdasDefensor = 15.0 / 36.0 * d + 21.0 / 36.0 * seguinte.perdasDefensor;
+    } else {
+        int na = dadosDoAtacante(a), nd = dadosDoDefensor(d);
+        int pares = na < nd ? na : nd;
+        for (int k = 0; k <= pares; k++) {
+            double p = tabela->chances[na][nd][k];
+            ChanceBatalha seguinte = valorChance(tabela, a - (pares - k), d - k);
+            c.vitoria += p * seguinte.vitoria;
+            c.perdasAtacante += p * ((pares - k) + seguinte.perdasAtacante);
+            c.perdasDefensor += p * (k + seguinte.perdasDefensor);
+        }
+    }
+    *celulaChance(tabela, a, d) = c;
+}
+
+/*
+ * Função: ampliarTabelaChances
+ * Aumenta o retângulo calculado para cobrir (atacantes, defensores)
+ * Deve ser chamada com a trava; só escreve células fora do retângulo publicado
+ */
+static inline void ampliarTabelaChances(TabelaChances* tabela, int atacantes, int defensores) {
+    uint64_t limites = atomic_load_explicit(&tabela->limites, memory_order_relaxed);
+    int antigoA = (int) (limites >> 32), antigoD = (int) (uint32_t) limites;
+    if (atacantes <= antigoA && defensores <= antigoD) {
+        return; // Outra thread já ampliou
+    }
+    if (atacantes < antigoA) atacantes = antigoA;
+    if (defensores < antigoD) defensores = antigoD;
+
+    // Linhas em ordem crescente de a, e d crescente dentro da linha: cada
+    // célula depende só de (a - i, d - k) com i, k >= 0
+    for (int a = 2; a <= atacantes; a++) {
+        for (int d = a <= antigoA ? antigoD + 1 : 1; d <= defensores; d++) {
+            calcularCelulaChance(tabela, a, d);
+        }
+    }
+
+    atomic_store_explicit(&tabela->limites, ((uint64_t) atacantes << 32) | (uint32_t) defensores,
+                          memory_order_release);
+}
+
+/*
+ * Função: consultarChance
+ * Chance de conquista e perdas esperadas de "atacante" tropas contra
+ * "defensor" tropas (pode ser chamada por várias threads ao mesmo tempo)
+ * Retorna 1 em caso de sucesso, 0 se as tropas passam da capacidade
+ */
+static inline int consultarChance(TabelaChances* tabela, int atacante, int defensor, ChanceBatalha* saida) {
+    if (atacante <= 1 || defensor <= 0) {
+        *saida = valorChance(tabela, atacante, defensor);
+        return 1;
+    }
+    if (atacante > tabela->maxAtacante || defensor > tabela->maxDefensor) {
+        return 0;
+    }
+
+    uint64_t limites = atomic_load_explicit(&tabela->limites, memory_order_acquire);
+    if (atacante > (int) (limites >> 32) || defensor > (int) (uint32_t) limites) {
+        int a = (atacante + PASSO_CHANCES - 1) / PASSO_CHANCES * PASSO_CHANCES;
+        int d = (defensor + PASSO_CHANCES - 1) / PASSO_CHANCES * PASSO_CHANCES;
+        if (a > tabela->maxAtacante) a = tabela->maxAtacante;
+        if (d > tabela->maxDefensor) d = tabela->maxDefensor;
+
+        pthread_mutex_lock(&tabela->trava);
+        ampliarTabelaChances(tabela, a, d);
+        pthread_mutex_unlock(&tabela->trava);
+    }
+
+    *saida = *celulaChance(tabela, atacante, defensor);
+    return 1;
+}
+
+// ==================== ARQUIVO ====================
+
+/*
+ * Função: salvarTabelaChances
+ * Grava o retângulo calculado em "caminho" (via arquivo temporário + rename)
+ * Retorna 1 em caso de sucesso, 0 em caso de erro
+ */
+static inline int salvarTabelaChances(TabelaChances* tabela, const char* caminho) {
+    char temporario[512];
+    if (snprintf(temporario, sizeof(temporario), "%s.tmp", caminho) >= (int) sizeof(temporario)) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&tabela->trava);
+    uint64_t limites = atomic_load_explicit(&tabela->limites, memory_order_relaxed);
+    CabecalhoChances cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.magica, MAGICA_CHANCES, 8);
+    cabecalho.versao = VERSAO_CHANCES;
+    cabecalho.regra = (uint32_t) tabela->regra;
+    cabecalho.atacantes = (uint32_t) (limites >> 32);
+    cabecalho.defensores = (uint32_t) limites;
+
+    int fd = open(temporario, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    int ok = fd >= 0;
+
+    // Cabeçalho (no lugar da linha a = 1) e depois uma linha (d = 1..defensores) por atacante
+    uint32_t ultima = cabecalho.atacantes > 1 ? cabecalho.atacantes : 1;
+    for (uint32_t a = 1; ok && a <= ultima; a++) {
+        const char* parte = a == 1 ? (const char*) &cabecalho : (const char*) celulaChance(tabela, (int) a, 1);
+        size_t tamanho = a == 1 ? sizeof(cabecalho) : sizeof(ChanceBatalha) * cabecalho.defensores;
+        while (tamanho > 0) {
+            ssize_t n = write(fd, parte, tamanho);
+            if (n <= 0) {
+                ok = 0;
+                break;
+            }
+            parte += n;
+            tamanho -= (size_t) n;
+        }
+    }
+    pthread_mutex_unlock(&tabela->trava);
+
+    if (fd >= 0 && close(fd) != 0) ok = 0;
+    if (ok && rename(temporario, caminho) != 0) ok = 0;
+    if (!ok) unlink(temporario);
+    return ok;
+}
+
+/*
+ * Função: carregarTabelaChances
+ * Recarrega um retângulo gravado por salvarTabelaChances() (antes de a
+ * tabela ser compartilhada); a parte que passa da capacidade é descartada
+ * Retorna 1 em caso de sucesso, 0 se o arquivo não existe ou é de outra regra/formato
+ */
+static inline int carregarTabelaChances(TabelaChances* tabela, const char* caminho) {
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+
+    CabecalhoChances cabecalho;
+    struct stat info;
+    if (fstat(fd, &info) != 0 ||
+        pread(fd, &cabecalho, sizeof(cabecalho), 0) != (ssize_t) sizeof(cabecalho) ||
+        memcmp(cabecalho.magica, MAGICA_CHANCES, 8) != 0 ||
+        cabecalho.versao != VERSAO_CHANCES ||
+        cabecalho.regra != (uint32_t) tabela->regra ||
+        (uint64_t) info.st_size != sizeof(cabecalho) +
+            sizeof(ChanceBatalha) * (uint64_t) (cabecalho.atacantes > 1 ? cabecalho.atacantes - 1 : 0) *
+            cabecalho.defensores) {
+        close(fd);
+        return 0;
+    }
+
+    int atacantes = cabecalho.atacantes < (uint32_t) tabela->maxAtacante ? (int) cabecalho.atacantes : tabela->maxAtacante;
+    int defensores = cabecalho.defensores < (uint32_t) tabela->maxDefensor ? (int) cabecalho.defensores : tabela->maxDefensor;
+    size_t linha = sizeof(ChanceBatalha) * cabecalho.defensores;
+    for (int a = 2; a <= atacantes; a++) {
+        off_t deslocamento = (off_t) (sizeof(cabecalho) + linha * (size_t) (a - 2));
+        size_t tamanho = sizeof(ChanceBatalha) * (size_t) defensores;
+        if (pread(fd, celulaChance(tabela, a, 1), tamanho, deslocamento) != (ssize_t) tamanho) {
+            close(fd);
+            return 0;
+        }
+    }
+    close(fd);
+
+    if (atacantes < 2 || defensores < 1) {
+        return 1; // Arquivo vazio: nada a publicar
+    }
+    atomic_store_explicit(&tabela->limites, ((uint64_t) atacantes << 32) | (uint32_t) defensores,
+                          memory_order_release);
+    return 1;
+}
+
+#endif // WAR_CHANCES_H
@@ -0,0 +1,339 @@
+/*
+ * Mapa em Colunas do Sistema WAR
+ *
+ * Cópia opcional do mapa em "struct of arrays": um vetor com a cor dona
+ * de cada território (1 byte), outro com as tropas (4 bytes) e um com a
+ * marca de nome iniciado por 'B' (1 byte). As varreduras que precisam
+ * apenas de dono e tropas leem 5 bytes por território em vez dos 12 do
+ * vetor de Territorio.
+ *
+ * Os kernels resumem uma cor (territórios, soma de tropas, maior tropa e
+ * quantos territórios têm essa maior tropa) com AVX2 quando o processador
+ * tem suporte, SSE2 caso contrário e um laço escalar fora do x86. Os
+ * vetores são alocados com folga até um múltiplo de LARGURA_COLUNAS,
+ * preenchida com COR_INVALIDA, para que os kernels não tratem sobras.
+ */
+
+#ifndef WAR_COLUNAS_H
+#define WAR_COLUNAS_H
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "war_cores.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define WAR_COLUNAS_AVX2 1
+#endif
+
+// Territórios por passo dos kernels (e múltiplo da folga dos vetores)
+#define LARGURA_COLUNAS 32
+
+// Territórios resumidos por bloco em resumirCores() (cabem no cache L1)
+#define BLOCO_COLUNAS 4096
+
+typedef struct {
+    IdCor* donos;          // Cor que controla cada território (NULL = colunas desativadas)
+    int32_t* tropas;       // Tropas de cada território
+    uint8_t* iniciaisB;    // 1 se o nome do território começa com 'B' (não muda nas batalhas)
+    int numTerritorios;
+    int capacidade;        // numTerritorios arredondado para LARGURA_COLUNAS
+} MapaColunar;
+
+// Resumo de uma cor em uma faixa do mapa
+typedef struct {
+    int territorios;
+    long long tropas;
+    int tropasMaximas;     // Maior tropa (no mínimo 0, como nos agregados)
+    int noMaximo;          // Territórios com exatamente "tropasMaximas" tropas
+} ResumoCor;
+
+/*
+ * Função: criarMapaColunar
+ * Aloca as colunas para "numTerritorios" territórios
+ * Retorna 1 em caso de sucesso, 0 se faltar memória
+ */
+static inline int criarMapaColunar(MapaColunar* colunas, int numTerritorios) {
+    int capacidade = (numTerritorios + LARGURA_COLUNAS - 1) / LARGURA_COLUNAS * LARGURA_COLUNAS;
+    if (capacidade == 0) capacidade = LARGURA_COLUNAS;
+
+    colunas->donos = (IdCor*) aligned_alloc(32, (size_t) capacidade);
+    colunas->tropas = (int32_t*) aligned_alloc(32, sizeof(int32_t) * (size_t) capacidade);
+    colunas->iniciaisB = (uint8_t*) aligned_alloc(32, (size_t) capacidade);
+    if (colunas->donos == NULL || colunas->tropas == NULL || colunas->iniciaisB == NULL) {
+        free(colunas->donos);
+        free(colunas->tropas);
+        free(colunas->iniciaisB);
+        memset(colunas, 0, sizeof(*colunas));
+        return 0;
+    }
+
+    // Folga: nenhuma cor válida é COR_INVALIDA
+    memset(colunas->donos, COR_INVALIDA, (size_t) capacidade);
+    memset(colunas->tropas, 0, sizeof(int32_t) * (size_t) capacidade);
+    memset(colunas->iniciaisB, 0, (size_t) capacidade);
+    colunas->numTerritorios = numTerritorios;
+    colunas->capacidade = capacidade;
+    return 1;
+}
+
+/*
+ * Função: liberarMapaColunar
+ * Libera as colunas e as deixa desativadas
+ */
+static inline void liberarMapaColunar(MapaColunar* colunas) {
+    free(colunas->donos);
+    free(colunas->tropas);
+    free(colunas->iniciaisB);
+    memset(colunas, 0, sizeof(*colunas));
+}
+
+/*
+ * Função: copiarMapaColunar
+ * Copia o conteúdo de colunas de mesmo tamanho (restauração rápida)
+ */
+static inline void copiarMapaColunar(MapaColunar* destino, const MapaColunar* origem) {
+    memcpy(destino->donos, origem->donos, (size_t) origem->capacidade);
+    memcpy(destino->tropas, origem->tropas, sizeof(int32_t) * (size_t) origem->capacidade);
+    memcpy(destino->iniciaisB, origem->iniciaisB, (size_t) origem->capacidade);
+}
+
+/*
+ * Função: atualizarColuna
+ * Atualiza dono e tropas de um território nas colunas
+ */
+static inline void atualizarColuna(MapaColunar* colunas, int territorio, IdCor cor, int tropas) {
+    colunas->donos[territorio] = cor;
+    colunas->tropas[territorio] = tropas;
+}
+
+// ==================== KERNELS ====================
+
+/*
+ * Função: juntarResumo
+ * Acumula o resumo "parcial" em "total"
+ */
+static inline void juntarResumo(ResumoCor* total, const ResumoCor* parcial) {
+    total->territorios += parcial->territorios;
+    total->tropas += parcial->tropas;
+    if (parcial->tropasMaximas > total->tropasMaximas) {
+        total->tropasMaximas = parcial->tropasMaximas;
+        total->noMaximo = parcial->noMaximo;
+    } else if (parcial->tropasMaximas == total->tropasMaximas) {
+        total->noMaximo += parcial->noMaximo;
+    }
+}
+
+/*
+ * Função: resumirFaixaEscalar
+ * Resumo de uma cor em [inicio, fim), um território por vez
+ */
+static inline void resumirFaixaEscalar(const IdCor* donos, const int32_t* tropas, int inicio, int fim,
+                                       IdCor cor, ResumoCor* resumo) {
+    memset(resumo, 0, sizeof(*resumo));
+    for (int i = inicio; i < fim; i++) {
+        if (donos[i] != cor) continue;
+        resumo->territorios++;
+        resumo->tropas += tropas[i];
+        if (tropas[i] > resumo->tropasMaximas) {
+            resumo->tropasMaximas = tropas[i];
+            resumo->noMaximo = 1;
+        } else if (tropas[i] == resumo->tropasMaximas) {
+            resumo->noMaximo++;
+        }
+    }
+}
+
+/*
+ * Função: reduzirPistas
+ * Combina os acumuladores de cada pista de um kernel vetorial
+ */
+static inline void reduzirPistas(const int32_t* contagem, const long long* soma, int numSomas,
+                                 const int32_t* maximo, const int32_t* noMaximo, int pistas,
+                                 ResumoCor* resumo) {
+    memset(resumo, 0, sizeof(*resumo));
+    for (int p = 0; p < pistas; p++) {
+        ResumoCor pista = { contagem[p], 0, maximo[p], noMaximo[p] };
+        juntarResumo(resumo, &pista);
+    }
+    for (int p = 0; p < numSomas; p++) {
+        resumo->tropas += soma[p];
+    }
+}
+
+#ifdef __SSE2__
+/*
+ * Função: resumirFaixaSSE2
+ * Resumo de uma cor em [inicio, fim) (múltiplos de 4), 4 territórios por passo
+ */
+static inline void resumirFaixaSSE2(const IdCor* donos, const int32_t* tropas, int inicio, int fim,
+                                    IdCor cor, ResumoCor* resumo) {
+    const __m128i alvo = _mm_set1_epi32(cor);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i um = _mm_set1_epi32(1);
+    const __m128i ausente = _mm_set1_epi32(INT_MIN);
+    __m128i contagem = zero, somaBaixa = zero, somaAlta = zero, maximo = zero, noMaximo = zero;
+
+    for (int i = inicio; i < fim; i += 4) {
+        int32_t quatro;
+        memcpy(&quatro, donos + i, sizeof(quatro));
+        __m128i d = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(quatro), zero), zero);
+        __m128i t = _mm_load_si128((const __m128i*) (tropas + i));
+        __m128i m = _mm_cmpeq_epi32(d, alvo);
+
+        contagem = _mm_sub_epi32(contagem, m);
+
+        // Soma em 64 bits (com extensão de sinal)
+        __m128i tm = _mm_and_si128(t, m);
+        __m128i sinal = _mm_cmpgt_epi32(zero, tm);
+        somaBaixa = _mm_add_epi64(somaBaixa, _mm_unpacklo_epi32(tm, sinal));
+        somaAlta = _mm_add_epi64(somaAlta, _mm_unpackhi_epi32(tm, sinal));
+
+        // Máximo e quantos o atingem (territórios de outra cor valem INT_MIN)
+        __m128i v = _mm_or_si128(_mm_and_si128(m, t), _mm_andnot_si128(m, ausente));
+        __m128i maior = _mm_cmpgt_epi32(v, maximo);
+        __m128i igual = _mm_cmpeq_epi32(v, maximo);
+        maximo = _mm_or_si128(_mm_and_si128(maior, v), _mm_andnot_si128(maior, maximo));
+        noMaximo = _mm_or_si128(_mm_and_si128(maior, um),
+                                _mm_andnot_si128(maior, _mm_sub_epi32(noMaximo, igual)));
+    }
+
+    int32_t c[4], mx[4], nm[4];
+    long long s[4];
+    _mm_storeu_si128((__m128i*) c, contagem);
+    _mm_storeu_si128((__m128i*) mx, maximo);
+    _mm_storeu_si128((__m128i*) nm, noMaximo);
+    _mm_storeu_si128((__m128i*) s, somaBaixa);
+    _mm_storeu_si128((__m128i*) (s + 2), somaAlta);
+    reduzirPistas(c, s, 4, mx, nm, 4, resumo);
+}
+#endif
+
+#ifdef WAR_COLUNAS_AVX2
+/*
+ * Função: resumirFaixaAVX2
+ * Resumo de uma cor em [inicio, fim) (múltiplos de 8), 8 territórios por passo
+ */
+__attribute__((target("avx2")))
+static inline void resumirFaixaAVX2(const IdCor* donos, const int32_t* tropas, int inicio, int fim,
+                                    IdCor cor, ResumoCor* resumo) {
+    const __m256i alvo = _mm256_set1_epi32(cor);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i um = _mm256_set1_epi32(1);
+    const __m256i ausente = _mm256_set1_epi32(INT_MIN);
+    __m256i contagem = zero, somaBaixa = zero, somaAlta = zero, maximo = zero, noMaximo = zero;
+
+    for (int i = inicio; i < fim; i += 8) {
+        __m256i d = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*) (donos + i)));
+        __m256i t = _mm256_load_si256((const __m256i*) (tropas + i));
+        __m256i m = _mm256_cmpeq_epi32(d, alvo);
+
+        contagem = _mm256_sub_epi32(contagem, m);
+
+        __m256i tm = _mm256_and_si256(t, m);
+        somaBaixa = _mm256_add_epi64(somaBaixa, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(tm)));
+        somaAlta = _mm256_add_epi64(somaAlta, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(tm, 1)));
+
+        __m256i v = _mm256_blendv_epi8(ausente, t, m);
+        __m256i maior = _mm256_cmpgt_epi32(v, maximo);
+        __m256i igual = _mm256_cmpeq_epi32(v, maximo);
+        maximo = _mm256_max_epi32(maximo, v);
+        noMaximo = _mm256_blendv_epi8(_mm256_sub_epi32(noMaximo, igual), um, maior);
+    }
+
+    int32_t c[8], mx[8], nm[8];
+    long long s[8];
+    _mm256_storeu_si256((__m256i*) c, contagem);
+    _mm256_storeu_si256((__m256i*) mx, maximo);
+    _mm256_storeu_si256((__m256i*) nm, noMaximo);
+    _mm256_storeu_si256((__m256i*) s, somaBaixa);
+    _mm256_storeu_si256((__m256i*) (s + 4), somaAlta);
+    reduzirPistas(c, s, 8, mx, nm, 8, resumo);
+}
+
+/*
+ * Função: temAVX2
+ * Retorna 1 se o processador executa AVX2 (consultado uma única vez)
+ */
+static inline int temAVX2(void) {
+    static int suporte = -1;
+    if (suporte < 0) {
+        __builtin_cpu_init();
+        suporte = __builtin_cpu_supports("avx2") ? 1 : 0;
+    }
+    return suporte;
+}
+#endif
+
+/*
+ * Função: resumirFaixa
+ * Resumo de uma cor em [inicio, fim) com o melhor kernel disponível
+ * ("inicio" e "fim" múltiplos de LARGURA_COLUNAS ou "fim" = capacidade)
+ */
+static inline void resumirFaixa(const MapaColunar* colunas, int inicio, int fim, IdCor cor, ResumoCor* resumo) {
+#ifdef WAR_COLUNAS_AVX2
+    if (temAVX2()) {
+        resumirFaixaAVX2(colunas->donos, colunas->tropas, inicio, fim, cor, resumo);
+        return;
+    }
+#endif
+#ifdef __SSE2__
+    resumirFaixaSSE2(colunas->donos, colunas->tropas, inicio, fim, cor, resumo);
+#else
+    resumirFaixaEscalar(colunas->donos, colunas->tropas, inicio, fim, cor, resumo);
+#endif
+}
+
+/*
+ * Função: resumirCor
+ * Resumo de uma cor no mapa inteiro
+ */
+static inline void resumirCor(const MapaColunar* colunas, IdCor cor, ResumoCor* resumo) {
+    resumirFaixa(colunas, 0, colunas->capacidade, cor, resumo);
+}
+
+/*
+ * Função: resumirCores
+ * Resumo das cores 0 a numCores - 1 em uma única passada pela memória:
+ * o mapa é lido em blocos de BLOCO_COLUNAS e cada bloco, já no cache, é
+ * resumido para todas as cores
+ */
+static inline void resumirCores(const MapaColunar* colunas, int numCores, ResumoCor resumos[]) {
+    memset(resumos, 0, sizeof(ResumoCor) * (size_t) numCores);
+    for (int inicio = 0; inicio < colunas->capacidade; inicio += BLOCO_COLUNAS) {
+        int fim = inicio + BLOCO_COLUNAS < colunas->capacidade ? inicio + BLOCO_COLUNAS : colunas->capacidade;
+        for (int c = 0; c < numCores; c++) {
+            ResumoCor parcial;
+            resumirFaixa(colunas, inicio, fim, (IdCor) c, &parcial);
+            juntarResumo(&resumos[c], &parcial);
+        }
+    }
+}
+
+/*
+ * Função: contarIniciaisB
+ * Conta, para as cores 0 a numCores - 1, os territórios com nome iniciado
+ * por 'B' em uma passada pelas colunas de donos e de iniciais (a folga
+ * não conta: a sua marca é 0)
+ * Retorna o total de territórios com a marca
+ */
+static inline int contarIniciaisB(const MapaColunar* colunas, int numCores, int porCor[]) {
+    int contagem[256] = {0};  // Indexado pelo IdCor (inclusive COR_INVALIDA)
+    for (int i = 0; i < colunas->capacidade; i++) {
+        contagem[colunas->donos[i]] += colunas->iniciaisB[i];
+    }
+    int total = 0;
+    for (int c = 0; c < numCores; c++) {
+        porCor[c] = contagem[c];
+        total += contagem[c];
+    }
+    return total;
+}
+
+#endif // WAR_COLUNAS_H
@@ -0,0 +1,788 @@
+/*
+ * Protocolo de Comandos do Sistema WAR
+ *
+ * Alternativa ao menu interativo para scripts e testes de carga: cada
+ * linha da entrada é um comando ("atacar 3 7", "atacar Brasil Argentina",
+ * "mostrar", "verificar", "carregar mapa.csv", ...) executado pelo mesmo
+ * motor do menu, e cada comando recebe uma resposta de uma linha que
+ * começa com "ok" ou "erro". Comandos que devolvem listas ("mostrar",
+ * "buscar", "jogadas", "ajuda") informam a quantidade de linhas que vêm
+ * em seguida.
+ * Os nomes em inglês do roteiro de testes ("attack", "show", "check",
+ * "load", ...) são aceitos como apelidos.
+ *
+ * A entrada é lida em blocos grandes e separada em linhas e palavras no
+ * próprio buffer, sem cópias; as respostas se acumulam em uma Tela e só
+ * são enviadas quando a entrada já lida acaba (ou o buffer fica grande),
+ * então um roteiro com milhares de comandos gera poucas escritas.
+ * Linhas vazias e iniciadas por '#' são ignoradas e não têm resposta.
+ */
+
+#ifndef WAR_COMANDOS_H
+#define WAR_COMANDOS_H
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "war_carregador.h"
+#include "war_chances.h"
+#include "war_diario.h"
+#include "war_engine.h"
+#include "war_metricas.h"
+#include "war_missoes.h"
+#include "war_relampago.h"
+#include "war_salvamento.h"
+#include "war_tela.h"
+
+// Capacidade inicial do leitor de linhas (cresce para linhas maiores)
+#define CAPACIDADE_LEITOR 65536
+
+// Respostas acumuladas antes de uma escrita forçada
+#define LIMITE_SAIDA_COMANDOS 65536
+
+// Palavras consideradas em uma linha de comando
+#define MAX_PALAVRAS_COMANDO 8
+
+// Leitor de linhas com buffer próprio sobre um descritor
+typedef struct {
+    int fd;
+    char* buffer;
+    size_t inicio;        // Primeiro byte ainda não entregue
+    size_t fim;           // Fim dos bytes lidos
+    size_t capacidade;
+    int fimArquivo;       // 1 depois que read() devolveu 0 ou erro
+    int bufferExterno;    // 1 se "buffer" não pertence ao leitor (não é liberado)
+} LeitorLinhas;
+
+// Estado da partida visto pelos comandos (ponteiros para o estado de main)
+typedef struct {
+    Jogo* jogo;
+    Jogador* jogadores;
+    int numJogadores;
+    DiarioBatalhas* diario;      // Diário aberto ou NULL
+    CacheRelampago* relampago;   // Tabelas do comando "relampago"
+    TabelaChances* chances;      // Chances exatas do comando "chance"
+    const char* arquivoSalvar;   // Destino padrão do comando "salvar" (NULL = obrigatório)
+    int turno;
+    long long executados;        // Comandos reconhecidos até agora
+} SessaoComandos;
+
+// Executa um comando já separado em palavras; retorna 0 para encerrar a sessão
+typedef int (*TratadorComando)(SessaoComandos* sessao, char* palavras[], int numPalavras, Tela* saida);
+
+typedef struct {
+    const char* nome;
+    const char* apelido;         // Nome alternativo (inglês)
+    int minArgumentos;
+    int maxArgumentos;
+    TratadorComando tratar;
+    const char* uso;
+} DefinicaoComando;
+
+// ==================== LEITURA ====================
+
+/*
+ * Função: criarLeitorLinhas
+ * Prepara a leitura de linhas do descritor "fd" com um buffer inicial de
+ * "capacidade" bytes (ele dobra quando uma linha não cabe)
+ * Retorna 1 em caso de sucesso, 0 se faltar memória
+ */
+static inline int criarLeitorLinhas(LeitorLinhas* leitor, int fd, size_t capacidade) {
+    memset(leitor, 0, sizeof(*leitor));
+    leitor->buffer = (char*) malloc(capacidade);
+    if (leitor->buffer == NULL) {
+        return 0;
+    }
+    leitor->fd = fd;
+    leitor->capacidade = capacidade;
+    return 1;
+}
+
+/*
+ * Função: criarLeitorLinhasEm
+ * Prepara a leitura sobre um buffer já reservado (por exemplo, em uma
+ * arena); se uma linha não couber, o leitor passa a usar uma cópia própria
+ */
+static inline void criarLeitorLinhasEm(LeitorLinhas* leitor, int fd, char* buffer, size_t capacidade) {
+    memset(leitor, 0, sizeof(*leitor));
+    leitor->fd = fd;
+    leitor->buffer = buffer;
+    leitor->capacidade = capacidade;
+    leitor->bufferExterno = 1;
+}
+
+/*
+ * Função: liberarLeitorLinhas
+ * Libera o buffer do leitor, se for próprio (o descritor não é fechado)
+ */
+static inline void liberarLeitorLinhas(LeitorLinhas* leitor) {
+    if (!leitor->bufferExterno) {
+        free(leitor->buffer);
+    }
+    memset(leitor, 0, sizeof(*leitor));
+}
+
+/*
+ * Função: temLinhaPronta
+ * Retorna 1 se a próxima linha já está no buffer (proximaLinha não vai
+ * esperar pela entrada)
+ */
+static inline int temLinhaPronta(const LeitorLinhas* leitor) {
+    size_t pendentes = leitor->fim - leitor->inicio;
+    return memchr(leitor->buffer + leitor->inicio, '\n', pendentes) != NULL ||
+           (leitor->fimArquivo && pendentes > 0);
+}
+
+/*
+ * Função: extrairLinha
+ * Entrega a próxima linha completa já lida (ou o resto, no fim da
+ * entrada), terminada em '\0' no próprio buffer, sem '\n' nem '\r'
+ * A linha vale até a próxima leitura
+ * Retorna 1 se havia uma linha, 0 se é preciso ler mais
+ */
+static inline int extrairLinha(LeitorLinhas* leitor, char** linha) {
+    char* inicio = leitor->buffer + leitor->inicio;
+    size_t pendentes = leitor->fim - leitor->inicio;
+    char* quebra = (char*) memchr(inicio, '\n', pendentes);
+
+    if (quebra == NULL && !(leitor->fimArquivo && pendentes > 0)) {
+        return 0;
+    }
+    char* fimLinha = quebra != NULL ? quebra : leitor->buffer + leitor->fim;
+    leitor->inicio = (size_t) (fimLinha - leitor->buffer) + (quebra != NULL ? 1 : 0);
+    if (fimLinha > inicio && fimLinha[-1] == '\r') {
+        fimLinha--;
+    }
+    *fimLinha = '\0';   // Há sempre um byte livre depois de "fim"
+    *linha = inicio;
+    return 1;
+}
+
+/*
+ * Função: encherLeitor
+ * Faz uma leitura do descritor, primeiro movendo a linha incompleta para
+ * o começo do buffer (e dobrando o buffer se ela já o ocupa todo)
+ * Retorna os bytes lidos, 0 no fim da entrada (marca "fimArquivo") ou -1
+ * em erro, com errno preservado (EAGAIN em descritores não bloqueantes)
+ */
+static inline ssize_t encherLeitor(LeitorLinhas* leitor) {
+    size_t pendentes = leitor->fim - leitor->inicio;
+    if (leitor->inicio > 0) {
+        memmove(leitor->buffer, leitor->buffer + leitor->inicio, pendentes);
+        leitor->inicio = 0;
+        leitor->fim = pendentes;
+    }
+    if (leitor->fim + 1 >= leitor->capacidade) {
+        char* buffer;
+        if (leitor->bufferExterno) {
+            buffer = (char*) malloc(leitor->capacidade * 2);
+            if (buffer != NULL) {
+                memcpy(buffer, leitor->buffer, leitor->fim);
+            }
+        } else {
+            buffer = (char*) realloc(leitor->buffer, leitor->capacidade * 2);
+        }
+        if (buffer == NULL) {
+            errno = ENOMEM;
+            return -1;
+        }
+        leitor->buffer = buffer;
+        leitor->capacidade *= 2;
+        leitor->bufferExterno = 0;
+    }
+
+    ssize_t lidos = read(leitor->fd, leitor->buffer + leitor->fim, leitor->capacidade - leitor->fim - 1);
+    if (lidos > 0) {
+        leitor->fim += (size_t) lidos;
+    } else if (lidos == 0) {
+        leitor->fimArquivo = 1;
+    }
+    return lidos;
+}
+
+/*
+ * Função: proximaLinha
+ * Entrega a próxima linha, esperando pela entrada se necessário
+ * Retorna 1 se havia uma linha, 0 no fim da entrada (ou em erro de leitura)
+ */
+static inline int proximaLinha(LeitorLinhas* leitor, char** linha) {
+    while (!extrairLinha(leitor, linha)) {
+        if (leitor->fimArquivo) {
+            return 0;
+        }
+        if (encherLeitor(leitor) < 0 && errno != EINTR) {
+            leitor->fimArquivo = 1;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Função: separarPalavras
+ * Separa a linha em palavras (espaços e tabulações), no próprio texto
+ * Retorna a quantidade de palavras (no máximo "maximo")
+ */
+static inline int separarPalavras(char* linha, char* palavras[], int maximo) {
+    int total = 0;
+    char* p = linha;
+
+    while (total < maximo) {
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\0') {
+            break;
+        }
+        palavras[total++] = p;
+        while (*p != '\0' && *p != ' ' && *p != '\t') p++;
+        if (*p == '\0') {
+            break;
+        }
+        *p++ = '\0';
+    }
+    return total;
+}
+
+/*
+ * Função: lerInteiroPalavra
+ * Converte uma palavra inteira em número (sem aceitar sobras nem estouro)
+ * Retorna 1 em caso de sucesso, 0 se a palavra não é um inteiro
+ */
+static inline int lerInteiroPalavra(const char* palavra, int* valor) {
+    int negativo = *palavra == '-';
+    const char* p = palavra + (negativo || *palavra == '+');
+    long long numero = 0;
+
+    if (*p == '\0') {
+        return 0;
+    }
+    for (; *p != '\0'; p++) {
+        if (*p < '0' || *p > '9') {
+            return 0;
+        }
+        numero = numero * 10 + (*p - '0');
+        if (numero > INT32_MAX) {
+            return 0;
+        }
+    }
+    *valor = (int) (negativo ? -numero : numero);
+    return 1;
+}
+
+// ==================== RESPOSTAS ====================
+
+/*
+ * Função: nomeCodigoAtaque
+ * Retorna o identificador de um ataque recusado usado nas respostas
+ */
+static inline const char* nomeCodigoAtaque(CodigoAtaque codigo) {
+    switch (codigo) {
+        case ATAQUE_OK:                   return "ok";
+        case ATAQUE_INDICE_INVALIDO:      return "territorio_invalido";
+        case ATAQUE_TROPAS_INSUFICIENTES: return "tropas_insuficientes";
+        case ATAQUE_MESMO_TERRITORIO:     return "mesmo_territorio";
+        case ATAQUE_MESMA_COR:            return "mesma_cor";
+        case ATAQUE_NAO_ADJACENTE:        return "nao_adjacente";
+    }
+    return "desconhecido";
+}
+
+/*
+ * Função: lerTerritorioPalavra
+ * Lê um território pelo número (a partir de 1) ou pelo nome ('_' no lugar
+ * de espaços) e o devolve em base 0; um nome desconhecido vira -1, que o
+ * motor recusa como índice inválido
+ */
+static inline int lerTerritorioPalavra(const Jogo* jogo, const char* palavra) {
+    int numero;
+    if (lerInteiroPalavra(palavra, &numero)) {
+        return numero - 1;
+    }
+    return buscarTerritorioPorNome(jogo, palavra, strlen(palavra));
+}
+
+/*
+ * Função: lerParTerritorios
+ * Lê atacante e defensor (números ou nomes) e os devolve em base 0
+ */
+static inline void lerParTerritorios(const Jogo* jogo, char* palavras[], int* atacante, int* defensor) {
+    *atacante = lerTerritorioPalavra(jogo, palavras[1]);
+    *defensor = lerTerritorioPalavra(jogo, palavras[2]);
+}
+
+/*
+ * Função: escreverLinhaTerritorio
+ * Acrescenta "numero<TAB>nome<TAB>cor<TAB>tropas" à saída
+ */
+static inline void escreverLinhaTerritorio(Tela* saida, const Jogo* jogo, int indice) {
+    const Territorio* t = &jogo->mapa[indice];
+    escreverTela(saida, "%d\t%s\t%s\t%d\n", indice + 1, nomeTerritorio(jogo, indice),
+                 nomeCor(&jogo->cores, t->cor), t->tropas);
+}
+
+// ==================== COMANDOS ====================
+
+/*
+ * Função: atacarPorComando
+ * Executa "atacar A D" ou "relampago A D" e responde com o resultado
+ */
+static inline int atacarPorComando(SessaoComandos* sessao, char* palavras[], Tela* saida, int relampago) {
+    Jogo* jogo = sessao->jogo;
+    int atacante, defensor;
+    ResultadoBatalha resultado;
+
+    lerParTerritorios(jogo, palavras, &atacante, &defensor);
+    CodigoAtaque codigo = validarAtaqueNoJogo(jogo, atacante, defensor);
+    if (codigo != ATAQUE_OK) {
+        escreverTela(saida, "erro %s\n", nomeCodigoAtaque(codigo));
+        return 1;
+    }
+
+    uint64_t medida = iniciarMedida();
+    if (relampago) {
+        if (!relampagoNoJogo(jogo, sessao->relampago, atacante, defensor, &resultado)) {
+            escreverTela(saida, "erro memoria\n");
+            return 1;
+        }
+    } else {
+        batalharNoJogo(jogo, atacante, defensor, &resultado);
+    }
+    encerrarMedida(LATENCIA_BATALHA, medida);
+    contarBatalha(&resultado);
+    // A batalha já foi aplicada: sem o diário a sessão não pode seguir
+    if (sessao->diario != NULL && !registrarBatalha(sessao->diario, sessao->turno, atacante, defensor, &resultado)) {
+        escreverTela(saida, "erro diario\n");
+        return 0;
+    }
+    sessao->turno++;
+    contarMetrica(CONTADOR_TURNOS, 1);
+    marcarAlterado(saida, atacante);
+    marcarAlterado(saida, defensor);
+
+    escreverTela(saida, "ok conquistou=%d perdas=%d,%d movidas=%d tropas=%d,%d\n",
+                 resultado.conquistou, resultado.perdasAtacante, resultado.perdasDefensor,
+                 resultado.tropasMovidas, jogo->mapa[atacante].tropas, jogo->mapa[defensor].tropas);
+    return 1;
+}
+
+static inline int comandoAtacar(SessaoComandos* sessao, char* palavras[], int numPalavras, Tela* saida) {
+    (void) numPalavras;
+    return atacarPorComando(sessao, palavras, saida, 0);
+}
+
+static inline int comandoRelampago(SessaoComandos* sessao, char* palavras[], int numPalavras, Tela* saida) {
+    (void) numPalavras;
+    return atacarPorComando(sessao, palavras, saida, 1);
+}
+
+/*
+ * Função: comandoMostrar
+ * "mostrar": todos os territórios; "mostrar alterados": só os alterados
+ * desde a última listagem (todos, se nada foi listado ainda)
+ */
+static inline int comandoMostrar(SessaoComandos* sessao, char* palavras[], int numPalavras, Tela* saida) {
+    const Jogo* jogo = sessao->jogo;
+
+    if (numPalavras > 1 && strcmp(palavras[1], "alterados") != 0 && strcmp(palavras[1], "changed") != 0) {
+        escreverTela(saida, "erro argumentos %s\n", palavras[0]);
+        return 1;
+    }
+    if (numPalavras > 1 && !saida->redesenhar) {
+        escreverTela(saida, "ok %d\n", saida->numAlterados);
+        for (int i = proximoAlterado(saida, 0); i >= 0; i = proximoAlterado(saida, i + 1)) {
+            escreverLinhaTerritorio(saida, jogo, i);
+        }
+    } else {
+        escreverTela(saida, "ok %d\n", jogo->numTerritorios);
+        for (int i = 0; i < jogo->numTerritorios; i++) {
+            escreverLinhaTerritorio(saida, jogo, i);
+        }
+    }
+    limparAlterados(saida);
+    return 1;
+}
+
+/*
+ * Função: comandoVerificar
+ * Responde com a quantidade e os números dos jogadores que cumpriram a missão
+ */
+static inline int comandoVerificar(SessaoComandos* sessao, char* palavras[], int numPalavras, Tela* saida) {
+    (void) palavras;
+    (void) numPalavras;
+    int vencedores[MAX_CORES];
+    int total = 0;
+    uint64_t medida = iniciarMedida();
+
+    for (int i = 0; i < sessao->numJogadores; i++) {
+        if (avaliarMissao(&sessao->jogadores[i].missao, sessao->jogo, sessao->jogadores[i].cor) &&
+            total < MAX_CORES) {
+            vencedores[total++] = i + 1;
+        }
+    }
+    encerrarMedida(LATENCIA_VITORIA, medida);
+    escreverTela(saida, "ok vencedores=%d", total);
+    for (int i = 0; i < total; i++) {
+        escreverTela(saida, " %d", vencedores[i]);
+    }
+    anexarTela(saida, "\n", 1);
+    return 1;
+}
+
+/*
+ * Função: comandoContinentes
+ * "continentes": uma linha "nome<TAB>territorios<TAB>dono" por continente
+ * (dono é a cor que domina o continente inteiro ou "-")
+ */
+static inline int comandoContinentes(SessaoComandos* sessao, char* palavras[], int numPalavras, Tela* saida) {
+    (void) palavras;
+    (void) numPalavras;
+    const Jogo* jogo = sessao->jogo;
+
+    escreverTela(saida, "ok %d\n", jogo->continentes.total);
+    for (int c = 0; c < jogo->continentes.total; c++) {
+        const char* dono = "-";
+        for (int cor = 0; cor < jogo->cores.total; cor++) {
+            if (continenteDominado(&jogo->continentes, &jogo->posse, c, (IdCor) cor)) {
+                dono = nomeCor(&jogo->cores, (IdCor) cor);
+                break;
+            }
+        }
+        escreverTela(saida, "%s\t%d\t%s\n", jogo->continentes.nomes[c], jogo->continentes.tamanhos[c], dono);
+    }
+    return 1;
+}
+
+/*
+ * Função: comandoBuscar
+ * "buscar PREFIXO": os territórios cujo nome começa com o prefixo, em
+ * ordem alfabética, no formato de "mostrar"
+ */
+static inline int comandoBuscar(SessaoComandos* sessao, char* palavras[], int numPalavras, Tela* saida) {
+    (void) numPalavras;
+    const Jogo* jogo = sessao->jogo;
+    int inicio, fim;
+
+    if (faixaPrefixo(jogo, palavras[1], strlen(palavras[1]), &inicio, &fim) < 0) {
+        escreverTela(saida, "erro sem_indice\n");
+        return 1;
+    }
+    escreverTela(saida, "ok %d\n", fim - inicio);
+    for (int k = inicio; k < fim; k++) {
+        escreverLinhaTerritorio(saida, jogo, (int) jogo->nomes.ordem[k]);
+    }
+    return 1;
+}
+
+/*
+ * Função: comandoChance
+ * "chance A D": chance exata de A conquistar D atacando até o fim
+ */
+static inline int comandoChance(SessaoComandos* sessao, char* palavras[], int numPalavras, Tela* saida) {
+    (void) numPalavras;
+    const Jogo* jogo = sessao->jogo;
+    int atacante, defensor;
+    ChanceBatalha chance;
+
+    lerParTerritorios(jogo, palavras, &atacante, &defensor);
+    if (atacante < 0 || atacante >= jogo->numTerritorios || defensor < 0 || defensor >= jogo->numTerritorios) {
+        escreverTela(saida, "erro %s\n", nomeCodigoAtaque(ATAQUE_INDICE_INVALIDO));
+        return 1;
+    }
+    if (!consultarChance(sessao->chances, jogo->mapa[atacante].tropas, jogo->mapa[defensor].tropas, &chance)) {
+        escreverTela(saida, "erro fora_da_tabela\n");
+        return 1;
+    }
+    escreverTela(saida, "ok vitoria=%.6f perdas=%.4f,%.4f\n",
+                 chance.vitoria, chance.perdasAtacante, chance.perdasDefensor);
+    return 1;
+}
+
+/*
+ * Função: comandoJogadas
+ * "jogadas COR [maximo]": ataques legais da cor (nome da cor ou número do
+ * jogador), uma linha "atacante<TAB>defensor" por ataque, até "maximo"
+ * A primeira consulta monta os grupos de jogadas da partida, que a partir
+ * daí são mantidos pelo motor a cada batalha
+ */
+static inline int comandoJogadas(SessaoComandos* sessao, char* palavras[], int numPalavras, Tela* saida) {
+    Jogo* jogo = sessao->jogo;
+    char* fim;
+
+    IdCor cor = buscarCor(&jogo->cores, palavras[1]);
+    long jogador = strtol(palavras[1], &fim, 10);
+    if (cor == COR_INVALIDA && *fim == '\0' && jogador >= 1 && jogador <= sessao->numJogadores) {
+        cor = sessao->jogadores[jogador - 1].cor;
+    }
+    if (cor == COR_INVALIDA) {
+        escreverTela(saida, "erro cor_invalida\n");
+        return 1;
+    }
+    long long maximo = -1;   // Sem limite
+    if (numPalavras > 2) {
+        maximo = strtoll(palavras[2], &fim, 10);
+        if (*fim != '\0' || maximo < 0) {
+            escreverTela(saida, "erro argumentos jogadas COR [maximo]\n");
+            return 1;
+        }
+    }
+    if (jogo->jogadas.numTerritorios != jogo->numTerritorios && !ativarJogadas(jogo)) {
+        escreverTela(saida, "erro memoria\n");
+        return 1;
+    }
+
+    uint64_t total = contarJogadas(jogo, cor);
+    uint64_t linhas = maximo >= 0 && (uint64_t) maximo < total ? (uint64_t) maximo : total;
+    escreverTela(saida, "ok %llu total=%llu\n", (unsigned long long) linhas, (unsigned long long) total);
+
+    IteradorJogadas it;
+    ParAtaque par;
+    iniciarJogadas(&it, jogo, cor);
+    for (uint64_t k = 0; k < linhas && proximaJogada(&it, &par); k++) {
+        escreverTela(saida, "%d\t%d\n", par.atacante + 1, par.defensor + 1);
+    }
+    return 1;
+}
+
+/*
+ * Função: comandoCarregar
+ * "carregar arquivo": troca o mapa da partida (CSV ou binário)
+ * Recusado com um diário aberto, que pertence ao mapa de partida, ou se
+ * algum jogador tem missão de continentes (o mapa novo vem sem eles)
+ */
+static inline int comandoCarregar(SessaoComandos* sessao, char* palavras[], int numPalavras, Tela* saida) {
+    (void) numPalavras;
+    Jogo* jogo = sessao->jogo;
+
+    if (sessao->diario != NULL) {
+        escreverTela(saida, "erro diario_aberto\n");
+        return 1;
+    }
+    for (int i = 0; i < sessao->numJogadores; i++) {
+        if (!missaoCabeNoMapa(&sessao->jogadores[i].missao, NULL)) {
+            escreverTela(saida, "erro missao_continente %d\n", i + 1);
+            return 1;
+        }
+    }
+    // Se faltar memória só para as colunas, as jogadas ou o índice, o erro
+    // vem com o mapa já trocado: a tela acompanha o mapa atual em todo caso
+    CodigoCarga codigo = substituirMapa(palavras[1], jogo);
+    int telaAjustada = redimensionarTela(saida, jogo->numTerritorios);
+    if (codigo != CARGA_OK) {
+        escreverTela(saida, "erro carga %s\n", mensagemCarga(codigo));
+        return 1;
+    }
+    if (!telaAjustada) {
+        escreverTela(saida, "erro memoria\n");
+        return 1;
+    }
+    escreverTela(saida, "ok territorios=%d cores=%d\n", jogo->numTerritorios, jogo->cores.total);
+    return 1;
+}
+
+/*
+ * Função: comandoSalvar
+ * "salvar [arquivo]": grava a partida (no arquivo de "--salvar" por padrão)
+ */
+static inline int comandoSalvar(SessaoComandos* sessao, char* palavras[], int numPalavras, Tela* saida) {
+    const char* caminho = numPalavras > 1 ? palavras[1] : sessao->arquivoSalvar;
+    if (caminho == NULL) {
+        escreverTela(saida, "erro argumentos salvar arquivo\n");
+        return 1;
+    }
+
+    if (sessao->diario != NULL && !descarregarDiario(sessao->diario)) {
+        escreverTela(saida, "erro diario\n");
+        return 0;
+    }
+    CodigoCarga codigo = salvarPartida(caminho, sessao->jogo, sessao->jogadores, sessao->numJogadores,
+                                       sessao->turno);
+    if (codigo != CARGA_OK) {
+        escreverTela(saida, "erro carga %s\n", mensagemCarga(codigo));
+        return 1;
+    }
+    escreverTela(saida, "ok turno=%d\n", sessao->turno);
+    return 1;
+}
+
+static inline int comandoTurno(SessaoComandos* sessao, char* palavras[], int numPalavras, Tela* saida) {
+    (void) palavras;
+    (void) numPalavras;
+    escreverTela(saida, "ok turno=%d comandos=%lld\n", sessao->turno, sessao->executados);
+    return 1;
+}
+
+/*
+ * Função: comandoMetricas
+ * "metricas": contadores e histogramas do processo em JSON, na mesma linha
+ */
+static inline int comandoMetricas(SessaoComandos* sessao, char* palavras[], int numPalavras, Tela* saida) {
+    (void) sessao;
+    (void) palavras;
+    (void) numPalavras;
+    char* texto = NULL;
+    size_t tamanho = 0;
+
+    if (!metricas.ativas) {
+        escreverTela(saida, "erro metricas_desligadas\n");
+        return 1;
+    }
+    FILE* json = open_memstream(&texto, &tamanho);
+    if (json == NULL) {
+        escreverTela(saida, "erro memoria\n");
+        return 1;
+    }
+    escreverMetricasJSON(json);
+    if (fclose(json) != 0) {
+        free(texto);
+        escreverTela(saida, "erro memoria\n");
+        return 1;
+    }
+    anexarTela(saida, "ok ", 3);
+    anexarTela(saida, texto, tamanho);
+    anexarTela(saida, "\n", 1);
+    free(texto);
+    return 1;
+}
+
+static inline int comandoSair(SessaoComandos* sessao, char* palavras[], int numPalavras, Tela* saida) {
+    (void) sessao;
+    (void) palavras;
+    (void) numPalavras;
+    anexarTela(saida, "ok\n", 3);
+    return 0;
+}
+
+static inline int comandoAjuda(SessaoComandos* sessao, char* palavras[], int numPalavras, Tela* saida);
+
+static const DefinicaoComando COMANDOS[] = {
+    {"atacar",    "attack", 2, 2, comandoAtacar,    "atacar A D"},
+    {"relampago", "blitz",  2, 2, comandoRelampago, "relampago A D"},
+    {"mostrar",   "show",   0, 1, comandoMostrar,   "mostrar [alterados]"},
+    {"verificar", "check",  0, 0, comandoVerificar, "verificar"},
+    {"chance",    "odds",   2, 2, comandoChance,    "chance A D"},
+    {"buscar",    "find",   1, 1, comandoBuscar,    "buscar PREFIXO"},
+    {"jogadas",   "moves",  1, 2, comandoJogadas,   "jogadas COR [maximo]"},
+    {"continentes", "continents", 0, 0, comandoContinentes, "continentes"},
+    {"carregar",  "load",   1, 1, comandoCarregar,  "carregar arquivo"},
+    {"salvar",    "save",   0, 1, comandoSalvar,    "salvar [arquivo]"},
+    {"turno",     "turn",   0, 0, comandoTurno,     "turno"},
+    {"metricas",  "metrics", 0, 0, comandoMetricas, "metricas"},
+    {"ajuda",     "help",   0, 0, comandoAjuda,     "ajuda"},
+    {"sair",      "quit",   0, 0, comandoSair,      "sair"},
+};
+
+#define TOTAL_COMANDOS ((int) (sizeof(COMANDOS) / sizeof(COMANDOS[0])))
+
+static inline int comandoAjuda(SessaoComandos* sessao, char* palavras[], int numPalavras, Tela* saida) {
+    (void) sessao;
+    (void) palavras;
+    (void) numPalavras;
+    escreverTela(saida, "ok %d\n", TOTAL_COMANDOS);
+    for (int i = 0; i < TOTAL_COMANDOS; i++) {
+        escreverTela(saida, "%s\t%s\n", COMANDOS[i].uso, COMANDOS[i].apelido);
+    }
+    return 1;
+}
+
+/*
+ * Função: buscarComando
+ * Retorna a definição do comando pelo nome ou apelido, ou NULL
+ */
+static inline const DefinicaoComando* buscarComando(const char* nome) {
+    for (int i = 0; i < TOTAL_COMANDOS; i++) {
+        if (strcmp(nome, COMANDOS[i].nome) == 0 || strcmp(nome, COMANDOS[i].apelido) == 0) {
+            return &COMANDOS[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Função: executarComando
+ * Interpreta uma linha e acrescenta a resposta à saída
+ * Retorna 0 se o comando encerrou a sessão, 1 caso contrário
+ */
+static inline int executarComando(SessaoComandos* sessao, char* linha, Tela* saida) {
+    char* palavras[MAX_PALAVRAS_COMANDO];
+    int numPalavras = separarPalavras(linha, palavras, MAX_PALAVRAS_COMANDO);
+
+    if (numPalavras == 0 || palavras[0][0] == '#') {
+        return 1;
+    }
+    const DefinicaoComando* comando = buscarComando(palavras[0]);
+    if (comando == NULL) {
+        escreverTela(saida, "erro comando_desconhecido %s\n", palavras[0]);
+        return 1;
+    }
+    if (numPalavras - 1 < comando->minArgumentos || numPalavras - 1 > comando->maxArgumentos) {
+        escreverTela(saida, "erro argumentos %s\n", comando->uso);
+        return 1;
+    }
+    sessao->executados++;
+    contarMetrica(CONTADOR_COMANDOS, 1);
+    uint64_t medida = iniciarMedida();
+    int continuar = comando->tratar(sessao, palavras, numPalavras, saida);
+    encerrarMedida(LATENCIA_COMANDO, medida);
+    return continuar;
+}
+
+/*
+ * Função: escreverPronto
+ * Saudação enviada no início de uma sessão, antes do primeiro comando
+ */
+static inline void escreverPronto(const SessaoComandos* sessao, Tela* saida) {
+    escreverTela(saida, "pronto territorios=%d jogadores=%d turno=%d\n",
+                 sessao->jogo->numTerritorios, sessao->numJogadores, sessao->turno);
+}
+
+/*
+ * Função: executarProtocolo
+ * Lê e executa comandos de "entrada" até "sair" ou o fim da entrada,
+ * enviando as respostas a "fdSaida" sempre que a entrada já lida acaba
+ * Se o diário não puder ser gravado, a sessão termina com "erro diario"
+ * Retorna 1 em caso de sucesso, 0 se faltar memória, a saída ou o diário falhar
+ */
+static inline int executarProtocolo(SessaoComandos* sessao, int entrada, int fdSaida, Tela* saida) {
+    LeitorLinhas leitor;
+    char* linha;
+    int continuar = 1;
+    int ok = 1;
+
+    if (!criarLeitorLinhas(&leitor, entrada, CAPACIDADE_LEITOR)) {
+        return 0;
+    }
+    escreverPronto(sessao, saida);
+
+    while (continuar && ok) {
+        // Antes de esperar pela entrada, entrega as respostas pendentes
+        if (saida->tamanho >= LIMITE_SAIDA_COMANDOS || !temLinhaPronta(&leitor)) {
+            if (sessao->diario != NULL && !descarregarDiario(sessao->diario)) {
+                escreverTela(saida, "erro diario\n");
+                continuar = 0;
+            }
+            ok = despejarTelaEm(saida, fdSaida);
+        }
+        if (!continuar) {
+            break;
+        }
+        if (!proximaLinha(&leitor, &linha)) {
+            break;
+        }
+        continuar = executarComando(sessao, linha, saida);
+    }
+
+    // Uma falha anterior do diário já foi respondida com "erro diario"
+    if (sessao->diario != NULL && !sessao->diario->falhou && !descarregarDiario(sessao->diario)) {
+        escreverTela(saida, "erro diario\n");
+    }
+    if (sessao->diario != NULL && sessao->diario->falhou) {
+        ok = 0;
+    }
+    if (!despejarTelaEm(saida, fdSaida)) {
+        ok = 0;
+    }
+    liberarLeitorLinhas(&leitor);
+    return ok;
+}
+
+#endif
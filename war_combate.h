@@ -0,0 +1,364 @@
+/*
+ * Combate Clássico do Sistema WAR
+ *
+ * Regra de dados da liga: o atacante rola até 3 dados (um a menos que as
+ * suas tropas) e o defensor até 2 (um por tropa). Os dados de cada lado
+ * são ordenados do maior para o menor e comparados aos pares (o maior do
+ * atacante com o maior do defensor, e assim por diante); cada par perdido
+ * custa uma tropa, e o empate favorece o defensor.
+ *
+ * Cada combate consome sempre DADOS_POR_COMBATE dados do fluxo (3 do
+ * atacante e depois 2 do defensor), mesmo quando rola menos: os dados que
+ * sobram são zerados. Assim o fluxo não depende das tropas, e um lote de
+ * combates sorteado de uma vez dá exatamente os mesmos dados que as
+ * batalhas resolvidas uma a uma.
+ *
+ * O lote guarda os dados em colunas (um vetor por posição de dado) e o
+ * kernel ordena 16 (SSE2) ou 32 (AVX2) combates por instrução com redes
+ * de ordenação de min/max, sem qsort nem desvios por combate. Ele só
+ * serve a combates independentes com os mesmos dados (--combates): numa
+ * partida, os dados de cada batalha dependem das tropas que a anterior
+ * deixou, e essas seguem por rolarCombate().
+ */
+
+#ifndef WAR_COMBATE_H
+#define WAR_COMBATE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "war_colunas.h"    // LARGURA_COLUNAS e temAVX2()
+#include "war_dados.h"
+
+#define DADOS_ATAQUE 3
+#define DADOS_DEFESA 2
+#define DADOS_POR_COMBATE (DADOS_ATAQUE + DADOS_DEFESA)
+
+// Combates sorteados por vez em sortearLote() (dados no buffer da pilha)
+#define BLOCO_SORTEIO 256
+
+// Regras de batalha disponíveis
+typedef enum {
+    REGRA_SIMPLES = 0,     // Um dado por lado; a vitória move metade das tropas
+    REGRA_CLASSICA         // 3 dados contra 2, comparados aos pares
+} RegraBatalha;
+
+// Lote de combates independentes em colunas
+typedef struct {
+    uint8_t* ataque[DADOS_ATAQUE];   // Dados do atacante (0 = não rolado)
+    uint8_t* defesa[DADOS_DEFESA];   // Dados do defensor (0 = não rolado)
+    uint8_t* perdasAtacante;         // Preenchido por resolverRolagens()
+    uint8_t* perdasDefensor;
+    int total;                       // Combates no lote
+    int capacidade;                  // Arredondada para LARGURA_COLUNAS
+    uint8_t* memoria;
+} LoteRolagens;
+
+// ==================== UM COMBATE ====================
+
+/*
+ * Função: dadosDoAtacante / dadosDoDefensor
+ * Quantos dados cada lado rola com as tropas que tem
+ */
+static inline int dadosDoAtacante(int tropas) {
+    int n = tropas - 1;
+    return n > DADOS_ATAQUE ? DADOS_ATAQUE : (n < 1 ? 1 : n);
+}
+
+static inline int dadosDoDefensor(int tropas) {
+    return tropas > DADOS_DEFESA ? DADOS_DEFESA : (tropas < 1 ? 1 : tropas);
+}
+
+/*
+ * Função: ordenarDados
+ * Ordena os dados de um combate do maior para o menor (mesma rede de
+ * comparações do kernel)
+ */
+static inline void ordenarDados(uint8_t ataque[DADOS_ATAQUE], uint8_t defesa[DADOS_DEFESA]) {
+    uint8_t t;
+#define TROCAR_MENOR(x, y) if ((x) < (y)) { t = (x); (x) = (y); (y) = t; }
+    TROCAR_MENOR(ataque[0], ataque[1]);
+    TROCAR_MENOR(ataque[1], ataque[2]);
+    TROCAR_MENOR(ataque[0], ataque[1]);
+    TROCAR_MENOR(defesa[0], defesa[1]);
+#undef TROCAR_MENOR
+}
+
+/*
+ * Função: compararDados
+ * Compara aos pares dados já ordenados e conta as perdas de cada lado
+ * Um par só vale se os dois lados rolaram aquele dado
+ */
+static inline void compararDados(const uint8_t ataque[DADOS_ATAQUE], const uint8_t defesa[DADOS_DEFESA],
+                                 int* perdasAtacante, int* perdasDefensor) {
+    *perdasAtacante = 0;
+    *perdasDefensor = 0;
+    for (int i = 0; i < DADOS_DEFESA; i++) {
+        if (ataque[i] == 0 || defesa[i] == 0) {
+            break;
+        }
+        if (ataque[i] > defesa[i]) {
+            (*perdasDefensor)++;
+        } else {
+            (*perdasAtacante)++;
+        }
+    }
+}
+
+/*
+ * Função: rolarCombate
+ * Sorteia os dados de um combate (consome sempre DADOS_POR_COMBATE dados),
+ * zera os que não foram rolados e os ordena
+ */
+static inline void rolarCombate(GeradorDados* dados, int numAtaque, int numDefesa,
+                                uint8_t ataque[DADOS_ATAQUE], uint8_t defesa[DADOS_DEFESA]) {
+    uint8_t faces[DADOS_POR_COMBATE];
+    preencherDados(dados, faces, DADOS_POR_COMBATE);
+    for (int i = 0; i < DADOS_ATAQUE; i++) {
+        ataque[i] = i < numAtaque ? faces[i] : 0;
+    }
+    for (int i = 0; i < DADOS_DEFESA; i++) {
+        defesa[i] = i < numDefesa ? faces[DADOS_ATAQUE + i] : 0;
+    }
+    ordenarDados(ataque, defesa);
+}
+
+/*
+ * Função: calcularChancesCombate
+ * Chance exata de cada desfecho de um combate, percorrendo todas as faces
+ * possíveis: chances[dados do atacante][dados do defensor][perdas do defensor]
+ */
+static inline void calcularChancesCombate(double chances[DADOS_ATAQUE + 1][DADOS_DEFESA + 1][DADOS_DEFESA + 1]) {
+    memset(chances, 0, sizeof(double) * (DADOS_ATAQUE + 1) * (DADOS_DEFESA + 1) * (DADOS_DEFESA + 1));
+
+    for (int na = 1; na <= DADOS_ATAQUE; na++) {
+        for (int nd = 1; nd <= DADOS_DEFESA; nd++) {
+            int combinacoes = 1;
+            for (int i = 0; i < na + nd; i++) combinacoes *= 6;
+
+            for (int c = 0; c < combinacoes; c++) {
+                uint8_t ataque[DADOS_ATAQUE] = { 0 }, defesa[DADOS_DEFESA] = { 0 };
+                int resto = c;
+                for (int i = 0; i < na; i++, resto /= 6) ataque[i] = (uint8_t) (resto % 6 + 1);
+                for (int i = 0; i < nd; i++, resto /= 6) defesa[i] = (uint8_t) (resto % 6 + 1);
+
+                int perdasAtacante, perdasDefensor;
+                ordenarDados(ataque, defesa);
+                compararDados(ataque, defesa, &perdasAtacante, &perdasDefensor);
+                chances[na][nd][perdasDefensor] += 1.0 / combinacoes;
+            }
+        }
+    }
+}
+
+// ==================== LOTES ====================
+
+/*
+ * Função: criarLoteRolagens
+ * Aloca um lote para até "capacidade" combates
+ * Retorna 1 em caso de sucesso, 0 se faltar memória
+ */
+static inline int criarLoteRolagens(LoteRolagens* lote, int capacidade) {
+    memset(lote, 0, sizeof(*lote));
+    capacidade = (capacidade + LARGURA_COLUNAS - 1) / LARGURA_COLUNAS * LARGURA_COLUNAS;
+    if (capacidade == 0) capacidade = LARGURA_COLUNAS;
+
+    // Uma coluna por dado mais as duas de perdas, todas alinhadas em 32 bytes
+    uint8_t* memoria = (uint8_t*) aligned_alloc(32, (size_t) capacidade * (DADOS_POR_COMBATE + 2));
+    if (memoria == NULL) {
+        return 0;
+    }
+    memset(memoria, 0, (size_t) capacidade * (DADOS_POR_COMBATE + 2));
+
+    for (int i = 0; i < DADOS_ATAQUE; i++) {
+        lote->ataque[i] = memoria + (size_t) capacidade * i;
+    }
+    for (int i = 0; i < DADOS_DEFESA; i++) {
+        lote->defesa[i] = memoria + (size_t) capacidade * (DADOS_ATAQUE + i);
+    }
+    lote->perdasAtacante = memoria + (size_t) capacidade * DADOS_POR_COMBATE;
+    lote->perdasDefensor = memoria + (size_t) capacidade * (DADOS_POR_COMBATE + 1);
+    lote->capacidade = capacidade;
+    lote->memoria = memoria;
+    return 1;
+}
+
+/*
+ * Função: liberarLoteRolagens
+ * Libera as colunas do lote
+ */
+static inline void liberarLoteRolagens(LoteRolagens* lote) {
+    free(lote->memoria);
+    memset(lote, 0, sizeof(*lote));
+}
+
+/*
+ * Função: sortearLote
+ * Sorteia os dados de "total" combates (total <= capacidade), todos com
+ * numAtaque contra numDefesa dados. A folga do lote fica zerada
+ */
+static inline void sortearLote(LoteRolagens* lote, int numAtaque, int numDefesa,
+                               int total, GeradorDados* dados) {
+    uint8_t faces[BLOCO_SORTEIO * DADOS_POR_COMBATE];
+
+    for (int inicio = 0; inicio < total; inicio += BLOCO_SORTEIO) {
+        int n = total - inicio < BLOCO_SORTEIO ? total - inicio : BLOCO_SORTEIO;
+        preencherDados(dados, faces, (size_t) n * DADOS_POR_COMBATE);
+
+        for (int k = 0; k < n; k++) {
+            const uint8_t* f = faces + (size_t) k * DADOS_POR_COMBATE;
+            int i = inicio + k;
+            for (int j = 0; j < DADOS_ATAQUE; j++) {
+                lote->ataque[j][i] = j < numAtaque ? f[j] : 0;
+            }
+            for (int j = 0; j < DADOS_DEFESA; j++) {
+                lote->defesa[j][i] = j < numDefesa ? f[DADOS_ATAQUE + j] : 0;
+            }
+        }
+    }
+
+    for (int j = 0; j < DADOS_ATAQUE; j++) {
+        memset(lote->ataque[j] + total, 0, (size_t) (lote->capacidade - total));
+    }
+    for (int j = 0; j < DADOS_DEFESA; j++) {
+        memset(lote->defesa[j] + total, 0, (size_t) (lote->capacidade - total));
+    }
+    lote->total = total;
+}
+
+/*
+ * Função: resolverRolagensEscalar
+ * Ordena e compara os combates [inicio, fim) um a um
+ */
+static inline void resolverRolagensEscalar(LoteRolagens* lote, int inicio, int fim) {
+    for (int i = inicio; i < fim; i++) {
+        uint8_t a[DADOS_ATAQUE] = { lote->ataque[0][i], lote->ataque[1][i], lote->ataque[2][i] };
+        uint8_t d[DADOS_DEFESA] = { lote->defesa[0][i], lote->defesa[1][i] };
+        int perdasAtacante, perdasDefensor;
+
+        ordenarDados(a, d);
+        compararDados(a, d, &perdasAtacante, &perdasDefensor);
+        for (int j = 0; j < DADOS_ATAQUE; j++) lote->ataque[j][i] = a[j];
+        for (int j = 0; j < DADOS_DEFESA; j++) lote->defesa[j][i] = d[j];
+        lote->perdasAtacante[i] = (uint8_t) perdasAtacante;
+        lote->perdasDefensor[i] = (uint8_t) perdasDefensor;
+    }
+}
+
+#ifdef __SSE2__
+/*
+ * Função: resolverRolagensSSE2
+ * Mesma rede de resolverRolagensEscalar(), 16 combates por passo
+ * ("inicio" e "fim" múltiplos de 16)
+ */
+static inline void resolverRolagensSSE2(LoteRolagens* lote, int inicio, int fim) {
+    const __m128i zero = _mm_setzero_si128();
+
+    for (int i = inicio; i < fim; i += 16) {
+        __m128i a0 = _mm_load_si128((const __m128i*) (lote->ataque[0] + i));
+        __m128i a1 = _mm_load_si128((const __m128i*) (lote->ataque[1] + i));
+        __m128i a2 = _mm_load_si128((const __m128i*) (lote->ataque[2] + i));
+        __m128i d0 = _mm_load_si128((const __m128i*) (lote->defesa[0] + i));
+        __m128i d1 = _mm_load_si128((const __m128i*) (lote->defesa[1] + i));
+        __m128i t;
+
+        // Rede de ordenação decrescente: (0,1) (1,2) (0,1) no ataque, (0,1) na defesa
+        t = _mm_max_epu8(a0, a1); a1 = _mm_min_epu8(a0, a1); a0 = t;
+        t = _mm_max_epu8(a1, a2); a2 = _mm_min_epu8(a1, a2); a1 = t;
+        t = _mm_max_epu8(a0, a1); a1 = _mm_min_epu8(a0, a1); a0 = t;
+        t = _mm_max_epu8(d0, d1); d1 = _mm_min_epu8(d0, d1); d0 = t;
+
+        // Par válido: os dois dados foram rolados (faces 1 a 6 cabem em epi8)
+        __m128i valido0 = _mm_andnot_si128(_mm_or_si128(_mm_cmpeq_epi8(a0, zero), _mm_cmpeq_epi8(d0, zero)),
+                                           _mm_cmpeq_epi8(zero, zero));
+        __m128i valido1 = _mm_andnot_si128(_mm_or_si128(_mm_cmpeq_epi8(a1, zero), _mm_cmpeq_epi8(d1, zero)),
+                                           _mm_cmpeq_epi8(zero, zero));
+        __m128i vence0 = _mm_cmpgt_epi8(a0, d0);
+        __m128i vence1 = _mm_cmpgt_epi8(a1, d1);
+
+        // Cada máscara vale -1: subtrair de zero conta os pares
+        __m128i perdasDefensor = _mm_sub_epi8(_mm_sub_epi8(zero, _mm_and_si128(vence0, valido0)),
+                                              _mm_and_si128(vence1, valido1));
+        __m128i perdasAtacante = _mm_sub_epi8(_mm_sub_epi8(zero, _mm_andnot_si128(vence0, valido0)),
+                                              _mm_andnot_si128(vence1, valido1));
+
+        _mm_store_si128((__m128i*) (lote->ataque[0] + i), a0);
+        _mm_store_si128((__m128i*) (lote->ataque[1] + i), a1);
+        _mm_store_si128((__m128i*) (lote->ataque[2] + i), a2);
+        _mm_store_si128((__m128i*) (lote->defesa[0] + i), d0);
+        _mm_store_si128((__m128i*) (lote->defesa[1] + i), d1);
+        _mm_store_si128((__m128i*) (lote->perdasAtacante + i), perdasAtacante);
+        _mm_store_si128((__m128i*) (lote->perdasDefensor + i), perdasDefensor);
+    }
+}
+#endif
+
+#ifdef WAR_COLUNAS_AVX2
+/*
+ * Função: resolverRolagensAVX2
+ * Mesma rede de resolverRolagensEscalar(), 32 combates por passo
+ * ("inicio" e "fim" múltiplos de 32)
+ */
+__attribute__((target("avx2")))
+static inline void resolverRolagensAVX2(LoteRolagens* lote, int inicio, int fim) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i todos = _mm256_cmpeq_epi8(zero, zero);
+
+    for (int i = inicio; i < fim; i += 32) {
+        __m256i a0 = _mm256_load_si256((const __m256i*) (lote->ataque[0] + i));
+        __m256i a1 = _mm256_load_si256((const __m256i*) (lote->ataque[1] + i));
+        __m256i a2 = _mm256_load_si256((const __m256i*) (lote->ataque[2] + i));
+        __m256i d0 = _mm256_load_si256((const __m256i*) (lote->defesa[0] + i));
+        __m256i d1 = _mm256_load_si256((const __m256i*) (lote->defesa[1] + i));
+        __m256i t;
+
+        t = _mm256_max_epu8(a0, a1); a1 = _mm256_min_epu8(a0, a1); a0 = t;
+        t = _mm256_max_epu8(a1, a2); a2 = _mm256_min_epu8(a1, a2); a1 = t;
+        t = _mm256_max_epu8(a0, a1); a1 = _mm256_min_epu8(a0, a1); a0 = t;
+        t = _mm256_max_epu8(d0, d1); d1 = _mm256_min_epu8(d0, d1); d0 = t;
+
+        __m256i valido0 = _mm256_andnot_si256(_mm256_or_si256(_mm256_cmpeq_epi8(a0, zero),
+                                                              _mm256_cmpeq_epi8(d0, zero)), todos);
+        __m256i valido1 = _mm256_andnot_si256(_mm256_or_si256(_mm256_cmpeq_epi8(a1, zero),
+                                                              _mm256_cmpeq_epi8(d1, zero)), todos);
+        __m256i vence0 = _mm256_cmpgt_epi8(a0, d0);
+        __m256i vence1 = _mm256_cmpgt_epi8(a1, d1);
+
+        __m256i perdasDefensor = _mm256_sub_epi8(_mm256_sub_epi8(zero, _mm256_and_si256(vence0, valido0)),
+                                                 _mm256_and_si256(vence1, valido1));
+        __m256i perdasAtacante = _mm256_sub_epi8(_mm256_sub_epi8(zero, _mm256_andnot_si256(vence0, valido0)),
+                                                 _mm256_andnot_si256(vence1, valido1));
+
+        _mm256_store_si256((__m256i*) (lote->ataque[0] + i), a0);
+        _mm256_store_si256((__m256i*) (lote->ataque[1] + i), a1);
+        _mm256_store_si256((__m256i*) (lote->ataque[2] + i), a2);
+        _mm256_store_si256((__m256i*) (lote->defesa[0] + i), d0);
+        _mm256_store_si256((__m256i*) (lote->defesa[1] + i), d1);
+        _mm256_store_si256((__m256i*) (lote->perdasAtacante + i), perdasAtacante);
+        _mm256_store_si256((__m256i*) (lote->perdasDefensor + i), perdasDefensor);
+    }
+}
+#endif
+
+/*
+ * Função: resolverRolagens
+ * Ordena os dados e calcula as perdas de todos os combates do lote com o
+ * melhor kernel disponível (a folga zerada resulta em zero perdas)
+ */
+static inline void resolverRolagens(LoteRolagens* lote) {
+    int fim = (lote->total + LARGURA_COLUNAS - 1) / LARGURA_COLUNAS * LARGURA_COLUNAS;
+#ifdef WAR_COLUNAS_AVX2
+    if (temAVX2()) {
+        resolverRolagensAVX2(lote, 0, fim);
+        return;
+    }
+#endif
+#ifdef __SSE2__
+    resolverRolagensSSE2(lote, 0, fim);
+#else
+    resolverRolagensEscalar(lote, 0, fim);
+#endif
+}
+
+#endif // WAR_COMBATE_H
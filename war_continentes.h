@@ -0,0 +1,282 @@
+/*
+ * Continentes do Sistema WAR
+ *
+ * Grupos nomeados de territórios (continentes ou regiões) guardados como
+ * conjuntos de bits: o bit i da faixa de um continente indica se o
+ * território i pertence a ele. Cada continente guarda só as palavras de
+ * 64 bits entre o seu primeiro e o seu último território, então um
+ * continente de territórios vizinhos no vetor ocupa poucas linhas de cache.
+ *
+ * A posse é outro conjunto de bits por cor (uma linha de palavras por ID
+ * de cor), mantido pelo motor a cada batalha. "A cor domina o continente"
+ * vira um E bit a bit com a negação da posse sobre a faixa do continente,
+ * e "quantos territórios do continente a cor tem", uma contagem de bits,
+ * sem percorrer o mapa nem comparar nomes.
+ *
+ * Os continentes são somente leitura depois de montados e podem ser
+ * compartilhados entre cópias da partida (como as fronteiras); a posse é
+ * própria de cada partida.
+ */
+
+#ifndef WAR_CONTINENTES_H
+#define WAR_CONTINENTES_H
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "war_cores.h"
+
+#define MAX_CONTINENTES 32   // Continentes distintos por mapa
+#define TAM_CONTINENTE 24    // Nome do continente (com '\0')
+
+typedef struct {
+    int total;                                  // Continentes cadastrados (0 = nenhum)
+    int numTerritorios;                         // Tamanho do mapa para o qual foram montados
+    char nomes[MAX_CONTINENTES][TAM_CONTINENTE];
+    int tamanhos[MAX_CONTINENTES];              // Territórios de cada continente
+    uint32_t primeira[MAX_CONTINENTES];         // Primeira palavra do mapa com membros
+    uint32_t palavras[MAX_CONTINENTES];         // Palavras da faixa (0 = continente vazio)
+    uint32_t deslocamento[MAX_CONTINENTES];     // Início da faixa em "membros"
+    const uint64_t* membros;                    // Faixas de bits dos continentes, em sequência
+    void* memoria;                              // Bloco alocado por construirContinentes (NULL em cópias)
+} Continentes;
+
+// Território de um continente (índices base 0)
+typedef struct {
+    uint32_t continente;
+    uint32_t territorio;
+} MembroContinente;
+
+// Posse por cor: bits[cor * palavras + w] (NULL = posse desativada)
+typedef struct {
+    uint64_t* bits;
+    uint32_t palavras;
+    uint32_t linhas;     // Cores com linha (as da tabela quando a posse foi criada)
+} PosseCores;
+
+/*
+ * Função: palavrasBits
+ * Palavras de 64 bits necessárias para "numTerritorios" bits
+ */
+static inline uint32_t palavrasBits(int numTerritorios) {
+    return (uint32_t) (((size_t) numTerritorios + 63) / 64);
+}
+
+/*
+ * Função: inicializarContinentes
+ * Deixa o mapa sem continentes cadastrados
+ */
+static inline void inicializarContinentes(Continentes* continentes) {
+    memset(continentes, 0, sizeof(*continentes));
+}
+
+/*
+ * Função: construirContinentes
+ * Monta as faixas de bits a partir dos nomes e de uma lista de membros
+ * (em qualquer ordem; membros repetidos contam uma vez)
+ * Retorna 1 em caso de sucesso, 0 se faltar memória ou houver índice inválido
+ */
+static inline int construirContinentes(Continentes* continentes, int numTerritorios,
+                                       const char nomes[][TAM_CONTINENTE], int total,
+                                       const MembroContinente* membros, size_t numMembros) {
+    if (total < 0 || total > MAX_CONTINENTES) {
+        return 0;
+    }
+
+    Continentes novo;
+    inicializarContinentes(&novo);
+    novo.total = total;
+    novo.numTerritorios = numTerritorios;
+
+    // Faixa de palavras de cada continente: do menor ao maior membro
+    uint32_t menor[MAX_CONTINENTES], maior[MAX_CONTINENTES];
+    for (int c = 0; c < total; c++) {
+        memcpy(novo.nomes[c], nomes[c], TAM_CONTINENTE);
+        novo.nomes[c][TAM_CONTINENTE - 1] = '\0';
+        menor[c] = UINT32_MAX;
+        maior[c] = 0;
+    }
+    for (size_t i = 0; i < numMembros; i++) {
+        uint32_t c = membros[i].continente;
+        uint32_t t = membros[i].territorio;
+        if (c >= (uint32_t) total || t >= (uint32_t) numTerritorios) {
+            return 0;
+        }
+        if (t < menor[c]) menor[c] = t;
+        if (t > maior[c]) maior[c] = t;
+    }
+
+    size_t totalPalavras = 0;
+    for (int c = 0; c < total; c++) {
+        if (menor[c] == UINT32_MAX) {
+            continue; // Continente sem territórios
+        }
+        novo.primeira[c] = menor[c] / 64;
+        novo.palavras[c] = maior[c] / 64 - menor[c] / 64 + 1;
+        novo.deslocamento[c] = (uint32_t) totalPalavras;
+        totalPalavras += novo.palavras[c];
+    }
+
+    uint64_t* bits = (uint64_t*) calloc(totalPalavras > 0 ? totalPalavras : 1, sizeof(uint64_t));
+    if (bits == NULL) {
+        return 0;
+    }
+    for (size_t i = 0; i < numMembros; i++) {
+        uint32_t c = membros[i].continente;
+        uint32_t t = membros[i].territorio;
+        uint64_t* palavra = &bits[novo.deslocamento[c] + t / 64 - novo.primeira[c]];
+        uint64_t bit = 1ULL << (t % 64);
+        if (!(*palavra & bit)) {
+            *palavra |= bit;
+            novo.tamanhos[c]++;
+        }
+    }
+
+    novo.membros = bits;
+    novo.memoria = bits;
+    *continentes = novo;
+    return 1;
+}
+
+/*
+ * Função: liberarContinentes
+ * Libera os continentes (se foram alocados) e deixa o mapa sem eles
+ */
+static inline void liberarContinentes(Continentes* continentes) {
+    free(continentes->memoria);
+    inicializarContinentes(continentes);
+}
+
+/*
+ * Função: buscarContinente
+ * Retorna o índice do continente com o nome (sem diferenciar maiúsculas) ou -1
+ */
+static inline int buscarContinente(const Continentes* continentes, const char* nome, size_t tamanho) {
+    for (int c = 0; c < continentes->total; c++) {
+        const char* atual = continentes->nomes[c];
+        size_t k = 0;
+        while (k < tamanho && atual[k] != '\0' &&
+               tolower((unsigned char) atual[k]) == tolower((unsigned char) nome[k])) {
+            k++;
+        }
+        if (k == tamanho && atual[k] == '\0') {
+            return c;
+        }
+    }
+    return -1;
+}
+
+// ==================== POSSE ====================
+
+/*
+ * Função: criarPosse
+ * Aloca a posse (vazia) de "numCores" cores para "numTerritorios" territórios
+ * Retorna 1 em caso de sucesso, 0 se faltar memória
+ */
+static inline int criarPosse(PosseCores* posse, int numTerritorios, int numCores) {
+    uint32_t palavras = palavrasBits(numTerritorios);
+    uint32_t linhas = numCores > 0 ? (uint32_t) numCores : 1;
+    posse->bits = (uint64_t*) calloc((size_t) linhas * (palavras > 0 ? palavras : 1), sizeof(uint64_t));
+    posse->palavras = posse->bits != NULL ? palavras : 0;
+    posse->linhas = posse->bits != NULL ? linhas : 0;
+    return posse->bits != NULL;
+}
+
+/*
+ * Função: liberarPosse
+ * Libera a posse e a deixa desativada
+ */
+static inline void liberarPosse(PosseCores* posse) {
+    free(posse->bits);
+    posse->bits = NULL;
+    posse->palavras = 0;
+    posse->linhas = 0;
+}
+
+/*
+ * Função: linhaPosse
+ * Retorna as palavras de posse da cor
+ */
+static inline uint64_t* linhaPosse(const PosseCores* posse, IdCor cor) {
+    return posse->bits + (size_t) cor * posse->palavras;
+}
+
+/*
+ * Função: marcarPosse
+ * Registra o território como da cor
+ */
+static inline void marcarPosse(PosseCores* posse, IdCor cor, int territorio) {
+    linhaPosse(posse, cor)[territorio / 64] |= 1ULL << (territorio % 64);
+}
+
+/*
+ * Função: desmarcarPosse
+ * Tira o território da posse da cor
+ */
+static inline void desmarcarPosse(PosseCores* posse, IdCor cor, int territorio) {
+    linhaPosse(posse, cor)[territorio / 64] &= ~(1ULL << (territorio % 64));
+}
+
+/*
+ * Função: copiarPosse
+ * Copia todas as linhas de uma posse criada com o mesmo tamanho
+ */
+static inline void copiarPosse(PosseCores* destino, const PosseCores* origem) {
+    memcpy(destino->bits, origem->bits, sizeof(uint64_t) * (size_t) origem->linhas * origem->palavras);
+}
+
+// ==================== CONSULTAS ====================
+
+/*
+ * Função: continenteDominado
+ * Retorna 1 se a cor controla todos os territórios do continente
+ * (um continente vazio não é dominado por ninguém)
+ */
+static inline int continenteDominado(const Continentes* continentes, const PosseCores* posse,
+                                     int continente, IdCor cor) {
+    if (continente < 0 || continente >= continentes->total || continentes->tamanhos[continente] == 0 ||
+        posse->bits == NULL || cor >= posse->linhas) {
+        return 0;
+    }
+    const uint64_t* membros = continentes->membros + continentes->deslocamento[continente];
+    const uint64_t* dono = linhaPosse(posse, cor) + continentes->primeira[continente];
+    uint64_t faltando = 0;
+    for (uint32_t w = 0; w < continentes->palavras[continente]; w++) {
+        faltando |= membros[w] & ~dono[w];
+    }
+    return faltando == 0;
+}
+
+/*
+ * Função: territoriosNoContinente
+ * Conta os territórios do continente controlados pela cor
+ */
+static inline int territoriosNoContinente(const Continentes* continentes, const PosseCores* posse,
+                                          int continente, IdCor cor) {
+    if (continente < 0 || continente >= continentes->total || posse->bits == NULL || cor >= posse->linhas) {
+        return 0;
+    }
+    const uint64_t* membros = continentes->membros + continentes->deslocamento[continente];
+    const uint64_t* dono = linhaPosse(posse, cor) + continentes->primeira[continente];
+    int total = 0;
+    for (uint32_t w = 0; w < continentes->palavras[continente]; w++) {
+        total += __builtin_popcountll(membros[w] & dono[w]);
+    }
+    return total;
+}
+
+/*
+ * Função: contarContinentesDominados
+ * Quantidade de continentes inteiramente controlados pela cor
+ */
+static inline int contarContinentesDominados(const Continentes* continentes, const PosseCores* posse, IdCor cor) {
+    int total = 0;
+    for (int c = 0; c < continentes->total; c++) {
+        total += continenteDominado(continentes, posse, c, cor);
+    }
+    return total;
+}
+
+#endif // WAR_CONTINENTES_H
@@ -0,0 +1,116 @@
+/*
+ * Tabela de Cores do Sistema WAR
+ *
+ * As cores dos exércitos são internadas uma única vez, no cadastro, em
+ * uma pequena tabela: territórios e jogadores guardam apenas o ID (um
+ * byte). Assim a posse de um território é verificada com uma comparação
+ * de inteiros, sem strcmp. Os nomes são normalizados (minúsculas, sem
+ * espaços nas pontas), então "Vermelha" e "vermelha" são a mesma cor.
+ */
+
+#ifndef WAR_CORES_H
+#define WAR_CORES_H
+
+#include <ctype.h>
+#include <stdint.h>
+#include <string.h>
+
+#define MAX_CORES 64        // Cores distintas por partida
+#define TAM_COR 10          // Tamanho máximo do nome (com '\0')
+#define COR_INVALIDA 0xFF   // Cor inexistente / tabela cheia
+
+// Identificador de uma cor internada
+typedef uint8_t IdCor;
+
+typedef struct {
+    char nomes[MAX_CORES][TAM_COR];  // Nomes normalizados, indexados pelo ID
+    int total;                       // Quantidade de cores internadas
+} TabelaCores;
+
+/*
+ * Função: inicializarCores
+ * Deixa a tabela de cores vazia
+ */
+static inline void inicializarCores(TabelaCores* cores) {
+    cores->total = 0;
+}
+
+/*
+ * Função: normalizarCor
+ * Copia "nome" para "destino" em minúsculas e sem espaços nas pontas
+ */
+static inline void normalizarCor(const char* nome, char destino[TAM_COR]) {
+    while (isspace((unsigned char) *nome)) nome++;
+
+    int tamanho = 0;
+    while (nome[tamanho] != '\0' && tamanho < TAM_COR - 1) {
+        destino[tamanho] = (char) tolower((unsigned char) nome[tamanho]);
+        tamanho++;
+    }
+    while (tamanho > 0 && isspace((unsigned char) destino[tamanho - 1])) tamanho--;
+    destino[tamanho] = '\0';
+}
+
+/*
+ * Função: buscarCor
+ * Retorna o ID de uma cor já internada ou COR_INVALIDA
+ */
+static inline IdCor buscarCor(const TabelaCores* cores, const char* nome) {
+    char normalizado[TAM_COR];
+    normalizarCor(nome, normalizado);
+
+    for (int i = 0; i < cores->total; i++) {
+        if (strcmp(cores->nomes[i], normalizado) == 0) {
+            return (IdCor) i;
+        }
+    }
+    return COR_INVALIDA;
+}
+
+/*
+ * Função: internarCor
+ * Retorna o ID da cor, cadastrando-a se ainda não existir
+ * Retorna COR_INVALIDA se a tabela estiver cheia
+ */
+static inline IdCor internarCor(TabelaCores* cores, const char* nome) {
+    IdCor id = buscarCor(cores, nome);
+    if (id != COR_INVALIDA) {
+        return id;
+    }
+    if (cores->total >= MAX_CORES) {
+        return COR_INVALIDA;
+    }
+    normalizarCor(nome, cores->nomes[cores->total]);
+    return (IdCor) cores->total++;
+}
+
+/*
+ * Função: validarCores
+ * Confere uma tabela lida de arquivo: total dentro do limite e cada
+ * nome terminado em '\0'
+ * Retorna 1 se a tabela é válida
+ */
+static inline int validarCores(const TabelaCores* cores) {
+    if (cores->total < 0 || cores->total > MAX_CORES) {
+        return 0;
+    }
+    for (int i = 0; i < cores->total; i++) {
+        if (memchr(cores->nomes[i], '\0', TAM_COR) == NULL) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Função: nomeCor
+ * Retorna o nome (normalizado) de uma cor a partir do ID
+ */
+static inline const char* nomeCor(const TabelaCores* cores, IdCor id) {
+    if (id >= cores->total) {
+        return "?";
+    }
+    return cores->nomes[id];
+}
+
+#endif // WAR_CORES_H
@@ -0,0 +1,243 @@
+/*
+ * Gerador de Dados do Sistema WAR
+ *
+ * Substitui o rand() global por geradores explícitos, reprodutíveis e
+ * independentes: cada partida (ou thread) possui o seu próprio fluxo.
+ * O gerador é baseado em contador (Philox4x32-10): o bloco n de um fluxo
+ * depende apenas de (semente, fluxo, n), então fluxos diferentes nunca se
+ * sobrepõem e podem ser distribuídos entre threads de forma determinística.
+ *
+ * Os dados de 6 faces são obtidos por rejeição (bytes >= 252 são
+ * descartados), sem o viés de "rand() % 6".
+ */
+
+#ifndef WAR_DADOS_H
+#define WAR_DADOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Tamanho, em bytes, de um bloco produzido pelo Philox4x32
+#define BYTES_POR_BLOCO 16
+
+// Maior múltiplo de 6 que cabe em um byte: bytes >= 252 são rejeitados
+#define LIMITE_REJEICAO_D6 252
+
+// Estado de um fluxo de dados (pode ser copiado/salvo byte a byte)
+typedef struct {
+    uint32_t chave[2];               // Derivada da semente
+    uint64_t fluxo;                  // Identificador do fluxo (partida/thread)
+    uint64_t contador;               // Próximo bloco a ser gerado
+    uint8_t bloco[BYTES_POR_BLOCO];  // Bloco atual de bytes aleatórios
+    int posicao;                     // Próximo byte a consumir do bloco
+} GeradorDados;
+
+// ==================== NÚCLEO PHILOX ====================
+
+/*
+ * Função: philox4x32
+ * Calcula o bloco de 128 bits correspondente a (chave, contador)
+ */
+static inline void philox4x32(const uint32_t chave[2], const uint32_t entrada[4], uint32_t saida[4]) {
+    uint32_t c0 = entrada[0], c1 = entrada[1], c2 = entrada[2], c3 = entrada[3];
+    uint32_t k0 = chave[0], k1 = chave[1];
+
+    for (int rodada = 0; rodada < 10; rodada++) {
+        uint64_t p0 = (uint64_t) 0xD2511F53u * c0;
+        uint64_t p1 = (uint64_t) 0xCD9E8D57u * c2;
+        uint32_t n0 = (uint32_t) (p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = (uint32_t) (p0 >> 32) ^ c3 ^ k1;
+        c1 = (uint32_t) p1;
+        c3 = (uint32_t) p0;
+        c0 = n0;
+        c2 = n2;
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+
+    saida[0] = c0;
+    saida[1] = c1;
+    saida[2] = c2;
+    saida[3] = c3;
+}
+
+/*
+ * Função: gerarBloco
+ * Gera o próximo bloco do fluxo em "destino" e avança o contador
+ */
+static inline void gerarBloco(GeradorDados* gerador, uint8_t destino[BYTES_POR_BLOCO]) {
+    uint32_t entrada[4] = {
+        (uint32_t) gerador->contador, (uint32_t) (gerador->contador >> 32),
+        (uint32_t) gerador->fluxo, (uint32_t) (gerador->fluxo >> 32)
+    };
+    uint32_t saida[4];
+
+    philox4x32(gerador->chave, entrada, saida);
+    gerador->contador++;
+
+    for (int i = 0; i < 4; i++) {
+        destino[4 * i + 0] = (uint8_t) saida[i];
+        destino[4 * i + 1] = (uint8_t) (saida[i] >> 8);
+        destino[4 * i + 2] = (uint8_t) (saida[i] >> 16);
+        destino[4 * i + 3] = (uint8_t) (saida[i] >> 24);
+    }
+}
+
+// ==================== INICIALIZAÇÃO ====================
+
+/*
+ * Função: inicializarGerador
+ * Prepara um fluxo a partir de uma semente explícita
+ * Parâmetros:
+ *   - semente: mesma semente + mesmo fluxo = mesma sequência de dados
+ *   - fluxo: identificador do fluxo (ex.: número da partida ou da thread)
+ */
+static inline void inicializarGerador(GeradorDados* gerador, uint64_t semente, uint64_t fluxo) {
+    gerador->chave[0] = (uint32_t) semente;
+    gerador->chave[1] = (uint32_t) (semente >> 32);
+    gerador->fluxo = fluxo;
+    gerador->contador = 0;
+    gerador->posicao = BYTES_POR_BLOCO; // Bloco vazio: força a geração
+}
+
+/*
+ * Função: derivarGerador
+ * Cria um novo fluxo com a mesma semente de "origem" (divisão determinística)
+ */
+static inline void derivarGerador(GeradorDados* destino, const GeradorDados* origem, uint64_t fluxo) {
+    destino->chave[0] = origem->chave[0];
+    destino->chave[1] = origem->chave[1];
+    destino->fluxo = fluxo;
+    destino->contador = 0;
+    destino->posicao = BYTES_POR_BLOCO;
+}
+
+// ==================== SORTEIOS ====================
+
+/*
+ * Função: proximoByte
+ * Consome o próximo byte aleatório do fluxo
+ */
+static inline uint8_t proximoByte(GeradorDados* gerador) {
+    if (gerador->posicao >= BYTES_POR_BLOCO) {
+        gerarBloco(gerador, gerador->bloco);
+        gerador->posicao = 0;
+    }
+    return gerador->bloco[gerador->posicao++];
+}
+
+/*
+ * Função: proximoU32
+ * Consome 32 bits aleatórios do fluxo
+ */
+static inline uint32_t proximoU32(GeradorDados* gerador) {
+    uint32_t valor = 0;
+    for (int i = 0; i < 4; i++) {
+        valor |= (uint32_t) proximoByte(gerador) << (8 * i);
+    }
+    return valor;
+}
+
+/*
+ * Função: rolarDado
+ * Sorteia um dado de 6 faces (1 a 6) sem viés
+ */
+static inline int rolarDado(GeradorDados* gerador) {
+    uint8_t valor;
+    do {
+        valor = proximoByte(gerador);
+    } while (valor >= LIMITE_REJEICAO_D6);
+    return (valor % 6) + 1;
+}
+
+/*
+ * Função: sortearIntervalo
+ * Sorteia um inteiro uniforme em [0, limite) (limite > 0), sem viés
+ */
+static inline uint32_t sortearIntervalo(GeradorDados* gerador, uint32_t limite) {
+    // Rejeita a parte final do intervalo de 32 bits que não é múltiplo de "limite"
+    uint32_t descarte = (uint32_t) (-limite) % limite;
+    uint32_t valor;
+    do {
+        valor = proximoU32(gerador);
+    } while (valor < descarte);
+    return valor % limite;
+}
+
+/*
+ * Função: sortearUniforme
+ * Sorteia um real uniforme em [0, 1) com 53 bits de precisão
+ */
+static inline double sortearUniforme(GeradorDados* gerador) {
+    uint64_t alto = proximoU32(gerador);
+    uint64_t baixo = proximoU32(gerador);
+    return (double) ((alto << 21) | (baixo >> 11)) * (1.0 / 9007199254740992.0);
+}
+
+/*
+ * Função: preencherDados
+ * Preenche "destino" com "quantidade" dados de 6 faces (valores 1 a 6)
+ * A sequência produzida é idêntica à de chamadas sucessivas de rolarDado();
+ * blocos completos sem bytes rejeitados são convertidos com SSE2
+ */
+static inline void preencherDados(GeradorDados* gerador, uint8_t* destino, size_t quantidade) {
+    size_t gerados = 0;
+
+    // Consome primeiro o que restou do bloco atual
+    while (gerados < quantidade && gerador->posicao < BYTES_POR_BLOCO) {
+        uint8_t valor = gerador->bloco[gerador->posicao++];
+        if (valor < LIMITE_REJEICAO_D6) {
+            destino[gerados++] = (uint8_t) ((valor % 6) + 1);
+        }
+    }
+
+#ifdef __SSE2__
+    const __m128i limite = _mm_set1_epi8((char) (LIMITE_REJEICAO_D6 - 1));
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i inverso6 = _mm_set1_epi16((short) 0xAAAB); // ceil(2^18 / 6)
+    const __m128i seis = _mm_set1_epi16(6);
+    const __m128i um = _mm_set1_epi8(1);
+
+    while (quantidade - gerados >= BYTES_POR_BLOCO) {
+        gerarBloco(gerador, gerador->bloco);
+        __m128i bytes = _mm_loadu_si128((const __m128i*) gerador->bloco);
+
+        // Algum byte >= 252? Então o bloco segue pelo caminho escalar
+        __m128i excesso = _mm_subs_epu8(bytes, limite);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(excesso, zero)) != 0xFFFF) {
+            gerador->posicao = 0;
+            while (gerador->posicao < BYTES_POR_BLOCO) {
+                uint8_t valor = gerador->bloco[gerador->posicao++];
+                if (valor < LIMITE_REJEICAO_D6) {
+                    destino[gerados++] = (uint8_t) ((valor % 6) + 1);
+                }
+            }
+            continue;
+        }
+
+        // valor % 6 em 16 bits: q = (valor * 0xAAAB) >> 18; r = valor - 6q
+        __m128i baixo = _mm_unpacklo_epi8(bytes, zero);
+        __m128i alto = _mm_unpackhi_epi8(bytes, zero);
+        __m128i qBaixo = _mm_srli_epi16(_mm_mulhi_epu16(baixo, inverso6), 2);
+        __m128i qAlto = _mm_srli_epi16(_mm_mulhi_epu16(alto, inverso6), 2);
+        baixo = _mm_sub_epi16(baixo, _mm_mullo_epi16(qBaixo, seis));
+        alto = _mm_sub_epi16(alto, _mm_mullo_epi16(qAlto, seis));
+
+        __m128i faces = _mm_add_epi8(_mm_packus_epi16(baixo, alto), um);
+        _mm_storeu_si128((__m128i*) (destino + gerados), faces);
+        gerados += BYTES_POR_BLOCO;
+        gerador->posicao = BYTES_POR_BLOCO;
+    }
+#endif
+
+    // Restante (ou tudo, sem SSE2) pelo caminho escalar
+    while (gerados < quantidade) {
+        destino[gerados++] = (uint8_t) rolarDado(gerador);
+    }
+}
+
+#endif // WAR_DADOS_H
@@ -0,0 +1,356 @@
+/*
+ * Diário de Batalhas do Sistema WAR
+ *
+ * Registra cada batalha como um evento de tamanho fixo em um arquivo que
+ * só cresce no final:
+ *
+ *   [CabecalhoDiario][EventoBatalha][EventoBatalha]...
+ *
+ * O cabeçalho guarda uma assinatura do mapa no momento em que o diário foi
+ * criado e a regra de batalha da partida. A reprodução parte desse mesmo mapa e reaplica os dados gravados
+ * em lote (sem entrada/saída), reconstruindo o mapa de qualquer turno; como
+ * o resultado gravado também é conferido, ela acusa qualquer mudança de
+ * comportamento do motor.
+ */
+
+#ifndef WAR_DIARIO_H
+#define WAR_DIARIO_H
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "war_engine.h"
+#include "war_relampago.h"   // aplicarRelampago() na reprodução
+
+// Identificação do formato do diário
+#define MAGICA_DIARIO "WARDIAR1"
+#define VERSAO_DIARIO 3
+
+// Eventos acumulados na memória antes de cada escrita
+#define EVENTOS_POR_ESCRITA 256
+
+// Cabeçalho do diário
+typedef struct {
+    char magica[8];            // MAGICA_DIARIO (sem '\0')
+    uint32_t versao;           // VERSAO_DIARIO
+    uint32_t tamanhoEvento;    // sizeof(EventoBatalha) de quem gravou
+    uint64_t numTerritorios;   // Tamanho do mapa de partida
+    uint64_t assinaturaMapa;   // assinaturaMapa() do mapa de partida
+    uint32_t regra;            // RegraBatalha da partida
+    uint32_t reservado;
+} CabecalhoDiario;
+
+// Uma batalha registrada (32 bytes)
+typedef struct {
+    uint32_t turno;            // Turno em que a batalha aconteceu
+    uint32_t atacante;         // Índice do território atacante
+    uint32_t defensor;         // Índice do território defensor
+    int32_t tropasMovidas;     // Tropas transferidas na conquista
+    int32_t perdasAtacante;    // Tropas perdidas pelo atacante
+    int32_t perdasDefensor;    // Tropas perdidas pelo defensor
+    uint8_t dadosAtacante[DADOS_ATAQUE];  // Em ordem decrescente (0 = não rolado)
+    uint8_t dadosDefensor[DADOS_DEFESA];
+    uint8_t conquistou;        // 1 se o defensor foi conquistado
+    uint8_t relampago;         // 1 se foi um ataque até o fim (só as perdas, sem dados)
+    uint8_t reservado;
+} EventoBatalha;
+
+// Diário aberto para gravação
+typedef struct {
+    int fd;
+    EventoBatalha pendentes[EVENTOS_POR_ESCRITA];  // Ainda não escritos no arquivo
+    int numPendentes;
+    uint64_t totalEventos;                         // Eventos no diário (arquivo + pendentes)
+    int falhou;                                    // 1 depois de uma escrita com erro
+} DiarioBatalhas;
+
+// Resultado de uma reprodução
+typedef struct {
+    uint64_t aplicados;        // Eventos reaplicados no mapa
+    uint64_t divergentes;      // Eventos cujo resultado difere do gravado
+    uint64_t invalidos;        // Eventos com índices fora do mapa (ignorados)
+    uint32_t ultimoTurno;      // Turno do último evento aplicado
+} ResumoReproducao;
+
+/*
+ * Função: assinaturaMapa
+ * Calcula uma assinatura (FNV-1a de 64 bits) dos nomes, cores e tropas
+ */
+static inline uint64_t assinaturaMapa(const Jogo* jogo) {
+    const Territorio* mapa = jogo->mapa;
+    uint64_t hash = 1469598103934665603ULL;
+    for (int i = 0; i < jogo->numTerritorios; i++) {
+        for (const char* c = nomeTerritorio(jogo, i); *c != '\0'; c++) {
+            hash = (hash ^ (uint8_t) *c) * 1099511628211ULL;
+        }
+        hash = (hash ^ mapa[i].cor) * 1099511628211ULL;
+        hash = (hash ^ (uint32_t) mapa[i].tropas) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/*
+ * Função: escreverTudo
+ * Escreve "tamanho" bytes no arquivo, repetindo em escritas parciais
+ * Retorna 1 em caso de sucesso, 0 em caso de erro
+ */
+static inline int escreverTudo(int fd, const void* dados, size_t tamanho) {
+    const char* p = (const char*) dados;
+    while (tamanho > 0) {
+        ssize_t n = write(fd, p, tamanho);
+        if (n <= 0) {
+            return 0;
+        }
+        p += n;
+        tamanho -= (size_t) n;
+    }
+    return 1;
+}
+
+/*
+ * Função: abrirDiario
+ * Abre o diário para acrescentar as batalhas a partir do turno "turno";
+ * um arquivo novo (ou vazio) recebe o cabeçalho com a assinatura do mapa
+ * e a regra atuais. Um diário existente precisa ter a mesma regra, o mesmo
+ * número de territórios e só eventos inteiros; sem eventos, o mapa atual
+ * ainda é o de partida e a assinatura é conferida, e com eventos o último
+ * turno gravado precisa ser anterior a "turno" (a reprodução conta com os
+ * turnos em ordem)
+ * Retorna 1 em caso de sucesso, 0 em caso de erro ou diário incompatível
+ */
+static inline int abrirDiario(DiarioBatalhas* diario, const char* caminho, const Jogo* jogo, int turno) {
+    diario->fd = open(caminho, O_RDWR | O_CREAT | O_APPEND, 0644);
+    diario->numPendentes = 0;
+    diario->totalEventos = 0;
+    diario->falhou = 0;
+    if (diario->fd < 0) {
+        return 0;
+    }
+
+    struct stat info;
+    if (fstat(diario->fd, &info) != 0) {
+        close(diario->fd);
+        return 0;
+    }
+
+    if (info.st_size == 0) {
+        CabecalhoDiario cabecalho;
+        memset(&cabecalho, 0, sizeof(cabecalho));
+        memcpy(cabecalho.magica, MAGICA_DIARIO, 8);
+        cabecalho.versao = VERSAO_DIARIO;
+        cabecalho.tamanhoEvento = sizeof(EventoBatalha);
+        cabecalho.numTerritorios = (uint64_t) jogo->numTerritorios;
+        cabecalho.assinaturaMapa = assinaturaMapa(jogo);
+        cabecalho.regra = (uint32_t) jogo->regra;
+        if (!escreverTudo(diario->fd, &cabecalho, sizeof(cabecalho))) {
+            close(diario->fd);
+            return 0;
+        }
+        return 1;
+    }
+
+    // Diário existente: confere o formato e a continuidade antes de seguir no final
+    CabecalhoDiario cabecalho;
+    if ((size_t) info.st_size < sizeof(cabecalho) ||
+        ((size_t) info.st_size - sizeof(cabecalho)) % sizeof(EventoBatalha) != 0 ||
+        pread(diario->fd, &cabecalho, sizeof(cabecalho), 0) != (ssize_t) sizeof(cabecalho) ||
+        memcmp(cabecalho.magica, MAGICA_DIARIO, 8) != 0 ||
+        cabecalho.versao != VERSAO_DIARIO ||
+        cabecalho.tamanhoEvento != sizeof(EventoBatalha) ||
+        cabecalho.regra != (uint32_t) jogo->regra ||
+        cabecalho.numTerritorios != (uint64_t) jogo->numTerritorios) {
+        close(diario->fd);
+        return 0;
+    }
+    diario->totalEventos = ((size_t) info.st_size - sizeof(cabecalho)) / sizeof(EventoBatalha);
+
+    int continua;
+    if (diario->totalEventos == 0) {
+        continua = cabecalho.assinaturaMapa == assinaturaMapa(jogo);
+    } else {
+        EventoBatalha ultimo;
+        continua = pread(diario->fd, &ultimo, sizeof(ultimo), info.st_size - (off_t) sizeof(ultimo)) ==
+                       (ssize_t) sizeof(ultimo) &&
+                   turno >= 0 && ultimo.turno < (uint32_t) turno;
+    }
+    if (!continua) {
+        close(diario->fd);
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * Função: descarregarDiario
+ * Escreve no arquivo os eventos pendentes (uma única escrita). Depois de
+ * um erro o diário não recebe mais nada: um evento pela metade ou uma
+ * lacuna estragaria a reprodução
+ * Retorna 1 em caso de sucesso, 0 se esta ou uma escrita anterior falhou
+ */
+static inline int descarregarDiario(DiarioBatalhas* diario) {
+    if (diario->falhou) {
+        return 0;
+    }
+    if (diario->numPendentes == 0) {
+        return 1;
+    }
+    int ok = escreverTudo(diario->fd, diario->pendentes,
+                          sizeof(EventoBatalha) * (size_t) diario->numPendentes);
+    diario->numPendentes = 0;
+    diario->falhou = !ok;
+    return ok;
+}
+
+/*
+ * Função: registrarBatalha
+ * Acrescenta uma batalha ao diário (gravada a cada EVENTOS_POR_ESCRITA
+ * eventos ou em descarregarDiario)
+ * Retorna 1 em caso de sucesso, 0 se o diário já falhou ou a escrita falhou
+ */
+static inline int registrarBatalha(DiarioBatalhas* diario, int turno, int atacante, int defensor,
+                                   const ResultadoBatalha* resultado) {
+    if (diario->falhou) {
+        return 0;
+    }
+    EventoBatalha* e = &diario->pendentes[diario->numPendentes++];
+    e->turno = (uint32_t) turno;
+    e->atacante = (uint32_t) atacante;
+    e->defensor = (uint32_t) defensor;
+    e->tropasMovidas = resultado->tropasMovidas;
+    memcpy(e->dadosAtacante, resultado->dadosAtacante, sizeof(e->dadosAtacante));
+    memcpy(e->dadosDefensor, resultado->dadosDefensor, sizeof(e->dadosDefensor));
+    e->conquistou = (uint8_t) resultado->conquistou;
+    e->perdasAtacante = resultado->perdasAtacante;
+    e->perdasDefensor = resultado->perdasDefensor;
+    e->relampago = (uint8_t) resultado->relampago;
+    e->reservado = 0;
+    diario->totalEventos++;
+
+    if (diario->numPendentes == EVENTOS_POR_ESCRITA) {
+        return descarregarDiario(diario);
+    }
+    return 1;
+}
+
+/*
+ * Função: fecharDiario
+ * Grava os eventos pendentes e fecha o arquivo
+ */
+static inline int fecharDiario(DiarioBatalhas* diario) {
+    int ok = descarregarDiario(diario);
+    if (close(diario->fd) != 0) {
+        ok = 0;
+    }
+    diario->fd = -1;
+    return ok;
+}
+
+// ==================== REPRODUÇÃO ====================
+
+/*
+ * Função: reproduzirEventos
+ * Reaplica os eventos no mapa até o turno "ateTurno" (inclusive) com a
+ * regra em que foram gravados, sem entrada/saída, e recalcula os
+ * agregados uma única vez no final (as colunas, se ativas, acompanham
+ * cada evento)
+ */
+static inline void reproduzirEventos(Jogo* jogo, const EventoBatalha* eventos, uint64_t total,
+                                     RegraBatalha regra, uint32_t ateTurno, ResumoReproducao* resumo) {
+    Territorio* mapa = jogo->mapa;
+    uint32_t quantidade = (uint32_t) jogo->numTerritorios;
+    memset(resumo, 0, sizeof(*resumo));
+
+    for (uint64_t i = 0; i < total; i++) {
+        const EventoBatalha* e = &eventos[i];
+        if (e->turno > ateTurno) {
+            break; // O diário está em ordem de turno
+        }
+        if (e->atacante >= quantidade || e->defensor >= quantidade || e->atacante == e->defensor) {
+            resumo->invalidos++;
+            continue;
+        }
+
+        ResultadoBatalha r;
+        if (e->relampago) {
+            // Ataque até o fim: o estado final sai das perdas gravadas
+            int atacanteFinal = mapa[e->atacante].tropas - e->perdasAtacante;
+            int defensorFinal = mapa[e->defensor].tropas - e->perdasDefensor;
+            if (atacanteFinal < 1 || defensorFinal < 0 || (atacanteFinal > 1 && defensorFinal > 0)) {
+                resumo->invalidos++;
+                continue;
+            }
+            aplicarRelampago(regra, &mapa[e->atacante], &mapa[e->defensor], atacanteFinal, defensorFinal, &r);
+        } else if (regra == REGRA_CLASSICA) {
+            aplicarCombate(&mapa[e->atacante], &mapa[e->defensor], e->dadosAtacante, e->dadosDefensor, &r);
+        } else {
+            aplicarDados(&mapa[e->atacante], &mapa[e->defensor], e->dadosAtacante[0], e->dadosDefensor[0], &r);
+        }
+        if (jogo->colunas.donos != NULL) {
+            atualizarColuna(&jogo->colunas, (int) e->atacante, mapa[e->atacante].cor, mapa[e->atacante].tropas);
+            atualizarColuna(&jogo->colunas, (int) e->defensor, mapa[e->defensor].cor, mapa[e->defensor].tropas);
+        }
+        if (r.conquistou != e->conquistou || r.tropasMovidas != e->tropasMovidas ||
+            r.perdasAtacante != e->perdasAtacante || r.perdasDefensor != e->perdasDefensor) {
+            resumo->divergentes++;
+        }
+        resumo->aplicados++;
+        resumo->ultimoTurno = e->turno;
+    }
+
+    recalcularAgregados(jogo);
+}
+
+/*
+ * Função: reproduzirDiario
+ * Mapeia o diário e reconstrói no "jogo" (que deve estar no mapa de
+ * partida do diário) o mapa ao final do turno "ateTurno"
+ * Retorna 1 em caso de sucesso, 0 se o arquivo for inválido e -1 se o
+ * mapa atual não for o mapa de partida do diário
+ */
+static inline int reproduzirDiario(const char* caminho, Jogo* jogo, uint32_t ateTurno,
+                                   ResumoReproducao* resumo) {
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(CabecalhoDiario)) {
+        close(fd);
+        return 0;
+    }
+
+    size_t tamanho = (size_t) info.st_size;
+    void* regiao = mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (regiao == MAP_FAILED) {
+        return 0;
+    }
+    madvise(regiao, tamanho, MADV_SEQUENTIAL);
+
+    const CabecalhoDiario* cabecalho = (const CabecalhoDiario*) regiao;
+    if (memcmp(cabecalho->magica, MAGICA_DIARIO, 8) != 0 ||
+        cabecalho->versao != VERSAO_DIARIO ||
+        cabecalho->tamanhoEvento != sizeof(EventoBatalha)) {
+        munmap(regiao, tamanho);
+        return 0;
+    }
+    if (cabecalho->numTerritorios != (uint64_t) jogo->numTerritorios ||
+        cabecalho->assinaturaMapa != assinaturaMapa(jogo)) {
+        munmap(regiao, tamanho);
+        return -1;
+    }
+
+    const EventoBatalha* eventos = (const EventoBatalha*) ((const char*) regiao + sizeof(CabecalhoDiario));
+    uint64_t total = (tamanho - sizeof(CabecalhoDiario)) / sizeof(EventoBatalha);
+    reproduzirEventos(jogo, eventos, total, (RegraBatalha) cabecalho->regra, ateTurno, resumo);
+
+    munmap(regiao, tamanho);
+    return 1;
+}
+
+#endif // WAR_DIARIO_H
@@ -0,0 +1,811 @@
+/*
+ * Motor de Batalhas do Sistema WAR
+ *
+ * Resolve ataques entre territórios sem nenhuma entrada/saída de terminal.
+ * Os programas interativos (war_intermediario.c e war_mestre.c) apenas
+ * coletam a escolha do jogador, chamam o motor e exibem o resultado, o que
+ * permite resolver batalhas em lote nas simulações.
+ */
+
+#ifndef WAR_ENGINE_H
+#define WAR_ENGINE_H
+
+#include <string.h>
+
+#include "war_agregados.h"  // Totais por cor atualizados a cada batalha
+#include "war_colunas.h"    // Cópia opcional do mapa em colunas (dono/tropas) e kernels SIMD
+#include "war_combate.h"    // Regra clássica (3 dados contra 2) e combates em lote
+#include "war_continentes.h" // Continentes e posse por cor em conjuntos de bits
+#include "war_cores.h"      // Cores internadas em IDs inteiros
+#include "war_dados.h"      // Gerador de dados explícito (um fluxo por partida/thread)
+#include "war_grafo.h"      // Fronteiras entre territórios (CSR)
+#include "war_jogadas.h"    // Territórios agrupados por dono e "pode atacar"
+#include "war_nomes.h"      // Pool de nomes e índice de nomes (hash e ordem alfabética)
+
+// Definição da estrutura Territorio
+// Agrupa informações relacionadas a um território em uma única unidade
+// (12 bytes: o nome fica no pool de nomes do mapa, sem limite de tamanho)
+typedef struct {
+    uint32_t nome;    // Deslocamento do nome no pool do mapa (ver nomeTerritorio())
+    int32_t tropas;   // Quantidade de tropas no território
+    IdCor cor;        // Cor do exército que controla o território (ID na TabelaCores)
+    uint8_t inicialB; // 1 se o nome começa com 'B' (os agregados não leem o nome)
+} Territorio;
+
+// Códigos devolvidos pelo motor ao validar/resolver um ataque
+typedef enum {
+    ATAQUE_OK = 0,
+    ATAQUE_INDICE_INVALIDO,       // Índice fora do mapa
+    ATAQUE_TROPAS_INSUFICIENTES,  // Atacante com menos de 2 tropas
+    ATAQUE_MESMO_TERRITORIO,      // Território atacando a si mesmo
+    ATAQUE_MESMA_COR,             // Atacante e defensor da mesma cor
+    ATAQUE_NAO_ADJACENTE          // Atacante e defensor não fazem fronteira
+} CodigoAtaque;
+
+// Par de índices (base 0) usado nas batalhas em lote
+typedef struct {
+    int atacante;
+    int defensor;
+} ParAtaque;
+
+// Resultado estruturado de uma batalha
+typedef struct {
+    CodigoAtaque codigo;     // ATAQUE_OK se a batalha aconteceu
+    int dadoAtacante;        // Maior dado do atacante (1 a 6)
+    int dadoDefensor;        // Maior dado do defensor (1 a 6)
+    int conquistou;          // 1 se o defensor foi conquistado
+    int tropasMovidas;       // Tropas transferidas na conquista
+    int perdasAtacante;      // Tropas perdidas pelo atacante
+    int perdasDefensor;      // Tropas perdidas pelo defensor (regra clássica)
+    int numDadosAtacante;    // Dados rolados por lado (1 na regra simples)
+    int numDadosDefensor;
+    uint8_t dadosAtacante[DADOS_ATAQUE];  // Dados em ordem decrescente (0 = não rolado)
+    uint8_t dadosDefensor[DADOS_DEFESA];
+    int relampago;           // 1 se foi um ataque até o fim sorteado de uma vez (sem dados)
+} ResultadoBatalha;
+
+// Estado completo de uma partida mantido pelo motor
+typedef struct {
+    Territorio* mapa;          // Vetor de territórios
+    int numTerritorios;        // Tamanho do mapa
+    TabelaCores cores;         // Cores internadas
+    GeradorDados dados;        // Fluxo de dados da partida
+    AgregadosMapa agregados;   // Totais por cor, atualizados a cada batalha
+    void* regiaoMapeada;       // Região do arquivo (mmap) que contém o mapa ou NULL
+    size_t tamanhoRegiao;      // Tamanho da região mapeada
+    int mapaExterno;           // 1 se o mapa foi reservado em uma arena (não é liberado)
+    GrafoAdjacencia grafo;     // Fronteiras do mapa (vazio = qualquer ataque é permitido)
+    BuscaGrafo busca;          // Rascunho das buscas no grafo (próprio de cada partida)
+    MapaColunar colunas;       // Dono/tropas em colunas (opcional, mantido pelo motor)
+    Continentes continentes;   // Continentes do mapa (vazio = nenhum; somente leitura)
+    PosseCores posse;          // Territórios de cada cor em bits (mantida pelo motor se houver continentes)
+    JogadasCores jogadas;      // Grupos do gerador de jogadas (opcional, mantidos pelo motor)
+    PoolNomes pool;            // Texto dos nomes do mapa (somente leitura; compartilhado entre cópias)
+    IndiceNomes nomes;         // Nome -> território e prefixos (vazio = busca percorre o mapa)
+    RegraBatalha regra;        // Regra de dados usada por batalharNoJogo()
+} Jogo;
+
+/*
+ * Função: inicializarJogo
+ * Deixa a partida sem mapa, com a tabela de cores vazia e o fluxo de
+ * dados da semente informada
+ */
+static inline void inicializarJogo(Jogo* jogo, uint64_t semente) {
+    memset(jogo, 0, sizeof(*jogo));
+    inicializarCores(&jogo->cores);
+    inicializarGerador(&jogo->dados, semente, 0);
+    inicializarGrafo(&jogo->grafo);
+    inicializarContinentes(&jogo->continentes);
+}
+
+// ==================== VALIDAÇÃO ====================
+
+/*
+ * Função: validarAtacante
+ * Verifica se um território pode iniciar um ataque
+ */
+static inline CodigoAtaque validarAtacante(const Territorio* mapa, int quantidade, int atacante) {
+    if (atacante < 0 || atacante >= quantidade) {
+        return ATAQUE_INDICE_INVALIDO;
+    }
+    if (mapa[atacante].tropas < 2) {
+        return ATAQUE_TROPAS_INSUFICIENTES;
+    }
+    return ATAQUE_OK;
+}
+
+/*
+ * Função: validarAtaque
+ * Verifica se o par atacante/defensor forma um ataque válido
+ */
+static inline CodigoAtaque validarAtaque(const Territorio* mapa, int quantidade, int atacante, int defensor) {
+    CodigoAtaque codigo = validarAtacante(mapa, quantidade, atacante);
+    if (codigo != ATAQUE_OK) {
+        return codigo;
+    }
+    if (defensor < 0 || defensor >= quantidade) {
+        return ATAQUE_INDICE_INVALIDO;
+    }
+    if (atacante == defensor) {
+        return ATAQUE_MESMO_TERRITORIO;
+    }
+    if (mapa[atacante].cor == mapa[defensor].cor) {
+        return ATAQUE_MESMA_COR;
+    }
+    return ATAQUE_OK;
+}
+
+/*
+ * Função: validarAtaqueNoJogo
+ * Versão de validarAtaque() que também exige fronteira entre os territórios
+ * (quando o mapa tem fronteiras cadastradas)
+ */
+static inline CodigoAtaque validarAtaqueNoJogo(const Jogo* jogo, int atacante, int defensor) {
+    CodigoAtaque codigo = validarAtaque(jogo->mapa, jogo->numTerritorios, atacante, defensor);
+    if (codigo != ATAQUE_OK) {
+        return codigo;
+    }
+    if (!saoAdjacentes(&jogo->grafo, atacante, defensor)) {
+        return ATAQUE_NAO_ADJACENTE;
+    }
+    return ATAQUE_OK;
+}
+
+// ==================== RESOLUÇÃO ====================
+
+/*
+ * Função: aplicarDados
+ * Aplica o resultado de uma rolagem já conhecida aos dois territórios
+ * Parâmetros:
+ *   - atacante/defensor: ponteiros para os territórios envolvidos
+ *   - dadoAtacante/dadoDefensor: valores dos dados (1 a 6)
+ *   - resultado: preenchido com o desfecho da batalha
+ */
+static inline void aplicarDados(Territorio* atacante, Territorio* defensor,
+                                int dadoAtacante, int dadoDefensor,
+                                ResultadoBatalha* resultado) {
+    memset(resultado, 0, sizeof(*resultado));
+    resultado->codigo = ATAQUE_OK;
+    resultado->dadoAtacante = dadoAtacante;
+    resultado->dadoDefensor = dadoDefensor;
+    resultado->numDadosAtacante = 1;
+    resultado->numDadosDefensor = 1;
+    resultado->dadosAtacante[0] = (uint8_t) dadoAtacante;
+    resultado->dadosDefensor[0] = (uint8_t) dadoDefensor;
+
+    if (dadoAtacante > dadoDefensor) {
+        // Transfere controle e metade das tropas do atacante
+        defensor->cor = atacante->cor;
+        int tropasTransferidas = atacante->tropas / 2;
+        if (tropasTransferidas < 1) tropasTransferidas = 1; // Mínimo de 1 tropa
+
+        defensor->tropas = tropasTransferidas;
+        atacante->tropas -= tropasTransferidas;
+
+        resultado->conquistou = 1;
+        resultado->tropasMovidas = tropasTransferidas;
+    } else if (atacante->tropas > 1) {
+        // O atacante perde uma tropa
+        atacante->tropas--;
+        resultado->perdasAtacante = 1;
+    }
+}
+
+/*
+ * Função: batalhar
+ * Rola os dados do fluxo "dados" e resolve uma batalha entre dois
+ * territórios, sem validar
+ */
+static inline void batalhar(Territorio* atacante, Territorio* defensor,
+                            GeradorDados* dados, ResultadoBatalha* resultado) {
+    int dadoAtacante = rolarDado(dados);
+    int dadoDefensor = rolarDado(dados);
+    aplicarDados(atacante, defensor, dadoAtacante, dadoDefensor, resultado);
+}
+
+/*
+ * Função: aplicarCombate
+ * Aplica um combate da regra clássica com dados já rolados e ordenados
+ * (0 = dado não rolado). Se o defensor fica sem tropas, o território é
+ * conquistado e recebe uma tropa por dado de ataque que sobreviveu
+ */
+static inline void aplicarCombate(Territorio* atacante, Territorio* defensor,
+                                  const uint8_t ataque[DADOS_ATAQUE], const uint8_t defesa[DADOS_DEFESA],
+                                  ResultadoBatalha* resultado) {
+    memset(resultado, 0, sizeof(*resultado));
+    resultado->codigo = ATAQUE_OK;
+    for (int i = 0; i < DADOS_ATAQUE; i++) {
+        resultado->dadosAtacante[i] = ataque[i];
+        resultado->numDadosAtacante += ataque[i] != 0;
+    }
+    for (int i = 0; i < DADOS_DEFESA; i++) {
+        resultado->dadosDefensor[i] = defesa[i];
+        resultado->numDadosDefensor += defesa[i] != 0;
+    }
+    resultado->dadoAtacante = ataque[0];
+    resultado->dadoDefensor = defesa[0];
+
+    compararDados(ataque, defesa, &resultado->perdasAtacante, &resultado->perdasDefensor);
+    atacante->tropas -= resultado->perdasAtacante;
+    defensor->tropas -= resultado->perdasDefensor;
+
+    if (defensor->tropas <= 0) {
+        // Sempre sobra ao menos um dado (cada tropa perdida pelo defensor é um par vencido)
+        int tropasTransferidas = resultado->numDadosAtacante - resultado->perdasAtacante;
+        if (tropasTransferidas > atacante->tropas - 1) tropasTransferidas = atacante->tropas - 1;
+        if (tropasTransferidas < 1) tropasTransferidas = 1;
+
+        defensor->cor = atacante->cor;
+        defensor->tropas = tropasTransferidas;
+        atacante->tropas -= tropasTransferidas;
+
+        resultado->conquistou = 1;
+        resultado->tropasMovidas = tropasTransferidas;
+    }
+}
+
+/*
+ * Função: batalharClassico
+ * Rola até 3 dados contra até 2 e resolve um combate da regra clássica,
+ * sem validar
+ */
+static inline void batalharClassico(Territorio* atacante, Territorio* defensor,
+                                    GeradorDados* dados, ResultadoBatalha* resultado) {
+    uint8_t ataque[DADOS_ATAQUE], defesa[DADOS_DEFESA];
+    rolarCombate(dados, dadosDoAtacante(atacante->tropas), dadosDoDefensor(defensor->tropas), ataque, defesa);
+    aplicarCombate(atacante, defensor, ataque, defesa, resultado);
+}
+
+/*
+ * Função: batalharPelaRegra
+ * Resolve uma batalha com a regra informada, sem validar
+ */
+static inline void batalharPelaRegra(RegraBatalha regra, Territorio* atacante, Territorio* defensor,
+                                     GeradorDados* dados, ResultadoBatalha* resultado) {
+    if (regra == REGRA_CLASSICA) {
+        batalharClassico(atacante, defensor, dados, resultado);
+    } else {
+        batalhar(atacante, defensor, dados, resultado);
+    }
+}
+
+/*
+ * Função: resolverBatalha
+ * Valida e resolve um ataque entre dois territórios do mapa (índices base 0)
+ * Retorna ATAQUE_OK se a batalha aconteceu ou o motivo da recusa
+ */
+static inline CodigoAtaque resolverBatalha(Territorio* mapa, int quantidade,
+                                           int atacante, int defensor,
+                                           GeradorDados* dados,
+                                           ResultadoBatalha* resultado) {
+    CodigoAtaque codigo = validarAtaque(mapa, quantidade, atacante, defensor);
+    if (codigo != ATAQUE_OK) {
+        memset(resultado, 0, sizeof(*resultado));
+        resultado->codigo = codigo;
+        return codigo;
+    }
+    batalhar(&mapa[atacante], &mapa[defensor], dados, resultado);
+    return ATAQUE_OK;
+}
+
+/*
+ * Função: resolverLote
+ * Resolve, em ordem, uma sequência de ataques sobre o mesmo mapa
+ * Parâmetros:
+ *   - pares: vetor com os pares atacante/defensor
+ *   - total: quantidade de pares
+ *   - dados: fluxo de dados usado por todas as batalhas do lote
+ *   - resultados: vetor (do mesmo tamanho) que recebe cada desfecho
+ * Retorna a quantidade de batalhas efetivamente realizadas
+ */
+static inline int resolverLote(Territorio* mapa, int quantidade,
+                               const ParAtaque* pares, int total,
+                               GeradorDados* dados, ResultadoBatalha* resultados) {
+    int realizadas = 0;
+    for (int i = 0; i < total; i++) {
+        if (resolverBatalha(mapa, quantidade, pares[i].atacante, pares[i].defensor,
+                            dados, &resultados[i]) == ATAQUE_OK) {
+            realizadas++;
+        }
+    }
+    return realizadas;
+}
+
+// ==================== PARTIDA COM AGREGADOS ====================
+
+/*
+ * Função: ativarColunas
+ * Cria a cópia do mapa em colunas, que passa a ser mantida pelo motor e
+ * usada nas varreduras de agregados (é a única passada pelos registros:
+ * daí em diante quem altera o mapa atualiza também as colunas)
+ * Retorna 1 em caso de sucesso, 0 se faltar memória
+ */
+static inline int ativarColunas(Jogo* jogo) {
+    liberarMapaColunar(&jogo->colunas);
+    if (!criarMapaColunar(&jogo->colunas, jogo->numTerritorios)) {
+        return 0;
+    }
+    for (int i = 0; i < jogo->numTerritorios; i++) {
+        atualizarColuna(&jogo->colunas, i, jogo->mapa[i].cor, jogo->mapa[i].tropas);
+        jogo->colunas.iniciaisB[i] = jogo->mapa[i].inicialB;
+    }
+    return 1;
+}
+
+/*
+ * Função: donoTerritorio
+ * Cor que controla o território, lida da coluna de donos se ativa
+ * (1 byte por território em vez do registro inteiro nas varreduras)
+ */
+static inline IdCor donoTerritorio(const Jogo* jogo, int territorio) {
+    return jogo->colunas.donos != NULL ? jogo->colunas.donos[territorio] : jogo->mapa[territorio].cor;
+}
+
+/*
+ * Função: montarPosse
+ * Refaz a posse por cor a partir do mapa (se estiver ativa)
+ */
+static inline void montarPosse(Jogo* jogo) {
+    if (jogo->posse.bits == NULL) {
+        return;
+    }
+    memset(jogo->posse.bits, 0, sizeof(uint64_t) * jogo->posse.linhas * jogo->posse.palavras);
+    for (int i = 0; i < jogo->numTerritorios; i++) {
+        if (jogo->mapa[i].cor < jogo->posse.linhas) {
+            marcarPosse(&jogo->posse, jogo->mapa[i].cor, i);
+        }
+    }
+}
+
+/*
+ * Função: ativarPosse
+ * Cria a posse por cor, que passa a ser mantida pelo motor a cada batalha
+ * (usada pelas missões de continentes)
+ * Retorna 1 em caso de sucesso, 0 se faltar memória
+ */
+static inline int ativarPosse(Jogo* jogo) {
+    liberarPosse(&jogo->posse);
+    if (!criarPosse(&jogo->posse, jogo->numTerritorios, jogo->cores.total)) {
+        return 0;
+    }
+    montarPosse(jogo);
+    return 1;
+}
+
+/*
+ * Função: podeAtacar
+ * Retorna 1 se o território tem 2+ tropas e (com fronteiras) algum vizinho de outra cor
+ */
+static inline int podeAtacar(const Jogo* jogo, int territorio) {
+    const Territorio* t = &jogo->mapa[territorio];
+    if (t->tropas < 2) {
+        return 0;
+    }
+    if (!grafoAtivo(&jogo->grafo)) {
+        return 1;
+    }
+    for (uint32_t k = jogo->grafo.inicio[territorio]; k < jogo->grafo.inicio[territorio + 1]; k++) {
+        if (jogo->mapa[jogo->grafo.vizinhos[k]].cor != t->cor) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Função: classificarJogada
+ * Coloca o território no grupo do seu dono e da sua situação atual
+ */
+static inline void classificarJogada(Jogo* jogo, int territorio) {
+    IdCor cor = jogo->mapa[territorio].cor;
+    int grupo = cor < MAX_CORES ? grupoJogadas(cor, podeAtacar(jogo, territorio)) : SEM_GRUPO;
+    moverParaGrupo(&jogo->jogadas, (uint32_t) territorio, grupo);
+}
+
+/*
+ * Função: montarJogadas
+ * Refaz os grupos do gerador de jogadas a partir do mapa (se estiverem ativos)
+ */
+static inline void montarJogadas(Jogo* jogo) {
+    if (jogo->jogadas.numTerritorios == 0) {
+        return;
+    }
+    esvaziarJogadas(&jogo->jogadas);
+    for (int i = jogo->numTerritorios - 1; i >= 0; i--) {
+        classificarJogada(jogo, i);   // Inseridos no início: as listas começam em ordem crescente
+    }
+}
+
+/*
+ * Função: ativarJogadas
+ * Cria os grupos do gerador de jogadas, que passam a ser mantidos pelo
+ * motor a cada batalha (usados pelo simulador e pelo comando "jogadas")
+ * Retorna 1 em caso de sucesso, 0 se faltar memória
+ */
+static inline int ativarJogadas(Jogo* jogo) {
+    liberarJogadas(&jogo->jogadas);
+    if (jogo->numTerritorios == 0) {
+        return 1;
+    }
+    if (!criarJogadas(&jogo->jogadas, jogo->numTerritorios)) {
+        return 0;
+    }
+    montarJogadas(jogo);
+    return 1;
+}
+
+/*
+ * Função: atualizarJogadas
+ * Reclassifica o que uma batalha pode ter mudado: atacante, defensor e,
+ * se o defensor trocou de dono, os vizinhos dele (cujos vizinhos inimigos mudaram)
+ */
+static inline void atualizarJogadas(Jogo* jogo, int atacante, int defensor) {
+    if (jogo->jogadas.numTerritorios == 0) {
+        return;
+    }
+    int grupoAnterior = jogo->jogadas.grupo[defensor];
+    int trocouDono = grupoAnterior == SEM_GRUPO || grupoAnterior / 2 != jogo->mapa[defensor].cor;
+
+    classificarJogada(jogo, atacante);
+    classificarJogada(jogo, defensor);
+    if (trocouDono && grafoAtivo(&jogo->grafo)) {
+        for (uint32_t k = jogo->grafo.inicio[defensor]; k < jogo->grafo.inicio[defensor + 1]; k++) {
+            classificarJogada(jogo, (int) jogo->grafo.vizinhos[k]);
+        }
+    }
+}
+
+/*
+ * Função: recalcularAgregados
+ * Reconstrói do zero os totais por cor (após o cadastro ou carga do mapa)
+ * Com as colunas ativas (já em dia com o mapa, ver ativarColunas()), os
+ * totais saem só delas: kernels vetoriais e a coluna de iniciais 'B'
+ * A posse por cor e os grupos de jogadas, se ativos, também são refeitos
+ */
+static inline void recalcularAgregados(Jogo* jogo) {
+    memset(&jogo->agregados, 0, sizeof(jogo->agregados));
+    montarPosse(jogo);
+    montarJogadas(jogo);
+
+    if (jogo->colunas.donos != NULL) {
+        ResumoCor resumos[MAX_CORES];
+        int iniciaisB[MAX_CORES];
+        resumirCores(&jogo->colunas, jogo->cores.total, resumos);
+        jogo->agregados.totalB = contarIniciaisB(&jogo->colunas, jogo->cores.total, iniciaisB);
+        for (int c = 0; c < jogo->cores.total; c++) {
+            AgregadoCor* a = &jogo->agregados.porCor[c];
+            a->territorios = resumos[c].territorios;
+            a->tropas = resumos[c].tropas;
+            a->tropasMaximas = resumos[c].tropasMaximas;
+            a->noMaximo = resumos[c].noMaximo;
+            a->territoriosB = iniciaisB[c];
+        }
+        return;
+    }
+
+    for (int i = 0; i < jogo->numTerritorios; i++) {
+        const Territorio* t = &jogo->mapa[i];
+        adicionarAoAgregado(&jogo->agregados, t->inicialB, t->cor, t->tropas);
+        if (t->inicialB) {
+            jogo->agregados.totalB++;
+        }
+    }
+}
+
+/*
+ * Função: tropasMaximasCor
+ * Retorna a maior tropa em um único território da cor
+ * Só percorre o mapa se o máximo ficou desatualizado desde a última consulta
+ */
+static inline int tropasMaximasCor(Jogo* jogo, IdCor cor) {
+    AgregadoCor* a = &jogo->agregados.porCor[cor];
+
+    if (a->maximoDesatualizado) {
+        if (jogo->colunas.donos != NULL) {
+            ResumoCor resumo;
+            resumirCor(&jogo->colunas, cor, &resumo);
+            a->tropasMaximas = resumo.tropasMaximas;
+            a->noMaximo = resumo.noMaximo;
+            a->maximoDesatualizado = 0;
+            return a->tropasMaximas;
+        }
+
+        a->tropasMaximas = 0;
+        a->noMaximo = 0;
+        for (int i = 0; i < jogo->numTerritorios; i++) {
+            if (jogo->mapa[i].cor != cor) continue;
+            if (jogo->mapa[i].tropas > a->tropasMaximas) {
+                a->tropasMaximas = jogo->mapa[i].tropas;
+                a->noMaximo = 1;
+            } else if (jogo->mapa[i].tropas == a->tropasMaximas) {
+                a->noMaximo++;
+            }
+        }
+        a->maximoDesatualizado = 0;
+    }
+    return a->tropasMaximas;
+}
+
+/*
+ * Função: retirarDaBatalha
+ * Tira atacante e defensor dos agregados (e o defensor da posse da sua
+ * cor) antes de a batalha alterá-los
+ */
+static inline void retirarDaBatalha(Jogo* jogo, int atacante, int defensor) {
+    const Territorio* a = &jogo->mapa[atacante];
+    const Territorio* d = &jogo->mapa[defensor];
+    removerDoAgregado(&jogo->agregados, a->inicialB, a->cor, a->tropas);
+    removerDoAgregado(&jogo->agregados, d->inicialB, d->cor, d->tropas);
+
+    if (jogo->posse.bits != NULL) {
+        desmarcarPosse(&jogo->posse, d->cor, defensor);  // Só o defensor muda de cor
+    }
+}
+
+/*
+ * Função: devolverDaBatalha
+ * Devolve atacante e defensor aos agregados (e às colunas, à posse e aos
+ * grupos de jogadas) após a batalha
+ */
+static inline void devolverDaBatalha(Jogo* jogo, int atacante, int defensor) {
+    const Territorio* a = &jogo->mapa[atacante];
+    const Territorio* d = &jogo->mapa[defensor];
+    adicionarAoAgregado(&jogo->agregados, a->inicialB, a->cor, a->tropas);
+    adicionarAoAgregado(&jogo->agregados, d->inicialB, d->cor, d->tropas);
+
+    if (jogo->colunas.donos != NULL) {
+        atualizarColuna(&jogo->colunas, atacante, a->cor, a->tropas);
+        atualizarColuna(&jogo->colunas, defensor, d->cor, d->tropas);
+    }
+    if (jogo->posse.bits != NULL) {
+        marcarPosse(&jogo->posse, d->cor, defensor);
+    }
+    atualizarJogadas(jogo, atacante, defensor);
+}
+
+/*
+ * Função: batalharNoJogo
+ * Resolve uma batalha já validada e atualiza os agregados das cores envolvidas
+ */
+static inline void batalharNoJogo(Jogo* jogo, int atacante, int defensor, ResultadoBatalha* resultado) {
+    retirarDaBatalha(jogo, atacante, defensor);
+    batalharPelaRegra(jogo->regra, &jogo->mapa[atacante], &jogo->mapa[defensor], &jogo->dados, resultado);
+    devolverDaBatalha(jogo, atacante, defensor);
+}
+
+/*
+ * Função: executarAtaque
+ * Valida e resolve um ataque da partida (índices base 0), mantendo os agregados
+ * Retorna ATAQUE_OK se a batalha aconteceu ou o motivo da recusa
+ */
+static inline CodigoAtaque executarAtaque(Jogo* jogo, int atacante, int defensor, ResultadoBatalha* resultado) {
+    CodigoAtaque codigo = validarAtaqueNoJogo(jogo, atacante, defensor);
+    if (codigo != ATAQUE_OK) {
+        memset(resultado, 0, sizeof(*resultado));
+        resultado->codigo = codigo;
+        return codigo;
+    }
+    batalharNoJogo(jogo, atacante, defensor, resultado);
+    return ATAQUE_OK;
+}
+
+/*
+ * Função: executarLote
+ * Versão de resolverLote() que mantém os agregados da partida
+ * Retorna a quantidade de batalhas efetivamente realizadas
+ */
+static inline int executarLote(Jogo* jogo, const ParAtaque* pares, int total, ResultadoBatalha* resultados) {
+    int realizadas = 0;
+    for (int i = 0; i < total; i++) {
+        if (executarAtaque(jogo, pares[i].atacante, pares[i].defensor, &resultados[i]) == ATAQUE_OK) {
+            realizadas++;
+        }
+    }
+    return realizadas;
+}
+
+// ==================== JOGADAS LEGAIS ====================
+
+// Percurso das jogadas legais de uma cor, sem alocação (ver proximaJogada())
+// Vale enquanto a partida não muda: uma batalha no meio do percurso o invalida
+typedef struct {
+    const Jogo* jogo;
+    IdCor cor;
+    uint32_t atacante;      // Atacante atual, no grupo da cor (FIM_GRUPO = acabou)
+    uint32_t vizinho;       // Com fronteiras: próxima posição em grafo.vizinhos
+    int grupoDefensor;      // Sem fronteiras: grupo dos defensores atuais
+    uint32_t defensor;      // Sem fronteiras: próximo defensor desse grupo
+} IteradorJogadas;
+
+/*
+ * Função: comecarAtacante
+ * Posiciona o percurso no primeiro defensor do atacante atual
+ */
+static inline void comecarAtacante(IteradorJogadas* it) {
+    it->vizinho = it->atacante != FIM_GRUPO && grafoAtivo(&it->jogo->grafo)
+                      ? it->jogo->grafo.inicio[it->atacante] : 0;
+    it->grupoDefensor = -1;
+    it->defensor = FIM_GRUPO;
+}
+
+/*
+ * Função: iniciarJogadas
+ * Prepara o percurso das jogadas legais da cor (os grupos de jogadas
+ * precisam estar ativos; sem eles o percurso é vazio)
+ */
+static inline void iniciarJogadas(IteradorJogadas* it, const Jogo* jogo, IdCor cor) {
+    it->jogo = jogo;
+    it->cor = cor;
+    it->atacante = jogo->jogadas.numTerritorios > 0 && cor < MAX_CORES
+                       ? jogo->jogadas.primeiro[grupoJogadas(cor, 1)] : FIM_GRUPO;
+    comecarAtacante(it);
+}
+
+/*
+ * Função: proximaJogada
+ * Entrega o próximo ataque legal da cor em "par" (índices base 0)
+ * Cada atacante do grupo da cor é visitado uma vez; com fronteiras, só
+ * os seus vizinhos são examinados, e sem fronteiras os defensores saem
+ * dos grupos das outras cores. O custo total é proporcional ao resultado
+ * Retorna 1 se entregou um ataque, 0 quando não há mais
+ */
+static inline int proximaJogada(IteradorJogadas* it, ParAtaque* par) {
+    const Jogo* jogo = it->jogo;
+    const JogadasCores* jogadas = &jogo->jogadas;
+    int ultimoGrupo = 2 * jogo->cores.total;   // Cores sem ID não têm territórios
+
+    while (it->atacante != FIM_GRUPO) {
+        uint32_t atacante = it->atacante;
+        if (grafoAtivo(&jogo->grafo)) {
+            uint32_t fim = jogo->grafo.inicio[atacante + 1];
+            while (it->vizinho < fim) {
+                uint32_t defensor = jogo->grafo.vizinhos[it->vizinho++];
+                if (jogo->mapa[defensor].cor != it->cor) {
+                    par->atacante = (int) atacante;
+                    par->defensor = (int) defensor;
+                    return 1;
+                }
+            }
+        } else {
+            for (;;) {
+                if (it->defensor != FIM_GRUPO) {
+                    par->atacante = (int) atacante;
+                    par->defensor = (int) it->defensor;
+                    it->defensor = jogadas->proximo[it->defensor];
+                    return 1;
+                }
+                do {
+                    it->grupoDefensor++;
+                } while (it->grupoDefensor < ultimoGrupo &&
+                         (it->grupoDefensor / 2 == it->cor || jogadas->primeiro[it->grupoDefensor] == FIM_GRUPO));
+                if (it->grupoDefensor >= ultimoGrupo) {
+                    break;
+                }
+                it->defensor = jogadas->primeiro[it->grupoDefensor];
+            }
+        }
+        it->atacante = jogadas->proximo[atacante];
+        comecarAtacante(it);
+    }
+    return 0;
+}
+
+/*
+ * Função: listarJogadas
+ * Escreve em "destino" até "capacidade" ataques legais da cor
+ * Retorna a quantidade escrita
+ */
+static inline size_t listarJogadas(const Jogo* jogo, IdCor cor, ParAtaque* destino, size_t capacidade) {
+    IteradorJogadas it;
+    size_t total = 0;
+    iniciarJogadas(&it, jogo, cor);
+    while (total < capacidade && proximaJogada(&it, &destino[total])) {
+        total++;
+    }
+    return total;
+}
+
+/*
+ * Função: contarJogadas
+ * Quantidade de ataques legais da cor (sem fronteiras, O(cores): atacantes
+ * vezes territórios das outras cores; com fronteiras, percorre as jogadas)
+ */
+static inline uint64_t contarJogadas(const Jogo* jogo, IdCor cor) {
+    if (jogo->jogadas.numTerritorios == 0 || cor >= MAX_CORES) {
+        return 0;
+    }
+    if (!grafoAtivo(&jogo->grafo)) {
+        uint64_t defensores = 0;
+        for (int g = 0; g < 2 * jogo->cores.total; g++) {
+            if (g / 2 != cor) {
+                defensores += jogo->jogadas.tamanho[g];
+            }
+        }
+        return (uint64_t) jogo->jogadas.tamanho[grupoJogadas(cor, 1)] * defensores;
+    }
+
+    IteradorJogadas it;
+    ParAtaque par;
+    uint64_t total = 0;
+    iniciarJogadas(&it, jogo, cor);
+    while (proximaJogada(&it, &par)) {
+        total++;
+    }
+    return total;
+}
+
+// ==================== NOMES ====================
+
+/*
+ * Função: nomeTerritorio
+ * Retorna o nome do território "i" (base 0), guardado no pool do mapa
+ */
+static inline const char* nomeTerritorio(const Jogo* jogo, int i) {
+    return nomeNoPool(&jogo->pool, jogo->mapa[i].nome);
+}
+
+/*
+ * Função: nomearTerritorio
+ * Dá ao território o nome que está no deslocamento do pool (e marca a inicial 'B')
+ */
+static inline void nomearTerritorio(Territorio* territorio, const PoolNomes* pool, uint32_t deslocamento) {
+    territorio->nome = deslocamento;
+    territorio->inicialB = (uint8_t) comecaComB(nomeNoPool(pool, deslocamento));
+}
+
+/*
+ * Função: fonteNomes
+ * Descreve para o índice onde estão os nomes do mapa atual
+ */
+static inline FonteNomes fonteNomes(const Jogo* jogo) {
+    FonteNomes fonte = { &jogo->pool, (const char*) &jogo->mapa[0].nome, sizeof(Territorio) };
+    return fonte;
+}
+
+/*
+ * Função: ativarIndiceNomes
+ * Monta o índice de nomes do mapa atual (os nomes não mudam na partida)
+ * Retorna 1 em caso de sucesso, 0 se faltar memória
+ */
+static inline int ativarIndiceNomes(Jogo* jogo) {
+    liberarIndiceNomes(&jogo->nomes);
+    if (jogo->numTerritorios == 0) {
+        return 1;
+    }
+    FonteNomes fonte = fonteNomes(jogo);
+    return construirIndiceNomes(&jogo->nomes, &fonte, jogo->numTerritorios);
+}
+
+/*
+ * Função: buscarTerritorioPorNome
+ * Retorna o território (base 0) com o nome, sem diferenciar maiúsculas, ou -1
+ * Com o índice, O(tamanho do nome); sem ele, percorre o mapa
+ */
+static inline int buscarTerritorioPorNome(const Jogo* jogo, const char* nome, size_t tamanho) {
+    if (jogo->nomes.numTerritorios == jogo->numTerritorios && jogo->numTerritorios > 0) {
+        FonteNomes fonte = fonteNomes(jogo);
+        return buscarNomeIndice(&jogo->nomes, &fonte, nome, tamanho);
+    }
+    for (int i = 0; i < jogo->numTerritorios; i++) {
+        if (nomeIgual(nomeTerritorio(jogo, i), nome, tamanho)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Função: faixaPrefixo
+ * Encontra em jogo->nomes.ordem a faixa [inicio, fim) dos territórios cujo
+ * nome começa com o prefixo
+ * Retorna a quantidade de territórios da faixa ou -1 se o índice não foi montado
+ */
+static inline int faixaPrefixo(const Jogo* jogo, const char* prefixo, size_t tamanho, int* inicio, int* fim) {
+    if (jogo->nomes.numTerritorios != jogo->numTerritorios || jogo->numTerritorios == 0) {
+        return -1;
+    }
+    FonteNomes fonte = fonteNomes(jogo);
+    return faixaPrefixoIndice(&jogo->nomes, &fonte, prefixo, tamanho, inicio, fim);
+}
+
+#endif // WAR_ENGINE_H
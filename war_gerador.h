@@ -0,0 +1,486 @@
+/*
+ * Gerador de Mapas do Sistema WAR
+ *
+ * Cria um mapa de N territórios a partir da semente da partida, direto na
+ * memória (sem arquivo intermediário): regiões com fronteiras, nomes,
+ * continentes e a distribuição inicial de donos e tropas.
+ *
+ * Regiões: um ponto é sorteado dentro de cada célula de uma grade
+ * (afastado das bordas) e cada território é a região de Voronoi do seu
+ * ponto. Com os pontos assim espalhados, as fronteiras são aproximadas
+ * pela triangulação de Delaunay: as quatro vizinhas da grade e, em cada
+ * quadrado de quatro pontos, a mais curta das duas diagonais (grau de 4 a
+ * 8, média 6). As coordenadas são inteiras (ESCALA_GERADOR subdivisões
+ * por célula), então as comparações de distância são exatas.
+ *
+ * Os territórios são numerados linha a linha da grade, de modo que os
+ * vizinhos de cada um já saem em ordem crescente e o CSR é escrito
+ * direto, sem ordenar. Cada linha é uma tarefa do pool de threads e
+ * sorteia com o seu próprio fluxo de dados (derivado da semente); o que
+ * depende de outras linhas (fronteiras, continentes) é função só dos
+ * pontos já sorteados. O mapa sai idêntico com qualquer número de threads.
+ *
+ * Nomes e donos vêm de permutações embaralhadas (bijeções) do número do
+ * território: os nomes (sílabas consoante-vogal, 5 bits por sílaba) são
+ * distintos sem busca por repetidos e são escritos em paralelo no pool, e
+ * as cores recebem os territórios como cartas de um baralho (N/P cada,
+ * com diferença de no máximo 1).
+ */
+
+#ifndef WAR_GERADOR_H
+#define WAR_GERADOR_H
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "war_engine.h"
+#include "war_tarefas.h"
+
+// Fluxos de dados do gerador: FLUXO_MAPA_GERADO (parâmetros) e
+// FLUXO_MAPA_GERADO | (linha + 1); não se misturam com os das partidas
+#define FLUXO_MAPA_GERADO (1ULL << 62)
+
+#define ESCALA_GERADOR 1024            // Subdivisões de uma célula da grade
+#define MARGEM_GERADOR 102             // Distância mínima do ponto à borda da célula
+#define TERRITORIOS_POR_CONTINENTE 7   // Tamanho médio dos continentes (até MAX_CONTINENTES)
+#define TROPAS_GERADAS 5               // Tropas iniciais: 1 a TROPAS_GERADAS por território
+#define SILABAS_CONTINENTE 3           // Nomes dos continentes (32^3 nomes distintos)
+
+// Sílabas dos nomes: 8 consoantes × 4 vogais (1 em 8 nomes começa com 'B')
+static const char CONSOANTES_GERADOR[8] = {'b', 'd', 'l', 'm', 'n', 'r', 's', 't'};
+static const char VOGAIS_GERADOR[4] = {'a', 'e', 'i', 'o'};
+
+// Cores dos jogadores dos mapas gerados (as demais são "cor 7", "cor 8", ...)
+#define CORES_GERADOR 6
+static const char* const NOMES_CORES_GERADOR[CORES_GERADOR] = {
+    "azul", "vermelha", "verde", "amarela", "preta", "branca"
+};
+
+// Bijeção sobre [0, 2^bits): afim, xorshift, produto ímpar, xorshift
+typedef struct {
+    uint64_t mascara;           // 2^bits - 1
+    uint64_t soma;
+    uint64_t fator1;            // Ímpares (invertíveis módulo 2^bits)
+    uint64_t fator2;
+    int deslocamento;           // Deslocamento dos xorshifts
+} Embaralhamento;
+
+// Estado compartilhado pelas tarefas (uma por linha da grade)
+typedef struct {
+    Jogo* jogo;
+    Territorio* mapa;
+    int numTerritorios;
+    int largura;                // Células por linha da grade
+    int linhas;                 // Linhas da grade (a última pode estar incompleta)
+    int32_t* pontoX;            // Ponto sorteado de cada território
+    int32_t* pontoY;
+    uint32_t* inicio;           // Graus e depois o início de cada faixa do CSR
+    uint32_t* vizinhos;
+    uint8_t* continente;        // Continente de cada território
+    int numContinentes;
+    int32_t centroX[MAX_CONTINENTES];   // Pontos dos territórios sorteados como centros
+    int32_t centroY[MAX_CONTINENTES];
+    char* texto;                // Texto do pool (nomes em posições fixas)
+    uint32_t primeiroNome;      // Deslocamento do nome do território 0
+    int silabas;                // Sílabas de cada nome
+    Embaralhamento nomes;
+    Embaralhamento donos;
+    IdCor cores[MAX_CORES];     // Cores dos jogadores
+    int numCores;
+} GeracaoMapa;
+
+// ==================== PERMUTAÇÕES ====================
+
+/*
+ * Função: iniciarEmbaralhamento
+ * Sorteia uma bijeção sobre [0, 2^bits) (1 <= bits <= 64)
+ */
+static inline void iniciarEmbaralhamento(Embaralhamento* e, int bits, GeradorDados* dados) {
+    e->mascara = bits >= 64 ? UINT64_MAX : (1ULL << bits) - 1;
+    e->soma = ((uint64_t) proximoU32(dados) << 32) | proximoU32(dados);
+    e->fator1 = ((uint64_t) proximoU32(dados) << 32) | proximoU32(dados) | 1;
+    e->fator2 = ((uint64_t) proximoU32(dados) << 32) | proximoU32(dados) | 1;
+    e->deslocamento = bits / 2 + 1;
+}
+
+/*
+ * Função: embaralhar
+ * Aplica a bijeção a um valor de [0, 2^bits)
+ */
+static inline uint64_t embaralhar(const Embaralhamento* e, uint64_t valor) {
+    valor = (valor * e->fator1 + e->soma) & e->mascara;
+    valor ^= valor >> e->deslocamento;
+    valor = (valor * e->fator2) & e->mascara;
+    valor ^= valor >> e->deslocamento;
+    return valor;
+}
+
+/*
+ * Função: embaralharFaixa
+ * Bijeção sobre [0, limite) (limite <= 2^bits): reaplica a permutação até
+ * o valor cair na faixa (o ciclo que passa por "valor" sempre volta a ela)
+ */
+static inline uint64_t embaralharFaixa(const Embaralhamento* e, uint64_t valor, uint64_t limite) {
+    do {
+        valor = embaralhar(e, valor);
+    } while (valor >= limite);
+    return valor;
+}
+
+/*
+ * Função: bitsPara
+ * Menor quantidade de bits (no mínimo 1) que representa os valores de [0, quantidade)
+ */
+static inline int bitsPara(uint64_t quantidade) {
+    int bits = 1;
+    while (bits < 64 && (1ULL << bits) < quantidade) {
+        bits++;
+    }
+    return bits;
+}
+
+/*
+ * Função: escreverNomeGerado
+ * Escreve o nome de "silabas" sílabas (5 bits cada) do código, com a
+ * inicial maiúscula e terminado em '\0' (2 * silabas + 1 bytes)
+ */
+static inline void escreverNomeGerado(char* destino, uint64_t codigo, int silabas) {
+    for (int s = 0; s < silabas; s++) {
+        unsigned silaba = (unsigned) (codigo >> (5 * (silabas - 1 - s))) & 31;
+        destino[2 * s] = CONSOANTES_GERADOR[silaba >> 2];
+        destino[2 * s + 1] = VOGAIS_GERADOR[silaba & 3];
+    }
+    destino[0] = (char) toupper((unsigned char) destino[0]);
+    destino[2 * silabas] = '\0';
+}
+
+// ==================== GRADE ====================
+
+/*
+ * Função: celulaGerada
+ * Retorna o território da célula (x, y) da grade ou -1 se ela não existe
+ */
+static inline int celulaGerada(const GeracaoMapa* ctx, int x, int y) {
+    if (x < 0 || y < 0 || x >= ctx->largura || y >= ctx->linhas) {
+        return -1;
+    }
+    long long indice = (long long) y * ctx->largura + x;
+    return indice < ctx->numTerritorios ? (int) indice : -1;
+}
+
+/*
+ * Função: distanciaGerada
+ * Quadrado da distância entre os pontos de dois territórios
+ */
+static inline int64_t distanciaGerada(const GeracaoMapa* ctx, int a, int b) {
+    int64_t dx = (int64_t) ctx->pontoX[a] - ctx->pontoX[b];
+    int64_t dy = (int64_t) ctx->pontoY[a] - ctx->pontoY[b];
+    return dx * dx + dy * dy;
+}
+
+/*
+ * Função: diagonalGerada
+ * Diagonal do quadrado de cantos a = (x, y), b = (x + 1, y), c = (x, y + 1)
+ * e d = (x + 1, y + 1) que vira fronteira: 1 = a-d, 2 = b-c, 0 = nenhuma
+ * (com os quatro cantos, a mais curta; sem "d", o triângulo a-b-c fecha com b-c)
+ */
+static inline int diagonalGerada(const GeracaoMapa* ctx, int x, int y) {
+    int a = celulaGerada(ctx, x, y);
+    int b = celulaGerada(ctx, x + 1, y);
+    int c = celulaGerada(ctx, x, y + 1);
+    int d = celulaGerada(ctx, x + 1, y + 1);
+    if (a < 0 || b < 0 || c < 0) {
+        return 0;
+    }
+    if (d < 0) {
+        return 2;
+    }
+    return distanciaGerada(ctx, a, d) <= distanciaGerada(ctx, b, c) ? 1 : 2;
+}
+
+/*
+ * Função: vizinhosGerados
+ * Escreve em "saida" (até 8) os vizinhos do território, em ordem crescente
+ * Retorna a quantidade de vizinhos
+ */
+static inline int vizinhosGerados(const GeracaoMapa* ctx, int territorio, uint32_t saida[8]) {
+    int x = territorio % ctx->largura;
+    int y = territorio / ctx->largura;
+    int total = 0;
+    int v;
+
+    // Linha de cima, a própria linha e a de baixo (numeração crescente)
+    if ((v = celulaGerada(ctx, x - 1, y - 1)) >= 0 && diagonalGerada(ctx, x - 1, y - 1) == 1) saida[total++] = (uint32_t) v;
+    if ((v = celulaGerada(ctx, x, y - 1)) >= 0) saida[total++] = (uint32_t) v;
+    if ((v = celulaGerada(ctx, x + 1, y - 1)) >= 0 && diagonalGerada(ctx, x, y - 1) == 2) saida[total++] = (uint32_t) v;
+    if ((v = celulaGerada(ctx, x - 1, y)) >= 0) saida[total++] = (uint32_t) v;
+    if ((v = celulaGerada(ctx, x + 1, y)) >= 0) saida[total++] = (uint32_t) v;
+    if ((v = celulaGerada(ctx, x - 1, y + 1)) >= 0 && diagonalGerada(ctx, x - 1, y) == 2) saida[total++] = (uint32_t) v;
+    if ((v = celulaGerada(ctx, x, y + 1)) >= 0) saida[total++] = (uint32_t) v;
+    if ((v = celulaGerada(ctx, x + 1, y + 1)) >= 0 && diagonalGerada(ctx, x, y) == 1) saida[total++] = (uint32_t) v;
+    return total;
+}
+
+// ==================== TAREFAS (UMA POR LINHA) ====================
+
+/*
+ * Função: tarefaTerritorios
+ * Sorteia ponto e tropas e escreve nome e dono de cada território da linha
+ */
+static inline void tarefaTerritorios(void* contexto, int trabalhador, uint32_t linha) {
+    (void) trabalhador;
+    GeracaoMapa* ctx = (GeracaoMapa*) contexto;
+    GeradorDados dados;
+    derivarGerador(&dados, &ctx->jogo->dados, FLUXO_MAPA_GERADO | ((uint64_t) linha + 1));
+
+    size_t tamanhoNome = 2 * (size_t) ctx->silabas + 1;
+    for (int x = 0; x < ctx->largura; x++) {
+        int i = celulaGerada(ctx, x, (int) linha);
+        if (i < 0) {
+            break;
+        }
+        ctx->pontoX[i] = x * ESCALA_GERADOR + MARGEM_GERADOR +
+                         (int32_t) sortearIntervalo(&dados, ESCALA_GERADOR - 2 * MARGEM_GERADOR);
+        ctx->pontoY[i] = (int32_t) linha * ESCALA_GERADOR + MARGEM_GERADOR +
+                         (int32_t) sortearIntervalo(&dados, ESCALA_GERADOR - 2 * MARGEM_GERADOR);
+
+        uint32_t deslocamento = ctx->primeiroNome + (uint32_t) (i * tamanhoNome);
+        escreverNomeGerado(ctx->texto + deslocamento, embaralhar(&ctx->nomes, (uint64_t) i), ctx->silabas);
+
+        Territorio* t = &ctx->mapa[i];
+        t->nome = deslocamento;
+        t->inicialB = (uint8_t) comecaComB(ctx->texto + deslocamento);
+        t->cor = ctx->cores[embaralharFaixa(&ctx->donos, (uint64_t) i, (uint64_t) ctx->numTerritorios) % ctx->numCores];
+        t->tropas = 1 + (int32_t) sortearIntervalo(&dados, TROPAS_GERADAS);
+    }
+}
+
+/*
+ * Função: tarefaGraus
+ * Conta os vizinhos e escolhe o continente (centro mais próximo) de cada
+ * território da linha
+ */
+static inline void tarefaGraus(void* contexto, int trabalhador, uint32_t linha) {
+    (void) trabalhador;
+    GeracaoMapa* ctx = (GeracaoMapa*) contexto;
+    uint32_t vizinhos[8];
+
+    for (int x = 0; x < ctx->largura; x++) {
+        int i = celulaGerada(ctx, x, (int) linha);
+        if (i < 0) {
+            break;
+        }
+        ctx->inicio[i + 1] = (uint32_t) vizinhosGerados(ctx, i, vizinhos);
+
+        int melhor = 0;
+        int64_t menorDistancia = INT64_MAX;
+        for (int c = 0; c < ctx->numContinentes; c++) {
+            int64_t dx = (int64_t) ctx->pontoX[i] - ctx->centroX[c];
+            int64_t dy = (int64_t) ctx->pontoY[i] - ctx->centroY[c];
+            if (dx * dx + dy * dy < menorDistancia) {
+                menorDistancia = dx * dx + dy * dy;
+                melhor = c;
+            }
+        }
+        ctx->continente[i] = (uint8_t) melhor;
+    }
+}
+
+/*
+ * Função: tarefaFronteiras
+ * Escreve os vizinhos de cada território da linha na sua faixa do CSR
+ */
+static inline void tarefaFronteiras(void* contexto, int trabalhador, uint32_t linha) {
+    (void) trabalhador;
+    GeracaoMapa* ctx = (GeracaoMapa*) contexto;
+
+    for (int x = 0; x < ctx->largura; x++) {
+        int i = celulaGerada(ctx, x, (int) linha);
+        if (i < 0) {
+            break;
+        }
+        vizinhosGerados(ctx, i, ctx->vizinhos + ctx->inicio[i]);
+    }
+}
+
+// ==================== GERAÇÃO ====================
+
+/*
+ * Função: gerarMapa
+ * Monta em "jogo" um mapa de "quantidade" territórios gerado a partir da
+ * semente do fluxo de dados do jogo (o fluxo da partida não é consumido),
+ * com fronteiras, continentes (com a posse ativa) e os territórios
+ * repartidos entre "numJogadores" cores
+ * Parâmetros:
+ *   - threads: threads a usar (<= 0 usa todos os núcleos; não muda o mapa)
+ * Retorna 1 em caso de sucesso, 0 se faltar memória ou os tamanhos forem inválidos
+ */
+static inline int gerarMapa(Jogo* jogo, int quantidade, int numJogadores, int threads) {
+    if (quantidade <= 0 || numJogadores <= 0 || numJogadores > MAX_CORES - jogo->cores.total) {
+        return 0;
+    }
+
+    GeracaoMapa ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.jogo = jogo;
+    ctx.numTerritorios = quantidade;
+    ctx.largura = 1;
+    while ((long long) ctx.largura * ctx.largura < quantidade) {
+        ctx.largura++;
+    }
+    ctx.linhas = (int) (((long long) quantidade + ctx.largura - 1) / ctx.largura);
+
+    // Sílabas suficientes para nomes distintos (32 por sílaba, no mínimo 2)
+    ctx.silabas = 2;
+    while ((1ULL << (5 * ctx.silabas)) < (uint64_t) quantidade) {
+        ctx.silabas++;
+    }
+    size_t tamanhoNomes = (size_t) quantidade * (2 * (size_t) ctx.silabas + 1);
+
+    // Parâmetros sorteados de uma vez: permutações, centros e nomes dos continentes
+    GeradorDados dados;
+    derivarGerador(&dados, &jogo->dados, FLUXO_MAPA_GERADO);
+    iniciarEmbaralhamento(&ctx.nomes, 5 * ctx.silabas, &dados);
+    iniciarEmbaralhamento(&ctx.donos, bitsPara((uint64_t) quantidade), &dados);
+
+    for (int c = 0; c < numJogadores; c++) {
+        char nome[TAM_COR];
+        if (c < CORES_GERADOR) {
+            snprintf(nome, sizeof(nome), "%s", NOMES_CORES_GERADOR[c]);
+        } else {
+            // c < MAX_CORES (conferido acima): o byte deixa a faixa visível ao compilador
+            snprintf(nome, sizeof(nome), "cor %u", (unsigned) (uint8_t) (c + 1));
+        }
+        ctx.cores[c] = internarCor(&jogo->cores, nome);
+        if (ctx.cores[c] == COR_INVALIDA) {
+            return 0;
+        }
+    }
+    ctx.numCores = numJogadores;
+
+    int tarefas = ctx.linhas;
+    uint32_t* bloco = NULL;
+    MembroContinente* membros = NULL;
+    PoolNomes pool;
+    memset(&pool, 0, sizeof(pool));
+    ctx.mapa = (Territorio*) malloc(sizeof(Territorio) * (size_t) quantidade);
+    ctx.pontoX = (int32_t*) malloc(sizeof(int32_t) * (size_t) quantidade);
+    ctx.pontoY = (int32_t*) malloc(sizeof(int32_t) * (size_t) quantidade);
+    ctx.continente = (uint8_t*) malloc((size_t) quantidade);
+    bloco = (uint32_t*) malloc(sizeof(uint32_t) * ((size_t) quantidade + 1));
+    if (ctx.mapa == NULL || ctx.pontoX == NULL || ctx.pontoY == NULL || ctx.continente == NULL ||
+        bloco == NULL || !iniciarPool(&pool, 1 + tamanhoNomes) ||
+        (ctx.primeiroNome = reservarTextoPool(&pool, tamanhoNomes)) == POOL_ERRO) {
+        goto falha;
+    }
+    ctx.texto = (char*) pool.memoria;
+    ctx.inicio = bloco;
+
+    // 1. Pontos, nomes, donos e tropas
+    if (executarEmParalelo((uint32_t) tarefas, threads, tarefaTerritorios, &ctx) < 0) {
+        goto falha;
+    }
+
+    // Centros dos continentes: territórios distintos sorteados
+    ctx.numContinentes = quantidade / TERRITORIOS_POR_CONTINENTE;
+    if (ctx.numContinentes < 1) ctx.numContinentes = 1;
+    if (ctx.numContinentes > MAX_CONTINENTES) ctx.numContinentes = MAX_CONTINENTES;
+    int centros[MAX_CONTINENTES];
+    for (int c = 0; c < ctx.numContinentes; c++) {
+        int repetido;
+        do {
+            centros[c] = (int) sortearIntervalo(&dados, (uint32_t) quantidade);
+            repetido = 0;
+            for (int k = 0; k < c; k++) {
+                repetido |= centros[k] == centros[c];
+            }
+        } while (repetido);
+        ctx.centroX[c] = ctx.pontoX[centros[c]];
+        ctx.centroY[c] = ctx.pontoY[centros[c]];
+    }
+
+    // 2. Graus e continentes; as faixas do CSR saem da soma acumulada dos graus
+    if (executarEmParalelo((uint32_t) tarefas, threads, tarefaGraus, &ctx) < 0) {
+        goto falha;
+    }
+    uint64_t totalVizinhos = 0;
+    bloco[0] = 0;
+    for (int i = 0; i < quantidade; i++) {
+        totalVizinhos += bloco[i + 1];
+        if (totalVizinhos > UINT32_MAX) {
+            goto falha;
+        }
+        bloco[i + 1] = (uint32_t) totalVizinhos;
+    }
+    uint32_t* crescido = (uint32_t*) realloc(bloco, sizeof(uint32_t) * ((size_t) quantidade + 1 + totalVizinhos));
+    if (crescido == NULL) {
+        goto falha;
+    }
+    bloco = crescido;
+    ctx.inicio = bloco;
+    ctx.vizinhos = bloco + quantidade + 1;
+
+    // 3. Fronteiras
+    if (executarEmParalelo((uint32_t) tarefas, threads, tarefaFronteiras, &ctx) < 0) {
+        goto falha;
+    }
+
+    // Continentes a partir da escolha de cada território
+    membros = (MembroContinente*) malloc(sizeof(MembroContinente) * (size_t) quantidade);
+    if (membros == NULL) {
+        goto falha;
+    }
+    for (int i = 0; i < quantidade; i++) {
+        membros[i].continente = ctx.continente[i];
+        membros[i].territorio = (uint32_t) i;
+    }
+    Embaralhamento nomesContinentes;
+    iniciarEmbaralhamento(&nomesContinentes, 5 * SILABAS_CONTINENTE, &dados);
+    char nomes[MAX_CONTINENTES][TAM_CONTINENTE];
+    for (int c = 0; c < ctx.numContinentes; c++) {
+        escreverNomeGerado(nomes[c], embaralhar(&nomesContinentes, (uint64_t) c), SILABAS_CONTINENTE);
+    }
+    Continentes continentes;
+    if (!construirContinentes(&continentes, quantidade, (const char (*)[TAM_CONTINENTE]) nomes,
+                              ctx.numContinentes, membros, (size_t) quantidade)) {
+        goto falha;
+    }
+    free(membros);
+    free(ctx.pontoX);
+    free(ctx.pontoY);
+    free(ctx.continente);
+
+    encerrarPool(&pool);
+    jogo->mapa = ctx.mapa;
+    jogo->numTerritorios = quantidade;
+    jogo->pool = pool;
+    jogo->regiaoMapeada = NULL;
+    jogo->tamanhoRegiao = 0;
+    jogo->mapaExterno = 0;
+    jogo->grafo.numTerritorios = quantidade;
+    jogo->grafo.numVizinhos = (uint32_t) totalVizinhos;
+    jogo->grafo.inicio = ctx.inicio;
+    jogo->grafo.vizinhos = ctx.vizinhos;
+    jogo->grafo.memoria = bloco;
+    jogo->continentes = continentes;
+    if (!ativarPosse(jogo)) {
+        return 0;   // O mapa fica na partida e é liberado com ela
+    }
+    recalcularAgregados(jogo);
+    return 1;
+
+falha:
+    liberarPool(&pool);
+    free(membros);
+    free(bloco);
+    free(ctx.mapa);
+    free(ctx.pontoX);
+    free(ctx.pontoY);
+    free(ctx.continente);
+    return 0;
+}
+
+#endif // WAR_GERADOR_H
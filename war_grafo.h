@@ -0,0 +1,250 @@
+/*
+ * Grafo de Adjacência do Sistema WAR
+ *
+ * Guarda as fronteiras entre territórios em formato CSR (compressed sparse
+ * row): os vizinhos de cada território ficam contíguos em um único vetor,
+ * em ordem crescente, e "inicio[i]" aponta para o primeiro deles. O grafo
+ * ocupa O(territórios + fronteiras) em vez de uma matriz N×N, e verificar
+ * uma fronteira percorre apenas os vizinhos do atacante.
+ *
+ * Um grafo vazio (numTerritorios = 0) significa "mapa sem fronteiras
+ * cadastradas": qualquer território pode atacar qualquer outro, como nas
+ * versões anteriores do jogo.
+ */
+
+#ifndef WAR_GRAFO_H
+#define WAR_GRAFO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    int numTerritorios;         // Territórios do grafo (0 = sem fronteiras)
+    uint32_t numVizinhos;       // Entradas em "vizinhos" (cada fronteira aparece 2 vezes)
+    const uint32_t* inicio;     // Vizinhos de i: vizinhos[inicio[i] .. inicio[i + 1])
+    const uint32_t* vizinhos;
+    void* memoria;              // Bloco alocado por construirGrafo (NULL se mapeado de arquivo)
+} GrafoAdjacencia;
+
+// Fronteira entre dois territórios (índices base 0)
+typedef struct {
+    uint32_t origem;
+    uint32_t destino;
+} Fronteira;
+
+// Rascunho das buscas no grafo (um por partida/thread)
+typedef struct {
+    uint32_t* marcas;           // marcas[i] == epoca: território já visitado nesta busca
+    uint32_t* pilha;
+    uint32_t epoca;
+    int capacidade;
+} BuscaGrafo;
+
+/*
+ * Função: inicializarGrafo
+ * Deixa o grafo vazio (sem fronteiras cadastradas)
+ */
+static inline void inicializarGrafo(GrafoAdjacencia* grafo) {
+    memset(grafo, 0, sizeof(*grafo));
+}
+
+/*
+ * Função: grafoAtivo
+ * Retorna 1 se o mapa tem fronteiras cadastradas
+ */
+static inline int grafoAtivo(const GrafoAdjacencia* grafo) {
+    return grafo->numTerritorios > 0;
+}
+
+/*
+ * Função: grauTerritorio
+ * Retorna a quantidade de vizinhos de um território
+ */
+static inline uint32_t grauTerritorio(const GrafoAdjacencia* grafo, int territorio) {
+    return grafo->inicio[territorio + 1] - grafo->inicio[territorio];
+}
+
+/*
+ * Função: saoAdjacentes
+ * Retorna 1 se "a" e "b" fazem fronteira (ou se o mapa não tem fronteiras)
+ * Percorre os vizinhos de "a": O(grau)
+ */
+static inline int saoAdjacentes(const GrafoAdjacencia* grafo, int a, int b) {
+    if (!grafoAtivo(grafo)) {
+        return 1;
+    }
+    const uint32_t* v = grafo->vizinhos + grafo->inicio[a];
+    const uint32_t* fim = grafo->vizinhos + grafo->inicio[a + 1];
+    for (; v < fim && *v <= (uint32_t) b; v++) {
+        if (*v == (uint32_t) b) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Função: compararVizinhos
+ * Ordem crescente para qsort
+ */
+static inline int compararVizinhos(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*) a;
+    uint32_t y = *(const uint32_t*) b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Função: construirGrafo
+ * Monta o CSR a partir de uma lista de fronteiras (em qualquer ordem, nos
+ * dois sentidos ou não); fronteiras repetidas e laços são descartados
+ * Retorna 1 em caso de sucesso, 0 se faltar memória ou houver índice inválido
+ */
+static inline int construirGrafo(GrafoAdjacencia* grafo, int numTerritorios,
+                                 const Fronteira* fronteiras, size_t numFronteiras) {
+    size_t tamanhoInicio = sizeof(uint32_t) * ((size_t) numTerritorios + 1);
+    uint32_t* bloco = (uint32_t*) calloc(1, tamanhoInicio + sizeof(uint32_t) * 2 * numFronteiras);
+    if (bloco == NULL) {
+        return 0;
+    }
+    uint32_t* inicio = bloco;
+    uint32_t* vizinhos = bloco + numTerritorios + 1;
+
+    // Contagem dos graus (cada fronteira nos dois sentidos)
+    for (size_t i = 0; i < numFronteiras; i++) {
+        uint32_t a = fronteiras[i].origem;
+        uint32_t b = fronteiras[i].destino;
+        if (a >= (uint32_t) numTerritorios || b >= (uint32_t) numTerritorios) {
+            free(bloco);
+            return 0;
+        }
+        if (a != b) {
+            inicio[a + 1]++;
+            inicio[b + 1]++;
+        }
+    }
+    for (int i = 0; i < numTerritorios; i++) {
+        inicio[i + 1] += inicio[i];
+    }
+
+    // Distribuição: proximo[i] é a próxima posição livre da faixa de i
+    uint32_t* proximo = (uint32_t*) malloc(sizeof(uint32_t) * ((size_t) numTerritorios + 1));
+    if (proximo == NULL) {
+        free(bloco);
+        return 0;
+    }
+    memcpy(proximo, inicio, sizeof(uint32_t) * ((size_t) numTerritorios + 1));
+    for (size_t i = 0; i < numFronteiras; i++) {
+        uint32_t a = fronteiras[i].origem;
+        uint32_t b = fronteiras[i].destino;
+        if (a != b) {
+            vizinhos[proximo[a]++] = b;
+            vizinhos[proximo[b]++] = a;
+        }
+    }
+    free(proximo);
+
+    // Ordena cada faixa e remove repetições, compactando o vetor
+    uint32_t escrita = 0;
+    uint32_t leituraInicio = 0;
+    for (int i = 0; i < numTerritorios; i++) {
+        uint32_t leituraFim = inicio[i + 1];
+        uint32_t* faixa = vizinhos + leituraInicio;
+        uint32_t tamanho = leituraFim - leituraInicio;
+        qsort(faixa, tamanho, sizeof(uint32_t), compararVizinhos);
+
+        inicio[i] = escrita;
+        for (uint32_t k = 0; k < tamanho; k++) {
+            if (k == 0 || faixa[k] != faixa[k - 1]) {
+                vizinhos[escrita++] = faixa[k];
+            }
+        }
+        leituraInicio = leituraFim;
+    }
+    inicio[numTerritorios] = escrita;
+
+    grafo->numTerritorios = numTerritorios;
+    grafo->numVizinhos = escrita;
+    grafo->inicio = inicio;
+    grafo->vizinhos = vizinhos;
+    grafo->memoria = bloco;
+    return 1;
+}
+
+/*
+ * Função: validarGrafo
+ * Confere um CSR lido de arquivo, como construirGrafo() o deixaria:
+ * "inicio" vai de 0 a numVizinhos sem diminuir e os vizinhos de cada
+ * território estão em ordem estritamente crescente e dentro do mapa
+ * Retorna 1 se o grafo é válido (O(territórios + fronteiras))
+ */
+static inline int validarGrafo(const uint32_t* inicio, const uint32_t* vizinhos,
+                               int numTerritorios, uint32_t numVizinhos) {
+    if (inicio[0] != 0 || inicio[numTerritorios] != numVizinhos) {
+        return 0;
+    }
+    for (int i = 0; i < numTerritorios; i++) {
+        if (inicio[i + 1] < inicio[i] || inicio[i + 1] > numVizinhos) {
+            return 0;
+        }
+        for (uint32_t k = inicio[i]; k < inicio[i + 1]; k++) {
+            if (vizinhos[k] >= (uint32_t) numTerritorios || (k > inicio[i] && vizinhos[k] <= vizinhos[k - 1])) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/*
+ * Função: liberarGrafo
+ * Libera o grafo (se foi alocado) e o deixa vazio
+ */
+static inline void liberarGrafo(GrafoAdjacencia* grafo) {
+    free(grafo->memoria);
+    inicializarGrafo(grafo);
+}
+
+// ==================== BUSCAS ====================
+
+/*
+ * Função: prepararBusca
+ * Garante espaço para "numTerritorios" e inicia uma nova busca (nova época,
+ * então as marcas não precisam ser apagadas)
+ * Retorna 1 em caso de sucesso, 0 se faltar memória
+ */
+static inline int prepararBusca(BuscaGrafo* busca, int numTerritorios) {
+    if (busca->capacidade < numTerritorios) {
+        uint32_t* marcas = (uint32_t*) calloc((size_t) numTerritorios, sizeof(uint32_t));
+        uint32_t* pilha = (uint32_t*) malloc(sizeof(uint32_t) * (size_t) numTerritorios);
+        if (marcas == NULL || pilha == NULL) {
+            free(marcas);
+            free(pilha);
+            return 0;
+        }
+        free(busca->marcas);
+        free(busca->pilha);
+        busca->marcas = marcas;
+        busca->pilha = pilha;
+        busca->capacidade = numTerritorios;
+        busca->epoca = 0;
+    }
+    if (++busca->epoca == 0) {
+        // A época deu a volta: apaga as marcas antigas
+        memset(busca->marcas, 0, sizeof(uint32_t) * (size_t) busca->capacidade);
+        busca->epoca = 1;
+    }
+    return 1;
+}
+
+/*
+ * Função: liberarBusca
+ * Libera o rascunho de buscas
+ */
+static inline void liberarBusca(BuscaGrafo* busca) {
+    free(busca->marcas);
+    free(busca->pilha);
+    memset(busca, 0, sizeof(*busca));
+}
+
+#endif // WAR_GRAFO_H
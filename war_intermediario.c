@@ -11,21 +11,22 @@
 #include <string.h>
 #include <time.h>
 
-// Definição da estrutura Territorio
-// Agrupa informações relacionadas a um território em uma única unidade
-typedef struct {
-    char nome[30];    // Nome do território (até 29 caracteres + '\0')
-    char cor[10];     // Cor do exército que controla o território
-    int tropas;       // Quantidade de tropas no território
-} Territorio;
+// Motor de batalhas: define a estrutura Territorio e resolve os ataques
+// sem entrada/saída, deixando para este programa apenas a interface
+#include "war_engine.h"
 
 // ==================== PROTÓTIPOS DAS FUNÇÕES ====================
 
-void cadastrarTerritorios(Territorio* mapa, int quantidade);
-void exibirTerritorios(Territorio* mapa, int quantidade);
-void atacar(Territorio* atacante, Territorio* defensor);
-void realizarAtaque(Territorio* mapa, int quantidade);
-void liberarMemoria(Territorio* mapa);
+void cadastrarTerritorios(Territorio* mapa, int quantidade, TabelaCores* cores, PoolNomes* nomes);
+void exibirTerritorios(Territorio* mapa, int quantidade, const TabelaCores* cores, const PoolNomes* nomes);
+void atacar(Territorio* atacante, Territorio* defensor, GeradorDados* dados, const TabelaCores* cores,
+            const PoolNomes* nomes);
+void realizarAtaque(Territorio* mapa, int quantidade, GeradorDados* dados, const TabelaCores* cores,
+                    const PoolNomes* nomes);
+void exibirErroAtaque(CodigoAtaque codigo);
+void liberarMemoria(Territorio* mapa, PoolNomes* nomes);
+IdCor lerCor(TabelaCores* cores);
+uint64_t lerSemente(int argc, char* argv[]);
 void limparBuffer();
 
 // ==================== FUNÇÃO PRINCIPAL ====================
@@ -34,19 +35,26 @@ void limparBuffer();
  * Função principal do programa
  * Gerencia o fluxo de cadastro, ataques e liberação de memória
  */
-int main() {
+int main(int argc, char* argv[]) {
     int numTerritorios;
     int opcao;
     Territorio* mapa = NULL; // Ponteiro para o vetor dinâmico de territórios
+    GeradorDados dados;      // Fluxo de dados desta partida
+    TabelaCores cores;       // Cores dos exércitos, internadas no cadastro
+    PoolNomes nomes;         // Nomes dos territórios (cada território guarda a posição do seu)
     
-    // Inicializa o gerador de números aleatórios
-    // Usa o tempo atual como semente para garantir aleatoriedade
-    srand(time(NULL));
+    // Inicializa o gerador de dados com uma semente explícita
+    // (--semente N repete exatamente uma partida já jogada)
+    uint64_t semente = lerSemente(argc, argv);
+    inicializarGerador(&dados, semente, 0);
+    inicializarCores(&cores);
+    memset(&nomes, 0, sizeof(nomes));
     
     // Mensagem de boas-vindas
     printf("========================================\n");
     printf("       SISTEMA WAR - TERRITORIOS\n");
-    printf("========================================\n\n");
+    printf("========================================\n");
+    printf("Semente da partida: %llu\n\n", (unsigned long long) semente);
     
     // Solicita a quantidade de territórios a serem cadastrados
     printf("Quantos territorios deseja cadastrar? ");
@@ -72,7 +80,7 @@ int main() {
     printf("\n");
     
     // Cadastra os territórios
-    cadastrarTerritorios(mapa, numTerritorios);
+    cadastrarTerritorios(mapa, numTerritorios, &cores, &nomes);
     
     // Menu principal do jogo
     do {
@@ -89,10 +97,10 @@ int main() {
         switch(opcao) {
             case 1:
                 printf("\n");
-                exibirTerritorios(mapa, numTerritorios);
+                exibirTerritorios(mapa, numTerritorios, &cores, &nomes);
                 break;
             case 2:
-                realizarAtaque(mapa, numTerritorios);
+                realizarAtaque(mapa, numTerritorios, &dados, &cores, &nomes);
                 break;
             case 3:
                 printf("\nEncerrando o jogo...\n");
@@ -103,7 +111,7 @@ int main() {
     } while(opcao != 3);
     
     // Liberação da memória alocada dinamicamente
-    liberarMemoria(mapa);
+    liberarMemoria(mapa, &nomes);
     
     printf("Memoria liberada com sucesso!\n");
     printf("Ate a proxima batalha!\n");
@@ -119,8 +127,10 @@ int main() {
  * Parâmetros:
  *   - mapa: ponteiro para o vetor de territórios
  *   - quantidade: número de territórios a cadastrar
+ *   - cores: tabela onde as cores digitadas são internadas
+ *   - nomes: pool onde os nomes digitados (de qualquer tamanho) são guardados
  */
-void cadastrarTerritorios(Territorio* mapa, int quantidade) {
+void cadastrarTerritorios(Territorio* mapa, int quantidade, TabelaCores* cores, PoolNomes* nomes) {
     printf("========================================\n");
     printf("      CADASTRO DE TERRITORIOS\n");
     printf("========================================\n\n");
@@ -132,12 +142,15 @@ void cadastrarTerritorios(Territorio* mapa, int quantidade) {
         // Acessa o território usando (mapa + i) ou mapa[i]
         // Ambas as notações são equivalentes
         printf("Digite o nome do territorio: ");
-        fgets((mapa + i)->nome, 30, stdin);
-        (mapa + i)->nome[strcspn((mapa + i)->nome, "\n")] = '\0';
+        uint32_t nome = lerLinhaPool(nomes, stdin);
+        if (nome == POOL_ERRO) {
+            printf("Erro ao alocar memoria! Encerrando programa.\n");
+            exit(1);
+        }
+        nomearTerritorio(mapa + i, nomes, nome);
         
         printf("Digite a cor do exercito: ");
-        fgets((mapa + i)->cor, 10, stdin);
-        (mapa + i)->cor[strcspn((mapa + i)->cor, "\n")] = '\0';
+        (mapa + i)->cor = lerCor(cores);
         
         printf("Digite o numero de tropas: ");
         scanf("%d", &(mapa + i)->tropas);
@@ -145,6 +158,7 @@ void cadastrarTerritorios(Territorio* mapa, int quantidade) {
         
         printf("\n");
     }
+    encerrarPool(nomes);
     
     printf("Todos os territorios foram cadastrados!\n");
 }
@@ -155,8 +169,10 @@ void cadastrarTerritorios(Territorio* mapa, int quantidade) {
  * Parâmetros:
  *   - mapa: ponteiro para o vetor de territórios
  *   - quantidade: número de territórios a exibir
+ *   - cores: tabela usada para exibir o nome das cores
+ *   - nomes: pool com os nomes dos territórios
  */
-void exibirTerritorios(Territorio* mapa, int quantidade) {
+void exibirTerritorios(Territorio* mapa, int quantidade, const TabelaCores* cores, const PoolNomes* nomes) {
     printf("========================================\n");
     printf("      TERRITORIOS CADASTRADOS\n");
     printf("========================================\n\n");
@@ -166,8 +182,8 @@ void exibirTerritorios(Territorio* mapa, int quantidade) {
         Territorio* t = mapa + i; // Ponteiro para o território atual
         
         printf("Territorio %d:\n", i + 1);
-        printf("  Nome: %s\n", t->nome);
-        printf("  Cor do Exercito: %s\n", t->cor);
+        printf("  Nome: %s\n", nomeNoPool(nomes, t->nome));
+        printf("  Cor do Exercito: %s\n", nomeCor(cores, t->cor));
         printf("  Quantidade de Tropas: %d\n", t->tropas);
         printf("----------------------------------------\n");
     }
@@ -175,54 +191,46 @@ void exibirTerritorios(Territorio* mapa, int quantidade) {
 
 /*
  * Função: atacar
- * Simula um ataque entre dois territórios usando dados aleatórios
+ * Simula um ataque entre dois territórios usando o motor de batalhas
+ * e exibe o relatório da batalha
  * Parâmetros:
  *   - atacante: ponteiro para o território atacante
  *   - defensor: ponteiro para o território defensor
+ *   - dados: fluxo de dados da partida
+ *   - cores: tabela usada para exibir o nome das cores
+ *   - nomes: pool com os nomes dos territórios
  */
-void atacar(Territorio* atacante, Territorio* defensor) {
+void atacar(Territorio* atacante, Territorio* defensor, GeradorDados* dados, const TabelaCores* cores,
+            const PoolNomes* nomes) {
+    ResultadoBatalha resultado;
+    
     printf("\n========================================\n");
     printf("         SIMULACAO DE BATALHA\n");
     printf("========================================\n");
     printf("Atacante: %s (%s) - %d tropas\n", 
-           atacante->nome, atacante->cor, atacante->tropas);
+           nomeNoPool(nomes, atacante->nome), nomeCor(cores, atacante->cor), atacante->tropas);
     printf("Defensor: %s (%s) - %d tropas\n", 
-           defensor->nome, defensor->cor, defensor->tropas);
+           nomeNoPool(nomes, defensor->nome), nomeCor(cores, defensor->cor), defensor->tropas);
     printf("----------------------------------------\n");
     
-    // Simula rolagem de dados (1 a 6) para cada lado
-    int dadoAtacante = (rand() % 6) + 1;
-    int dadoDefensor = (rand() % 6) + 1;
+    // O motor rola os dados e atualiza os territórios
+    batalhar(atacante, defensor, dados, &resultado);
     
-    printf("Dado do Atacante: %d\n", dadoAtacante);
-    printf("Dado do Defensor: %d\n", dadoDefensor);
+    printf("Dado do Atacante: %d\n", resultado.dadoAtacante);
+    printf("Dado do Defensor: %d\n", resultado.dadoDefensor);
     printf("----------------------------------------\n");
     
-    // Determina o vencedor da batalha
-    if (dadoAtacante > dadoDefensor) {
+    // Exibe o vencedor da batalha
+    if (resultado.conquistou) {
         printf("VITORIA DO ATACANTE!\n");
-        printf("O territorio %s foi conquistado!\n", defensor->nome);
-        
-        // Atualiza o território defensor
-        // Muda a cor (transfere controle) para o atacante
-        strcpy(defensor->cor, atacante->cor);
-        
-        // Transfere metade das tropas do atacante para o defensor
-        int tropasTransferidas = atacante->tropas / 2;
-        if (tropasTransferidas < 1) tropasTransferidas = 1; // Mínimo de 1 tropa
-        
-        defensor->tropas = tropasTransferidas;
-        atacante->tropas -= tropasTransferidas;
-        
-        printf("Tropas transferidas: %d\n", tropasTransferidas);
+        printf("O territorio %s foi conquistado!\n", nomeNoPool(nomes, defensor->nome));
+        printf("Tropas transferidas: %d\n", resultado.tropasMovidas);
         
     } else {
         printf("VITORIA DO DEFENSOR!\n");
         printf("O ataque foi repelido!\n");
         
-        // O atacante perde uma tropa
-        if (atacante->tropas > 1) {
-            atacante->tropas--;
+        if (resultado.perdasAtacante > 0) {
             printf("O atacante perdeu 1 tropa.\n");
         } else {
             printf("O atacante nao possui tropas suficientes para perder.\n");
@@ -238,8 +246,12 @@ void atacar(Territorio* atacante, Territorio* defensor) {
  * Parâmetros:
  *   - mapa: ponteiro para o vetor de territórios
  *   - quantidade: número de territórios disponíveis
+ *   - dados: fluxo de dados da partida
+ *   - cores: tabela usada para exibir o nome das cores
+ *   - nomes: pool com os nomes dos territórios
  */
-void realizarAtaque(Territorio* mapa, int quantidade) {
+void realizarAtaque(Territorio* mapa, int quantidade, GeradorDados* dados, const TabelaCores* cores,
+                    const PoolNomes* nomes) {
     int indiceAtacante, indiceDefensor;
     
     printf("\n========================================\n");
@@ -250,7 +262,7 @@ void realizarAtaque(Territorio* mapa, int quantidade) {
     printf("Territorios disponiveis:\n");
     for (int i = 0; i < quantidade; i++) {
         printf("%d. %s (%s) - %d tropas\n", 
-               i + 1, mapa[i].nome, mapa[i].cor, mapa[i].tropas);
+               i + 1, nomeNoPool(nomes, mapa[i].nome), nomeCor(cores, mapa[i].cor), mapa[i].tropas);
     }
     
     // Seleciona o território atacante
@@ -259,15 +271,10 @@ void realizarAtaque(Territorio* mapa, int quantidade) {
     limparBuffer();
     indiceAtacante--; // Ajusta para índice do vetor (0-based)
     
-    // Validação do índice do atacante
-    if (indiceAtacante < 0 || indiceAtacante >= quantidade) {
-        printf("Territorio invalido!\n");
-        return;
-    }
-    
-    // Verifica se o atacante tem tropas suficientes
-    if (mapa[indiceAtacante].tropas < 2) {
-        printf("O territorio atacante precisa ter pelo menos 2 tropas!\n");
+    // Valida o índice e as tropas do atacante
+    CodigoAtaque codigo = validarAtacante(mapa, quantidade, indiceAtacante);
+    if (codigo != ATAQUE_OK) {
+        exibirErroAtaque(codigo);
         return;
     }
     
@@ -277,49 +284,101 @@ void realizarAtaque(Territorio* mapa, int quantidade) {
     limparBuffer();
     indiceDefensor--; // Ajusta para índice do vetor
     
-    // Validação do índice do defensor
-    if (indiceDefensor < 0 || indiceDefensor >= quantidade) {
-        printf("Territorio invalido!\n");
-        return;
-    }
-    
-    // Impede ataque ao próprio território
-    if (indiceAtacante == indiceDefensor) {
-        printf("Um territorio nao pode atacar a si mesmo!\n");
-        return;
-    }
-    
-    // Impede ataque entre territórios da mesma cor
-    if (strcmp(mapa[indiceAtacante].cor, mapa[indiceDefensor].cor) == 0) {
-        printf("Nao e possivel atacar um territorio da mesma cor!\n");
+    // Valida o defensor, o auto-ataque e o ataque entre mesma cor
+    codigo = validarAtaque(mapa, quantidade, indiceAtacante, indiceDefensor);
+    if (codigo != ATAQUE_OK) {
+        exibirErroAtaque(codigo);
         return;
     }
     
     // Executa o ataque usando ponteiros
-    atacar(&mapa[indiceAtacante], &mapa[indiceDefensor]);
+    atacar(&mapa[indiceAtacante], &mapa[indiceDefensor], dados, cores, nomes);
     
     // Exibe o estado atualizado dos territórios envolvidos
     printf("\nEstado apos o ataque:\n");
     printf("Atacante - %s: %d tropas (%s)\n", 
-           mapa[indiceAtacante].nome, mapa[indiceAtacante].tropas, 
-           mapa[indiceAtacante].cor);
+           nomeNoPool(nomes, mapa[indiceAtacante].nome), mapa[indiceAtacante].tropas, 
+           nomeCor(cores, mapa[indiceAtacante].cor));
     printf("Defensor - %s: %d tropas (%s)\n", 
-           mapa[indiceDefensor].nome, mapa[indiceDefensor].tropas, 
-           mapa[indiceDefensor].cor);
+           nomeNoPool(nomes, mapa[indiceDefensor].nome), mapa[indiceDefensor].tropas, 
+           nomeCor(cores, mapa[indiceDefensor].cor));
+}
+
+/*
+ * Função: exibirErroAtaque
+ * Exibe a mensagem correspondente a um ataque recusado pelo motor
+ * Parâmetro:
+ *   - codigo: motivo da recusa devolvido pelo motor
+ */
+void exibirErroAtaque(CodigoAtaque codigo) {
+    switch (codigo) {
+        case ATAQUE_INDICE_INVALIDO:
+            printf("Territorio invalido!\n");
+            break;
+        case ATAQUE_TROPAS_INSUFICIENTES:
+            printf("O territorio atacante precisa ter pelo menos 2 tropas!\n");
+            break;
+        case ATAQUE_MESMO_TERRITORIO:
+            printf("Um territorio nao pode atacar a si mesmo!\n");
+            break;
+        case ATAQUE_MESMA_COR:
+            printf("Nao e possivel atacar um territorio da mesma cor!\n");
+            break;
+        default:
+            break;
+    }
 }
 
 /*
  * Função: liberarMemoria
  * Libera a memória alocada dinamicamente para os territórios
- * Parâmetro:
+ * Parâmetros:
  *   - mapa: ponteiro para o vetor de territórios a ser liberado
+ *   - nomes: pool com os nomes dos territórios
  */
-void liberarMemoria(Territorio* mapa) {
+void liberarMemoria(Territorio* mapa, PoolNomes* nomes) {
     // Verifica se o ponteiro não é nulo antes de liberar
     if (mapa != NULL) {
         free(mapa);
         mapa = NULL; // Boa prática: evita ponteiros pendentes
     }
+    
+    // Libera o texto dos nomes
+    liberarPool(nomes);
+}
+
+/*
+ * Função: lerCor
+ * Lê o nome de uma cor do teclado e devolve o seu ID na tabela de cores
+ * Parâmetro:
+ *   - cores: tabela onde a cor é internada (se ainda não existir)
+ */
+IdCor lerCor(TabelaCores* cores) {
+    char nome[TAM_COR] = "";
+    
+    fgets(nome, TAM_COR, stdin);
+    nome[strcspn(nome, "\n")] = '\0';
+    
+    IdCor id = internarCor(cores, nome);
+    if (id == COR_INVALIDA) {
+        printf("Limite de %d cores atingido! Encerrando programa.\n", MAX_CORES);
+        exit(1);
+    }
+    return id;
+}
+
+/*
+ * Função: lerSemente
+ * Lê a semente do gerador de dados da opção "--semente N"; sem a opção,
+ * usa o horário atual. A semente é exibida para permitir repetir a partida
+ */
+uint64_t lerSemente(int argc, char* argv[]) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--semente") == 0) {
+            return strtoull(argv[i + 1], NULL, 10);
+        }
+    }
+    return (uint64_t) time(NULL);
 }
 
 /*
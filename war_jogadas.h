@@ -0,0 +1,154 @@
+/*
+ * Jogadas Legais do Sistema WAR
+ *
+ * Um ataque é legal quando o atacante tem pelo menos 2 tropas, o defensor
+ * é de outra cor e, se o mapa tem fronteiras, os dois são vizinhos.
+ * Testar os pares um a um custa O(T²) para listar as jogadas de uma cor;
+ * aqui cada território fica em um grupo conforme o seu dono e se ele
+ * "pode atacar" (2+ tropas e, com fronteiras, algum vizinho inimigo).
+ *
+ * Os grupos são listas duplamente ligadas sobre vetores de índices (nada
+ * é alocado depois da criação): entrar e sair de um grupo é O(1) e
+ * percorrer um grupo custa o seu tamanho. O motor reclassifica só o que
+ * uma batalha pode mudar (atacante, defensor e, se o defensor trocou de
+ * dono, os vizinhos dele), e as jogadas de uma cor saem do seu grupo de
+ * atacantes em tempo proporcional ao resultado (ver proximaJogada() em
+ * war_engine.h). Como a posse, os grupos são próprios de cada partida.
+ */
+
+#ifndef WAR_JOGADAS_H
+#define WAR_JOGADAS_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "war_cores.h"
+
+#define FIM_GRUPO UINT32_MAX          // Fim de uma lista de grupo
+#define SEM_GRUPO 0xFF                // Território fora dos grupos (cor inválida)
+#define GRUPOS_JOGADAS (2 * MAX_CORES)
+
+// Grupos por cor: o grupo 2 * cor + 1 tem os territórios da cor que podem
+// atacar e o grupo 2 * cor, os demais (numTerritorios = 0: desativados)
+typedef struct {
+    uint32_t* proximo;                    // Próximo território do mesmo grupo (FIM_GRUPO = último)
+    uint32_t* anterior;                   // Anterior (FIM_GRUPO = primeiro)
+    uint8_t* grupo;                       // Grupo atual de cada território
+    uint32_t primeiro[GRUPOS_JOGADAS];    // Primeiro território de cada grupo
+    uint32_t tamanho[GRUPOS_JOGADAS];     // Territórios de cada grupo
+    int numTerritorios;
+    void* memoria;                        // Bloco dos três vetores
+} JogadasCores;
+
+/*
+ * Função: grupoJogadas
+ * Grupo dos territórios da cor que podem (ou não) atacar
+ */
+static inline int grupoJogadas(IdCor cor, int podeAtacar) {
+    return 2 * (int) cor + (podeAtacar != 0);
+}
+
+/*
+ * Função: esvaziarJogadas
+ * Deixa todos os territórios fora dos grupos
+ */
+static inline void esvaziarJogadas(JogadasCores* jogadas) {
+    for (int g = 0; g < GRUPOS_JOGADAS; g++) {
+        jogadas->primeiro[g] = FIM_GRUPO;
+        jogadas->tamanho[g] = 0;
+    }
+    memset(jogadas->grupo, SEM_GRUPO, (size_t) jogadas->numTerritorios);
+}
+
+/*
+ * Função: criarJogadas
+ * Aloca os grupos (vazios) para "numTerritorios" territórios
+ * Retorna 1 em caso de sucesso, 0 se faltar memória
+ */
+static inline int criarJogadas(JogadasCores* jogadas, int numTerritorios) {
+    memset(jogadas, 0, sizeof(*jogadas));
+    size_t n = numTerritorios > 0 ? (size_t) numTerritorios : 1;
+    char* bloco = (char*) malloc(n * (2 * sizeof(uint32_t) + 1));
+    if (bloco == NULL) {
+        return 0;
+    }
+    jogadas->proximo = (uint32_t*) bloco;
+    jogadas->anterior = jogadas->proximo + n;
+    jogadas->grupo = (uint8_t*) (jogadas->anterior + n);
+    jogadas->numTerritorios = numTerritorios;
+    jogadas->memoria = bloco;
+    esvaziarJogadas(jogadas);
+    return 1;
+}
+
+/*
+ * Função: liberarJogadas
+ * Libera os grupos e os deixa desativados
+ */
+static inline void liberarJogadas(JogadasCores* jogadas) {
+    free(jogadas->memoria);
+    memset(jogadas, 0, sizeof(*jogadas));
+}
+
+/*
+ * Função: copiarJogadas
+ * Copia os grupos de outra partida com o mesmo mapa (criados com o mesmo tamanho)
+ */
+static inline void copiarJogadas(JogadasCores* destino, const JogadasCores* origem) {
+    memcpy(destino->memoria, origem->memoria, (size_t) origem->numTerritorios * (2 * sizeof(uint32_t) + 1));
+    memcpy(destino->primeiro, origem->primeiro, sizeof(origem->primeiro));
+    memcpy(destino->tamanho, origem->tamanho, sizeof(origem->tamanho));
+}
+
+/*
+ * Função: moverParaGrupo
+ * Tira o território do seu grupo atual e o coloca no início de "grupo"
+ * (SEM_GRUPO apenas o tira)
+ */
+static inline void moverParaGrupo(JogadasCores* jogadas, uint32_t territorio, int grupo) {
+    int atual = jogadas->grupo[territorio];
+    if (atual == grupo) {
+        return;
+    }
+    if (atual != SEM_GRUPO) {
+        uint32_t proximo = jogadas->proximo[territorio];
+        uint32_t anterior = jogadas->anterior[territorio];
+        if (anterior != FIM_GRUPO) {
+            jogadas->proximo[anterior] = proximo;
+        } else {
+            jogadas->primeiro[atual] = proximo;
+        }
+        if (proximo != FIM_GRUPO) {
+            jogadas->anterior[proximo] = anterior;
+        }
+        jogadas->tamanho[atual]--;
+    }
+
+    jogadas->grupo[territorio] = (uint8_t) grupo;
+    if (grupo != SEM_GRUPO) {
+        uint32_t primeiro = jogadas->primeiro[grupo];
+        jogadas->proximo[territorio] = primeiro;
+        jogadas->anterior[territorio] = FIM_GRUPO;
+        if (primeiro != FIM_GRUPO) {
+            jogadas->anterior[primeiro] = territorio;
+        }
+        jogadas->primeiro[grupo] = territorio;
+        jogadas->tamanho[grupo]++;
+    }
+}
+
+/*
+ * Função: copiarGrupo
+ * Escreve em "destino" os territórios do grupo (em ordem de lista)
+ * Retorna a quantidade escrita (o tamanho do grupo)
+ */
+static inline int copiarGrupo(const JogadasCores* jogadas, int grupo, int* destino) {
+    int total = 0;
+    for (uint32_t t = jogadas->primeiro[grupo]; t != FIM_GRUPO; t = jogadas->proximo[t]) {
+        destino[total++] = (int) t;
+    }
+    return total;
+}
+
+#endif // WAR_JOGADAS_H
@@ -6,101 +6,510 @@
  * Utiliza alocação dinâmica, ponteiros e verificação de condições de vitória.
  */
 
+// O programa usa chamadas POSIX e extensões da glibc (clock_gettime, sysconf,
+// ...): sem isto, compilar com -std=c11 esconde as declarações
+#define _GNU_SOURCE
+
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
-// Definição da estrutura Territorio
+#include "war_arena.h"       // Arena de memória da partida digitada
+#include "war_benchmark.h"   // Medições de desempenho (--benchmark)
+#include "war_carregador.h"  // Carga de mapas e jogadores a partir de arquivos
+#include "war_chances.h"     // Chances exatas de conquista (tabela compartilhada)
+#include "war_comandos.h"    // Protocolo de comandos em linha (--comandos)
+#include "war_diario.h"      // Diário de batalhas e reprodução
+#include "war_engine.h"      // Motor de batalhas (Territorio, resolverBatalha, ...)
+#include "war_gerador.h"     // Mapas gerados a partir da semente (--gerar)
+#include "war_metricas.h"    // Contadores e latências exportados (--metricas)
+#include "war_missoes.h"     // Registro de missões (Missao, Jogador, avaliarMissao)
+#include "war_relampago.h"   // Ataque até o fim sorteado de uma vez
+#include "war_salvamento.h"  // Salvamento e restauração de partidas
+#include "war_servidor.h"    // Servidor de partidas em socket Unix (--servidor)
+#include "war_tarefas.h"     // Pool de threads com roubo de trabalho (simulador)
+#include "war_tela.h"        // Saída em buffer e territórios alterados
+
+// Faixas do histograma de turnos do simulador (potências de 2: 1, 2-3, 4-7, ...)
+#define FAIXAS_HISTOGRAMA 20
+
+// Combates resolvidos por lote em estimarCombates()
+#define COMBATES_POR_LOTE 4096
+
+// Seleção de ataque: maior mapa listado por inteiro e opções exibidas
+// quando um começo de nome serve para vários territórios
+#define LIMITE_LISTA_ATAQUE 100
+#define MAX_SUGESTOES_NOME 10
+
+// Modo "--benchmark": jogadores sintéticos, tropas dos pares atacados e
+// maiores mapas dos casos que geram texto (tela e CSV) ou jogam partidas
+#define JOGADORES_BENCHMARK 4
+#define TROPAS_BENCHMARK 1000000
+#define LIMITE_TEXTO_BENCHMARK 1000000
+#define LIMITE_PARTIDAS_BENCHMARK 1000
+
+// Estado e estatísticas de um trabalhador do simulador
+// Cada thread escreve apenas no seu próprio registro (sem travas)
+typedef struct {
+    _Alignas(64) long long partidas;
+    long long semVencedor;                                    // Partidas sem missão cumprida
+    long long batalhas;                                       // Batalhas resolvidas
+    long long sorteadas[TOTAL_MISSOES];                       // Vezes em que a missão foi sorteada
+    long long cumpridas[TOTAL_MISSOES];                       // Vitórias por missão
+    long long somaTurnos[TOTAL_MISSOES];                      // Soma dos turnos até a vitória
+    long long histograma[TOTAL_MISSOES][FAIXAS_HISTOGRAMA];   // Turnos até a vitória
+    Jogo jogo;                                                // Cópia de trabalho da partida
+    int* candidatos;                                          // Rascunho para sortear ataques
+    int* missoes;                                             // Missão de cada jogador na partida
+    Arena* arena;                                             // Mapa, candidatos e missões da thread
+} TrabalhadorSimulacao;
+
+// Dados compartilhados (somente leitura) entre as partidas simuladas
 typedef struct {
-    char nome[30];    // Nome do território
-    char cor[10];     // Cor do exército que controla o território
-    int tropas;       // Quantidade de tropas no território
-} Territorio;
+    const Jogo* inicial;       // Mapa, cores e agregados antes do primeiro ataque
+    const Jogador* jogadores;
+    int numJogadores;
+    const Missao* catalogo;    // Missões compiladas que podem ser sorteadas
+    uint64_t semente;
+    int maxTurnos;
+    TabelaChances* chances;    // Defensor mais provável de cair (NULL = sorteado)
+    const JogadasCores* jogadas; // Grupos de jogadas do mapa inicial
+    TrabalhadorSimulacao* trabalhadores;
+} ContextoSimulacao;
 
-// Definição da estrutura Jogador
+// Estado dos casos do modo "--benchmark" (um mapa sintético por vez)
 typedef struct {
-    char nome[30];    // Nome do jogador
-    char cor[10];     // Cor do exército do jogador
-    char* missao;     // Ponteiro para a missão (alocação dinâmica)
-} Jogador;
+    Jogo jogo;
+    Jogador jogadores[JOGADORES_BENCHMARK];
+    const Missao* catalogo;
+    int missao;                // Missão do catálogo avaliada em benchAvaliarMissao()
+    Tela tela;
+    const char* arquivoMapa;   // Mapa gravado lido em benchCarregarMapa()
+    int proximoPar;            // Próximo par (2k, 2k+1) atacado em benchAtacar()
+    int numThreads;
+    uint64_t semente;
+} ContextoBenchmark;
 
 // ==================== PROTÓTIPOS DAS FUNÇÕES ====================
 
-void cadastrarTerritorios(Territorio* mapa, int quantidade);
-void cadastrarJogadores(Jogador* jogadores, int quantidade);
-void exibirTerritorios(Territorio* mapa, int quantidade);
-void exibirMissao(char* missao);
-void atribuirMissao(char* destino, char* missoes[], int totalMissoes);
-int verificarMissao(char* missao, Territorio* mapa, int tamanho, char* corJogador);
-void atacar(Territorio* atacante, Territorio* defensor);
-void realizarAtaque(Territorio* mapa, int quantidade);
-void verificarVitoria(Jogador* jogadores, int numJogadores, Territorio* mapa, int numTerritorios);
-void liberarMemoria(Territorio* mapa, Jogador* jogadores, int numJogadores);
+void cadastrarTerritorios(Jogo* jogo);
+void cadastrarJogadores(Jogador* jogadores, int quantidade, const Missao catalogo[],
+                        GeradorDados* dados, TabelaCores* cores);
+void exibirTerritorios(const Jogo* jogo, Tela* tela);
+void exibirAlterados(const Jogo* jogo, Tela* tela);
+void escreverTerritorio(Tela* tela, const Jogo* jogo, int indice);
+void exibirMissao(const Missao* missao, const TabelaCores* cores, const Continentes* continentes);
+void atribuirMissao(Missao* destino, const Missao missoes[], int totalMissoes, GeradorDados* dados);
+void atacar(Jogo* jogo, int indiceAtacante, int indiceDefensor, DiarioBatalhas* diario, int turno,
+            CacheRelampago* relampago, Tela* tela);
+void realizarAtaque(Jogo* jogo, DiarioBatalhas* diario, int turno, CacheRelampago* relampago,
+                    TabelaChances* chances, Tela* tela);
+void exibirErroAtaque(CodigoAtaque codigo);
+void verificarVitoria(Jogador* jogadores, int numJogadores, Jogo* jogo);
+int menorDeOrdem(int* valores, int total, int ordem);
+int escolherDefensor(const Territorio* mapa, int atacante, TabelaChances* chances, GeradorDados* dados,
+                     int* candidatos, int total);
+int escolherAtaque(const Jogo* jogo, IdCor cor, GeradorDados* dados, TabelaChances* chances,
+                   int* candidatos, int* atacante, int* defensor);
+void simularPartida(void* contexto, int trabalhador, uint32_t indice);
+void executarSimulacao(const Jogo* jogo, const Jogador* jogadores, int numJogadores,
+                       const Missao catalogo[], long long partidas, int maxTurnos,
+                       int numThreads, uint64_t semente, TabelaChances* chances);
+void estimarCombates(long long combates, GeradorDados* dados);
+int executarBenchmarks(const char* arquivoJson, long long maximoTerritorios, double tempoMinimo,
+                       int numThreads, RegraBatalha regra, uint64_t semente);
+void benchAtacar(void* contexto, long long operacoes);
+void benchAvaliarMissao(void* contexto, long long operacoes);
+void benchVerificarVitoria(void* contexto, long long operacoes);
+void benchExibirTerritorios(void* contexto, long long operacoes);
+void benchCarregarMapa(void* contexto, long long operacoes);
+void benchPartidas(void* contexto, long long operacoes);
+int prepararContinentes(const char* arquivo, Jogo* jogo);
+void liberarMemoria(Jogo* jogo, Jogador* jogadores, Arena* arena);
+IdCor lerCor(TabelaCores* cores);
+int lerTerritorio(const Jogo* jogo);
+uint64_t lerSemente(int argc, char* argv[]);
+long long lerOpcao(int argc, char* argv[], const char* nome, long long padrao);
+const char* lerTextoOpcao(int argc, char* argv[], const char* nome);
+int lerBandeira(int argc, char* argv[], const char* nome);
 void limparBuffer();
 
 // ==================== FUNÇÃO PRINCIPAL ====================
 
-int main() {
-    int numTerritorios, numJogadores;
-    int opcao;
+int main(int argc, char* argv[]) {
+    int numJogadores = 0;
+    int opcao = 0;
     int turno = 1;
-    Territorio* mapa = NULL;
+    Jogo jogo;          // Mapa, cores, dados e agregados da partida
     Jogador* jogadores = NULL;
+    Arena* arena = NULL;             // Mapa e jogadores digitados (liberados de uma vez)
+    Missao catalogo[TOTAL_MISSOES];  // Missões compiladas para esta partida
+    CacheRelampago relampago;        // Tabelas dos ataques até o fim (opção 7)
+    TabelaChances chances;           // Chances exatas de conquista da regra da partida
+    Tela tela;                       // Buffer de saída e territórios alterados (opções 1 e 8)
+    
+    // Arquivos opcionais: "--mapa arquivo" e "--jogadores arquivo" substituem o cadastro
+    const char* arquivoMapa = lerTextoOpcao(argc, argv, "--mapa");
+    const char* arquivoJogadores = lerTextoOpcao(argc, argv, "--jogadores");
+    
+    // "--gerar N" gera um mapa de N territórios a partir da semente (fronteiras,
+    // continentes e territórios repartidos entre "--gerar-jogadores P" cores)
+    long long territoriosGerados = lerOpcao(argc, argv, "--gerar", 0);
+    
+    // Salvamento: "--continuar arquivo" retoma uma partida salva, "--salvar arquivo"
+    // define onde salvar e "--autosalvar N" salva em segundo plano a cada N turnos
+    const char* arquivoContinuar = lerTextoOpcao(argc, argv, "--continuar");
+    const char* arquivoSalvar = lerTextoOpcao(argc, argv, "--salvar");
+    int intervaloSalvamento = (int) lerOpcao(argc, argv, "--autosalvar", 0);
+    SalvamentoPeriodico salvamento;
+    int salvamentoAtivo = 0;
+    if (arquivoSalvar == NULL) {
+        arquivoSalvar = arquivoContinuar != NULL ? arquivoContinuar : "war_partida.sav";
+    }
+    
+    // "--turnos N" limita cada partida do simulador a N turnos (o laço do
+    // simulador vai até o turno N inclusive, então N fica abaixo de INT_MAX)
+    long long turnosSimulados = lerOpcao(argc, argv, "--turnos", 1000);
+    if (turnosSimulados <= 0 || turnosSimulados >= INT_MAX) {
+        printf("Erro: --turnos deve estar entre 1 e %d.\n", INT_MAX - 1);
+        return 1;
+    }
     
-    // Inicializa o gerador de números aleatórios
-    srand(time(NULL));
+    // Inicializa o gerador de dados (--semente N repete uma partida)
+    uint64_t semente = lerSemente(argc, argv);
+    inicializarJogo(&jogo, semente);
     
     // Mensagem de boas-vindas
     printf("========================================\n");
     printf("    SISTEMA WAR - MISSOES ESTRATEGICAS\n");
-    printf("========================================\n\n");
+    printf("========================================\n");
+    printf("Semente da partida: %llu\n\n", (unsigned long long) semente);
+    
+    // "--combates N" estima as chances de cada combate da regra clássica e encerra
+    long long combatesEstimados = lerOpcao(argc, argv, "--combates", 0);
+    if (combatesEstimados > 0) {
+        estimarCombates(combatesEstimados, &jogo.dados);
+        return 0;
+    }
+    
+    // "--benchmark arquivo.json" mede as operações do jogo em mapas sintéticos
+    // de até "--benchmark-maximo N" territórios e encerra
+    const char* arquivoBenchmark = lerTextoOpcao(argc, argv, "--benchmark");
+    if (arquivoBenchmark != NULL) {
+        int ok = executarBenchmarks(arquivoBenchmark, lerOpcao(argc, argv, "--benchmark-maximo", 10000000),
+                                    lerOpcao(argc, argv, "--benchmark-ms", 200) / 1000.0,
+                                    (int) lerOpcao(argc, argv, "--threads", 0),
+                                    lerBandeira(argc, argv, "--classica") ? REGRA_CLASSICA : REGRA_SIMPLES,
+                                    semente);
+        return ok ? 0 : 1;
+    }
     
-    // Solicita o número de jogadores
-    printf("Quantos jogadores vao participar? ");
-    scanf("%d", &numJogadores);
-    limparBuffer();
+    // Uma partida restaurada já traz mapa, jogadores, turno e dados
+    if (arquivoContinuar != NULL) {
+        if (arquivoMapa != NULL || arquivoJogadores != NULL || territoriosGerados > 0) {
+            printf("Erro: --continuar ja traz o mapa e os jogadores (nao use --mapa, --jogadores ou --gerar).\n");
+            return 1;
+        }
+        CodigoCarga codigo = restaurarPartida(arquivoContinuar, &jogo, &jogadores, &numJogadores, &turno);
+        if (codigo != CARGA_OK) {
+            printf("Erro ao continuar a partida '%s': %s\n", arquivoContinuar, mensagemCarga(codigo));
+            return 1;
+        }
+        printf("Partida restaurada: turno %d, %d jogadores, %d territorios.\n",
+               turno, numJogadores, jogo.numTerritorios);
+        arquivoMapa = arquivoContinuar;
+        arquivoJogadores = arquivoContinuar;
+    } else if (lerBandeira(argc, argv, "--classica")) {
+        // "--classica": 3 dados contra 2 (uma partida salva mantém a sua regra)
+        jogo.regra = REGRA_CLASSICA;
+    }
+    if (jogo.regra == REGRA_CLASSICA) {
+        printf("Regra de batalha: classica (ate 3 dados contra 2).\n");
+    }
     
-    if (numJogadores <= 0) {
-        printf("Quantidade invalida! Encerrando programa.\n");
+    // O mapa carregado traz a sua própria tabela de cores, então vem antes do catálogo
+    if (arquivoMapa != NULL && arquivoContinuar == NULL) {
+        CodigoCarga codigo = carregarMapa(arquivoMapa, &jogo);
+        if (codigo != CARGA_OK) {
+            printf("Erro ao carregar o mapa '%s': %s\n", arquivoMapa, mensagemCarga(codigo));
+            return 1;
+        }
+        printf("Mapa carregado: %d territorios, %d cores.\n", jogo.numTerritorios, jogo.cores.total);
+    } else if (territoriosGerados > 0 && arquivoContinuar == NULL) {
+        int coresGeradas = (int) lerOpcao(argc, argv, "--gerar-jogadores", CORES_GERADOR);
+        struct timespec inicio, fim;
+        clock_gettime(CLOCK_MONOTONIC, &inicio);
+        int ok = territoriosGerados <= INT32_MAX && coresGeradas > 0 && coresGeradas <= MAX_CORES &&
+                 gerarMapa(&jogo, (int) territoriosGerados, coresGeradas, (int) lerOpcao(argc, argv, "--threads", 0));
+        clock_gettime(CLOCK_MONOTONIC, &fim);
+        if (!ok) {
+            printf("Erro ao gerar o mapa de %lld territorios para %d jogadores.\n", territoriosGerados, coresGeradas);
+            liberarMemoria(&jogo, NULL, arena);
+            return 1;
+        }
+        printf("Mapa gerado: %d territorios, %u fronteiras, %d continentes, %d cores em %.3f s.\n",
+               jogo.numTerritorios, jogo.grafo.numVizinhos / 2, jogo.continentes.total, jogo.cores.total,
+               (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9);
+        arquivoMapa = "--gerar";  // Como um mapa de arquivo: dispensa o cadastro digitado
+    }
+    compilarCatalogo(&jogo.cores, catalogo);
+    
+    // "--continentes arquivo" agrupa os territórios em continentes (linhas "continente,territorio");
+    // um mapa de arquivo os recebe antes dos jogadores, que podem ter missões de continentes
+    const char* arquivoContinentes = lerTextoOpcao(argc, argv, "--continentes");
+    if (arquivoContinentes != NULL && arquivoMapa != NULL && !prepararContinentes(arquivoContinentes, &jogo)) {
+        liberarMemoria(&jogo, jogadores, arena);
         return 1;
     }
     
-    // Solicita a quantidade de territórios
-    printf("Quantos territorios deseja cadastrar? ");
-    scanf("%d", &numTerritorios);
-    limparBuffer();
+    // As missões de continentes de uma partida salva precisam dos mesmos continentes
+    for (int i = 0; arquivoContinuar != NULL && i < numJogadores; i++) {
+        if (!missaoCabeNoMapa(&jogadores[i].missao, &jogo.continentes)) {
+            printf("Erro: a missao do jogador %d usa um continente que o mapa nao tem (use --continentes).\n",
+                   i + 1);
+            liberarMemoria(&jogo, jogadores, arena);
+            return 1;
+        }
+    }
+    
+    if (arquivoContinuar != NULL) {
+        // Jogadores já restaurados com as suas missões
+    } else if (arquivoJogadores != NULL) {
+        CodigoCarga codigo = carregarJogadoresCSV(arquivoJogadores, &jogadores, &numJogadores,
+                                                  catalogo, &jogo.dados, &jogo.cores, &jogo.continentes);
+        if (codigo != CARGA_OK) {
+            printf("Erro ao carregar os jogadores '%s': %s\n", arquivoJogadores, mensagemCarga(codigo));
+            liberarMemoria(&jogo, NULL, arena);
+            return 1;
+        }
+        printf("Jogadores carregados: %d.\n", numJogadores);
+    } else {
+        // Solicita o número de jogadores
+        printf("Quantos jogadores vao participar? ");
+        scanf("%d", &numJogadores);
+        limparBuffer();
+        
+        if (numJogadores <= 0) {
+            printf("Quantidade invalida! Encerrando programa.\n");
+            liberarMemoria(&jogo, NULL, arena);
+            return 1;
+        }
+    }
     
-    if (numTerritorios <= 0) {
-        printf("Quantidade invalida! Encerrando programa.\n");
+    if (arquivoMapa == NULL) {
+        // Solicita a quantidade de territórios
+        printf("Quantos territorios deseja cadastrar? ");
+        scanf("%d", &jogo.numTerritorios);
+        limparBuffer();
+        
+        if (jogo.numTerritorios <= 0) {
+            printf("Quantidade invalida! Encerrando programa.\n");
+            liberarMemoria(&jogo, jogadores, arena);
+            return 1;
+        }
+    }
+    
+    // ALOCAÇÃO DINÂMICA: o que for digitado (territórios e jogadores) vem
+    // de uma única arena dimensionada agora e devolvida de uma vez no final
+    size_t tamanhoArena = 0;
+    if (arquivoMapa == NULL) {
+        tamanhoArena += tamanhoReserva(sizeof(Territorio) * (size_t) jogo.numTerritorios);
+    }
+    if (arquivoJogadores == NULL) {
+        tamanhoArena += tamanhoReserva(sizeof(Jogador) * (size_t) numJogadores);
+    }
+    if (tamanhoArena > 0 && (arena = criarArena(tamanhoArena)) == NULL) {
+        printf("Erro ao alocar memoria para a partida!\n");
+        liberarMemoria(&jogo, jogadores, arena);
         return 1;
     }
     
-    // ALOCAÇÃO DINÂMICA DOS TERRITÓRIOS
-    mapa = (Territorio*) calloc(numTerritorios, sizeof(Territorio));
-    if (mapa == NULL) {
-        printf("Erro ao alocar memoria para territorios!\n");
+    if (arquivoMapa == NULL) {
+        jogo.mapa = (Territorio*) reservarArena(arena, sizeof(Territorio) * (size_t) jogo.numTerritorios);
+        jogo.mapaExterno = 1;
+    }
+    
+    if (arquivoJogadores == NULL) {
+        jogadores = (Jogador*) reservarArena(arena, sizeof(Jogador) * (size_t) numJogadores);
+        
+        printf("\n");
+        
+        // Cadastra os jogadores e atribui missões
+        cadastrarJogadores(jogadores, numJogadores, catalogo, &jogo.dados, &jogo.cores);
+    }
+    
+    if (arquivoMapa == NULL) {
+        // Cadastra os territórios e calcula os totais por cor
+        cadastrarTerritorios(&jogo);
+        recalcularAgregados(&jogo);
+    }
+    
+    // Índice de nomes: territórios escolhidos pelo nome ou pelo começo do nome
+    if (!ativarIndiceNomes(&jogo)) {
+        printf("Aviso: memoria insuficiente para o indice de nomes.\n");
+    }
+    
+    // "--colunas" mantém dono/tropas em colunas para varreduras vetorizadas
+    if (lerBandeira(argc, argv, "--colunas") && !ativarColunas(&jogo)) {
+        printf("Aviso: memoria insuficiente para o mapa em colunas.\n");
+    }
+    
+    // Um mapa digitado só recebe os continentes depois do cadastro
+    if (arquivoContinentes != NULL && arquivoMapa == NULL && !prepararContinentes(arquivoContinentes, &jogo)) {
+        liberarMemoria(&jogo, jogadores, arena);
         return 1;
     }
     
-    // ALOCAÇÃO DINÂMICA DOS JOGADORES
-    jogadores = (Jogador*) calloc(numJogadores, sizeof(Jogador));
-    if (jogadores == NULL) {
-        printf("Erro ao alocar memoria para jogadores!\n");
-        free(mapa);
+    // "--fronteiras arquivo" cadastra as fronteiras do mapa (pares "a,b")
+    const char* arquivoFronteiras = lerTextoOpcao(argc, argv, "--fronteiras");
+    if (arquivoFronteiras != NULL) {
+        CodigoCarga codigo = carregarFronteirasCSV(arquivoFronteiras, &jogo);
+        if (codigo != CARGA_OK) {
+            printf("Erro ao carregar as fronteiras '%s': %s\n", arquivoFronteiras, mensagemCarga(codigo));
+            liberarMemoria(&jogo, jogadores, arena);
+            return 1;
+        }
+        printf("Fronteiras carregadas: %u.\n", jogo.grafo.numVizinhos / 2);
+    }
+    
+    // "--reproduzir diario" reconstrói o mapa a partir do diário (até "--ate-turno N")
+    const char* arquivoReproduzir = lerTextoOpcao(argc, argv, "--reproduzir");
+    if (arquivoReproduzir != NULL) {
+        ResumoReproducao resumo;
+        uint32_t ateTurno = (uint32_t) lerOpcao(argc, argv, "--ate-turno", UINT32_MAX);
+        struct timespec inicio, fim;
+        clock_gettime(CLOCK_MONOTONIC, &inicio);
+        int situacao = reproduzirDiario(arquivoReproduzir, &jogo, ateTurno, &resumo);
+        clock_gettime(CLOCK_MONOTONIC, &fim);
+        
+        if (situacao <= 0) {
+            printf("Erro ao reproduzir '%s': %s\n", arquivoReproduzir,
+                   situacao < 0 ? "o mapa atual nao e o mapa de partida do diario"
+                                : "diario invalido ou ilegivel");
+            liberarMemoria(&jogo, jogadores, arena);
+            return 1;
+        }
+        
+        double segundos = (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+        printf("Diario reproduzido ate o turno %u: %llu eventos em %.3f s (%.0f eventos/s)\n",
+               resumo.ultimoTurno, (unsigned long long) resumo.aplicados, segundos,
+               segundos > 0 ? resumo.aplicados / segundos : 0.0);
+        if (resumo.divergentes > 0 || resumo.invalidos > 0) {
+            printf("Atencao: %llu eventos divergentes, %llu invalidos.\n",
+                   (unsigned long long) resumo.divergentes, (unsigned long long) resumo.invalidos);
+        }
+        turno = (int) resumo.ultimoTurno + 1;
+    }
+    
+    // "--salvar-mapa arquivo" grava o mapa no formato binário (carga instantânea)
+    const char* arquivoBinario = lerTextoOpcao(argc, argv, "--salvar-mapa");
+    if (arquivoBinario != NULL) {
+        CodigoCarga codigo = salvarMapaBinario(arquivoBinario, &jogo);
+        printf("%s '%s': %s\n", codigo == CARGA_OK ? "Mapa salvo em" : "Erro ao salvar o mapa",
+               arquivoBinario, codigo == CARGA_OK ? "formato binario" : mensagemCarga(codigo));
+    }
+    
+    // Chances exatas de conquista; "--tabela-chances arquivo" as reaproveita entre execuções
+    const char* arquivoChances = lerTextoOpcao(argc, argv, "--tabela-chances");
+    if (!criarTabelaChances(&chances, jogo.regra, LIMITE_CHANCES_PADRAO, LIMITE_CHANCES_PADRAO)) {
+        printf("Erro ao alocar memoria para a tabela de chances!\n");
+        liberarMemoria(&jogo, jogadores, arena);
         return 1;
     }
+    if (arquivoChances != NULL && carregarTabelaChances(&chances, arquivoChances)) {
+        uint64_t limites = atomic_load(&chances.limites);
+        printf("Tabela de chances carregada: %u x %u tropas.\n",
+               (unsigned) (limites >> 32), (unsigned) (uint32_t) limites);
+    }
+    
+    // "--metricas arquivo" liga contadores e latências e os grava a cada
+    // "--metricas-intervalo S" segundos (Prometheus, ou JSON se "*.json")
+    const char* arquivoMetricas = lerTextoOpcao(argc, argv, "--metricas");
+    if (arquivoMetricas != NULL &&
+        !ativarMetricas(arquivoMetricas, (int) lerOpcao(argc, argv, "--metricas-intervalo", 10))) {
+        printf("Aviso: nao foi possivel exportar as metricas para '%s'.\n", arquivoMetricas);
+    }
+    
+    // Modo simulador: "--simular N" joga N partidas automáticas e encerra
+    // ("--bots": cada jogador ataca o vizinho que tem mais chance de conquistar)
+    long long partidasSimuladas = lerOpcao(argc, argv, "--simular", 0);
+    if (partidasSimuladas > 0) {
+        executarSimulacao(&jogo, jogadores, numJogadores, catalogo, partidasSimuladas,
+                          (int) turnosSimulados,
+                          (int) lerOpcao(argc, argv, "--threads", 0), semente,
+                          lerBandeira(argc, argv, "--bots") ? &chances : NULL);
+        if (arquivoChances != NULL && !salvarTabelaChances(&chances, arquivoChances)) {
+            printf("Aviso: nao foi possivel gravar a tabela de chances '%s'.\n", arquivoChances);
+        }
+        if (!encerrarMetricas()) {
+            printf("Aviso: falha ao gravar as metricas '%s'.\n", arquivoMetricas);
+        }
+        liberarTabelaChances(&chances);
+        liberarMemoria(&jogo, jogadores, arena);
+        return 0;
+    }
+    
+    // "--diario arquivo" registra todas as batalhas da partida
+    const char* arquivoDiario = lerTextoOpcao(argc, argv, "--diario");
+    DiarioBatalhas diario;
+    DiarioBatalhas* diarioAtivo = NULL;
+    if (arquivoDiario != NULL) {
+        if (abrirDiario(&diario, arquivoDiario, &jogo, turno)) {
+            diarioAtivo = &diario;
+        } else {
+            printf("Aviso: nao foi possivel abrir o diario '%s' (ilegivel ou de outra partida).\n",
+                   arquivoDiario);
+        }
+    }
+    
+    if (intervaloSalvamento > 0) {
+        salvamentoAtivo = iniciarSalvamentoPeriodico(&salvamento, arquivoSalvar);
+        if (!salvamentoAtivo) {
+            printf("Aviso: salvamento automatico indisponivel.\n");
+        }
+    }
     
-    printf("\n");
+    inicializarCacheRelampago(&relampago);
+    if (!criarTela(&tela, jogo.numTerritorios)) {
+        printf("Erro ao alocar memoria para a tela!\n");
+        liberarCacheRelampago(&relampago);
+        liberarTabelaChances(&chances);
+        liberarMemoria(&jogo, jogadores, arena);
+        return 1;
+    }
     
-    // Cadastra os jogadores e atribui missões
-    cadastrarJogadores(jogadores, numJogadores);
+    // "--comandos": a entrada padrão traz comandos em linha em vez do menu
+    if (lerBandeira(argc, argv, "--comandos")) {
+        SessaoComandos sessao = {&jogo, jogadores, numJogadores, diarioAtivo, &relampago, &chances,
+                                 arquivoSalvar, turno, 0};
+        fflush(stdout);
+        if (!executarProtocolo(&sessao, STDIN_FILENO, STDOUT_FILENO, &tela)) {
+            printf("Aviso: o protocolo de comandos foi interrompido.\n");
+        }
+        turno = sessao.turno;
+        opcao = 5;
+    }
     
-    // Cadastra os territórios
-    cadastrarTerritorios(mapa, numTerritorios);
+    // "--servidor caminho": cada conexão ao socket joga uma cópia desta partida
+    const char* caminhoServidor = lerTextoOpcao(argc, argv, "--servidor");
+    if (caminhoServidor != NULL && opcao != 5) {
+        Servidor servidor = {-1, -1, NULL, &jogo, jogadores, numJogadores, &relampago, &chances,
+                             semente, NULL, NULL, 0, 0, 0, 0, 0};
+        printf("Servidor de partidas em '%s' (Ctrl+C encerra).\n", caminhoServidor);
+        fflush(stdout);
+        if (executarServidor(&servidor, caminhoServidor)) {
+            printf("Servidor encerrado: %llu sessoes, %lld comandos.\n",
+                   (unsigned long long) servidor.sessoesCriadas, servidor.comandos);
+        } else {
+            printf("Erro ao criar o servidor em '%s'.\n", caminhoServidor);
+        }
+        opcao = 5;
+    }
     
     // Menu principal do jogo
-    do {
+    while (opcao != 5) {
         printf("\n========================================\n");
         printf("        MENU PRINCIPAL - TURNO %d\n", turno);
         printf("========================================\n");
@@ -109,6 +518,9 @@ int main() {
         printf("3. Realizar ataque\n");
         printf("4. Verificar condicoes de vitoria\n");
         printf("5. Sair\n");
+        printf("6. Salvar partida\n");
+        printf("7. Atacar ate o fim (relampago)\n");
+        printf("8. Exibir territorios alterados\n");
         printf("Escolha uma opcao: ");
         scanf("%d", &opcao);
         limparBuffer();
@@ -116,36 +528,86 @@ int main() {
         switch(opcao) {
             case 1:
                 printf("\n");
-                exibirTerritorios(mapa, numTerritorios);
+                exibirTerritorios(&jogo, &tela);
+                break;
+            case 8:
+                printf("\n");
+                exibirAlterados(&jogo, &tela);
                 break;
             case 2:
                 printf("\n========================================\n");
                 printf("      MISSOES DOS JOGADORES\n");
                 printf("========================================\n");
                 for (int i = 0; i < numJogadores; i++) {
-                    printf("\nJogador: %s (%s)\n", jogadores[i].nome, jogadores[i].cor);
-                    exibirMissao(jogadores[i].missao);
+                    printf("\nJogador: %s (%s)\n", jogadores[i].nome, nomeCor(&jogo.cores, jogadores[i].cor));
+                    exibirMissao(&jogadores[i].missao, &jogo.cores, &jogo.continentes);
                 }
                 break;
             case 3:
-                realizarAtaque(mapa, numTerritorios);
+            case 7:
+                realizarAtaque(&jogo, diarioAtivo, turno, opcao == 7 ? &relampago : NULL, &chances,
+                               &tela);
+                if (diarioAtivo != NULL && !descarregarDiario(diarioAtivo)) {
+                    printf("Aviso: falha ao gravar o diario de batalhas; ele foi fechado.\n");
+                    fecharDiario(diarioAtivo);
+                    diarioAtivo = NULL;
+                }
                 turno++;
+                contarMetrica(CONTADOR_TURNOS, 1);
                 // Verifica vitória automaticamente após cada ataque
-                verificarVitoria(jogadores, numJogadores, mapa, numTerritorios);
+                verificarVitoria(jogadores, numJogadores, &jogo);
+                // Salvamento automático sem interromper o menu
+                if (salvamentoAtivo && turno % intervaloSalvamento == 0 &&
+                    !agendarSalvamento(&salvamento, &jogo, jogadores, numJogadores, turno)) {
+                    printf("Aviso: memoria insuficiente para o salvamento automatico do turno %d.\n", turno);
+                }
                 break;
             case 4:
-                verificarVitoria(jogadores, numJogadores, mapa, numTerritorios);
+                verificarVitoria(jogadores, numJogadores, &jogo);
                 break;
             case 5:
                 printf("\nEncerrando o jogo...\n");
                 break;
+            case 6: {
+                CodigoCarga codigo = salvarPartida(arquivoSalvar, &jogo, jogadores, numJogadores, turno);
+                if (codigo == CARGA_OK) {
+                    printf("\nPartida salva em '%s' (turno %d).\n", arquivoSalvar, turno);
+                } else {
+                    printf("\nErro ao salvar a partida: %s\n", mensagemCarga(codigo));
+                }
+                break;
+            }
             default:
                 printf("\nOpcao invalida! Tente novamente.\n");
         }
-    } while(opcao != 5);
+    }
+    
+    if (diarioAtivo != NULL && !fecharDiario(diarioAtivo)) {
+        printf("Aviso: falha ao gravar o diario de batalhas.\n");
+    }
+    if (salvamentoAtivo) {
+        CodigoCarga codigo = encerrarSalvamentoPeriodico(&salvamento);
+        if (salvamento.substituidos > 0) {
+            printf("Salvamento automatico: %d copias substituidas por outras mais novas antes de gravadas.\n",
+                   salvamento.substituidos);
+        }
+        if (codigo != CARGA_OK) {
+            printf("Aviso: o ultimo salvamento automatico falhou.\n");
+        }
+    }
+    
+    if (arquivoChances != NULL && !salvarTabelaChances(&chances, arquivoChances)) {
+        printf("Aviso: nao foi possivel gravar a tabela de chances '%s'.\n", arquivoChances);
+    }
+    if (!encerrarMetricas()) {
+        printf("Aviso: falha ao gravar as metricas '%s'.\n", arquivoMetricas);
+    }
     
     // Liberação da memória alocada dinamicamente
-    liberarMemoria(mapa, jogadores, numJogadores);
+    liberarTabelaChances(&chances);
+    liberarCacheRelampago(&relampago);
+    liberarTela(&tela);
+    liberarMemoria(&jogo, jogadores, arena);
     
     printf("Memoria liberada com sucesso!\n");
     printf("Ate a proxima batalha!\n");
@@ -159,19 +621,8 @@ int main() {
  * Função: cadastrarJogadores
  * Cadastra os jogadores e atribui missões aleatórias
  */
-void cadastrarJogadores(Jogador* jogadores, int quantidade) {
-    // Vetor de missões pré-definidas
-    char* missoes[] = {
-        "Conquistar 3 territorios seguidos com a mesma cor",
-        "Eliminar todas as tropas da cor vermelha do mapa",
-        "Controlar pelo menos 5 territorios ao mesmo tempo",
-        "Acumular 30 ou mais tropas em um unico territorio",
-        "Conquistar territorios de pelo menos 3 cores diferentes",
-        "Dominar todos os territorios cujo nome comeca com a letra 'B'",
-        "Ter controle de territorios com soma total de 40 tropas"
-    };
-    int totalMissoes = 7;
-    
+void cadastrarJogadores(Jogador* jogadores, int quantidade, const Missao catalogo[],
+                        GeradorDados* dados, TabelaCores* cores) {
     printf("========================================\n");
     printf("      CADASTRO DE JOGADORES\n");
     printf("========================================\n\n");
@@ -184,21 +635,13 @@ void cadastrarJogadores(Jogador* jogadores, int quantidade) {
         jogadores[i].nome[strcspn(jogadores[i].nome, "\n")] = '\0';
         
         printf("Digite a cor do exercito: ");
-        fgets(jogadores[i].cor, 10, stdin);
-        jogadores[i].cor[strcspn(jogadores[i].cor, "\n")] = '\0';
-        
-        // ALOCAÇÃO DINÂMICA PARA A MISSÃO
-        jogadores[i].missao = (char*) malloc(100 * sizeof(char));
-        if (jogadores[i].missao == NULL) {
-            printf("Erro ao alocar memoria para a missao!\n");
-            exit(1);
-        }
+        jogadores[i].cor = lerCor(cores);
         
         // Atribui uma missão aleatória (passagem por referência)
-        atribuirMissao(jogadores[i].missao, missoes, totalMissoes);
+        atribuirMissao(&jogadores[i].missao, catalogo, TOTAL_MISSOES, dados);
         
         printf("\nMissao atribuida para %s:\n", jogadores[i].nome);
-        exibirMissao(jogadores[i].missao); // Passagem por valor
+        exibirMissao(&jogadores[i].missao, cores, NULL); // Apenas leitura
         printf("\n");
     }
     
@@ -210,141 +653,35 @@ void cadastrarJogadores(Jogador* jogadores, int quantidade) {
  * Sorteia e atribui uma missão aleatória ao jogador
  * Parâmetros:
  *   - destino: ponteiro para onde a missão será copiada (passagem por referência)
- *   - missoes: vetor de strings com as missões disponíveis
+ *   - missoes: vetor com as missões compiladas disponíveis
  *   - totalMissoes: quantidade total de missões no vetor
+ *   - dados: fluxo de dados da partida usado no sorteio
  */
-void atribuirMissao(char* destino, char* missoes[], int totalMissoes) {
+void atribuirMissao(Missao* destino, const Missao missoes[], int totalMissoes, GeradorDados* dados) {
     // Sorteia um índice aleatório
-    int indice = rand() % totalMissoes;
+    int indice = (int) sortearIntervalo(dados, (uint32_t) totalMissoes);
     
-    // Copia a missão sorteada para o destino usando strcpy
-    strcpy(destino, missoes[indice]);
+    // Copia a missão sorteada (tipo e parâmetros) para o destino
+    *destino = missoes[indice];
 }
 
 /*
  * Função: exibirMissao
- * Exibe a missão do jogador (passagem por valor - apenas leitura)
- */
-void exibirMissao(char* missao) {
-    printf("Missao: %s\n", missao);
-}
-
-/*
- * Função: verificarMissao
- * Verifica se a missão do jogador foi cumprida
- * Retorna 1 se cumprida, 0 caso contrário
- */
-int verificarMissao(char* missao, Territorio* mapa, int tamanho, char* corJogador) {
-    // Contadores para verificação das missões
-    int territoriosControlados = 0;
-    int tropasVermelhas = 0;
-    int tropasEmUmTerritorio = 0;
-    int coresConquistadas[10] = {0}; // Até 10 cores diferentes
-    int indiceCores = 0;
-    int somaTotalTropas = 0;
-    int territoriosSequenciais = 0;
-    int sequenciaAtual = 0;
-    char coresUnicas[10][10];
-    int numCoresUnicas = 0;
-    
-    // Analisa todos os territórios
-    for (int i = 0; i < tamanho; i++) {
-        // Conta territórios controlados pelo jogador
-        if (strcmp(mapa[i].cor, corJogador) == 0) {
-            territoriosControlados++;
-            somaTotalTropas += mapa[i].tropas;
-            sequenciaAtual++;
-            
-            // Verifica maior quantidade de tropas em um território
-            if (mapa[i].tropas > tropasEmUmTerritorio) {
-                tropasEmUmTerritorio = mapa[i].tropas;
-            }
-            
-            // Adiciona cor única se ainda não foi contada
-            int corJaContada = 0;
-            for (int j = 0; j < numCoresUnicas; j++) {
-                if (strcmp(coresUnicas[j], mapa[i].cor) == 0) {
-                    corJaContada = 1;
-                    break;
-                }
-            }
-            if (!corJaContada && numCoresUnicas < 10) {
-                strcpy(coresUnicas[numCoresUnicas], mapa[i].cor);
-                numCoresUnicas++;
-            }
-        } else {
-            if (sequenciaAtual > territoriosSequenciais) {
-                territoriosSequenciais = sequenciaAtual;
-            }
-            sequenciaAtual = 0;
-        }
-        
-        // Conta tropas vermelhas no mapa
-        if (strcmp(mapa[i].cor, "vermelha") == 0 || strcmp(mapa[i].cor, "Vermelha") == 0) {
-            tropasVermelhas += mapa[i].tropas;
-        }
-    }
-    
-    // Atualiza sequência final
-    if (sequenciaAtual > territoriosSequenciais) {
-        territoriosSequenciais = sequenciaAtual;
-    }
-    
-    // VERIFICAÇÃO DAS MISSÕES ESPECÍFICAS
-    
-    // Missão 1: Conquistar 3 territórios seguidos
-    if (strstr(missao, "3 territorios seguidos") != NULL) {
-        return territoriosSequenciais >= 3;
-    }
-    
-    // Missão 2: Eliminar todas as tropas vermelhas
-    if (strstr(missao, "tropas da cor vermelha") != NULL) {
-        return tropasVermelhas == 0;
-    }
-    
-    // Missão 3: Controlar pelo menos 5 territórios
-    if (strstr(missao, "5 territorios") != NULL) {
-        return territoriosControlados >= 5;
-    }
-    
-    // Missão 4: Acumular 30 ou mais tropas em um único território
-    if (strstr(missao, "30 ou mais tropas") != NULL) {
-        return tropasEmUmTerritorio >= 30;
-    }
-    
-    // Missão 5: Conquistar territórios de 3 cores diferentes
-    if (strstr(missao, "3 cores diferentes") != NULL) {
-        return numCoresUnicas >= 3;
-    }
-    
-    // Missão 6: Dominar territórios que começam com 'B'
-    if (strstr(missao, "comeca com a letra 'B'") != NULL) {
-        int territoriosB = 0;
-        int territoriosBControlados = 0;
-        for (int i = 0; i < tamanho; i++) {
-            if (mapa[i].nome[0] == 'B' || mapa[i].nome[0] == 'b') {
-                territoriosB++;
-                if (strcmp(mapa[i].cor, corJogador) == 0) {
-                    territoriosBControlados++;
-                }
-            }
-        }
-        return territoriosB > 0 && territoriosBControlados == territoriosB;
-    }
-    
-    // Missão 7: Ter 40 tropas somadas
-    if (strstr(missao, "40 tropas") != NULL) {
-        return somaTotalTropas >= 40;
-    }
-    
-    return 0; // Missão não cumprida
+ * Exibe a missão do jogador (ponteiro constante - apenas leitura)
+ */
+void exibirMissao(const Missao* missao, const TabelaCores* cores, const Continentes* continentes) {
+    char texto[100];
+    descreverMissao(missao, cores, continentes, texto, sizeof(texto));
+    printf("Missao: %s\n", texto);
 }
 
 /*
  * Função: verificarVitoria
  * Verifica se algum jogador cumpriu sua missão e declara o vencedor
  */
-void verificarVitoria(Jogador* jogadores, int numJogadores, Territorio* mapa, int numTerritorios) {
+void verificarVitoria(Jogador* jogadores, int numJogadores, Jogo* jogo) {
+    uint64_t medida = iniciarMedida();
+    
     printf("\n========================================\n");
     printf("    VERIFICACAO DE CONDICOES DE VITORIA\n");
     printf("========================================\n");
@@ -352,14 +689,14 @@ void verificarVitoria(Jogador* jogadores, int numJogadores, Territorio* mapa, in
     int alguemVenceu = 0;
     
     for (int i = 0; i < numJogadores; i++) {
-        // Verifica a missão (passagem por referência para verificação)
-        int missaoCumprida = verificarMissao(jogadores[i].missao, mapa, numTerritorios, jogadores[i].cor);
+        // Avalia a missão compilada do jogador
+        int missaoCumprida = avaliarMissao(&jogadores[i].missao, jogo, jogadores[i].cor);
         
         if (missaoCumprida) {
             printf("\n*** VITORIA! ***\n");
             printf("O jogador %s (%s) cumpriu sua missao!\n", 
-                   jogadores[i].nome, jogadores[i].cor);
-            printf("Missao: %s\n", jogadores[i].missao);
+                   jogadores[i].nome, nomeCor(&jogo->cores, jogadores[i].cor));
+            exibirMissao(&jogadores[i].missao, &jogo->cores, &jogo->continentes);
             printf("\n*** PARABENS! ***\n");
             alguemVenceu = 1;
         }
@@ -371,27 +708,34 @@ void verificarVitoria(Jogador* jogadores, int numJogadores, Territorio* mapa, in
     }
     
     printf("========================================\n");
+    encerrarMedida(LATENCIA_VITORIA, medida);
 }
 
 /*
  * Função: cadastrarTerritorios
  * Realiza o cadastro de todos os territórios
+ * Os nomes (de qualquer tamanho) vão para o pool de nomes da partida
  */
-void cadastrarTerritorios(Territorio* mapa, int quantidade) {
+void cadastrarTerritorios(Jogo* jogo) {
+    Territorio* mapa = jogo->mapa;
+    
     printf("\n========================================\n");
     printf("      CADASTRO DE TERRITORIOS\n");
     printf("========================================\n\n");
     
-    for (int i = 0; i < quantidade; i++) {
+    for (int i = 0; i < jogo->numTerritorios; i++) {
         printf("--- Territorio %d ---\n", i + 1);
         
         printf("Digite o nome do territorio: ");
-        fgets(mapa[i].nome, 30, stdin);
-        mapa[i].nome[strcspn(mapa[i].nome, "\n")] = '\0';
+        uint32_t nome = lerLinhaPool(&jogo->pool, stdin);
+        if (nome == POOL_ERRO) {
+            printf("Erro ao alocar memoria para os nomes! Encerrando programa.\n");
+            exit(1);
+        }
+        nomearTerritorio(&mapa[i], &jogo->pool, nome);
         
         printf("Digite a cor do exercito: ");
-        fgets(mapa[i].cor, 10, stdin);
-        mapa[i].cor[strcspn(mapa[i].cor, "\n")] = '\0';
+        mapa[i].cor = lerCor(&jogo->cores);
         
         printf("Digite o numero de tropas: ");
         scanf("%d", &mapa[i].tropas);
@@ -399,69 +743,154 @@ void cadastrarTerritorios(Territorio* mapa, int quantidade) {
         
         printf("\n");
     }
+    encerrarPool(&jogo->pool);
     
     printf("Todos os territorios foram cadastrados!\n");
 }
 
+/*
+ * Função: escreverTerritorio
+ * Acrescenta ao buffer da tela o bloco de um território
+ */
+void escreverTerritorio(Tela* tela, const Jogo* jogo, int indice) {
+    const Territorio* territorio = &jogo->mapa[indice];
+    escreverTela(tela,
+                 "Territorio %d:\n"
+                 "  Nome: %s\n"
+                 "  Cor do Exercito: %s\n"
+                 "  Quantidade de Tropas: %d\n"
+                 "----------------------------------------\n",
+                 indice + 1, nomeTerritorio(jogo, indice), nomeCor(&jogo->cores, territorio->cor),
+                 territorio->tropas);
+}
+
 /*
  * Função: exibirTerritorios
  * Exibe informações de todos os territórios
+ * A tela inteira é montada no buffer e enviada em uma única escrita
  */
-void exibirTerritorios(Territorio* mapa, int quantidade) {
-    printf("========================================\n");
-    printf("      TERRITORIOS CADASTRADOS\n");
-    printf("========================================\n\n");
+void exibirTerritorios(const Jogo* jogo, Tela* tela) {
+    static const char titulo[] =
+        "========================================\n"
+        "      TERRITORIOS CADASTRADOS\n"
+        "========================================\n\n";
     
-    for (int i = 0; i < quantidade; i++) {
-        printf("Territorio %d:\n", i + 1);
-        printf("  Nome: %s\n", mapa[i].nome);
-        printf("  Cor do Exercito: %s\n", mapa[i].cor);
-        printf("  Quantidade de Tropas: %d\n", mapa[i].tropas);
-        printf("----------------------------------------\n");
+    anexarTela(tela, titulo, sizeof(titulo) - 1);
+    for (int i = 0; i < jogo->numTerritorios; i++) {
+        escreverTerritorio(tela, jogo, i);
     }
+    despejarTela(tela);
+    limparAlterados(tela);
+}
+
+/*
+ * Função: exibirAlterados
+ * Exibe apenas os territórios alterados desde a última exibição
+ * (na primeira vez, ou se nada foi exibido ainda, mostra o mapa inteiro)
+ */
+void exibirAlterados(const Jogo* jogo, Tela* tela) {
+    if (tela->redesenhar) {
+        exibirTerritorios(jogo, tela);
+        return;
+    }
+    
+    escreverTela(tela,
+                 "========================================\n"
+                 "      TERRITORIOS ALTERADOS: %d\n"
+                 "========================================\n\n",
+                 tela->numAlterados);
+    for (int i = proximoAlterado(tela, 0); i >= 0; i = proximoAlterado(tela, i + 1)) {
+        escreverTerritorio(tela, jogo, i);
+    }
+    if (tela->numAlterados == 0) {
+        escreverTela(tela, "Nenhum territorio mudou desde a ultima exibicao.\n");
+    }
+    despejarTela(tela);
+    limparAlterados(tela);
 }
 
 /*
  * Função: atacar
- * Simula um ataque entre dois territórios usando dados aleatórios
+ * Simula um ataque entre dois territórios usando o motor de batalhas
+ * (que também atualiza os agregados da partida) e exibe o relatório
+ * A batalha é registrada no diário, se houver um aberto
+ * Com "relampago", ataca até o fim com um único sorteio
+ * Os dois territórios são marcados como alterados na tela
  */
-void atacar(Territorio* atacante, Territorio* defensor) {
+void atacar(Jogo* jogo, int indiceAtacante, int indiceDefensor, DiarioBatalhas* diario, int turno,
+            CacheRelampago* relampago, Tela* tela) {
+    Territorio* atacante = &jogo->mapa[indiceAtacante];
+    Territorio* defensor = &jogo->mapa[indiceDefensor];
+    ResultadoBatalha resultado;
+    
     printf("\n========================================\n");
     printf("         SIMULACAO DE BATALHA\n");
     printf("========================================\n");
     printf("Atacante: %s (%s) - %d tropas\n", 
-           atacante->nome, atacante->cor, atacante->tropas);
+           nomeTerritorio(jogo, indiceAtacante), nomeCor(&jogo->cores, atacante->cor), atacante->tropas);
     printf("Defensor: %s (%s) - %d tropas\n", 
-           defensor->nome, defensor->cor, defensor->tropas);
+           nomeTerritorio(jogo, indiceDefensor), nomeCor(&jogo->cores, defensor->cor), defensor->tropas);
     printf("----------------------------------------\n");
     
-    // Simula rolagem de dados (1 a 6)
-    int dadoAtacante = (rand() % 6) + 1;
-    int dadoDefensor = (rand() % 6) + 1;
+    // Resolve a batalha sem entrada/saída
+    uint64_t medida = iniciarMedida();
+    if (relampago != NULL) {
+        if (!relampagoNoJogo(jogo, relampago, indiceAtacante, indiceDefensor, &resultado)) {
+            printf("Erro ao alocar memoria para o ataque relampago!\n");
+            return;
+        }
+    } else {
+        batalharNoJogo(jogo, indiceAtacante, indiceDefensor, &resultado);
+    }
+    encerrarMedida(LATENCIA_BATALHA, medida);
+    contarBatalha(&resultado);
+    if (diario != NULL && !registrarBatalha(diario, turno, indiceAtacante, indiceDefensor, &resultado)) {
+        printf("Aviso: a batalha nao foi registrada no diario.\n");
+    }
+    marcarAlterado(tela, indiceAtacante);
+    marcarAlterado(tela, indiceDefensor);
+    
+    if (resultado.relampago) {
+        printf("Ataque ate o fim (relampago)\n");
+        printf("Perdas: atacante %d, defensor %d\n", resultado.perdasAtacante, resultado.perdasDefensor);
+        if (resultado.conquistou) {
+            printf("O territorio %s foi conquistado!\n", nomeTerritorio(jogo, indiceDefensor));
+            printf("Tropas transferidas: %d\n", resultado.tropasMovidas);
+        } else {
+            printf("O ataque parou: o atacante ficou com 1 tropa.\n");
+        }
+        printf("========================================\n");
+        return;
+    }
     
-    printf("Dado do Atacante: %d\n", dadoAtacante);
-    printf("Dado do Defensor: %d\n", dadoDefensor);
+    if (jogo->regra == REGRA_CLASSICA) {
+        printf("Dados do Atacante:");
+        for (int i = 0; i < resultado.numDadosAtacante; i++) printf(" %d", resultado.dadosAtacante[i]);
+        printf("\nDados do Defensor:");
+        for (int i = 0; i < resultado.numDadosDefensor; i++) printf(" %d", resultado.dadosDefensor[i]);
+        printf("\n----------------------------------------\n");
+        printf("Perdas: atacante %d, defensor %d\n", resultado.perdasAtacante, resultado.perdasDefensor);
+        if (resultado.conquistou) {
+            printf("O territorio %s foi conquistado!\n", nomeTerritorio(jogo, indiceDefensor));
+            printf("Tropas transferidas: %d\n", resultado.tropasMovidas);
+        }
+        printf("========================================\n");
+        return;
+    }
+    
+    printf("Dado do Atacante: %d\n", resultado.dadoAtacante);
+    printf("Dado do Defensor: %d\n", resultado.dadoDefensor);
     printf("----------------------------------------\n");
     
-    if (dadoAtacante > dadoDefensor) {
+    if (resultado.conquistou) {
         printf("VITORIA DO ATACANTE!\n");
-        printf("O territorio %s foi conquistado!\n", defensor->nome);
-        
-        // Transfere controle e tropas
-        strcpy(defensor->cor, atacante->cor);
-        int tropasTransferidas = atacante->tropas / 2;
-        if (tropasTransferidas < 1) tropasTransferidas = 1;
-        
-        defensor->tropas = tropasTransferidas;
-        atacante->tropas -= tropasTransferidas;
-        
-        printf("Tropas transferidas: %d\n", tropasTransferidas);
+        printf("O territorio %s foi conquistado!\n", nomeTerritorio(jogo, indiceDefensor));
+        printf("Tropas transferidas: %d\n", resultado.tropasMovidas);
     } else {
         printf("VITORIA DO DEFENSOR!\n");
         printf("O ataque foi repelido!\n");
         
-        if (atacante->tropas > 1) {
-            atacante->tropas--;
+        if (resultado.perdasAtacante > 0) {
             printf("O atacante perdeu 1 tropa.\n");
         }
     }
@@ -472,90 +901,840 @@ void atacar(Territorio* atacante, Territorio* defensor) {
 /*
  * Função: realizarAtaque
  * Gerencia a seleção de territórios e execução do ataque
+ * (com "relampago", o ataque segue até o fim em um único sorteio)
+ * Antes do ataque exibe a chance exata de conquista consultada em "chances"
+ * Os territórios podem ser escolhidos pelo número ou pelo nome; mapas
+ * grandes não são listados
  */
-void realizarAtaque(Territorio* mapa, int quantidade) {
+void realizarAtaque(Jogo* jogo, DiarioBatalhas* diario, int turno, CacheRelampago* relampago,
+                    TabelaChances* chances, Tela* tela) {
+    Territorio* mapa = jogo->mapa;
+    int quantidade = jogo->numTerritorios;
+    const TabelaCores* cores = &jogo->cores;
     int indiceAtacante, indiceDefensor;
     
-    printf("\n========================================\n");
-    printf("         SELECAO DE ATAQUE\n");
-    printf("========================================\n\n");
+    static const char titulo[] =
+        "\n========================================\n"
+        "         SELECAO DE ATAQUE\n"
+        "========================================\n\n";
+    static const char lista[] = "Territorios disponiveis:\n";
     
-    printf("Territorios disponiveis:\n");
-    for (int i = 0; i < quantidade; i++) {
-        printf("%d. %s (%s) - %d tropas\n", 
-               i + 1, mapa[i].nome, mapa[i].cor, mapa[i].tropas);
+    anexarTela(tela, titulo, sizeof(titulo) - 1);
+    if (quantidade <= LIMITE_LISTA_ATAQUE) {
+        anexarTela(tela, lista, sizeof(lista) - 1);
+        for (int i = 0; i < quantidade; i++) {
+            escreverTela(tela, "%d. %s (%s) - %d tropas\n",
+                         i + 1, nomeTerritorio(jogo, i), nomeCor(cores, mapa[i].cor), mapa[i].tropas);
+        }
+    } else {
+        escreverTela(tela, "Mapa com %d territorios: digite o numero, o nome ou o comeco do nome.\n", quantidade);
     }
+    despejarTela(tela);
     
-    printf("\nEscolha o territorio ATACANTE (1-%d): ", quantidade);
-    scanf("%d", &indiceAtacante);
-    limparBuffer();
-    indiceAtacante--;
+    printf("\nEscolha o territorio ATACANTE (1-%d ou nome): ", quantidade);
+    indiceAtacante = lerTerritorio(jogo);
     
-    if (indiceAtacante < 0 || indiceAtacante >= quantidade) {
-        printf("Territorio invalido!\n");
+    CodigoAtaque codigo = validarAtacante(mapa, quantidade, indiceAtacante);
+    if (codigo != ATAQUE_OK) {
+        exibirErroAtaque(codigo);
         return;
     }
     
-    if (mapa[indiceAtacante].tropas < 2) {
-        printf("O territorio atacante precisa ter pelo menos 2 tropas!\n");
+    printf("Escolha o territorio DEFENSOR (1-%d ou nome): ", quantidade);
+    indiceDefensor = lerTerritorio(jogo);
+    
+    codigo = validarAtaqueNoJogo(jogo, indiceAtacante, indiceDefensor);
+    if (codigo != ATAQUE_OK) {
+        exibirErroAtaque(codigo);
         return;
     }
     
-    printf("Escolha o territorio DEFENSOR (1-%d): ", quantidade);
-    scanf("%d", &indiceDefensor);
-    limparBuffer();
-    indiceDefensor--;
+    ChanceBatalha chance;
+    if (consultarChance(chances, mapa[indiceAtacante].tropas, mapa[indiceDefensor].tropas, &chance)) {
+        printf("Chance de conquista atacando ate o fim: %.1f%% (perdas esperadas: %.1f x %.1f)\n",
+               100.0 * chance.vitoria, chance.perdasAtacante, chance.perdasDefensor);
+    }
+    
+    atacar(jogo, indiceAtacante, indiceDefensor, diario, turno, relampago, tela);
+    
+    printf("\nEstado apos o ataque:\n");
+    printf("Atacante - %s: %d tropas (%s)\n", 
+           nomeTerritorio(jogo, indiceAtacante), mapa[indiceAtacante].tropas, 
+           nomeCor(cores, mapa[indiceAtacante].cor));
+    printf("Defensor - %s: %d tropas (%s)\n", 
+           nomeTerritorio(jogo, indiceDefensor), mapa[indiceDefensor].tropas, 
+           nomeCor(cores, mapa[indiceDefensor].cor));
+}
+
+/*
+ * Função: exibirErroAtaque
+ * Exibe a mensagem correspondente a um ataque recusado pelo motor
+ */
+void exibirErroAtaque(CodigoAtaque codigo) {
+    switch (codigo) {
+        case ATAQUE_INDICE_INVALIDO:
+            printf("Territorio invalido!\n");
+            break;
+        case ATAQUE_TROPAS_INSUFICIENTES:
+            printf("O territorio atacante precisa ter pelo menos 2 tropas!\n");
+            break;
+        case ATAQUE_MESMO_TERRITORIO:
+            printf("Um territorio nao pode atacar a si mesmo!\n");
+            break;
+        case ATAQUE_MESMA_COR:
+            printf("Nao e possivel atacar um territorio da mesma cor!\n");
+            break;
+        case ATAQUE_NAO_ADJACENTE:
+            printf("So e possivel atacar territorios que fazem fronteira!\n");
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+ * Função: menorDeOrdem
+ * Retorna o valor que estaria na posição "ordem" se os "total" valores
+ * (distintos) estivessem em ordem crescente, sem ordenar tudo: seleção
+ * rápida em O(total) no caso médio (os valores são reorganizados)
+ */
+int menorDeOrdem(int* valores, int total, int ordem) {
+    int esquerda = 0;
+    int direita = total - 1;
+    
+    while (esquerda < direita) {
+        int pivo = valores[esquerda + (direita - esquerda) / 2];
+        int i = esquerda;
+        int j = direita;
+        while (i <= j) {
+            while (valores[i] < pivo) i++;
+            while (valores[j] > pivo) j--;
+            if (i <= j) {
+                int troca = valores[i];
+                valores[i++] = valores[j];
+                valores[j--] = troca;
+            }
+        }
+        if (ordem <= j) {
+            direita = j;
+        } else if (ordem >= i) {
+            esquerda = i;
+        } else {
+            break; // Entre j e i só há valores iguais ao pivô
+        }
+    }
+    return valores[ordem];
+}
+
+/*
+ * Função: escolherDefensor
+ * Escolhe o alvo entre "total" candidatos (em qualquer ordem): sorteado
+ * pela posição em ordem crescente, ou o de maior chance de conquista se
+ * houver tabela (o de menor índice, em caso de empate)
+ */
+int escolherDefensor(const Territorio* mapa, int atacante, TabelaChances* chances, GeradorDados* dados,
+                     int* candidatos, int total) {
+    if (chances == NULL) {
+        return menorDeOrdem(candidatos, total, (int) sortearIntervalo(dados, (uint32_t) total));
+    }
     
-    if (indiceDefensor < 0 || indiceDefensor >= quantidade) {
-        printf("Territorio invalido!\n");
+    int melhor = -1;
+    int menor = candidatos[0];
+    double maiorChance = -1.0;
+    for (int i = 0; i < total; i++) {
+        ChanceBatalha chance;
+        if (candidatos[i] < menor) {
+            menor = candidatos[i];
+        }
+        if (consultarChance(chances, mapa[atacante].tropas, mapa[candidatos[i]].tropas, &chance) &&
+            (chance.vitoria > maiorChance || (chance.vitoria == maiorChance && candidatos[i] < melhor))) {
+            maiorChance = chance.vitoria;
+            melhor = candidatos[i];
+        }
+    }
+    return melhor >= 0 ? melhor : menor;
+}
+
+/*
+ * Função: escolherAtaque
+ * Sorteia um ataque válido para o exército "cor" a partir dos grupos de
+ * jogadas da partida (que precisam estar ativos): um atacante do grupo
+ * da cor e um defensor de outra cor (vizinho do atacante, se o mapa tiver
+ * fronteiras). O sorteio é feito pela posição em ordem crescente de
+ * índice, então a escolha não depende da ordem interna dos grupos
+ * Parâmetros:
+ *   - chances: se informada, o defensor é o alvo com maior chance de
+ *     conquista (em vez de sorteado)
+ *   - candidatos: vetor de rascunho com espaço para todos os territórios
+ * Retorna 1 se encontrou um ataque, 0 se a cor não pode atacar
+ */
+int escolherAtaque(const Jogo* jogo, IdCor cor, GeradorDados* dados, TabelaChances* chances,
+                   int* candidatos, int* atacante, int* defensor) {
+    const JogadasCores* jogadas = &jogo->jogadas;
+    const GrafoAdjacencia* grafo = &jogo->grafo;
+    
+    // Atacantes: o grupo da cor (2+ tropas e, com fronteiras, algum vizinho inimigo)
+    int total = copiarGrupo(jogadas, grupoJogadas(cor, 1), candidatos);
+    if (total == 0) {
+        return 0;
+    }
+    *atacante = menorDeOrdem(candidatos, total, (int) sortearIntervalo(dados, (uint32_t) total));
+    
+    total = 0;
+    if (grafoAtivo(grafo)) {
+        for (uint32_t k = grafo->inicio[*atacante]; k < grafo->inicio[*atacante + 1]; k++) {
+            if (jogo->mapa[grafo->vizinhos[k]].cor != cor) {
+                candidatos[total++] = (int) grafo->vizinhos[k];
+            }
+        }
+    } else {
+        // Sem fronteiras: todos os territórios das outras cores
+        for (int g = 0; g < 2 * jogo->cores.total; g++) {
+            if (g / 2 != cor) {
+                total += copiarGrupo(jogadas, g, candidatos + total);
+            }
+        }
+        if (total == 0) {
+            return 0;
+        }
+    }
+    *defensor = escolherDefensor(jogo->mapa, *atacante, chances, dados, candidatos, total);
+    return 1;
+}
+
+/*
+ * Função: simularPartida
+ * Joga uma partida completa sem interação (tarefa do pool de threads)
+ * Cada partida usa o fluxo de dados "indice + 1" da semente, portanto o
+ * resultado não depende da quantidade de threads
+ */
+void simularPartida(void* contexto, int trabalhador, uint32_t indice) {
+    ContextoSimulacao* ctx = (ContextoSimulacao*) contexto;
+    TrabalhadorSimulacao* estat = &ctx->trabalhadores[trabalhador];
+    Jogo* jogo = &estat->jogo;
+    ResultadoBatalha resultado;
+    
+    // Restaura o estado inicial (o mapa de trabalho é da própria thread)
+    inicializarGerador(&jogo->dados, ctx->semente, (uint64_t) indice + 1);
+    memcpy(jogo->mapa, ctx->inicial->mapa, sizeof(Territorio) * jogo->numTerritorios);
+    jogo->agregados = ctx->inicial->agregados;
+    if (jogo->colunas.donos != NULL) {
+        copiarMapaColunar(&jogo->colunas, &ctx->inicial->colunas);
+    }
+    if (jogo->posse.bits != NULL) {
+        copiarPosse(&jogo->posse, &ctx->inicial->posse);
+    }
+    copiarJogadas(&jogo->jogadas, ctx->jogadas);
+    
+    for (int j = 0; j < ctx->numJogadores; j++) {
+        estat->missoes[j] = (int) sortearIntervalo(&jogo->dados, TOTAL_MISSOES);
+        estat->sorteadas[estat->missoes[j]]++;
+    }
+    estat->partidas++;
+    
+    int semAtaque = 0;  // Turnos seguidos em que ninguém conseguiu atacar
+    for (int turno = 0; turno <= ctx->maxTurnos; turno++) {
+        // Turno 0 apenas verifica missões já cumpridas no mapa inicial
+        if (turno > 0) {
+            const Jogador* jogador = &ctx->jogadores[(turno - 1) % ctx->numJogadores];
+            int atacante, defensor;
+            
+            if (!escolherAtaque(jogo, jogador->cor, &jogo->dados, ctx->chances, estat->candidatos,
+                                &atacante, &defensor)) {
+                if (++semAtaque >= ctx->numJogadores) {
+                    break; // Nenhum jogador consegue mais atacar
+                }
+                continue;
+            }
+            semAtaque = 0;
+            batalharNoJogo(jogo, atacante, defensor, &resultado);
+            estat->batalhas++;
+        }
+        
+        for (int j = 0; j < ctx->numJogadores; j++) {
+            int missao = estat->missoes[j];
+            if (avaliarMissao(&ctx->catalogo[missao], jogo, ctx->jogadores[j].cor)) {
+                int faixa = turno <= 1 ? 0 : 31 - __builtin_clz((unsigned) turno);
+                if (faixa >= FAIXAS_HISTOGRAMA) faixa = FAIXAS_HISTOGRAMA - 1;
+                
+                estat->cumpridas[missao]++;
+                estat->somaTurnos[missao] += turno;
+                estat->histograma[missao][faixa]++;
+                return;
+            }
+        }
+    }
+    
+    estat->semVencedor++;
+}
+
+/*
+ * Função: executarSimulacao
+ * Joga "partidas" partidas aleatórias em todos os núcleos e exibe a chance
+ * de cada missão ser cumprida e quantos turnos isso leva
+ */
+void executarSimulacao(const Jogo* jogo, const Jogador* jogadores, int numJogadores,
+                       const Missao catalogo[], long long partidas, int maxTurnos,
+                       int numThreads, uint64_t semente, TabelaChances* chances) {
+    int numTerritorios = jogo->numTerritorios;
+    
+    if (numThreads <= 0) numThreads = contarNucleos();
+    if (numThreads > MAX_TRABALHADORES) numThreads = MAX_TRABALHADORES;
+    if (partidas > UINT32_MAX) partidas = UINT32_MAX;
+    
+    // Grupos de jogadas do mapa inicial: montados uma vez e copiados no início de cada partida
+    Jogo modelo = *jogo;
+    if (!criarJogadas(&modelo.jogadas, numTerritorios)) {
+        printf("Erro ao alocar memoria para o simulador!\n");
         return;
     }
+    montarJogadas(&modelo);
     
-    if (indiceAtacante == indiceDefensor) {
-        printf("Um territorio nao pode atacar a si mesmo!\n");
+    TrabalhadorSimulacao* trabalhadores =
+        (TrabalhadorSimulacao*) aligned_alloc(64, sizeof(TrabalhadorSimulacao) * numThreads);
+    if (trabalhadores == NULL) {
+        printf("Erro ao alocar memoria para o simulador!\n");
+        liberarJogadas(&modelo.jogadas);
         return;
     }
+    memset(trabalhadores, 0, sizeof(TrabalhadorSimulacao) * numThreads);
+    
+    for (int t = 0; t < numThreads; t++) {
+        trabalhadores[t].jogo = *jogo; // Copia cores, dimensões, fronteiras, continentes e nomes; o mapa é próprio
+        memset(&trabalhadores[t].jogo.busca, 0, sizeof(BuscaGrafo));
+        memset(&trabalhadores[t].jogo.colunas, 0, sizeof(MapaColunar));
+        memset(&trabalhadores[t].jogo.posse, 0, sizeof(PosseCores));
+        memset(&trabalhadores[t].jogo.jogadas, 0, sizeof(JogadasCores));
+        // Uma arena por thread: as partidas só reescrevem o que já foi reservado
+        Arena* arena = criarArena(tamanhoReserva(sizeof(Territorio) * numTerritorios) +
+                                  tamanhoReserva(sizeof(int) * numTerritorios) +
+                                  tamanhoReserva(sizeof(int) * numJogadores));
+        trabalhadores[t].arena = arena;
+        trabalhadores[t].jogo.mapa = (Territorio*) reservarArena(arena, sizeof(Territorio) * numTerritorios);
+        trabalhadores[t].jogo.mapaExterno = 1;
+        trabalhadores[t].candidatos = (int*) reservarArena(arena, sizeof(int) * numTerritorios);
+        trabalhadores[t].missoes = (int*) reservarArena(arena, sizeof(int) * numJogadores);
+        if (arena == NULL ||
+            (jogo->colunas.donos != NULL && !criarMapaColunar(&trabalhadores[t].jogo.colunas, numTerritorios)) ||
+            (jogo->posse.bits != NULL &&
+             !criarPosse(&trabalhadores[t].jogo.posse, numTerritorios, (int) jogo->posse.linhas)) ||
+            !criarJogadas(&trabalhadores[t].jogo.jogadas, numTerritorios)) {
+            printf("Erro ao alocar memoria para o simulador!\n");
+            numThreads = t + 1;
+            goto liberar;
+        }
+    }
     
-    if (strcmp(mapa[indiceAtacante].cor, mapa[indiceDefensor].cor) == 0) {
-        printf("Nao e possivel atacar um territorio da mesma cor!\n");
+    ContextoSimulacao contexto = {
+        jogo, jogadores, numJogadores, catalogo, semente, maxTurnos, chances, &modelo.jogadas, trabalhadores
+    };
+    
+    printf("\n========================================\n");
+    printf("      SIMULADOR MONTE CARLO\n");
+    printf("========================================\n");
+    printf("Partidas: %lld | Limite de turnos: %d | Threads: %d\n",
+           partidas, maxTurnos, numThreads);
+    
+    struct timespec inicio, fim;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    executarEmParalelo((uint32_t) partidas, numThreads, simularPartida, &contexto);
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    double segundos = (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+    
+    // Junta os histogramas de cada thread (fora do caminho quente)
+    TrabalhadorSimulacao total;
+    memset(&total, 0, sizeof(total));
+    for (int t = 0; t < numThreads; t++) {
+        total.partidas += trabalhadores[t].partidas;
+        total.semVencedor += trabalhadores[t].semVencedor;
+        total.batalhas += trabalhadores[t].batalhas;
+        for (int m = 0; m < TOTAL_MISSOES; m++) {
+            total.sorteadas[m] += trabalhadores[t].sorteadas[m];
+            total.cumpridas[m] += trabalhadores[t].cumpridas[m];
+            total.somaTurnos[m] += trabalhadores[t].somaTurnos[m];
+            for (int f = 0; f < FAIXAS_HISTOGRAMA; f++) {
+                total.histograma[m][f] += trabalhadores[t].histograma[m][f];
+            }
+        }
+    }
+    
+    contarMetrica(CONTADOR_PARTIDAS_SIMULADAS, (uint64_t) total.partidas);
+    contarMetrica(CONTADOR_BATALHAS_SIMULADAS, (uint64_t) total.batalhas);
+    
+    printf("Tempo: %.3f s (%.0f partidas/s)\n", segundos,
+           segundos > 0 ? total.partidas / segundos : 0.0);
+    printf("Partidas sem vencedor: %lld (%.2f%%)\n", total.semVencedor,
+           total.partidas > 0 ? 100.0 * total.semVencedor / total.partidas : 0.0);
+    
+    for (int m = 0; m < TOTAL_MISSOES; m++) {
+        printf("----------------------------------------\n");
+        char texto[100];
+        descreverMissao(&catalogo[m], &jogo->cores, &jogo->continentes, texto, sizeof(texto));
+        printf("Missao %d: %s\n", m + 1, texto);
+        printf("  Sorteada: %lld | Cumprida: %lld (%.2f%%)\n",
+               total.sorteadas[m], total.cumpridas[m],
+               total.sorteadas[m] > 0 ? 100.0 * total.cumpridas[m] / total.sorteadas[m] : 0.0);
+        if (total.cumpridas[m] == 0) {
+            continue;
+        }
+        printf("  Turnos ate a vitoria (media): %.1f\n",
+               (double) total.somaTurnos[m] / total.cumpridas[m]);
+        for (int f = 0; f < FAIXAS_HISTOGRAMA; f++) {
+            if (total.histograma[m][f] > 0) {
+                long long de = f == 0 ? 0 : 1LL << f;
+                printf("    %lld-%lld turnos: %lld\n", de, (2LL << f) - 1, total.histograma[m][f]);
+            }
+        }
+    }
+    printf("========================================\n");
+    
+liberar:
+    for (int t = 0; t < numThreads; t++) {
+        liberarBusca(&trabalhadores[t].jogo.busca);
+        liberarMapaColunar(&trabalhadores[t].jogo.colunas);
+        liberarPosse(&trabalhadores[t].jogo.posse);
+        liberarJogadas(&trabalhadores[t].jogo.jogadas);
+        liberarArena(trabalhadores[t].arena);
+    }
+    free(trabalhadores);
+    liberarJogadas(&modelo.jogadas);
+}
+
+/*
+ * Função: estimarCombates
+ * Resolve "combates" combates independentes de cada combinação de dados
+ * da regra clássica (3x2 até 1x1), em lotes, e exibe a frequência de cada
+ * desfecho (perdas do atacante x perdas do defensor)
+ */
+void estimarCombates(long long combates, GeradorDados* dados) {
+    LoteRolagens lote;
+    
+    if (!criarLoteRolagens(&lote, COMBATES_POR_LOTE)) {
+        printf("Erro ao alocar memoria para os combates!\n");
         return;
     }
     
-    atacar(&mapa[indiceAtacante], &mapa[indiceDefensor]);
+    printf("========================================\n");
+    printf("   COMBATES DA REGRA CLASSICA (LOTES)\n");
+    printf("========================================\n");
+    printf("Combates por combinacao: %lld\n", combates);
     
-    printf("\nEstado apos o ataque:\n");
-    printf("Atacante - %s: %d tropas (%s)\n", 
-           mapa[indiceAtacante].nome, mapa[indiceAtacante].tropas, 
-           mapa[indiceAtacante].cor);
-    printf("Defensor - %s: %d tropas (%s)\n", 
-           mapa[indiceDefensor].nome, mapa[indiceDefensor].tropas, 
-           mapa[indiceDefensor].cor);
+    struct timespec inicio, fim;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    for (int a = DADOS_ATAQUE; a >= 1; a--) {
+        for (int d = DADOS_DEFESA; d >= 1; d--) {
+            long long desfechos[DADOS_DEFESA + 1] = { 0 };  // Indexado pelas perdas do defensor
+            for (long long feitos = 0; feitos < combates; feitos += COMBATES_POR_LOTE) {
+                int n = combates - feitos < COMBATES_POR_LOTE ? (int) (combates - feitos) : COMBATES_POR_LOTE;
+                sortearLote(&lote, a, d, n, dados);
+                resolverRolagens(&lote);
+                for (int i = 0; i < n; i++) {
+                    desfechos[lote.perdasDefensor[i]]++;
+                }
+            }
+            
+            int pares = a < d ? a : d;
+            printf("----------------------------------------\n");
+            printf("%d dado(s) contra %d:\n", a, d);
+            for (int perdas = pares; perdas >= 0; perdas--) {
+                printf("  Atacante perde %d, defensor perde %d: %.2f%%\n", pares - perdas, perdas,
+                       100.0 * desfechos[perdas] / combates);
+            }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    double segundos = (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+    
+    printf("----------------------------------------\n");
+    printf("Tempo: %.3f s (%.0f combates/s)\n", segundos,
+           segundos > 0 ? 6.0 * combates / segundos : 0.0);
+    printf("========================================\n");
+    liberarLoteRolagens(&lote);
 }
 
 /*
- * Função: liberarMemoria
- * Libera toda a memória alocada dinamicamente
+ * Função: benchAtacar
+ * Caso "atacar": ataques completos (batalha e relatório) entre os pares
+ * (2k, 2k+1) do mapa, em rodízio; um par que não pode mais atacar é
+ * reabastecido (raro: os atacantes começam com TROPAS_BENCHMARK tropas)
  */
-void liberarMemoria(Territorio* mapa, Jogador* jogadores, int numJogadores) {
-    // Libera as missões de cada jogador
-    for (int i = 0; i < numJogadores; i++) {
-        if (jogadores[i].missao != NULL) {
-            free(jogadores[i].missao);
-            jogadores[i].missao = NULL;
+void benchAtacar(void* contexto, long long operacoes) {
+    ContextoBenchmark* ctx = (ContextoBenchmark*) contexto;
+    Jogo* jogo = &ctx->jogo;
+    int pares = jogo->numTerritorios / 2;
+    
+    for (long long i = 0; i < operacoes; i++) {
+        int atacante = 2 * ctx->proximoPar;
+        int defensor = atacante + 1;
+        if (++ctx->proximoPar == pares) {
+            ctx->proximoPar = 0;
         }
+        if (validarAtaqueNoJogo(jogo, atacante, defensor) != ATAQUE_OK) {
+            retirarDaBatalha(jogo, atacante, defensor);
+            jogo->mapa[atacante].tropas = TROPAS_BENCHMARK;
+            jogo->mapa[defensor].cor = (IdCor) ((jogo->mapa[atacante].cor + 1) % CORES_BENCHMARK);
+            if (jogo->mapa[defensor].tropas < 1) {
+                jogo->mapa[defensor].tropas = 1;
+            }
+            devolverDaBatalha(jogo, atacante, defensor);
+        }
+        atacar(jogo, atacante, defensor, NULL, 1, NULL, &ctx->tela);
     }
+}
+
+/*
+ * Função: benchAvaliarMissao
+ * Caso "avaliarMissao/N": avalia a missão N do catálogo para cada jogador
+ */
+void benchAvaliarMissao(void* contexto, long long operacoes) {
+    ContextoBenchmark* ctx = (ContextoBenchmark*) contexto;
+    const Missao* missao = &ctx->catalogo[ctx->missao];
+    volatile int cumpridas = 0;  // Impede que o compilador descarte as avaliações
     
-    // Libera o vetor de jogadores
-    if (jogadores != NULL) {
+    for (long long i = 0; i < operacoes; i++) {
+        cumpridas += avaliarMissao(missao, &ctx->jogo, ctx->jogadores[i % JOGADORES_BENCHMARK].cor);
+    }
+}
+
+/*
+ * Função: benchVerificarVitoria
+ * Caso "verificarVitoria": verificação completa (com o relatório) de todos os jogadores
+ */
+void benchVerificarVitoria(void* contexto, long long operacoes) {
+    ContextoBenchmark* ctx = (ContextoBenchmark*) contexto;
+    
+    for (long long i = 0; i < operacoes; i++) {
+        verificarVitoria(ctx->jogadores, JOGADORES_BENCHMARK, &ctx->jogo);
+    }
+}
+
+/*
+ * Função: benchExibirTerritorios
+ * Caso "exibirTerritorios": o mapa inteiro montado na tela e enviado ao stdout
+ * (que aponta para /dev/null durante a medição)
+ */
+void benchExibirTerritorios(void* contexto, long long operacoes) {
+    ContextoBenchmark* ctx = (ContextoBenchmark*) contexto;
+    
+    for (long long i = 0; i < operacoes; i++) {
+        exibirTerritorios(&ctx->jogo, &ctx->tela);
+    }
+}
+
+/*
+ * Função: benchCarregarMapa
+ * Casos "carregarMapaCSV" e "carregarMapaBinario": carga e liberação do arquivo gravado
+ */
+void benchCarregarMapa(void* contexto, long long operacoes) {
+    ContextoBenchmark* ctx = (ContextoBenchmark*) contexto;
+    Jogo jogo;
+    
+    for (long long i = 0; i < operacoes; i++) {
+        inicializarJogo(&jogo, ctx->semente);
+        if (carregarMapa(ctx->arquivoMapa, &jogo) == CARGA_OK) {
+            liberarMapa(&jogo);
+        }
+    }
+}
+
+/*
+ * Função: benchPartidas
+ * Caso "partidaSimulada": partidas completas no simulador (todas as threads)
+ */
+void benchPartidas(void* contexto, long long operacoes) {
+    ContextoBenchmark* ctx = (ContextoBenchmark*) contexto;
+    
+    executarSimulacao(&ctx->jogo, ctx->jogadores, JOGADORES_BENCHMARK, ctx->catalogo, operacoes, 1000,
+                      ctx->numThreads, ctx->semente, NULL);
+}
+
+/*
+ * Função: executarBenchmarks
+ * Mede cada caso em mapas sintéticos de 10, 1 mil, 100 mil e 10 milhões de
+ * territórios (até "maximoTerritorios"), exibe uma linha por caso e grava o
+ * relatório JSON em "arquivoJson"
+ * Retorna 1 em caso de sucesso, 0 em caso de erro
+ */
+int executarBenchmarks(const char* arquivoJson, long long maximoTerritorios, double tempoMinimo,
+                       int numThreads, RegraBatalha regra, uint64_t semente) {
+    static const int TAMANHOS[] = { 10, 1000, 100000, 10000000 };
+    RelatorioBenchmark relatorio;
+    ContextoBenchmark ctx;
+    Missao catalogo[TOTAL_MISSOES];
+    char arquivoMapa[] = "/tmp/war_benchmark_XXXXXX";
+    int ok = 1;
+    
+    if (numThreads <= 0) numThreads = contarNucleos();
+    if (tempoMinimo <= 0) tempoMinimo = 0.2;
+    
+    int fd = mkstemp(arquivoMapa);
+    if (fd < 0 || !criarRelatorio(&relatorio, tempoMinimo)) {
+        printf("Erro ao preparar os arquivos do benchmark!\n");
+        if (fd >= 0) {
+            close(fd);
+            unlink(arquivoMapa);
+        }
+        return 0;
+    }
+    close(fd);
+    
+    printf("========================================\n");
+    printf("      BENCHMARK DO MOTOR\n");
+    printf("========================================\n");
+    printf("Tempo minimo por caso: %.0f ms | Threads: %d | Alocacoes: %s\n",
+           tempoMinimo * 1000, numThreads, CONTAGEM_ALOCACOES ? "contadas" : "indisponiveis (binario sem -DWAR_CONTAR_ALOCACOES)");
+    
+    for (size_t t = 0; t < sizeof(TAMANHOS) / sizeof(TAMANHOS[0]) && ok; t++) {
+        int tamanho = TAMANHOS[t];
+        if (tamanho > maximoTerritorios) {
+            break;
+        }
+        
+        memset(&ctx, 0, sizeof(ctx));
+        inicializarJogo(&ctx.jogo, semente);
+        ctx.jogo.regra = regra;
+        ctx.catalogo = catalogo;
+        ctx.arquivoMapa = arquivoMapa;
+        ctx.numThreads = numThreads;
+        ctx.semente = semente;
+        if (!gerarMapaBenchmark(&ctx.jogo, tamanho) || !criarTela(&ctx.tela, tamanho)) {
+            printf("Erro ao alocar memoria para o mapa de %d territorios!\n", tamanho);
+            liberarMapa(&ctx.jogo);
+            ok = 0;
+            break;
+        }
+        compilarCatalogo(&ctx.jogo.cores, catalogo);
+        for (int j = 0; j < JOGADORES_BENCHMARK; j++) {
+            snprintf(ctx.jogadores[j].nome, sizeof(ctx.jogadores[j].nome), "Jogador %d", j + 1);
+            ctx.jogadores[j].cor = (IdCor) j;
+            ctx.jogadores[j].missao = catalogo[j % TOTAL_MISSOES];
+        }
+        printf("----------------------------------------\n");
+        
+        // Casos que não alteram o mapa vêm antes dos ataques
+        const ResultadoBenchmark* r = NULL;
+        for (ctx.missao = 0; ctx.missao < TOTAL_MISSOES; ctx.missao++) {
+            char nome[TAM_NOME_BENCHMARK];
+            snprintf(nome, sizeof(nome), "avaliarMissao/%d", ctx.missao + 1);
+            if ((r = medirBenchmark(&relatorio, nome, tamanho, 0, benchAvaliarMissao, &ctx)) != NULL) {
+                exibirResultadoBenchmark(r);
+            }
+        }
+        if ((r = medirBenchmark(&relatorio, "verificarVitoria", tamanho, 0, benchVerificarVitoria, &ctx)) != NULL) {
+            exibirResultadoBenchmark(r);
+        }
+        if (tamanho <= LIMITE_TEXTO_BENCHMARK &&
+            (r = medirBenchmark(&relatorio, "exibirTerritorios", tamanho, 0, benchExibirTerritorios, &ctx)) != NULL) {
+            exibirResultadoBenchmark(r);
+        }
+        
+        // Carga: o mesmo mapa gravado em CSV e no formato binário
+        FILE* csv = tamanho <= LIMITE_TEXTO_BENCHMARK ? fopen(arquivoMapa, "w") : NULL;
+        if (csv != NULL) {
+            for (int i = 0; i < tamanho; i++) {
+                fprintf(csv, "%s,%s,%d\n", nomeTerritorio(&ctx.jogo, i), nomeCor(&ctx.jogo.cores, ctx.jogo.mapa[i].cor),
+                        ctx.jogo.mapa[i].tropas);
+            }
+            if (fclose(csv) == 0 &&
+                (r = medirBenchmark(&relatorio, "carregarMapaCSV", tamanho, 0, benchCarregarMapa, &ctx)) != NULL) {
+                exibirResultadoBenchmark(r);
+            }
+        }
+        if (salvarMapaBinario(arquivoMapa, &ctx.jogo) == CARGA_OK &&
+            (r = medirBenchmark(&relatorio, "carregarMapaBinario", tamanho, 0, benchCarregarMapa, &ctx)) != NULL) {
+            exibirResultadoBenchmark(r);
+        }
+        
+        // Partidas completas (macro), a partir do mapa sorteado
+        if (tamanho <= LIMITE_PARTIDAS_BENCHMARK &&
+            (r = medirBenchmark(&relatorio, "partidaSimulada", tamanho, UINT32_MAX, benchPartidas, &ctx)) != NULL) {
+            exibirResultadoBenchmark(r);
+        }
+        
+        // Ataques: cada par (2k, 2k+1) recebe cores diferentes e tropas de sobra
+        for (int i = 0; i + 1 < tamanho; i += 2) {
+            ctx.jogo.mapa[i].tropas = TROPAS_BENCHMARK;
+            if (ctx.jogo.mapa[i + 1].cor == ctx.jogo.mapa[i].cor) {
+                ctx.jogo.mapa[i + 1].cor = (IdCor) ((ctx.jogo.mapa[i].cor + 1) % CORES_BENCHMARK);
+            }
+        }
+        recalcularAgregados(&ctx.jogo);
+        if ((r = medirBenchmark(&relatorio, "atacar", tamanho, 0, benchAtacar, &ctx)) != NULL) {
+            exibirResultadoBenchmark(r);
+        }
+        
+        liberarTela(&ctx.tela);
+        liberarMapa(&ctx.jogo);
+    }
+    unlink(arquivoMapa);
+    
+    printf("========================================\n");
+    if (ok && !escreverRelatorioJSON(&relatorio, arquivoJson, semente, numThreads)) {
+        printf("Erro ao gravar o relatorio '%s'.\n", arquivoJson);
+        ok = 0;
+    } else if (ok) {
+        printf("Relatorio gravado em '%s' (%d casos).\n", arquivoJson, relatorio.total);
+    }
+    liberarRelatorio(&relatorio);
+    return ok;
+}
+
+/*
+ * Função: prepararContinentes
+ * Carrega os continentes do arquivo para o mapa atual e informa o resultado
+ * Retorna 1 em caso de sucesso, 0 em caso de erro (já informado)
+ */
+int prepararContinentes(const char* arquivo, Jogo* jogo) {
+    CodigoCarga codigo = carregarContinentesCSV(arquivo, jogo);
+    if (codigo != CARGA_OK) {
+        printf("Erro ao carregar os continentes '%s': %s\n", arquivo, mensagemCarga(codigo));
+        return 0;
+    }
+    printf("Continentes carregados: %d.\n", jogo->continentes.total);
+    return 1;
+}
+
+/*
+ * Função: liberarMemoria
+ * Libera toda a memória alocada dinamicamente
+ * (as missões ficam dentro de cada Jogador e não precisam ser liberadas;
+ * o que foi reservado na arena sai junto com ela)
+ */
+void liberarMemoria(Jogo* jogo, Jogador* jogadores, Arena* arena) {
+    // Libera o vetor de jogadores (carregado de arquivo)
+    if (jogadores != NULL && !arenaContem(arena, jogadores)) {
         free(jogadores);
         jogadores = NULL;
     }
     
-    // Libera o vetor de territórios
-    if (mapa != NULL) {
-        free(mapa);
-        mapa = NULL;
+    // Libera o vetor de territórios (alocado ou mapeado do arquivo)
+    if (jogo->mapa != NULL) {
+        liberarMapa(jogo);
+    }
+    
+    // Devolve a arena da partida digitada
+    liberarArena(arena);
+}
+
+/*
+ * Função: lerCor
+ * Lê o nome de uma cor do teclado e devolve o seu ID na tabela de cores
+ */
+IdCor lerCor(TabelaCores* cores) {
+    char nome[TAM_COR] = "";
+    
+    fgets(nome, TAM_COR, stdin);
+    nome[strcspn(nome, "\n")] = '\0';
+    
+    IdCor id = internarCor(cores, nome);
+    if (id == COR_INVALIDA) {
+        printf("Limite de %d cores atingido! Encerrando programa.\n", MAX_CORES);
+        exit(1);
+    }
+    return id;
+}
+
+/*
+ * Função: lerTerritorio
+ * Lê do teclado o número (a partir de 1) ou o nome de um território;
+ * um começo de nome serve se só um território começa com ele
+ * Retorna o índice em base 0 ou -1 (com as opções, se o começo é ambíguo)
+ */
+int lerTerritorio(const Jogo* jogo) {
+    char linha[64];
+    size_t tamanho = 0;
+    const char* texto = linha;
+    
+    // Como scanf("%d"), pula linhas em branco
+    while (tamanho == 0) {
+        if (fgets(linha, sizeof(linha), stdin) == NULL) {
+            return -1;
+        }
+        if (strchr(linha, '\n') == NULL) {
+            limparBuffer(); // Linha longa demais para um nome
+        }
+        texto = linha;
+        while (*texto == ' ' || *texto == '\t') texto++;
+        tamanho = strcspn(texto, "\r\n");
+        while (tamanho > 0 && (texto[tamanho - 1] == ' ' || texto[tamanho - 1] == '\t')) tamanho--;
+    }
+    
+    char* fim;
+    long numero = strtol(texto, &fim, 10);
+    if (fim == texto + tamanho) {
+        return numero >= 1 && numero <= jogo->numTerritorios ? (int) numero - 1 : -1;
+    }
+    
+    int territorio = buscarTerritorioPorNome(jogo, texto, tamanho);
+    int inicio, final;
+    if (territorio >= 0 || faixaPrefixo(jogo, texto, tamanho, &inicio, &final) <= 0) {
+        return territorio;
+    }
+    if (final - inicio == 1) {
+        return (int) jogo->nomes.ordem[inicio];
+    }
+    
+    printf("%d territorios comecam com '%.*s':\n", final - inicio, (int) tamanho, texto);
+    for (int k = inicio; k < final && k < inicio + MAX_SUGESTOES_NOME; k++) {
+        int i = (int) jogo->nomes.ordem[k];
+        printf("  %d. %s (%s) - %d tropas\n", i + 1, nomeTerritorio(jogo, i),
+               nomeCor(&jogo->cores, jogo->mapa[i].cor), jogo->mapa[i].tropas);
+    }
+    return -1;
+}
+
+/*
+ * Função: lerSemente
+ * Lê a semente do gerador de dados da opção "--semente N"; sem a opção,
+ * usa o horário atual. A semente é exibida para permitir repetir a partida
+ */
+uint64_t lerSemente(int argc, char* argv[]) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--semente") == 0) {
+            return strtoull(argv[i + 1], NULL, 10);
+        }
+    }
+    return (uint64_t) time(NULL);
+}
+
+/*
+ * Função: lerOpcao
+ * Lê o valor inteiro de uma opção "nome N" da linha de comando
+ * Retorna "padrao" se a opção não foi informada
+ */
+long long lerOpcao(int argc, char* argv[], const char* nome, long long padrao) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], nome) == 0) {
+            return strtoll(argv[i + 1], NULL, 10);
+        }
     }
+    return padrao;
+}
+
+/*
+ * Função: lerTextoOpcao
+ * Procura "nome valor" na linha de comando e retorna o valor ou NULL
+ */
+const char* lerTextoOpcao(int argc, char* argv[], const char* nome) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], nome) == 0) {
+            return argv[i + 1];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Função: lerBandeira
+ * Retorna 1 se a opção "nome" (sem valor) aparece na linha de comando
+ */
+int lerBandeira(int argc, char* argv[], const char* nome) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], nome) == 0) {
+            return 1;
+        }
+    }
+    return 0;
 }
 
 /*
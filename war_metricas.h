@@ -0,0 +1,391 @@
+/*
+ * Métricas de Execução do Sistema WAR
+ *
+ * Contadores (turnos, batalhas por desfecho, comandos, sessões, partidas
+ * simuladas, bytes enviados) e histogramas de latência das entradas do
+ * jogo (batalha, verificação de vitória, comando e escrita da saída),
+ * ligados por "--metricas arquivo". Uma thread grava o arquivo a cada
+ * "--metricas-intervalo" segundos no formato texto do Prometheus (ou em
+ * JSON, se o nome termina em ".json"); o comando "metricas" do protocolo
+ * responde o mesmo conteúdo em JSON.
+ *
+ * Para custar menos de 1% mesmo nos comandos mais curtos:
+ *   - desligadas, cada ponto de medida é um único teste de "ativas";
+ *   - só a thread do jogo escreve nos contadores (o simulador soma os
+ *     totais das suas threads ao final), então cada incremento é uma
+ *     leitura e uma escrita relaxadas, sem instrução travada; a thread
+ *     de exportação apenas lê;
+ *   - apenas 1 em cada AMOSTRAGEM_METRICAS medidas consulta o relógio,
+ *     então os histogramas são amostras (os contadores são exatos).
+ */
+
+#ifndef WAR_METRICAS_H
+#define WAR_METRICAS_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "war_engine.h"
+
+// Uma medida de latência a cada AMOSTRAGEM_METRICAS (potência de 2)
+#define AMOSTRAGEM_METRICAS 64
+
+// Faixas dos histogramas: a faixa i guarda latências de 2^i a 2^(i+1) - 1 ns
+// (a última também recebe tudo o que passa de ~2 s)
+#define FAIXAS_LATENCIA 32
+
+typedef enum {
+    CONTADOR_TURNOS = 0,
+    CONTADOR_VITORIAS_ATACANTE,   // Batalhas em que só o defensor perdeu tropas
+    CONTADOR_VITORIAS_DEFENSOR,   // Batalhas em que só o atacante perdeu tropas
+    CONTADOR_BATALHAS_DIVIDIDAS,  // Perdas dos dois lados (regra clássica)
+    CONTADOR_CONQUISTAS,
+    CONTADOR_COMANDOS,
+    CONTADOR_SESSOES,
+    CONTADOR_PARTIDAS_SIMULADAS,
+    CONTADOR_BATALHAS_SIMULADAS,
+    CONTADOR_BYTES_SAIDA,
+    TOTAL_CONTADORES
+} TipoContador;
+
+typedef enum {
+    LATENCIA_BATALHA = 0,   // Resolução de um ataque (dados ou relâmpago)
+    LATENCIA_VITORIA,       // Verificação das missões de todos os jogadores
+    LATENCIA_COMANDO,       // Um comando do protocolo, do texto à resposta
+    LATENCIA_SAIDA,         // Escrita das respostas/telas no descritor
+    TOTAL_LATENCIAS
+} TipoLatencia;
+
+// Nomes dos contadores e dos histogramas na exportação
+static const char* const NOMES_CONTADORES[TOTAL_CONTADORES] = {
+    "turnos", "vitorias_atacante", "vitorias_defensor", "batalhas_divididas", "conquistas",
+    "comandos", "sessoes", "partidas_simuladas", "batalhas_simuladas", "bytes_saida"
+};
+static const char* const NOMES_LATENCIAS[TOTAL_LATENCIAS] = {
+    "batalha", "vitoria", "comando", "saida"
+};
+
+typedef struct {
+    _Atomic uint64_t contadores[TOTAL_CONTADORES];
+    _Atomic uint64_t faixas[TOTAL_LATENCIAS][FAIXAS_LATENCIA];
+    _Atomic uint64_t somaNs[TOTAL_LATENCIAS];
+    _Atomic int64_t sessoesAbertas;
+    int ativas;                // 1 depois de ativarMetricas()
+    uint32_t amostra;          // Medidas iniciadas (escolhe as amostradas)
+    struct timespec inicio;    // Ativação (tempo de execução exportado)
+
+    // Exportação periódica
+    pthread_t thread;
+    pthread_mutex_t trava;
+    pthread_cond_t sinal;
+    char caminho[256];
+    int intervalo;             // Segundos entre gravações
+    int json;                  // 1 = JSON, 0 = texto do Prometheus
+    int exportando;            // 1 enquanto a thread existe
+    int encerrar;
+} Metricas;
+
+static Metricas metricas;
+
+// ==================== PONTOS DE MEDIDA ====================
+
+/*
+ * Função: relogioNs
+ * Relógio monotônico em nanossegundos
+ */
+static inline uint64_t relogioNs(void) {
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return (uint64_t) agora.tv_sec * 1000000000ULL + (uint64_t) agora.tv_nsec;
+}
+
+/*
+ * Função: somarValor
+ * Soma "valor" a um contador que só a thread do jogo escreve
+ */
+static inline void somarValor(_Atomic uint64_t* contador, uint64_t valor) {
+    atomic_store_explicit(contador, atomic_load_explicit(contador, memory_order_relaxed) + valor,
+                          memory_order_relaxed);
+}
+
+/*
+ * Função: contarMetrica
+ * Soma "valor" ao contador, se as métricas estiverem ativas
+ */
+static inline void contarMetrica(TipoContador contador, uint64_t valor) {
+    if (metricas.ativas) {
+        somarValor(&metricas.contadores[contador], valor);
+    }
+}
+
+/*
+ * Função: iniciarMedida
+ * Início de uma medida de latência: retorna o relógio se esta chamada foi
+ * escolhida pela amostragem, ou 0 (nada a medir)
+ */
+static inline uint64_t iniciarMedida(void) {
+    if (!metricas.ativas || (++metricas.amostra & (AMOSTRAGEM_METRICAS - 1)) != 0) {
+        return 0;
+    }
+    return relogioNs();
+}
+
+/*
+ * Função: encerrarMedida
+ * Registra no histograma "tipo" o tempo desde iniciarMedida()
+ */
+static inline void encerrarMedida(TipoLatencia tipo, uint64_t inicio) {
+    if (inicio == 0) {
+        return;
+    }
+    uint64_t ns = relogioNs() - inicio;
+    int faixa = 63 - __builtin_clzll(ns | 1);
+    if (faixa >= FAIXAS_LATENCIA) {
+        faixa = FAIXAS_LATENCIA - 1;
+    }
+    somarValor(&metricas.faixas[tipo][faixa], 1);
+    somarValor(&metricas.somaNs[tipo], ns);
+}
+
+/*
+ * Função: contarBatalha
+ * Conta o desfecho de uma batalha resolvida
+ */
+static inline void contarBatalha(const ResultadoBatalha* resultado) {
+    if (!metricas.ativas) {
+        return;
+    }
+    if (resultado->perdasAtacante > 0 && resultado->perdasDefensor > 0) {
+        somarValor(&metricas.contadores[CONTADOR_BATALHAS_DIVIDIDAS], 1);
+    } else if (resultado->perdasAtacante > 0) {
+        somarValor(&metricas.contadores[CONTADOR_VITORIAS_DEFENSOR], 1);
+    } else {
+        somarValor(&metricas.contadores[CONTADOR_VITORIAS_ATACANTE], 1);
+    }
+    if (resultado->conquistou) {
+        somarValor(&metricas.contadores[CONTADOR_CONQUISTAS], 1);
+    }
+}
+
+/*
+ * Função: mudarSessoesAbertas
+ * Soma "variacao" às sessões abertas (e conta as novas)
+ */
+static inline void mudarSessoesAbertas(int variacao) {
+    if (!metricas.ativas) {
+        return;
+    }
+    atomic_store_explicit(&metricas.sessoesAbertas,
+                          atomic_load_explicit(&metricas.sessoesAbertas, memory_order_relaxed) + variacao,
+                          memory_order_relaxed);
+    if (variacao > 0) {
+        somarValor(&metricas.contadores[CONTADOR_SESSOES], (uint64_t) variacao);
+    }
+}
+
+// ==================== EXPORTAÇÃO ====================
+
+/*
+ * Função: memoriaResidente
+ * Bytes do processo residentes na memória (0 se /proc não está disponível)
+ */
+static inline uint64_t memoriaResidente(void) {
+    unsigned long long paginas = 0, residentes = 0;
+    FILE* arquivo = fopen("/proc/self/statm", "r");
+    if (arquivo == NULL) {
+        return 0;
+    }
+    if (fscanf(arquivo, "%llu %llu", &paginas, &residentes) != 2) {
+        residentes = 0;
+    }
+    fclose(arquivo);
+    return (uint64_t) residentes * (uint64_t) sysconf(_SC_PAGESIZE);
+}
+
+/*
+ * Função: segundosAtivas
+ * Segundos desde a ativação das métricas
+ */
+static inline double segundosAtivas(void) {
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return (agora.tv_sec - metricas.inicio.tv_sec) + (agora.tv_nsec - metricas.inicio.tv_nsec) / 1e9;
+}
+
+/*
+ * Função: escreverMetricasPrometheus
+ * Escreve as métricas no formato texto do Prometheus
+ */
+static inline void escreverMetricasPrometheus(FILE* saida) {
+    fprintf(saida, "# TYPE war_ativo_segundos gauge\nwar_ativo_segundos %.3f\n", segundosAtivas());
+    fprintf(saida, "# TYPE war_memoria_residente_bytes gauge\nwar_memoria_residente_bytes %llu\n",
+            (unsigned long long) memoriaResidente());
+    fprintf(saida, "# TYPE war_sessoes_abertas gauge\nwar_sessoes_abertas %lld\n",
+            (long long) atomic_load_explicit(&metricas.sessoesAbertas, memory_order_relaxed));
+    for (int c = 0; c < TOTAL_CONTADORES; c++) {
+        fprintf(saida, "# TYPE war_%s_total counter\nwar_%s_total %llu\n", NOMES_CONTADORES[c],
+                NOMES_CONTADORES[c],
+                (unsigned long long) atomic_load_explicit(&metricas.contadores[c], memory_order_relaxed));
+    }
+
+    fprintf(saida, "# HELP war_latencia_segundos Latencia amostrada (1 em %d medidas)\n"
+                   "# TYPE war_latencia_segundos histogram\n", AMOSTRAGEM_METRICAS);
+    for (int l = 0; l < TOTAL_LATENCIAS; l++) {
+        unsigned long long acumulado = 0;
+        for (int f = 0; f < FAIXAS_LATENCIA - 1; f++) {
+            acumulado += atomic_load_explicit(&metricas.faixas[l][f], memory_order_relaxed);
+            fprintf(saida, "war_latencia_segundos_bucket{operacao=\"%s\",le=\"%.9f\"} %llu\n",
+                    NOMES_LATENCIAS[l], (double) ((2ULL << f) - 1) / 1e9, acumulado);
+        }
+        acumulado += atomic_load_explicit(&metricas.faixas[l][FAIXAS_LATENCIA - 1], memory_order_relaxed);
+        fprintf(saida, "war_latencia_segundos_bucket{operacao=\"%s\",le=\"+Inf\"} %llu\n",
+                NOMES_LATENCIAS[l], acumulado);
+        fprintf(saida, "war_latencia_segundos_sum{operacao=\"%s\"} %.9f\n", NOMES_LATENCIAS[l],
+                atomic_load_explicit(&metricas.somaNs[l], memory_order_relaxed) / 1e9);
+        fprintf(saida, "war_latencia_segundos_count{operacao=\"%s\"} %llu\n", NOMES_LATENCIAS[l], acumulado);
+    }
+}
+
+/*
+ * Função: escreverMetricasJSON
+ * Escreve as métricas como um objeto JSON em uma única linha
+ * (histogramas: pares [limite_ns, amostras] das faixas não vazias)
+ */
+static inline void escreverMetricasJSON(FILE* saida) {
+    fprintf(saida, "{\"ativo_s\":%.3f,\"memoria_residente_bytes\":%llu,\"sessoes_abertas\":%lld,"
+                   "\"amostragem\":%d,\"contadores\":{",
+            segundosAtivas(), (unsigned long long) memoriaResidente(),
+            (long long) atomic_load_explicit(&metricas.sessoesAbertas, memory_order_relaxed),
+            AMOSTRAGEM_METRICAS);
+    for (int c = 0; c < TOTAL_CONTADORES; c++) {
+        fprintf(saida, "%s\"%s\":%llu", c > 0 ? "," : "", NOMES_CONTADORES[c],
+                (unsigned long long) atomic_load_explicit(&metricas.contadores[c], memory_order_relaxed));
+    }
+    fprintf(saida, "},\"latencias\":{");
+    for (int l = 0; l < TOTAL_LATENCIAS; l++) {
+        unsigned long long amostras = 0;
+        int primeira = 1;
+        fprintf(saida, "%s\"%s\":{\"faixas_ns\":[", l > 0 ? "," : "", NOMES_LATENCIAS[l]);
+        for (int f = 0; f < FAIXAS_LATENCIA; f++) {
+            unsigned long long n = atomic_load_explicit(&metricas.faixas[l][f], memory_order_relaxed);
+            if (n > 0) {
+                fprintf(saida, "%s[%llu,%llu]", primeira ? "" : ",", (2ULL << f) - 1, n);
+                primeira = 0;
+                amostras += n;
+            }
+        }
+        fprintf(saida, "],\"amostras\":%llu,\"soma_ns\":%llu}", amostras,
+                (unsigned long long) atomic_load_explicit(&metricas.somaNs[l], memory_order_relaxed));
+    }
+    fprintf(saida, "}}");
+}
+
+/*
+ * Função: exportarMetricas
+ * Grava as métricas em "caminho" (arquivo temporário renomeado por cima
+ * do anterior, então quem lê nunca vê um arquivo pela metade)
+ * Retorna 1 em caso de sucesso, 0 em caso de erro
+ */
+static inline int exportarMetricas(const char* caminho, int json) {
+    char temporario[sizeof(metricas.caminho) + 8];
+    snprintf(temporario, sizeof(temporario), "%s.tmp", caminho);
+
+    FILE* arquivo = fopen(temporario, "w");
+    if (arquivo == NULL) {
+        return 0;
+    }
+    if (json) {
+        escreverMetricasJSON(arquivo);
+        fputc('\n', arquivo);
+    } else {
+        escreverMetricasPrometheus(arquivo);
+    }
+    if (fclose(arquivo) != 0 || rename(temporario, caminho) != 0) {
+        unlink(temporario);
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * Função: lacoMetricas
+ * Thread que grava as métricas a cada "intervalo" segundos
+ */
+static inline void* lacoMetricas(void* argumento) {
+    (void) argumento;
+    pthread_mutex_lock(&metricas.trava);
+    while (!metricas.encerrar) {
+        struct timespec prazo;
+        clock_gettime(CLOCK_REALTIME, &prazo);
+        prazo.tv_sec += metricas.intervalo;
+        while (!metricas.encerrar && pthread_cond_timedwait(&metricas.sinal, &metricas.trava, &prazo) == 0) {
+            // Sinal sem pedido de encerramento: continua esperando o prazo
+        }
+        if (!metricas.encerrar) {
+            pthread_mutex_unlock(&metricas.trava);
+            exportarMetricas(metricas.caminho, metricas.json);
+            pthread_mutex_lock(&metricas.trava);
+        }
+    }
+    pthread_mutex_unlock(&metricas.trava);
+    return NULL;
+}
+
+/*
+ * Função: ativarMetricas
+ * Liga as métricas e, com "caminho", a gravação a cada "intervalo" segundos
+ * Retorna 1 em caso de sucesso, 0 se a exportação não pôde ser iniciada
+ * (as métricas continuam ligadas para o comando "metricas")
+ */
+static inline int ativarMetricas(const char* caminho, int intervalo) {
+    metricas.ativas = 1;
+    clock_gettime(CLOCK_MONOTONIC, &metricas.inicio);
+    if (caminho == NULL) {
+        return 1;
+    }
+    size_t tamanho = strlen(caminho);
+    if (tamanho >= sizeof(metricas.caminho)) {
+        return 0;
+    }
+    memcpy(metricas.caminho, caminho, tamanho + 1);
+    metricas.json = tamanho >= 5 && strcmp(caminho + tamanho - 5, ".json") == 0;
+    metricas.intervalo = intervalo > 0 ? intervalo : 10;
+    metricas.encerrar = 0;
+    pthread_mutex_init(&metricas.trava, NULL);
+    pthread_cond_init(&metricas.sinal, NULL);
+    if (pthread_create(&metricas.thread, NULL, lacoMetricas, NULL) != 0) {
+        pthread_mutex_destroy(&metricas.trava);
+        pthread_cond_destroy(&metricas.sinal);
+        return 0;
+    }
+    metricas.exportando = 1;
+    return 1;
+}
+
+/*
+ * Função: encerrarMetricas
+ * Para a thread de exportação e grava as métricas uma última vez
+ * Retorna 1 se a última gravação deu certo (ou não havia arquivo)
+ */
+static inline int encerrarMetricas(void) {
+    if (!metricas.exportando) {
+        return 1;
+    }
+    pthread_mutex_lock(&metricas.trava);
+    metricas.encerrar = 1;
+    pthread_cond_signal(&metricas.sinal);
+    pthread_mutex_unlock(&metricas.trava);
+    pthread_join(metricas.thread, NULL);
+    pthread_mutex_destroy(&metricas.trava);
+    pthread_cond_destroy(&metricas.sinal);
+    metricas.exportando = 0;
+    return exportarMetricas(metricas.caminho, metricas.json);
+}
+
+#endif // WAR_METRICAS_H
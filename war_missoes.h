@@ -0,0 +1,340 @@
+/*
+ * Registro de Missões do Sistema WAR
+ *
+ * Cada missão é um tipo (TipoMissao) com parâmetros tipados: quantidade
+ * ou limiar, cor e letra inicial. O registro associa a cada tipo o modelo
+ * do texto exibido e a função que avalia a missão, então verificar uma
+ * missão é uma chamada direta, sem busca de substrings, e os jogadores
+ * guardam a missão por valor, sem alocação.
+ *
+ * Para criar uma missão nova com um tipo existente basta acrescentar uma
+ * linha ao catálogo MISSOES_PADRAO. As missões de continentes dependem do
+ * mapa carregado e ficam fora do catálogo sorteado: vêm do arquivo de
+ * jogadores ("continente NOME" ou "continentes N").
+ */
+
+#ifndef WAR_MISSOES_H
+#define WAR_MISSOES_H
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "war_engine.h"
+
+// Tipos de missão conhecidos pelo registro
+typedef enum {
+    MISSAO_TERRITORIOS_SEGUIDOS = 0,  // "quantidade" territórios seguidos
+    MISSAO_ELIMINAR_COR,              // Nenhuma tropa da cor "cor" no mapa
+    MISSAO_CONTROLAR_TERRITORIOS,     // Pelo menos "quantidade" territórios
+    MISSAO_TROPAS_EM_TERRITORIO,      // "quantidade" tropas em um único território
+    MISSAO_CORES_DIFERENTES,          // Territórios de "quantidade" cores diferentes
+    MISSAO_DOMINAR_INICIAL,           // Todos os territórios com nome iniciado por "inicial"
+    MISSAO_SOMA_TROPAS,               // Soma de tropas de pelo menos "quantidade"
+    MISSAO_DOMINAR_CONTINENTE,        // Todo o continente de índice "quantidade"
+    MISSAO_CONTINENTES_COMPLETOS,     // Pelo menos "quantidade" continentes inteiros
+    TOTAL_TIPOS_MISSAO
+} TipoMissao;
+
+// Missão compilada: parâmetros já resolvidos (cor como ID)
+typedef struct {
+    TipoMissao tipo;
+    int quantidade;   // Quantidade, limiar ou continente, conforme o tipo
+    IdCor cor;        // Cor alvo (MISSAO_ELIMINAR_COR)
+    char inicial;     // Letra inicial (MISSAO_DOMINAR_INICIAL)
+} Missao;
+
+// Missão como escrita no catálogo (cor pelo nome)
+typedef struct {
+    TipoMissao tipo;
+    int quantidade;
+    const char* cor;
+    char inicial;
+} ModeloMissao;
+
+// Definição da estrutura Jogador
+typedef struct {
+    char nome[30];    // Nome do jogador
+    IdCor cor;        // Cor do exército do jogador (ID na TabelaCores)
+    Missao missao;    // Missão sorteada (por valor)
+} Jogador;
+
+// Avaliador de um tipo de missão: retorna 1 se cumprida
+typedef int (*AvaliadorMissao)(const Missao* missao, Jogo* jogo, IdCor corJogador);
+
+// Entrada do registro: texto (printf) e avaliador de um tipo
+typedef struct {
+    const char* modelo;
+    AvaliadorMissao avaliar;
+} DefinicaoMissao;
+
+// Missões pré-definidas, sorteadas para os jogadores
+#define TOTAL_MISSOES 7
+static const ModeloMissao MISSOES_PADRAO[TOTAL_MISSOES] = {
+    { MISSAO_TERRITORIOS_SEGUIDOS,  3,  NULL,       0   },
+    { MISSAO_ELIMINAR_COR,          0,  "vermelha", 0   },
+    { MISSAO_CONTROLAR_TERRITORIOS, 5,  NULL,       0   },
+    { MISSAO_TROPAS_EM_TERRITORIO,  30, NULL,       0   },
+    { MISSAO_CORES_DIFERENTES,      3,  NULL,       0   },
+    { MISSAO_DOMINAR_INICIAL,       0,  NULL,       'B' },
+    { MISSAO_SOMA_TROPAS,           40, NULL,       0   }
+};
+
+// ==================== AVALIADORES ====================
+
+// Territórios seguidos da cor: uma região conexa pelas fronteiras
+// (sem fronteiras cadastradas, vale a ordem do vetor)
+static inline int avaliarTerritoriosSeguidos(const Missao* missao, Jogo* jogo, IdCor corJogador) {
+    if (!grafoAtivo(&jogo->grafo)) {
+        int sequenciaAtual = 0;
+        for (int i = 0; i < jogo->numTerritorios; i++) {
+            if (donoTerritorio(jogo, i) == corJogador) {
+                if (++sequenciaAtual >= missao->quantidade) {
+                    return 1;
+                }
+            } else {
+                sequenciaAtual = 0;
+            }
+        }
+        return 0;
+    }
+
+    if (jogo->agregados.porCor[corJogador].territorios < missao->quantidade ||
+        !prepararBusca(&jogo->busca, jogo->numTerritorios)) {
+        return 0;
+    }
+
+    // Busca em profundidade a partir de cada território ainda não visitado
+    const GrafoAdjacencia* grafo = &jogo->grafo;
+    uint32_t* marcas = jogo->busca.marcas;
+    uint32_t* pilha = jogo->busca.pilha;
+    uint32_t epoca = jogo->busca.epoca;
+
+    for (int i = 0; i < jogo->numTerritorios; i++) {
+        if (donoTerritorio(jogo, i) != corJogador || marcas[i] == epoca) {
+            continue;
+        }
+
+        int regiao = 0;
+        int topo = 0;
+        pilha[topo++] = (uint32_t) i;
+        marcas[i] = epoca;
+        while (topo > 0) {
+            uint32_t atual = pilha[--topo];
+            if (++regiao >= missao->quantidade) {
+                return 1;
+            }
+            for (uint32_t k = grafo->inicio[atual]; k < grafo->inicio[atual + 1]; k++) {
+                uint32_t vizinho = grafo->vizinhos[k];
+                if (donoTerritorio(jogo, (int) vizinho) == corJogador && marcas[vizinho] != epoca) {
+                    marcas[vizinho] = epoca;
+                    pilha[topo++] = vizinho;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// Nenhuma tropa da cor alvo (soma dos agregados)
+static inline int avaliarEliminarCor(const Missao* missao, Jogo* jogo, IdCor corJogador) {
+    (void) corJogador;
+    return jogo->agregados.porCor[missao->cor].tropas == 0;
+}
+
+// Quantidade de territórios controlados
+static inline int avaliarControlarTerritorios(const Missao* missao, Jogo* jogo, IdCor corJogador) {
+    return jogo->agregados.porCor[corJogador].territorios >= missao->quantidade;
+}
+
+// Maior tropa em um único território
+static inline int avaliarTropasEmTerritorio(const Missao* missao, Jogo* jogo, IdCor corJogador) {
+    return tropasMaximasCor(jogo, corJogador) >= missao->quantidade;
+}
+
+// Cores diferentes entre os territórios controlados
+static inline int avaliarCoresDiferentes(const Missao* missao, Jogo* jogo, IdCor corJogador) {
+    // Todo território controlado tem a cor do jogador, então há no máximo 1 cor
+    int numCoresUnicas = jogo->agregados.porCor[corJogador].territorios > 0 ? 1 : 0;
+    return numCoresUnicas >= missao->quantidade;
+}
+
+// Todos os territórios com a letra inicial
+static inline int avaliarDominarInicial(const Missao* missao, Jogo* jogo, IdCor corJogador) {
+    // A letra 'B' é mantida pelos agregados; outras letras usam a faixa do
+    // índice de nomes ou, sem ele, percorrem o mapa
+    if (missao->inicial == 'B' || missao->inicial == 'b') {
+        return jogo->agregados.totalB > 0 &&
+               jogo->agregados.porCor[corJogador].territoriosB == jogo->agregados.totalB;
+    }
+
+    int inicio, fim;
+    if (faixaPrefixo(jogo, &missao->inicial, 1, &inicio, &fim) >= 0) {
+        for (int k = inicio; k < fim; k++) {
+            if (donoTerritorio(jogo, (int) jogo->nomes.ordem[k]) != corJogador) {
+                return 0;
+            }
+        }
+        return fim > inicio;
+    }
+
+    int territorios = 0;
+    for (int i = 0; i < jogo->numTerritorios; i++) {
+        if (toupper((unsigned char) nomeTerritorio(jogo, i)[0]) == toupper((unsigned char) missao->inicial)) {
+            if (jogo->mapa[i].cor != corJogador) {
+                return 0;
+            }
+            territorios++;
+        }
+    }
+    return territorios > 0;
+}
+
+// Soma das tropas da cor
+static inline int avaliarSomaTropas(const Missao* missao, Jogo* jogo, IdCor corJogador) {
+    return jogo->agregados.porCor[corJogador].tropas >= missao->quantidade;
+}
+
+// Continente inteiro: faixa do continente contra a posse da cor
+static inline int avaliarDominarContinente(const Missao* missao, Jogo* jogo, IdCor corJogador) {
+    return continenteDominado(&jogo->continentes, &jogo->posse, missao->quantidade, corJogador);
+}
+
+// Quantidade de continentes inteiros
+static inline int avaliarContinentesCompletos(const Missao* missao, Jogo* jogo, IdCor corJogador) {
+    if (jogo->continentes.total < missao->quantidade) {
+        return 0;
+    }
+    return contarContinentesDominados(&jogo->continentes, &jogo->posse, corJogador) >= missao->quantidade;
+}
+
+// Registro: uma entrada por TipoMissao, na mesma ordem do enum
+static const DefinicaoMissao REGISTRO_MISSOES[TOTAL_TIPOS_MISSAO] = {
+    { "Conquistar %d territorios seguidos com a mesma cor",             avaliarTerritoriosSeguidos },
+    { "Eliminar todas as tropas da cor %s do mapa",                     avaliarEliminarCor },
+    { "Controlar pelo menos %d territorios ao mesmo tempo",             avaliarControlarTerritorios },
+    { "Acumular %d ou mais tropas em um unico territorio",              avaliarTropasEmTerritorio },
+    { "Conquistar territorios de pelo menos %d cores diferentes",       avaliarCoresDiferentes },
+    { "Dominar todos os territorios cujo nome comeca com a letra '%c'", avaliarDominarInicial },
+    { "Ter controle de territorios com soma total de %d tropas",        avaliarSomaTropas },
+    { "Dominar todo o continente %s",                                   avaliarDominarContinente },
+    { "Dominar pelo menos %d continentes inteiros",                     avaliarContinentesCompletos }
+};
+
+// ==================== COMPILAÇÃO E CONSULTA ====================
+
+/*
+ * Função: compilarMissao
+ * Converte um modelo do catálogo em missão pronta para avaliar,
+ * internando a cor alvo na tabela da partida
+ * Retorna 1 em caso de sucesso, 0 se a tabela de cores estiver cheia
+ */
+static inline int compilarMissao(const ModeloMissao* modelo, TabelaCores* cores, Missao* missao) {
+    missao->tipo = modelo->tipo;
+    missao->quantidade = modelo->quantidade;
+    missao->inicial = modelo->inicial;
+    missao->cor = COR_INVALIDA;
+
+    if (modelo->cor != NULL) {
+        missao->cor = internarCor(cores, modelo->cor);
+        if (missao->cor == COR_INVALIDA) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Função: compilarCatalogo
+ * Compila todas as missões pré-definidas para uma partida
+ * Retorna 1 em caso de sucesso, 0 se a tabela de cores estiver cheia
+ */
+static inline int compilarCatalogo(TabelaCores* cores, Missao catalogo[TOTAL_MISSOES]) {
+    for (int i = 0; i < TOTAL_MISSOES; i++) {
+        if (!compilarMissao(&MISSOES_PADRAO[i], cores, &catalogo[i])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Função: validarMissao
+ * Confere uma missão lida de arquivo: tipo do registro (ele escolhe o
+ * avaliador), cor alvo internada e continente dentro do limite
+ * (se o continente existe no mapa é conferido por missaoCabeNoMapa(),
+ * depois que os continentes forem carregados)
+ * Retorna 1 se a missão é válida
+ */
+static inline int validarMissao(const Missao* missao, int numCores) {
+    if ((unsigned) missao->tipo >= TOTAL_TIPOS_MISSAO) {
+        return 0;
+    }
+    switch (missao->tipo) {
+        case MISSAO_ELIMINAR_COR:
+            return missao->cor < numCores;
+        case MISSAO_DOMINAR_CONTINENTE:
+            return missao->quantidade >= 0 && missao->quantidade < MAX_CONTINENTES;
+        default:
+            return 1;
+    }
+}
+
+/*
+ * Função: missaoCabeNoMapa
+ * Confere se os continentes de uma missão existem no mapa, como na carga
+ * do arquivo de jogadores (NULL = mapa sem continentes)
+ * Retorna 1 se a missão não usa continentes ou se os que usa existem
+ */
+static inline int missaoCabeNoMapa(const Missao* missao, const Continentes* continentes) {
+    int total = continentes != NULL ? continentes->total : 0;
+    switch (missao->tipo) {
+        case MISSAO_DOMINAR_CONTINENTE:
+            return missao->quantidade >= 0 && missao->quantidade < total;
+        case MISSAO_CONTINENTES_COMPLETOS:
+            return missao->quantidade >= 1 && missao->quantidade <= total;
+        default:
+            return 1;
+    }
+}
+
+/*
+ * Função: avaliarMissao
+ * Verifica se a missão foi cumprida pelo exército "corJogador"
+ */
+static inline int avaliarMissao(const Missao* missao, Jogo* jogo, IdCor corJogador) {
+    return REGISTRO_MISSOES[missao->tipo].avaliar(missao, jogo, corJogador);
+}
+
+/*
+ * Função: descreverMissao
+ * Escreve em "destino" o texto da missão para exibição
+ * (sem "continentes", o continente aparece pelo número)
+ */
+static inline void descreverMissao(const Missao* missao, const TabelaCores* cores,
+                                   const Continentes* continentes, char* destino, size_t tamanho) {
+    const char* modelo = REGISTRO_MISSOES[missao->tipo].modelo;
+
+    switch (missao->tipo) {
+        case MISSAO_ELIMINAR_COR:
+            snprintf(destino, tamanho, modelo, nomeCor(cores, missao->cor));
+            break;
+        case MISSAO_DOMINAR_INICIAL:
+            snprintf(destino, tamanho, modelo, missao->inicial);
+            break;
+        case MISSAO_DOMINAR_CONTINENTE:
+            if (continentes != NULL && missao->quantidade >= 0 && missao->quantidade < continentes->total) {
+                snprintf(destino, tamanho, modelo, continentes->nomes[missao->quantidade]);
+            } else {
+                char numero[16];
+                snprintf(numero, sizeof(numero), "#%d", missao->quantidade + 1);
+                snprintf(destino, tamanho, modelo, numero);
+            }
+            break;
+        default:
+            snprintf(destino, tamanho, modelo, missao->quantidade);
+            break;
+    }
+}
+
+#endif // WAR_MISSOES_H
@@ -0,0 +1,556 @@
+/*
+ * Nomes dos Territórios do Sistema WAR
+ *
+ * Pool de nomes: os nomes de todos os territórios de um mapa ficam em um
+ * único bloco de texto (terminados em '\0', um após o outro) e cada
+ * território guarda só o deslocamento de 32 bits do seu nome. Nomes
+ * repetidos são guardados uma vez, não há limite de tamanho e o bloco pode
+ * ser mapeado direto do arquivo do mapa, sem cópia. Como os nomes não
+ * mudam durante a partida, o pool é somente leitura depois de montado e
+ * pode ser compartilhado entre cópias da partida (como as fronteiras).
+ *
+ * Índice de nomes: permite escolher territórios pelo nome em vez do número
+ * da lista:
+ *   - uma tabela hash (endereçamento aberto, sondagem linear) leva o nome
+ *     ao índice do território em O(tamanho do nome);
+ *   - um vetor com os territórios em ordem alfabética responde consultas
+ *     por prefixo com duas buscas binárias: os nomes que começam com o
+ *     prefixo ficam contíguos no vetor.
+ *
+ * Os nomes são comparados sem diferenciar maiúsculas, e '_' equivale a
+ * espaço (para digitar "Costa_Rica" em um comando separado por espaços).
+ * O índice não copia os nomes: guarda só índices de territórios e os
+ * encontra pela FonteNomes (pool + deslocamentos no vetor de territórios).
+ */
+
+#ifndef WAR_NOMES_H
+#define WAR_NOMES_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define POOL_ERRO UINT32_MAX   // Deslocamento devolvido quando o nome não coube
+
+// Texto de todos os nomes; o deslocamento 0 é o nome vazio
+typedef struct {
+    const char* texto;          // Nomes terminados em '\0', em sequência
+    uint32_t tamanho;           // Bytes usados de "texto"
+    uint32_t capacidade;        // Bytes alocados de "texto" (durante a montagem)
+    uint32_t* tabela;           // Deslocamento + 1 de cada nome distinto (só durante a montagem)
+    uint32_t mascara;           // Capacidade da tabela - 1 (potência de 2)
+    uint32_t distintos;         // Nomes na tabela
+    void* memoria;              // Texto alocado (NULL se mapeado de arquivo ou em cópias)
+} PoolNomes;
+
+// Onde o índice encontra o nome do território i: o deslocamento fica em
+// "registros + i * passo" (o campo "nome" do vetor de territórios)
+typedef struct {
+    const PoolNomes* pool;
+    const char* registros;      // Deslocamento do nome do território 0
+    size_t passo;               // Distância entre dois territórios (sizeof(Territorio))
+} FonteNomes;
+
+typedef struct {
+    const uint32_t* tabela;     // Índice + 1 do território em cada posição (0 = vazia)
+    uint32_t mascara;           // Capacidade da tabela - 1 (potência de 2)
+    const uint32_t* ordem;      // Territórios em ordem alfabética
+    int numTerritorios;         // 0 = índice não montado
+    void* memoria;              // Bloco alocado por construirIndiceNomes (NULL em cópias)
+} IndiceNomes;
+
+// ==================== POOL ====================
+
+/*
+ * Função: iniciarPool
+ * Aloca o texto de um pool vazio (só o nome vazio, no deslocamento 0)
+ * Retorna 1 em caso de sucesso, 0 se faltar memória
+ */
+static inline int iniciarPool(PoolNomes* pool, size_t capacidade) {
+    memset(pool, 0, sizeof(*pool));
+    if (capacidade < 64) capacidade = 64;
+    if (capacidade > UINT32_MAX) capacidade = UINT32_MAX;
+
+    char* texto = (char*) malloc(capacidade);
+    if (texto == NULL) {
+        return 0;
+    }
+    texto[0] = '\0';
+    pool->texto = texto;
+    pool->memoria = texto;
+    pool->tamanho = 1;
+    pool->capacidade = (uint32_t) capacidade;
+    return 1;
+}
+
+/*
+ * Função: apontarPool
+ * Usa como pool um texto já pronto (mapeado de um arquivo, sem cópia)
+ * Retorna 1 se o texto é um pool válido (começa e termina em '\0')
+ */
+static inline int apontarPool(PoolNomes* pool, const char* texto, uint64_t tamanho) {
+    memset(pool, 0, sizeof(*pool));
+    if (tamanho == 0 || tamanho > UINT32_MAX || texto[0] != '\0' || texto[tamanho - 1] != '\0') {
+        return 0;
+    }
+    pool->texto = texto;
+    pool->tamanho = (uint32_t) tamanho;
+    return 1;
+}
+
+/*
+ * Função: reservarTextoPool
+ * Reserva "tamanho" bytes no fim do pool, a serem preenchidos pelo chamador
+ * em (char*) pool->memoria + deslocamento (ex.: vários nomes escritos em
+ * paralelo, cada thread na sua parte)
+ * Um pool zerado é iniciado na primeira reserva
+ * Retorna o deslocamento da reserva ou POOL_ERRO se faltar memória
+ */
+static inline uint32_t reservarTextoPool(PoolNomes* pool, size_t tamanho) {
+    if (pool->tamanho == 0 && !iniciarPool(pool, 0)) {
+        return POOL_ERRO;
+    }
+    if (tamanho > (size_t) UINT32_MAX - pool->tamanho) {
+        return POOL_ERRO;
+    }
+    size_t necessario = (size_t) pool->tamanho + tamanho;
+    if (necessario > pool->capacidade) {
+        size_t capacidade = (size_t) pool->capacidade * 2;
+        if (capacidade < necessario) capacidade = necessario;
+        if (capacidade > UINT32_MAX) capacidade = UINT32_MAX;
+        char* texto = (char*) realloc(pool->memoria, capacidade);
+        if (texto == NULL) {
+            return POOL_ERRO;
+        }
+        pool->texto = texto;
+        pool->memoria = texto;
+        pool->capacidade = (uint32_t) capacidade;
+    }
+
+    uint32_t deslocamento = pool->tamanho;
+    pool->tamanho += (uint32_t) tamanho;
+    return deslocamento;
+}
+
+/*
+ * Função: acrescentarNome
+ * Copia os "tamanho" bytes do nome para o fim do pool, sem procurar repetidos
+ * (para nomes que já se sabe que são distintos, como os dos mapas gerados)
+ * Um pool zerado é iniciado no primeiro nome
+ * Retorna o deslocamento do nome ou POOL_ERRO se faltar memória
+ */
+static inline uint32_t acrescentarNome(PoolNomes* pool, const char* nome, size_t tamanho) {
+    if (tamanho == 0) {
+        return 0;
+    }
+    uint32_t deslocamento = reservarTextoPool(pool, tamanho + 1);
+    if (deslocamento != POOL_ERRO) {
+        char* texto = (char*) pool->memoria;
+        memcpy(texto + deslocamento, nome, tamanho);
+        texto[deslocamento + tamanho] = '\0';
+    }
+    return deslocamento;
+}
+
+/*
+ * Função: hashBytes
+ * FNV-1a dos bytes do nome (exato: diferencia maiúsculas)
+ */
+static inline uint32_t hashBytes(const char* nome, size_t tamanho) {
+    uint32_t hash = 2166136261u;
+    for (size_t k = 0; k < tamanho; k++) {
+        hash = (hash ^ (unsigned char) nome[k]) * 16777619u;
+    }
+    return hash;
+}
+
+/*
+ * Função: crescerTabelaPool
+ * Aumenta a tabela de nomes distintos até comportar "nomes" nomes (ou a
+ * dobra, se já comporta), reposicionando os que já estão nela
+ * Retorna 1 em caso de sucesso, 0 se faltar memória
+ */
+static inline int crescerTabelaPool(PoolNomes* pool, size_t nomes) {
+    size_t capacidade = pool->tabela != NULL ? ((size_t) pool->mascara + 1) * 2 : 1024;
+    while (capacidade < 2 * nomes && capacidade < ((size_t) 1 << 31)) {
+        capacidade *= 2;
+    }
+    uint32_t* tabela = (uint32_t*) calloc(capacidade, sizeof(uint32_t));
+    if (tabela == NULL) {
+        return 0;
+    }
+    uint32_t mascara = (uint32_t) (capacidade - 1);
+    if (pool->tabela != NULL) {
+        for (uint32_t k = 0; k <= pool->mascara; k++) {
+            uint32_t entrada = pool->tabela[k];
+            if (entrada == 0) continue;
+            const char* nome = pool->texto + entrada - 1;
+            uint32_t posicao = hashBytes(nome, strlen(nome)) & mascara;
+            while (tabela[posicao] != 0) {
+                posicao = (posicao + 1) & mascara;
+            }
+            tabela[posicao] = entrada;
+        }
+        free(pool->tabela);
+    }
+    pool->tabela = tabela;
+    pool->mascara = mascara;
+    return 1;
+}
+
+/*
+ * Função: reservarNomesPool
+ * Dimensiona de uma vez a busca por repetidos para "nomes" nomes (evita
+ * refazer a tabela várias vezes ao carregar um mapa grande)
+ * Retorna 1 em caso de sucesso, 0 se faltar memória
+ */
+static inline int reservarNomesPool(PoolNomes* pool, size_t nomes) {
+    if (pool->tabela != NULL && 2 * nomes <= (size_t) pool->mascara + 1) {
+        return 1;
+    }
+    return crescerTabelaPool(pool, nomes);
+}
+
+/*
+ * Função: internarNome
+ * Retorna o deslocamento do nome no pool, acrescentando-o só se ainda
+ * não estiver lá (nomes iguais compartilham o mesmo texto)
+ * Um pool zerado é iniciado no primeiro nome
+ * Retorna POOL_ERRO se faltar memória
+ */
+static inline uint32_t internarNome(PoolNomes* pool, const char* nome, size_t tamanho) {
+    if (tamanho == 0) {
+        return 0;
+    }
+    if (pool->tamanho == 0 && !iniciarPool(pool, 0)) {
+        return POOL_ERRO;
+    }
+    if ((pool->tabela == NULL || 2 * (pool->distintos + 1) > pool->mascara + 1) && !crescerTabelaPool(pool, 0)) {
+        return POOL_ERRO;
+    }
+
+    uint32_t posicao = hashBytes(nome, tamanho) & pool->mascara;
+    while (pool->tabela[posicao] != 0) {
+        const char* existente = pool->texto + pool->tabela[posicao] - 1;
+        if (memcmp(existente, nome, tamanho) == 0 && existente[tamanho] == '\0') {
+            return pool->tabela[posicao] - 1;
+        }
+        posicao = (posicao + 1) & pool->mascara;
+    }
+
+    uint32_t deslocamento = acrescentarNome(pool, nome, tamanho);
+    if (deslocamento != POOL_ERRO) {
+        pool->tabela[posicao] = deslocamento + 1;
+        pool->distintos++;
+    }
+    return deslocamento;
+}
+
+/*
+ * Função: lerLinhaPool
+ * Lê uma linha do arquivo (de qualquer tamanho, sem o '\n') e a interna no pool
+ * Retorna o deslocamento do nome (0 no fim do arquivo) ou POOL_ERRO
+ */
+static inline uint32_t lerLinhaPool(PoolNomes* pool, FILE* arquivo) {
+    char bloco[128];
+    char* linha = NULL;
+    size_t tamanho = 0;
+
+    while (fgets(bloco, sizeof(bloco), arquivo) != NULL) {
+        size_t lidos = strlen(bloco);
+        char* maior = (char*) realloc(linha, tamanho + lidos + 1);
+        if (maior == NULL) {
+            free(linha);
+            return POOL_ERRO;
+        }
+        linha = maior;
+        memcpy(linha + tamanho, bloco, lidos + 1);
+        tamanho += lidos;
+        if (lidos > 0 && bloco[lidos - 1] == '\n') {
+            break;
+        }
+    }
+    if (linha == NULL) {
+        return 0;
+    }
+
+    uint32_t deslocamento = internarNome(pool, linha, strcspn(linha, "\n"));
+    free(linha);
+    return deslocamento;
+}
+
+/*
+ * Função: encerrarPool
+ * Termina a montagem: descarta a tabela de repetidos e devolve a sobra do texto
+ */
+static inline void encerrarPool(PoolNomes* pool) {
+    free(pool->tabela);
+    pool->tabela = NULL;
+    pool->mascara = 0;
+    pool->distintos = 0;
+    if (pool->memoria != NULL && pool->capacidade > pool->tamanho) {
+        char* texto = (char*) realloc(pool->memoria, pool->tamanho);
+        if (texto != NULL) {
+            pool->texto = texto;
+            pool->memoria = texto;
+            pool->capacidade = pool->tamanho;
+        }
+    }
+}
+
+/*
+ * Função: liberarPool
+ * Libera o pool (se foi alocado) e o deixa vazio
+ */
+static inline void liberarPool(PoolNomes* pool) {
+    free(pool->tabela);
+    free(pool->memoria);
+    memset(pool, 0, sizeof(*pool));
+}
+
+/*
+ * Função: nomeNoPool
+ * Retorna o nome no deslocamento (nome vazio se o deslocamento está fora do pool)
+ */
+static inline const char* nomeNoPool(const PoolNomes* pool, uint32_t deslocamento) {
+    return deslocamento < pool->tamanho ? pool->texto + deslocamento : "";
+}
+
+/*
+ * Função: tamanhoPool
+ * Bytes do pool gravados nos arquivos (um pool vazio grava só o nome vazio)
+ */
+static inline size_t tamanhoPool(const PoolNomes* pool) {
+    return pool->tamanho > 0 ? pool->tamanho : 1;
+}
+
+/*
+ * Função: textoPool
+ * Texto do pool gravado nos arquivos
+ */
+static inline const char* textoPool(const PoolNomes* pool) {
+    return pool->tamanho > 0 ? pool->texto : "";
+}
+
+// ==================== ÍNDICE ====================
+
+/*
+ * Função: letraNome
+ * Letra usada nas comparações de nomes (minúscula ASCII; '_' vira espaço)
+ */
+static inline unsigned char letraNome(char c) {
+    unsigned char letra = (unsigned char) c;
+    if (letra >= 'A' && letra <= 'Z') {
+        return (unsigned char) (letra + ('a' - 'A'));
+    }
+    return letra == '_' ? ' ' : letra;
+}
+
+/*
+ * Função: hashNome
+ * FNV-1a das letras do nome, até "tamanho" bytes ou o '\0'
+ */
+static inline uint32_t hashNome(const char* nome, size_t tamanho) {
+    uint32_t hash = 2166136261u;
+    for (size_t k = 0; k < tamanho && nome[k] != '\0'; k++) {
+        hash = (hash ^ letraNome(nome[k])) * 16777619u;
+    }
+    return hash;
+}
+
+/*
+ * Função: compararPrefixo
+ * Compara as primeiras "tamanho" letras do nome com o prefixo
+ * Retorna < 0, 0 (o nome começa com o prefixo) ou > 0, na ordem do índice
+ */
+static inline int compararPrefixo(const char* nome, const char* prefixo, size_t tamanho) {
+    for (size_t k = 0; k < tamanho; k++) {
+        if (nome[k] == '\0') {
+            return -1;
+        }
+        int diferenca = (int) letraNome(nome[k]) - (int) letraNome(prefixo[k]);
+        if (diferenca != 0) {
+            return diferenca;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Função: nomeIgual
+ * Retorna 1 se o nome (terminado em '\0') é igual aos "tamanho" bytes da busca
+ */
+static inline int nomeIgual(const char* nome, const char* busca, size_t tamanho) {
+    return compararPrefixo(nome, busca, tamanho) == 0 && nome[tamanho] == '\0';
+}
+
+// Nome a ordenar: as 8 primeiras letras em um inteiro (comparação direta),
+// o nome completo para desempatar e o território (nomes repetidos
+// compartilham o texto no pool)
+typedef struct {
+    uint64_t chave;
+    const char* nome;
+    uint32_t territorio;
+} ChaveNome;
+
+/*
+ * Função: chaveNome
+ * Empacota as 8 primeiras letras do nome, a primeira no byte mais alto
+ * (nomes mais curtos completam com zeros, que vêm antes de qualquer letra)
+ */
+static inline uint64_t chaveNome(const char* nome) {
+    uint64_t chave = 0;
+    int k = 0;
+    for (; k < 8 && nome[k] != '\0'; k++) {
+        chave = (chave << 8) | letraNome(nome[k]);
+    }
+    return k < 8 ? chave << (8 * (8 - k)) : chave;
+}
+
+/*
+ * Função: compararNomesIndice
+ * Ordem alfabética das letras para qsort (nomes iguais: ordem do mapa)
+ */
+static inline int compararNomesIndice(const void* a, const void* b) {
+    const ChaveNome* x = (const ChaveNome*) a;
+    const ChaveNome* y = (const ChaveNome*) b;
+    if (x->chave != y->chave) {
+        return x->chave < y->chave ? -1 : 1;
+    }
+    if ((x->chave & 0xFF) != 0) {
+        // As 8 primeiras letras são iguais: compara o resto
+        for (size_t k = 8;; k++) {
+            int diferenca = (int) letraNome(x->nome[k]) - (int) letraNome(y->nome[k]);
+            if (diferenca != 0) {
+                return diferenca;
+            }
+            if (x->nome[k] == '\0') {
+                break;
+            }
+        }
+    }
+    return (x->territorio > y->territorio) - (x->territorio < y->territorio);
+}
+
+/*
+ * Função: nomeNoIndice
+ * Nome do território "i" (deslocamento lido no vetor de territórios)
+ */
+static inline const char* nomeNoIndice(const FonteNomes* fonte, uint32_t i) {
+    const uint32_t* deslocamento = (const uint32_t*) (fonte->registros + (size_t) i * fonte->passo);
+    return nomeNoPool(fonte->pool, *deslocamento);
+}
+
+/*
+ * Função: construirIndiceNomes
+ * Monta a tabela hash e a ordem alfabética dos "numTerritorios" nomes
+ * (nomes repetidos: a busca exata encontra o primeiro do mapa)
+ * Retorna 1 em caso de sucesso, 0 se faltar memória
+ */
+static inline int construirIndiceNomes(IndiceNomes* indice, const FonteNomes* fonte, int numTerritorios) {
+    uint32_t capacidade = 16;
+    while (capacidade < 2 * (uint32_t) numTerritorios) {
+        capacidade *= 2;
+    }
+
+    uint32_t* bloco = (uint32_t*) calloc((size_t) capacidade + (size_t) numTerritorios, sizeof(uint32_t));
+    ChaveNome* chaves = (ChaveNome*) malloc(sizeof(ChaveNome) * ((size_t) numTerritorios + 1));
+    if (bloco == NULL || chaves == NULL) {
+        free(bloco);
+        free(chaves);
+        return 0;
+    }
+    uint32_t* tabela = bloco;
+    uint32_t* ordem = bloco + capacidade;
+    uint32_t mascara = capacidade - 1;
+
+    for (uint32_t i = 0; i < (uint32_t) numTerritorios; i++) {
+        const char* nome = nomeNoIndice(fonte, i);
+        uint32_t posicao = hashNome(nome, SIZE_MAX) & mascara;
+        while (tabela[posicao] != 0) {
+            if (nomeIgual(nomeNoIndice(fonte, tabela[posicao] - 1), nome, strlen(nome))) {
+                break; // Repetido: fica o primeiro
+            }
+            posicao = (posicao + 1) & mascara;
+        }
+        if (tabela[posicao] == 0) {
+            tabela[posicao] = i + 1;
+        }
+        chaves[i].chave = chaveNome(nome);
+        chaves[i].nome = nome;
+        chaves[i].territorio = i;
+    }
+
+    qsort(chaves, (size_t) numTerritorios, sizeof(ChaveNome), compararNomesIndice);
+    for (int i = 0; i < numTerritorios; i++) {
+        ordem[i] = chaves[i].territorio;
+    }
+    free(chaves);
+
+    indice->tabela = tabela;
+    indice->mascara = mascara;
+    indice->ordem = ordem;
+    indice->numTerritorios = numTerritorios;
+    indice->memoria = bloco;
+    return 1;
+}
+
+/*
+ * Função: liberarIndiceNomes
+ * Libera o índice (se foi alocado) e o deixa vazio
+ */
+static inline void liberarIndiceNomes(IndiceNomes* indice) {
+    free(indice->memoria);
+    memset(indice, 0, sizeof(*indice));
+}
+
+/*
+ * Função: buscarNomeIndice
+ * Retorna o território com o nome (base 0) ou -1
+ */
+static inline int buscarNomeIndice(const IndiceNomes* indice, const FonteNomes* fonte,
+                                   const char* nome, size_t tamanho) {
+    uint32_t posicao = hashNome(nome, tamanho) & indice->mascara;
+    while (indice->tabela[posicao] != 0) {
+        uint32_t territorio = indice->tabela[posicao] - 1;
+        if (nomeIgual(nomeNoIndice(fonte, territorio), nome, tamanho)) {
+            return (int) territorio;
+        }
+        posicao = (posicao + 1) & indice->mascara;
+    }
+    return -1;
+}
+
+/*
+ * Função: faixaPrefixoIndice
+ * Encontra em "ordem" a faixa [inicio, fim) dos nomes que começam com o prefixo
+ * Retorna a quantidade de nomes da faixa
+ */
+static inline int faixaPrefixoIndice(const IndiceNomes* indice, const FonteNomes* fonte,
+                                     const char* prefixo, size_t tamanho, int* inicio, int* fim) {
+    int baixo = 0, alto = indice->numTerritorios;
+    while (baixo < alto) {
+        int meio = baixo + (alto - baixo) / 2;
+        if (compararPrefixo(nomeNoIndice(fonte, indice->ordem[meio]), prefixo, tamanho) < 0) {
+            baixo = meio + 1;
+        } else {
+            alto = meio;
+        }
+    }
+    *inicio = baixo;
+
+    alto = indice->numTerritorios;
+    while (baixo < alto) {
+        int meio = baixo + (alto - baixo) / 2;
+        if (compararPrefixo(nomeNoIndice(fonte, indice->ordem[meio]), prefixo, tamanho) <= 0) {
+            baixo = meio + 1;
+        } else {
+            alto = meio;
+        }
+    }
+    *fim = baixo;
+    return *fim - *inicio;
+}
+
+#endif // WAR_NOMES_H
@@ -0,0 +1,300 @@
+/*
+ * Ataque Relâmpago do Sistema WAR
+ *
+ * Ataca até o defensor cair ou o atacante ficar com 1 tropa, mas sem
+ * rolar os dados batalha a batalha: o desfecho final (tropas que sobram
+ * de cada lado) é sorteado de uma só vez a partir da sua distribuição
+ * exata.
+ *
+ * A batalha é uma cadeia de Markov sobre (tropas do atacante, tropas do
+ * defensor). Cada rolagem só diminui as tropas, então percorrer os estados
+ * em ordem decrescente e empurrar a probabilidade de cada um para os
+ * seguintes dá a chance de cada estado final em O(atacante × defensor),
+ * guardando apenas 3 linhas da grade. A distribuição vira uma tabela
+ * acumulada com uma tabela-guia (método dos pontos de corte): o sorteio
+ * salta direto para perto do desfecho e custa O(1) em média. As tabelas
+ * ficam em cache, e um segundo ataque com as mesmas tropas não refaz a
+ * programação dinâmica.
+ */
+
+#ifndef WAR_RELAMPAGO_H
+#define WAR_RELAMPAGO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "war_engine.h"
+
+// Tabelas no cache (mapeamento direto por regra/atacante/defensor)
+#define ENTRADAS_CACHE_RELAMPAGO 256
+
+// Acima deste número de estados (atacante × defensor) o ataque é rolado batalha a batalha
+#define LIMITE_ESTADOS_RELAMPAGO (1 << 24)
+
+// Distribuição dos desfechos de um ataque até o fim
+typedef struct {
+    RegraBatalha regra;
+    int atacante;              // Tropas iniciais (0 = entrada vazia)
+    int defensor;
+    int numDesfechos;          // (atacante - 1) conquistas + defensor derrotas
+    double* acumulada;         // Probabilidade acumulada de cada desfecho
+    uint32_t* guia;            // guia[k]: primeiro desfecho com acumulada > k / numDesfechos
+} TabelaRelampago;
+
+// Cache de tabelas (uma por partida; não é compartilhado entre threads)
+typedef struct {
+    TabelaRelampago entradas[ENTRADAS_CACHE_RELAMPAGO];
+    double chances[DADOS_ATAQUE + 1][DADOS_DEFESA + 1][DADOS_DEFESA + 1];  // [dados A][dados D][perdas D]
+    uint64_t consultas;
+    uint64_t construidas;      // Tabelas montadas (consultas - construidas = acertos)
+} CacheRelampago;
+
+/*
+ * Função: inicializarCacheRelampago
+ * Deixa o cache vazio e calcula as chances exatas de cada combate clássico
+ */
+static inline void inicializarCacheRelampago(CacheRelampago* cache) {
+    memset(cache, 0, sizeof(*cache));
+    calcularChancesCombate(cache->chances);
+}
+
+/*
+ * Função: liberarCacheRelampago
+ * Libera todas as tabelas do cache
+ */
+static inline void liberarCacheRelampago(CacheRelampago* cache) {
+    for (int i = 0; i < ENTRADAS_CACHE_RELAMPAGO; i++) {
+        free(cache->entradas[i].acumulada);
+    }
+    memset(cache->entradas, 0, sizeof(cache->entradas));
+}
+
+/*
+ * Função: indiceDesfecho
+ * Posição de um estado final na tabela: conquistas com 2..atacante tropas
+ * restantes primeiro, depois derrotas com 1..defensor tropas restantes
+ */
+static inline int indiceDesfecho(int atacanteInicial, int atacante, int defensor) {
+    return defensor == 0 ? atacante - 2 : atacanteInicial - 1 + defensor - 1;
+}
+
+/*
+ * Função: montarTabelaRelampago
+ * Calcula a distribuição dos desfechos por programação dinâmica e monta a
+ * tabela acumulada e a guia
+ * Retorna 1 em caso de sucesso, 0 se faltar memória
+ */
+static inline int montarTabelaRelampago(const CacheRelampago* cache, TabelaRelampago* tabela,
+                                        RegraBatalha regra, int atacante, int defensor) {
+    int n = atacante - 1 + defensor;
+    size_t largura = (size_t) defensor + 1;
+
+    // acumulada[n] e guia[n] em um único bloco; as 3 linhas da grade à parte
+    char* bloco = (char*) malloc(sizeof(double) * (size_t) n + sizeof(uint32_t) * (size_t) n);
+    double* linhas = (double*) calloc(3 * largura, sizeof(double));
+    if (bloco == NULL || linhas == NULL) {
+        free(bloco);
+        free(linhas);
+        return 0;
+    }
+    double* desfechos = (double*) bloco;
+    uint32_t* guia = (uint32_t*) (bloco + sizeof(double) * (size_t) n);
+    memset(desfechos, 0, sizeof(double) * (size_t) n);
+
+    // Linha x da grade: linhas + (x % 3) * largura (cada rolagem tira no máximo 2 tropas do atacante)
+    linhas[(size_t) (atacante % 3) * largura + (size_t) defensor] = 1.0;
+    for (int x = atacante; x >= 2; x--) {
+        double* linha = linhas + (size_t) (x % 3) * largura;
+        for (int y = defensor; y >= 1; y--) {
+            double massa = linha[y];
+            if (massa == 0.0) continue;
+
+            if (regra == REGRA_SIMPLES) {
+                // Vence com 15/36 (conquista na hora); senão perde 1 tropa
+                desfechos[indiceDesfecho(atacante, x, 0)] += massa * (15.0 / 36.0);
+                if (x - 1 == 1) {
+                    desfechos[indiceDesfecho(atacante, 1, y)] += massa * (21.0 / 36.0);
+                } else {
+                    linhas[(size_t) ((x - 1) % 3) * largura + (size_t) y] += massa * (21.0 / 36.0);
+                }
+                continue;
+            }
+
+            int na = dadosDoAtacante(x), nd = dadosDoDefensor(y);
+            int pares = na < nd ? na : nd;
+            for (int k = 0; k <= pares; k++) {
+                double p = massa * cache->chances[na][nd][k];
+                int nx = x - (pares - k), ny = y - k;
+                if (ny == 0 || nx == 1) {
+                    desfechos[indiceDesfecho(atacante, nx, ny)] += p;
+                } else {
+                    linhas[(size_t) (nx % 3) * largura + (size_t) ny] += p;
+                }
+            }
+        }
+        memset(linha, 0, sizeof(double) * largura); // A linha será reusada por x - 3
+    }
+    free(linhas);
+
+    // Acumulada dividida pelo total: o arredondamento da soma não a deixa
+    // passar de 1 antes do último desfecho, que vale exatamente 1
+    double soma = 0.0;
+    for (int i = 0; i < n; i++) {
+        soma += desfechos[i];
+        desfechos[i] = soma;
+    }
+    for (int i = 0; i < n - 1; i++) {
+        desfechos[i] /= soma;
+    }
+    desfechos[n - 1] = 1.0;
+    for (int k = 0, i = 0; k < n; k++) {
+        while (desfechos[i] <= (double) k / n) i++;
+        guia[k] = (uint32_t) i;
+    }
+
+    tabela->regra = regra;
+    tabela->atacante = atacante;
+    tabela->defensor = defensor;
+    tabela->numDesfechos = n;
+    tabela->acumulada = desfechos;
+    tabela->guia = guia;
+    return 1;
+}
+
+/*
+ * Função: buscarTabelaRelampago
+ * Devolve a tabela de (regra, atacante, defensor), montando-a se não
+ * estiver no cache (substitui a que ocupava a mesma entrada)
+ * Retorna NULL se faltar memória
+ */
+static inline const TabelaRelampago* buscarTabelaRelampago(CacheRelampago* cache, RegraBatalha regra,
+                                                           int atacante, int defensor) {
+    uint32_t hash = ((uint32_t) atacante * 0x9E3779B1u) ^ ((uint32_t) defensor * 0x85EBCA77u) ^ (uint32_t) regra;
+    TabelaRelampago* entrada = &cache->entradas[(hash >> 16) % ENTRADAS_CACHE_RELAMPAGO];
+    cache->consultas++;
+
+    if (entrada->acumulada != NULL && entrada->regra == regra &&
+        entrada->atacante == atacante && entrada->defensor == defensor) {
+        return entrada;
+    }
+
+    TabelaRelampago nova;
+    if (!montarTabelaRelampago(cache, &nova, regra, atacante, defensor)) {
+        return NULL;
+    }
+    free(entrada->acumulada);
+    *entrada = nova;
+    cache->construidas++;
+    return entrada;
+}
+
+/*
+ * Função: sortearDesfecho
+ * Sorteia um desfecho da tabela com um único número aleatório
+ * Retorna o índice do desfecho (ver indiceDesfecho)
+ */
+static inline int sortearDesfecho(const TabelaRelampago* tabela, GeradorDados* dados) {
+    double u = sortearUniforme(dados);
+    uint32_t i = tabela->guia[(int) (u * tabela->numDesfechos)];
+    while (tabela->acumulada[i] <= u) i++;
+    return (int) i;
+}
+
+// ==================== APLICAÇÃO ====================
+
+/*
+ * Função: aplicarRelampago
+ * Leva os dois territórios ao estado final de um ataque até o fim
+ * ("atacanteFinal" tropas restantes no atacante e "defensorFinal" no
+ * defensor; defensorFinal = 0 é conquista). Na conquista, a regra simples
+ * move metade das tropas e a clássica move até 3 (uma por dado)
+ */
+static inline void aplicarRelampago(RegraBatalha regra, Territorio* atacante, Territorio* defensor,
+                                    int atacanteFinal, int defensorFinal, ResultadoBatalha* resultado) {
+    memset(resultado, 0, sizeof(*resultado));
+    resultado->codigo = ATAQUE_OK;
+    resultado->relampago = 1;
+    resultado->perdasAtacante = atacante->tropas - atacanteFinal;
+    resultado->perdasDefensor = defensor->tropas - defensorFinal;
+
+    atacante->tropas = atacanteFinal;
+    defensor->tropas = defensorFinal;
+    if (defensorFinal > 0) {
+        return;
+    }
+
+    int tropasTransferidas = regra == REGRA_CLASSICA ? dadosDoAtacante(atacanteFinal) : atacanteFinal / 2;
+    if (tropasTransferidas < 1) tropasTransferidas = 1;
+
+    defensor->cor = atacante->cor;
+    defensor->tropas = tropasTransferidas;
+    atacante->tropas -= tropasTransferidas;
+
+    resultado->conquistou = 1;
+    resultado->tropasMovidas = tropasTransferidas;
+}
+
+/*
+ * Função: rolarAteOFim
+ * Caminho sem tabela: rola batalha a batalha sobre as contagens de tropas
+ * até o defensor cair ou o atacante ficar com 1 (um defensor sem tropas
+ * cai sem combate)
+ */
+static inline void rolarAteOFim(RegraBatalha regra, GeradorDados* dados, int* atacante, int* defensor) {
+    if (*defensor < 1) {
+        *defensor = 0;
+        return;
+    }
+    while (*atacante > 1 && *defensor > 0) {
+        if (regra == REGRA_CLASSICA) {
+            uint8_t ataque[DADOS_ATAQUE], defesa[DADOS_DEFESA];
+            int perdasAtacante, perdasDefensor;
+            rolarCombate(dados, dadosDoAtacante(*atacante), dadosDoDefensor(*defensor), ataque, defesa);
+            compararDados(ataque, defesa, &perdasAtacante, &perdasDefensor);
+            *atacante -= perdasAtacante;
+            *defensor -= perdasDefensor;
+        } else if (rolarDado(dados) > rolarDado(dados)) {
+            *defensor = 0;
+        } else {
+            (*atacante)--;
+        }
+    }
+}
+
+/*
+ * Função: relampagoNoJogo
+ * Resolve um ataque até o fim já validado, mantendo agregados e colunas
+ * Retorna 1 em caso de sucesso, 0 se faltar memória para a tabela
+ */
+static inline int relampagoNoJogo(Jogo* jogo, CacheRelampago* cache, int atacante, int defensor,
+                                  ResultadoBatalha* resultado) {
+    Territorio* a = &jogo->mapa[atacante];
+    Territorio* d = &jogo->mapa[defensor];
+    int atacanteFinal = a->tropas, defensorFinal = d->tropas;
+
+    if (d->tropas < 1 || (long long) a->tropas * d->tropas > LIMITE_ESTADOS_RELAMPAGO) {
+        // Defensor vazio ou exércitos grandes demais para a tabela
+        rolarAteOFim(jogo->regra, &jogo->dados, &atacanteFinal, &defensorFinal);
+    } else {
+        const TabelaRelampago* tabela = buscarTabelaRelampago(cache, jogo->regra, a->tropas, d->tropas);
+        if (tabela == NULL) {
+            return 0;
+        }
+        int desfecho = sortearDesfecho(tabela, &jogo->dados);
+        if (desfecho < tabela->atacante - 1) {
+            atacanteFinal = desfecho + 2;
+            defensorFinal = 0;
+        } else {
+            atacanteFinal = 1;
+            defensorFinal = desfecho - (tabela->atacante - 1) + 1;
+        }
+    }
+
+    retirarDaBatalha(jogo, atacante, defensor);
+    aplicarRelampago(jogo->regra, a, d, atacanteFinal, defensorFinal, resultado);
+    devolverDaBatalha(jogo, atacante, defensor);
+    return 1;
+}
+
+#endif // WAR_RELAMPAGO_H
@@ -0,0 +1,424 @@
+/*
+ * Salvamento de Partidas do Sistema WAR
+ *
+ * Grava o estado completo de uma partida (territórios, jogadores com as
+ * missões, turno, cores, agregados e o estado do gerador de dados) em um
+ * arquivo binário versionado:
+ *
+ *   [CabecalhoSalvamento][Jogador x numJogadores][Territorio x numTerritorios]
+ *   [fronteiras (CSR), se houver][pool de nomes]
+ *
+ * A gravação é uma única chamada writev em um arquivo temporário, renomeado
+ * por cima do anterior (um salvamento interrompido não estraga o último).
+ * A restauração mapeia o arquivo com mmap, como o mapa binário do
+ * carregador, então continuar uma partida não repete nenhuma jogada.
+ *
+ * O salvamento periódico copia o estado para um buffer e deixa a escrita
+ * no disco para uma thread separada: o menu não espera o disco nem a
+ * thread (os buffers se alternam e só a troca acontece sob a trava).
+ */
+
+#ifndef WAR_SALVAMENTO_H
+#define WAR_SALVAMENTO_H
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "war_carregador.h"
+#include "war_engine.h"
+#include "war_missoes.h"
+
+// Identificação do formato de salvamento
+#define MAGICA_SALVAMENTO "WARSAVE1"
+#define VERSAO_SALVAMENTO 3
+
+// Cabeçalho do arquivo de salvamento
+typedef struct {
+    char magica[8];              // MAGICA_SALVAMENTO (sem '\0')
+    uint32_t versao;             // VERSAO_SALVAMENTO
+    uint32_t tamanhoTerritorio;  // sizeof(Territorio) de quem gravou
+    uint32_t tamanhoJogador;     // sizeof(Jogador) de quem gravou
+    uint32_t numJogadores;
+    uint64_t numTerritorios;
+    int64_t turno;
+    uint64_t deslocamentoMapa;   // Início dos territórios no arquivo
+    uint64_t numVizinhos;        // Entradas do vetor "vizinhos" do CSR
+    uint32_t temFronteiras;      // 1 se o CSR foi gravado após os territórios
+    uint32_t regra;              // RegraBatalha da partida (0 = simples, como nas versões anteriores)
+    uint64_t tamanhoNomes;       // Bytes do pool de nomes, gravado após o CSR
+    TabelaCores cores;
+    AgregadosMapa agregados;
+    GeradorDados dados;          // Fluxo de dados exatamente onde parou
+} CabecalhoSalvamento;
+
+/*
+ * Função: montarCabecalhoSalvamento
+ * Preenche o cabeçalho de um salvamento a partir do estado da partida
+ */
+static inline void montarCabecalhoSalvamento(CabecalhoSalvamento* cabecalho, const Jogo* jogo,
+                                             int numJogadores, int turno) {
+    memset(cabecalho, 0, sizeof(*cabecalho));
+    memcpy(cabecalho->magica, MAGICA_SALVAMENTO, 8);
+    cabecalho->versao = VERSAO_SALVAMENTO;
+    cabecalho->tamanhoTerritorio = sizeof(Territorio);
+    cabecalho->tamanhoJogador = sizeof(Jogador);
+    cabecalho->numJogadores = (uint32_t) numJogadores;
+    cabecalho->numTerritorios = (uint64_t) jogo->numTerritorios;
+    cabecalho->turno = turno;
+    cabecalho->deslocamentoMapa = sizeof(CabecalhoSalvamento) + sizeof(Jogador) * (size_t) numJogadores;
+    cabecalho->temFronteiras = grafoAtivo(&jogo->grafo) ? 1 : 0;
+    cabecalho->numVizinhos = cabecalho->temFronteiras ? jogo->grafo.numVizinhos : 0;
+    cabecalho->tamanhoNomes = tamanhoPool(&jogo->pool);
+    cabecalho->cores = jogo->cores;
+    cabecalho->agregados = jogo->agregados;
+    cabecalho->dados = jogo->dados;
+    cabecalho->regra = (uint32_t) jogo->regra;
+}
+
+/*
+ * Função: tamanhoFronteiras
+ * Bytes ocupados pelo CSR no arquivo (0 se o mapa não tem fronteiras)
+ */
+static inline size_t tamanhoFronteiras(const GrafoAdjacencia* grafo) {
+    if (!grafoAtivo(grafo)) {
+        return 0;
+    }
+    return sizeof(uint32_t) * ((size_t) grafo->numTerritorios + 1 + grafo->numVizinhos);
+}
+
+/*
+ * Função: gravarPartes
+ * Grava as partes em "caminho" com writev (via arquivo temporário + rename)
+ */
+static inline CodigoCarga gravarPartes(const char* caminho, struct iovec* partes, int numPartes) {
+    char temporario[512];
+    if (snprintf(temporario, sizeof(temporario), "%s.tmp", caminho) >= (int) sizeof(temporario)) {
+        return CARGA_ERRO_ARQUIVO;
+    }
+
+    int fd = open(temporario, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return CARGA_ERRO_ARQUIVO;
+    }
+
+    // Normalmente uma única chamada; o laço só cobre escritas parciais
+    int atual = 0;
+    while (atual < numPartes) {
+        ssize_t escritos = writev(fd, partes + atual, numPartes - atual);
+        if (escritos < 0) {
+            close(fd);
+            unlink(temporario);
+            return CARGA_ERRO_ARQUIVO;
+        }
+        while (atual < numPartes && (size_t) escritos >= partes[atual].iov_len) {
+            escritos -= (ssize_t) partes[atual].iov_len;
+            atual++;
+        }
+        if (atual < numPartes) {
+            partes[atual].iov_base = (char*) partes[atual].iov_base + escritos;
+            partes[atual].iov_len -= (size_t) escritos;
+        }
+    }
+
+    if (fsync(fd) != 0 || close(fd) != 0 || rename(temporario, caminho) != 0) {
+        unlink(temporario);
+        return CARGA_ERRO_ARQUIVO;
+    }
+    return CARGA_OK;
+}
+
+/*
+ * Função: salvarPartida
+ * Grava o estado completo da partida em "caminho"
+ */
+static inline CodigoCarga salvarPartida(const char* caminho, const Jogo* jogo,
+                                        const Jogador* jogadores, int numJogadores, int turno) {
+    CabecalhoSalvamento cabecalho;
+    montarCabecalhoSalvamento(&cabecalho, jogo, numJogadores, turno);
+
+    size_t tamanhoInicio = cabecalho.temFronteiras ? sizeof(uint32_t) * ((size_t) jogo->numTerritorios + 1) : 0;
+    struct iovec partes[6] = {
+        { &cabecalho, sizeof(cabecalho) },
+        { (void*) jogadores, sizeof(Jogador) * (size_t) numJogadores },
+        { jogo->mapa, sizeof(Territorio) * (size_t) jogo->numTerritorios },
+        { (void*) jogo->grafo.inicio, tamanhoInicio },
+        { (void*) jogo->grafo.vizinhos, sizeof(uint32_t) * (size_t) cabecalho.numVizinhos },
+        { (void*) textoPool(&jogo->pool), (size_t) cabecalho.tamanhoNomes }
+    };
+    return gravarPartes(caminho, partes, 6);
+}
+
+/*
+ * Função: validarJogadores
+ * Confere os jogadores lidos de um salvamento: nome terminado em '\0',
+ * cor internada e missão válida
+ * Retorna 1 se todos são válidos
+ */
+static inline int validarJogadores(const Jogador* jogadores, uint32_t numJogadores, int numCores) {
+    for (uint32_t i = 0; i < numJogadores; i++) {
+        if (memchr(jogadores[i].nome, '\0', sizeof(jogadores[i].nome)) == NULL ||
+            jogadores[i].cor >= numCores || !validarMissao(&jogadores[i].missao, numCores)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Função: restaurarPartida
+ * Restaura uma partida salva: o mapa e os nomes ficam mapeados do arquivo
+ * (cópia privada, liberar com liberarMapa) e os jogadores são copiados
+ * para um vetor alocado (liberar com free)
+ * Jogadores, territórios e fronteiras são conferidos como no mapa binário
+ * e os agregados são refeitos, então um arquivo adulterado é recusado
+ */
+static inline CodigoCarga restaurarPartida(const char* caminho, Jogo* jogo, Jogador** jogadores,
+                                           int* numJogadores, int* turno) {
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) {
+        return CARGA_ERRO_ARQUIVO;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(CabecalhoSalvamento)) {
+        close(fd);
+        return CARGA_ERRO_FORMATO;
+    }
+
+    size_t tamanho = (size_t) info.st_size;
+    void* regiao = mmap(NULL, tamanho, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (regiao == MAP_FAILED) {
+        return CARGA_ERRO_MEMORIA;
+    }
+
+    const CabecalhoSalvamento* cabecalho = (const CabecalhoSalvamento*) regiao;
+    size_t esperado = sizeof(CabecalhoSalvamento) + sizeof(Jogador) * (size_t) cabecalho->numJogadores;
+    size_t tamanhoMapa = sizeof(Territorio) * cabecalho->numTerritorios;
+    size_t tamanhoGrafo = cabecalho->temFronteiras
+                        ? sizeof(uint32_t) * (cabecalho->numTerritorios + 1 + cabecalho->numVizinhos)
+                        : 0;
+    PoolNomes pool;
+    if (memcmp(cabecalho->magica, MAGICA_SALVAMENTO, 8) != 0 ||
+        cabecalho->versao != VERSAO_SALVAMENTO ||
+        cabecalho->tamanhoTerritorio != sizeof(Territorio) ||
+        cabecalho->tamanhoJogador != sizeof(Jogador) ||
+        cabecalho->numJogadores == 0 ||
+        cabecalho->numTerritorios == 0 || cabecalho->numTerritorios > INT32_MAX ||
+        cabecalho->numVizinhos > UINT32_MAX || cabecalho->tamanhoNomes > UINT32_MAX ||
+        !validarCores(&cabecalho->cores) ||
+        cabecalho->deslocamentoMapa != esperado ||
+        tamanho < esperado + tamanhoMapa + tamanhoGrafo + cabecalho->tamanhoNomes ||
+        !apontarPool(&pool, (const char*) regiao + esperado + tamanhoMapa + tamanhoGrafo, cabecalho->tamanhoNomes) ||
+        !validarJogadores((const Jogador*) ((const char*) regiao + sizeof(CabecalhoSalvamento)),
+                          cabecalho->numJogadores, cabecalho->cores.total) ||
+        !validarTerritorios((const Territorio*) ((const char*) regiao + esperado),
+                            (int) cabecalho->numTerritorios, cabecalho->cores.total, cabecalho->tamanhoNomes) ||
+        (cabecalho->temFronteiras &&
+         !validarGrafo((const uint32_t*) ((const char*) regiao + esperado + tamanhoMapa),
+                       (const uint32_t*) ((const char*) regiao + esperado + tamanhoMapa) + cabecalho->numTerritorios + 1,
+                       (int) cabecalho->numTerritorios, (uint32_t) cabecalho->numVizinhos))) {
+        munmap(regiao, tamanho);
+        return CARGA_ERRO_FORMATO;
+    }
+
+    Jogador* vetor = (Jogador*) malloc(sizeof(Jogador) * cabecalho->numJogadores);
+    if (vetor == NULL) {
+        munmap(regiao, tamanho);
+        return CARGA_ERRO_MEMORIA;
+    }
+    memcpy(vetor, (const char*) regiao + sizeof(CabecalhoSalvamento),
+           sizeof(Jogador) * cabecalho->numJogadores);
+
+    inicializarGrafo(&jogo->grafo);
+    if (cabecalho->temFronteiras) {
+        const uint32_t* inicio = (const uint32_t*) ((const char*) regiao + esperado + tamanhoMapa);
+        jogo->grafo.numTerritorios = (int) cabecalho->numTerritorios;
+        jogo->grafo.numVizinhos = (uint32_t) cabecalho->numVizinhos;
+        jogo->grafo.inicio = inicio;
+        jogo->grafo.vizinhos = inicio + cabecalho->numTerritorios + 1;
+    }
+
+    jogo->mapa = (Territorio*) ((char*) regiao + cabecalho->deslocamentoMapa);
+    jogo->numTerritorios = (int) cabecalho->numTerritorios;
+    jogo->pool = pool;
+    jogo->cores = cabecalho->cores;
+    jogo->dados = cabecalho->dados;
+    jogo->regra = cabecalho->regra == REGRA_CLASSICA ? REGRA_CLASSICA : REGRA_SIMPLES;
+    jogo->regiaoMapeada = regiao;
+    jogo->tamanhoRegiao = tamanho;
+    recalcularAgregados(jogo);
+
+    *jogadores = vetor;
+    *numJogadores = (int) cabecalho->numJogadores;
+    *turno = (int) cabecalho->turno;
+    return CARGA_OK;
+}
+
+// ==================== SALVAMENTO PERIÓDICO ====================
+
+// Cópia do estado em um dos buffers do salvamento periódico
+typedef struct {
+    char* dados;
+    size_t tamanho;
+    size_t capacidade;
+} CopiaSalvamento;
+
+// Salvamento em segundo plano: o menu monta a cópia em um buffer só seu
+// e, sob a trava, apenas a troca com o buffer entregue à thread
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t trava;
+    pthread_cond_t sinal;
+    char caminho[256];
+    CopiaSalvamento montagem;  // Do menu: montada fora da trava
+    CopiaSalvamento entregue;  // Aguardando a thread (válida se "pendente")
+    CopiaSalvamento gravando;  // Da thread: em gravação fora da trava
+    int pendente;              // 1 enquanto "entregue" não foi retirada pela thread
+    int encerrar;
+    int substituidos;          // Cópias trocadas por uma mais nova antes de gravadas
+    CodigoCarga ultimoCodigo;  // Resultado da última gravação
+    int ultimoTurno;           // Turno da última cópia gravada (-1 se nenhuma)
+} SalvamentoPeriodico;
+
+/*
+ * Função: trocarCopias
+ * Troca o conteúdo de dois buffers (só os ponteiros e tamanhos)
+ */
+static inline void trocarCopias(CopiaSalvamento* a, CopiaSalvamento* b) {
+    CopiaSalvamento temporaria = *a;
+    *a = *b;
+    *b = temporaria;
+}
+
+/*
+ * Função: lacoSalvamento
+ * Thread que grava as cópias entregues por agendarSalvamento()
+ */
+static inline void* lacoSalvamento(void* argumento) {
+    SalvamentoPeriodico* sp = (SalvamentoPeriodico*) argumento;
+
+    pthread_mutex_lock(&sp->trava);
+    for (;;) {
+        while (!sp->pendente && !sp->encerrar) {
+            pthread_cond_wait(&sp->sinal, &sp->trava);
+        }
+        if (!sp->pendente) {
+            break; // Encerrando sem nada para gravar
+        }
+
+        // Retira a cópia entregue: o menu já pode entregar a próxima
+        trocarCopias(&sp->entregue, &sp->gravando);
+        sp->pendente = 0;
+        pthread_mutex_unlock(&sp->trava);
+        struct iovec parte = { sp->gravando.dados, sp->gravando.tamanho };
+        CodigoCarga codigo = gravarPartes(sp->caminho, &parte, 1);
+        int turno = (int) ((const CabecalhoSalvamento*) sp->gravando.dados)->turno;
+        pthread_mutex_lock(&sp->trava);
+
+        sp->ultimoCodigo = codigo;
+        sp->ultimoTurno = codigo == CARGA_OK ? turno : sp->ultimoTurno;
+    }
+    pthread_mutex_unlock(&sp->trava);
+    return NULL;
+}
+
+/*
+ * Função: iniciarSalvamentoPeriodico
+ * Cria a thread de salvamento que grava em "caminho"
+ * Retorna 1 em caso de sucesso, 0 em caso de erro
+ */
+static inline int iniciarSalvamentoPeriodico(SalvamentoPeriodico* sp, const char* caminho) {
+    memset(sp, 0, sizeof(*sp));
+    if (strlen(caminho) >= sizeof(sp->caminho)) {
+        return 0;
+    }
+    strcpy(sp->caminho, caminho);
+    sp->ultimoCodigo = CARGA_OK;
+    sp->ultimoTurno = -1;
+    pthread_mutex_init(&sp->trava, NULL);
+    pthread_cond_init(&sp->sinal, NULL);
+
+    if (pthread_create(&sp->thread, NULL, lacoSalvamento, sp) != 0) {
+        pthread_mutex_destroy(&sp->trava);
+        pthread_cond_destroy(&sp->sinal);
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * Função: agendarSalvamento
+ * Copia o estado atual para gravação em segundo plano. A cópia é feita
+ * sem a trava, no buffer do menu; sob a trava ela só é trocada com a
+ * entregue. Se a thread ainda não retirou a cópia anterior, a nova a
+ * substitui (conta em "substituidos"): grava-se sempre o estado mais novo
+ * Retorna 1 se a cópia foi agendada, 0 se faltou memória
+ */
+static inline int agendarSalvamento(SalvamentoPeriodico* sp, const Jogo* jogo,
+                                    const Jogador* jogadores, int numJogadores, int turno) {
+    CopiaSalvamento* copia = &sp->montagem;
+    size_t tamanhoJogadores = sizeof(Jogador) * (size_t) numJogadores;
+    size_t tamanhoMapa = sizeof(Territorio) * (size_t) jogo->numTerritorios;
+    size_t tamanhoGrafo = tamanhoFronteiras(&jogo->grafo);
+    size_t tamanhoNomes = tamanhoPool(&jogo->pool);
+    size_t total = sizeof(CabecalhoSalvamento) + tamanhoJogadores + tamanhoMapa + tamanhoGrafo + tamanhoNomes;
+    if (total > copia->capacidade) {
+        char* novo = (char*) realloc(copia->dados, total);
+        if (novo == NULL) {
+            return 0;
+        }
+        copia->dados = novo;
+        copia->capacidade = total;
+    }
+
+    montarCabecalhoSalvamento((CabecalhoSalvamento*) copia->dados, jogo, numJogadores, turno);
+    memcpy(copia->dados + sizeof(CabecalhoSalvamento), jogadores, tamanhoJogadores);
+    char* destino = copia->dados + sizeof(CabecalhoSalvamento) + tamanhoJogadores;
+    memcpy(destino, jogo->mapa, tamanhoMapa);
+    if (tamanhoGrafo > 0) {
+        size_t tamanhoInicio = sizeof(uint32_t) * ((size_t) jogo->numTerritorios + 1);
+        memcpy(destino + tamanhoMapa, jogo->grafo.inicio, tamanhoInicio);
+        memcpy(destino + tamanhoMapa + tamanhoInicio, jogo->grafo.vizinhos, tamanhoGrafo - tamanhoInicio);
+    }
+    memcpy(destino + tamanhoMapa + tamanhoGrafo, textoPool(&jogo->pool), tamanhoNomes);
+    copia->tamanho = total;
+
+    pthread_mutex_lock(&sp->trava);
+    trocarCopias(&sp->montagem, &sp->entregue);
+    sp->substituidos += sp->pendente;
+    sp->pendente = 1;
+    pthread_cond_signal(&sp->sinal);
+    pthread_mutex_unlock(&sp->trava);
+    return 1;
+}
+
+/*
+ * Função: encerrarSalvamentoPeriodico
+ * Termina a gravação pendente, encerra a thread e libera os buffers
+ * Retorna o resultado da última gravação
+ */
+static inline CodigoCarga encerrarSalvamentoPeriodico(SalvamentoPeriodico* sp) {
+    pthread_mutex_lock(&sp->trava);
+    sp->encerrar = 1;
+    pthread_cond_signal(&sp->sinal);
+    pthread_mutex_unlock(&sp->trava);
+
+    pthread_join(sp->thread, NULL);
+    pthread_mutex_destroy(&sp->trava);
+    pthread_cond_destroy(&sp->sinal);
+    free(sp->montagem.dados);
+    free(sp->entregue.dados);
+    free(sp->gravando.dados);
+    return sp->ultimoCodigo;
+}
+
+#endif // WAR_SALVAMENTO_H
@@ -0,0 +1,450 @@
+/*
+ * Servidor de Partidas do Sistema WAR
+ *
+ * Um único processo hospeda muitas partidas independentes: cada conexão
+ * em um socket Unix local é uma sessão com a sua própria cópia do mapa e
+ * dos jogadores, falando o protocolo de comandos de war_comandos.h. Um
+ * laço epoll atende todas as conexões em uma só thread, então o motor
+ * não precisa de travas.
+ *
+ * O que não muda durante a partida é compartilhado entre as sessões: cores,
+ * fronteiras, a tabela de chances e as tabelas do ataque relâmpago. Cada
+ * sessão guarda só o mapa, os jogadores, o fluxo de dados (o fluxo
+ * "número da sessão" da semente) e os buffers de entrada e saída.
+ *
+ * Toda a memória de uma sessão (a própria sessão, mapa, jogadores e os
+ * buffers iniciais) vem de uma única arena. Ao fim da conexão a arena é
+ * reiniciada e guardada para a próxima sessão, então abrir e fechar
+ * milhares de partidas não passa pelo malloc a cada vez.
+ *
+ * As respostas ficam na Tela da sessão até o socket aceitar; enquanto
+ * houver muitas respostas pendentes, a sessão deixa de ler comandos
+ * (o cliente que não lê as respostas não faz o servidor crescer).
+ */
+
+#ifndef WAR_SERVIDOR_H
+#define WAR_SERVIDOR_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "war_arena.h"
+#include "war_comandos.h"
+#include "war_metricas.h"
+
+// Buffers iniciais de entrada e de respostas de cada sessão (crescem se preciso)
+#define CAPACIDADE_LEITOR_SESSAO 1024
+#define CAPACIDADE_SAIDA_SESSAO 2048
+
+// Arenas de sessões encerradas guardadas para reaproveitamento
+#define MAX_ARENAS_LIVRES 1024
+
+// Maior linha aceita de um cliente; acima disso a sessão é encerrada
+#define LIMITE_LINHA_SESSAO 65536
+
+// Respostas pendentes a partir das quais a sessão para de ler comandos
+#define LIMITE_PENDENTE_SESSAO (256 * 1024)
+
+// Eventos tratados por chamada a epoll_wait()
+#define EVENTOS_POR_ESPERA 64
+
+// Uma conexão e a partida que ela joga
+typedef struct SessaoServidor {
+    Arena* arena;                // Arena que contém a sessão e a sua partida
+    int fd;
+    Jogo jogo;                   // Mapa próprio; cores e fronteiras copiadas do inicial
+    Jogador* jogadores;
+    SessaoComandos comandos;
+    LeitorLinhas leitor;
+    Tela saida;                  // Respostas; [enviado, tamanho) ainda não foi enviado
+    size_t enviado;
+    uint32_t eventos;            // Eventos registrados no epoll
+    int encerrar;                // Fechar assim que as respostas forem enviadas
+    struct SessaoServidor* anterior;
+    struct SessaoServidor* proxima;
+} SessaoServidor;
+
+typedef struct {
+    int fd;                      // Socket de escuta
+    int epoll;
+    const char* caminho;
+    const Jogo* inicial;         // Partida que cada sessão copia
+    const Jogador* jogadores;
+    int numJogadores;
+    CacheRelampago* relampago;   // Compartilhados (o servidor tem uma só thread)
+    TabelaChances* chances;
+    uint64_t semente;
+    SessaoServidor* sessoes;     // Lista das sessões abertas
+    Arena* arenasLivres;         // Arenas reiniciadas, prontas para novas sessões
+    int numArenasLivres;
+    size_t tamanhoArena;         // Capacidade da arena de uma sessão
+    uint64_t sessoesCriadas;
+    int sessoesAtivas;
+    long long comandos;          // Comandos das sessões já encerradas
+} Servidor;
+
+// Ligado pelos sinais de encerramento
+static volatile sig_atomic_t servidorInterrompido = 0;
+
+static inline void interromperServidor(int sinal) {
+    (void) sinal;
+    servidorInterrompido = 1;
+}
+
+// ==================== SESSÕES ====================
+
+/*
+ * Função: tamanhoArenaSessao
+ * Bytes que a arena de uma sessão precisa para a partida inicial
+ */
+static inline size_t tamanhoArenaSessao(const Servidor* servidor) {
+    int numTerritorios = servidor->inicial->numTerritorios;
+    return tamanhoReserva(sizeof(SessaoServidor)) +
+           tamanhoReserva(sizeof(Territorio) * (size_t) numTerritorios) +
+           tamanhoReserva(sizeof(Jogador) * (size_t) servidor->numJogadores) +
+           tamanhoReserva(CAPACIDADE_LEITOR_SESSAO) +
+           tamanhoReserva(CAPACIDADE_SAIDA_SESSAO) +
+           tamanhoReserva(tamanhoAlterados(numTerritorios));
+}
+
+/*
+ * Função: liberarSessao
+ * Libera o que a sessão alocou fora da arena (buffers que cresceram,
+ * colunas, posse, grupos de jogadas, um mapa trocado) e devolve a arena
+ * inteira de uma vez: ela é reiniciada e guardada para a próxima sessão
+ * (ou liberada, se já há muitas)
+ * O socket já deve estar fechado
+ */
+static inline void liberarSessao(Servidor* servidor, SessaoServidor* sessao) {
+    Arena* arena = sessao->arena;   // A sessão mora na própria arena
+
+    liberarMapa(&sessao->jogo);   // As fronteiras não pertencem à sessão
+    liberarLeitorLinhas(&sessao->leitor);
+    liberarTela(&sessao->saida);
+    if (servidor->numArenasLivres < MAX_ARENAS_LIVRES) {
+        reiniciarArena(arena);
+        arena->proxima = servidor->arenasLivres;
+        servidor->arenasLivres = arena;
+        servidor->numArenasLivres++;
+    } else {
+        liberarArena(arena);
+    }
+}
+
+/*
+ * Função: obterArenaSessao
+ * Reaproveita uma arena livre ou cria uma nova
+ */
+static inline Arena* obterArenaSessao(Servidor* servidor) {
+    Arena* arena = servidor->arenasLivres;
+    if (arena == NULL) {
+        return criarArena(servidor->tamanhoArena);
+    }
+    servidor->arenasLivres = arena->proxima;
+    servidor->numArenasLivres--;
+    arena->proxima = NULL;
+    return arena;
+}
+
+/*
+ * Função: criarSessao
+ * Cria a partida de uma nova conexão como cópia da partida inicial,
+ * com tudo reservado em uma única arena
+ * Retorna a sessão ou NULL se faltar memória
+ */
+static inline SessaoServidor* criarSessao(Servidor* servidor, int fd) {
+    const Jogo* inicial = servidor->inicial;
+    Arena* arena = obterArenaSessao(servidor);
+    if (arena == NULL) {
+        return NULL;
+    }
+
+    // A arena foi dimensionada para estas reservas, que não falham
+    SessaoServidor* sessao = (SessaoServidor*) reservarArena(arena, sizeof(SessaoServidor));
+    sessao->arena = arena;
+    sessao->fd = fd;
+    sessao->jogo = *inicial;   // Cores, agregados, regra, fronteiras, continentes e nomes (somente leitura)
+    sessao->jogo.grafo.memoria = NULL;
+    sessao->jogo.continentes.memoria = NULL;
+    sessao->jogo.pool.memoria = NULL;
+    sessao->jogo.nomes.memoria = NULL;
+    sessao->jogo.regiaoMapeada = NULL;
+    sessao->jogo.tamanhoRegiao = 0;
+    memset(&sessao->jogo.busca, 0, sizeof(BuscaGrafo));
+    memset(&sessao->jogo.colunas, 0, sizeof(MapaColunar));
+    memset(&sessao->jogo.posse, 0, sizeof(PosseCores));
+    memset(&sessao->jogo.jogadas, 0, sizeof(JogadasCores));   // Criados pelo comando "jogadas", se usado
+    inicializarGerador(&sessao->jogo.dados, servidor->semente, ++servidor->sessoesCriadas);
+
+    sessao->jogo.mapa = (Territorio*) reservarArena(arena, sizeof(Territorio) * (size_t) inicial->numTerritorios);
+    sessao->jogo.mapaExterno = 1;
+    sessao->jogadores = (Jogador*) reservarArena(arena, sizeof(Jogador) * (size_t) servidor->numJogadores);
+    criarLeitorLinhasEm(&sessao->leitor, fd, (char*) reservarArena(arena, CAPACIDADE_LEITOR_SESSAO),
+                        CAPACIDADE_LEITOR_SESSAO);
+    criarTelaEm(&sessao->saida, inicial->numTerritorios,
+                (char*) reservarArena(arena, CAPACIDADE_SAIDA_SESSAO), CAPACIDADE_SAIDA_SESSAO,
+                (uint64_t*) reservarArena(arena, tamanhoAlterados(inicial->numTerritorios)));
+
+    if ((inicial->colunas.donos != NULL && !criarMapaColunar(&sessao->jogo.colunas, inicial->numTerritorios)) ||
+        (inicial->posse.bits != NULL &&
+         !criarPosse(&sessao->jogo.posse, inicial->numTerritorios, (int) inicial->posse.linhas))) {
+        liberarSessao(servidor, sessao);
+        return NULL;
+    }
+    memcpy(sessao->jogo.mapa, inicial->mapa, sizeof(Territorio) * (size_t) inicial->numTerritorios);
+    memcpy(sessao->jogadores, servidor->jogadores, sizeof(Jogador) * (size_t) servidor->numJogadores);
+    if (sessao->jogo.colunas.donos != NULL) {
+        copiarMapaColunar(&sessao->jogo.colunas, &inicial->colunas);
+    }
+    if (sessao->jogo.posse.bits != NULL) {
+        copiarPosse(&sessao->jogo.posse, &inicial->posse);
+    }
+
+    SessaoComandos comandos = {&sessao->jogo, sessao->jogadores, servidor->numJogadores, NULL,
+                               servidor->relampago, servidor->chances, NULL, 1, 0};
+    sessao->comandos = comandos;
+    escreverPronto(&sessao->comandos, &sessao->saida);
+    return sessao;
+}
+
+/*
+ * Função: fecharSessao
+ * Retira a sessão do epoll e da lista, fecha o socket e libera a memória
+ */
+static inline void fecharSessao(Servidor* servidor, SessaoServidor* sessao) {
+    epoll_ctl(servidor->epoll, EPOLL_CTL_DEL, sessao->fd, NULL);
+    close(sessao->fd);
+    if (sessao->anterior != NULL) {
+        sessao->anterior->proxima = sessao->proxima;
+    } else {
+        servidor->sessoes = sessao->proxima;
+    }
+    if (sessao->proxima != NULL) {
+        sessao->proxima->anterior = sessao->anterior;
+    }
+    servidor->sessoesAtivas--;
+    mudarSessoesAbertas(-1);
+    servidor->comandos += sessao->comandos.executados;
+    liberarSessao(servidor, sessao);
+}
+
+/*
+ * Função: enviarSessao
+ * Envia o que o socket aceitar das respostas pendentes
+ * Retorna 1 se a sessão continua utilizável, 0 se a conexão falhou
+ */
+static inline int enviarSessao(SessaoServidor* sessao) {
+    uint64_t medida = iniciarMedida();
+    size_t enviadoAntes = sessao->enviado;
+
+    while (sessao->enviado < sessao->saida.tamanho) {
+        ssize_t escrito = send(sessao->fd, sessao->saida.texto + sessao->enviado,
+                               sessao->saida.tamanho - sessao->enviado, MSG_NOSIGNAL);
+        if (escrito < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            contarMetrica(CONTADOR_BYTES_SAIDA, sessao->enviado - enviadoAntes);
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        sessao->enviado += (size_t) escrito;
+    }
+    contarMetrica(CONTADOR_BYTES_SAIDA, sessao->enviado - enviadoAntes);
+    encerrarMedida(LATENCIA_SAIDA, medida);
+    sessao->saida.tamanho = 0;
+    sessao->enviado = 0;
+    return 1;
+}
+
+/*
+ * Função: atenderSessao
+ * Executa os comandos completos já lidos, envia as respostas e escolhe
+ * o próximo evento esperado: leitura se tudo foi enviado, escrita se não
+ * Retorna 0 se a sessão foi fechada
+ */
+static inline int atenderSessao(Servidor* servidor, SessaoServidor* sessao) {
+    char* linha;
+
+    while (!sessao->encerrar && sessao->saida.tamanho - sessao->enviado < LIMITE_PENDENTE_SESSAO &&
+           extrairLinha(&sessao->leitor, &linha)) {
+        if (!executarComando(&sessao->comandos, linha, &sessao->saida)) {
+            sessao->encerrar = 1;
+        }
+    }
+    if (!enviarSessao(sessao)) {
+        fecharSessao(servidor, sessao);
+        return 0;
+    }
+
+    int pendente = sessao->saida.tamanho > 0;
+    if (!pendente && (sessao->encerrar || sessao->leitor.fimArquivo)) {
+        fecharSessao(servidor, sessao);
+        return 0;
+    }
+    if (!pendente && temLinhaPronta(&sessao->leitor)) {
+        return atenderSessao(servidor, sessao);   // Parou pelo limite e já esvaziou
+    }
+
+    uint32_t eventos = pendente ? EPOLLOUT : EPOLLIN;
+    if (eventos != sessao->eventos) {
+        struct epoll_event evento = {.events = eventos, .data.ptr = sessao};
+        epoll_ctl(servidor->epoll, EPOLL_CTL_MOD, sessao->fd, &evento);
+        sessao->eventos = eventos;
+    }
+    return 1;
+}
+
+/*
+ * Função: lerSessao
+ * Lê o que chegou no socket e atende os comandos completos
+ */
+static inline void lerSessao(Servidor* servidor, SessaoServidor* sessao) {
+    ssize_t lidos = encherLeitor(&sessao->leitor);
+    if (lidos < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        fecharSessao(servidor, sessao);
+        return;
+    }
+    if (sessao->leitor.capacidade > LIMITE_LINHA_SESSAO) {
+        fecharSessao(servidor, sessao);   // Linha longa demais
+        return;
+    }
+    atenderSessao(servidor, sessao);
+}
+
+/*
+ * Função: aceitarConexoes
+ * Aceita todas as conexões pendentes, criando uma sessão para cada uma
+ */
+static inline void aceitarConexoes(Servidor* servidor) {
+    for (;;) {
+        int fd = accept(servidor->fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;   // EAGAIN: não há mais conexões (ou limite de descritores)
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+        SessaoServidor* sessao = criarSessao(servidor, fd);
+        if (sessao == NULL) {
+            close(fd);
+            continue;
+        }
+        struct epoll_event evento = {.events = EPOLLIN, .data.ptr = sessao};
+        if (epoll_ctl(servidor->epoll, EPOLL_CTL_ADD, fd, &evento) != 0) {
+            close(fd);
+            liberarSessao(servidor, sessao);
+            continue;
+        }
+        sessao->eventos = EPOLLIN;
+        sessao->proxima = servidor->sessoes;
+        if (servidor->sessoes != NULL) {
+            servidor->sessoes->anterior = sessao;
+        }
+        servidor->sessoes = sessao;
+        servidor->sessoesAtivas++;
+        mudarSessoesAbertas(1);
+        atenderSessao(servidor, sessao);   // Envia a saudação
+    }
+}
+
+// ==================== SERVIDOR ====================
+
+/*
+ * Função: iniciarServidor
+ * Cria o socket Unix em "caminho" (substituindo um socket antigo) e o epoll
+ * Retorna 1 em caso de sucesso, 0 em caso de erro
+ */
+static inline int iniciarServidor(Servidor* servidor, const char* caminho) {
+    struct sockaddr_un endereco;
+    if (strlen(caminho) >= sizeof(endereco.sun_path)) {
+        return 0;
+    }
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    strcpy(endereco.sun_path, caminho);
+
+    servidor->caminho = caminho;
+    servidor->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    servidor->epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (servidor->fd < 0 || servidor->epoll < 0) {
+        goto falha;
+    }
+    unlink(caminho);
+    if (bind(servidor->fd, (struct sockaddr*) &endereco, sizeof(endereco)) != 0 ||
+        listen(servidor->fd, SOMAXCONN) != 0) {
+        goto falha;
+    }
+    struct epoll_event evento = {.events = EPOLLIN, .data.ptr = NULL};   // NULL = socket de escuta
+    if (epoll_ctl(servidor->epoll, EPOLL_CTL_ADD, servidor->fd, &evento) != 0) {
+        goto falha;
+    }
+    return 1;
+
+falha:
+    if (servidor->fd >= 0) close(servidor->fd);
+    if (servidor->epoll >= 0) close(servidor->epoll);
+    servidor->fd = servidor->epoll = -1;
+    return 0;
+}
+
+/*
+ * Função: executarServidor
+ * Atende conexões em "caminho" até SIGINT/SIGTERM; cada conexão joga uma
+ * cópia independente de "inicial" com os jogadores informados
+ * Retorna 1 se o servidor funcionou, 0 se não foi possível criá-lo
+ */
+static inline int executarServidor(Servidor* servidor, const char* caminho) {
+    struct epoll_event eventos[EVENTOS_POR_ESPERA];
+    struct sigaction acao;
+
+    if (!iniciarServidor(servidor, caminho)) {
+        return 0;
+    }
+    servidor->tamanhoArena = tamanhoArenaSessao(servidor);
+    memset(&acao, 0, sizeof(acao));
+    acao.sa_handler = interromperServidor;   // Sem SA_RESTART: epoll_wait volta com EINTR
+    sigaction(SIGINT, &acao, NULL);
+    sigaction(SIGTERM, &acao, NULL);
+
+    while (!servidorInterrompido) {
+        int prontos = epoll_wait(servidor->epoll, eventos, EVENTOS_POR_ESPERA, -1);
+        for (int i = 0; i < prontos; i++) {
+            SessaoServidor* sessao = (SessaoServidor*) eventos[i].data.ptr;
+            if (sessao == NULL) {
+                aceitarConexoes(servidor);
+            } else if (eventos[i].events & EPOLLOUT) {
+                atenderSessao(servidor, sessao);
+            } else if (eventos[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                lerSessao(servidor, sessao);
+            }
+        }
+    }
+
+    while (servidor->sessoes != NULL) {
+        fecharSessao(servidor, servidor->sessoes);
+    }
+    while (servidor->arenasLivres != NULL) {
+        Arena* arena = servidor->arenasLivres;
+        servidor->arenasLivres = arena->proxima;
+        liberarArena(arena);
+    }
+    servidor->numArenasLivres = 0;
+    close(servidor->fd);
+    close(servidor->epoll);
+    unlink(caminho);
+    return 1;
+}
+
+#endif
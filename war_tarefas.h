@@ -0,0 +1,190 @@
+/*
+ * Pool de Tarefas com Roubo de Trabalho do Sistema WAR
+ *
+ * Executa "total" tarefas independentes (identificadas por índice) em
+ * todos os núcleos. Cada trabalhador começa com uma faixa contígua de
+ * índices; quando a sua acaba, rouba metade da faixa restante de outro
+ * trabalhador. A faixa [inicio, fim) de cada trabalhador cabe em uma
+ * única palavra de 64 bits, atualizada por compare-and-swap, então não
+ * há nenhuma trava no caminho quente.
+ */
+
+#ifndef WAR_TAREFAS_H
+#define WAR_TAREFAS_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Máximo de trabalhadores aceitos pelo pool
+#define MAX_TRABALHADORES 256
+
+// Função executada para cada tarefa
+// Parâmetros: contexto compartilhado, número do trabalhador (0 a n-1), índice da tarefa
+typedef void (*FuncaoTarefa)(void* contexto, int trabalhador, uint32_t indice);
+
+// Faixa de índices de um trabalhador: (inicio << 32) | fim
+// Alinhada em 64 bytes para que trabalhadores não disputem a mesma linha de cache
+typedef struct {
+    _Alignas(64) _Atomic uint64_t faixa;
+} FaixaTrabalho;
+
+typedef struct {
+    FaixaTrabalho* faixas;
+    int numTrabalhadores;
+    FuncaoTarefa funcao;
+    void* contexto;
+} PoolTarefas;
+
+typedef struct {
+    PoolTarefas* pool;
+    int trabalhador;
+} ArgumentoTrabalhador;
+
+/*
+ * Função: contarNucleos
+ * Retorna a quantidade de núcleos disponíveis (no mínimo 1)
+ */
+static inline int contarNucleos(void) {
+    long nucleos = sysconf(_SC_NPROCESSORS_ONLN);
+    if (nucleos < 1) return 1;
+    if (nucleos > MAX_TRABALHADORES) return MAX_TRABALHADORES;
+    return (int) nucleos;
+}
+
+/*
+ * Função: pegarPropria
+ * Retira o próximo índice da própria faixa; retorna 0 se ela estiver vazia
+ */
+static inline int pegarPropria(FaixaTrabalho* faixa, uint32_t* indice) {
+    uint64_t atual = atomic_load_explicit(&faixa->faixa, memory_order_acquire);
+    for (;;) {
+        uint32_t inicio = (uint32_t) (atual >> 32);
+        uint32_t fim = (uint32_t) atual;
+        if (inicio >= fim) {
+            return 0;
+        }
+        uint64_t novo = ((uint64_t) (inicio + 1) << 32) | fim;
+        if (atomic_compare_exchange_weak_explicit(&faixa->faixa, &atual, novo,
+                                                  memory_order_acq_rel,
+                                                  memory_order_acquire)) {
+            *indice = inicio;
+            return 1;
+        }
+    }
+}
+
+/*
+ * Função: roubarTrabalho
+ * Rouba a metade final da faixa de algum outro trabalhador
+ * Retorna 1 se conseguiu (a faixa roubada passa a ser a do ladrão)
+ */
+static inline int roubarTrabalho(PoolTarefas* pool, int ladrao) {
+    for (int passo = 1; passo < pool->numTrabalhadores; passo++) {
+        FaixaTrabalho* vitima = &pool->faixas[(ladrao + passo) % pool->numTrabalhadores];
+        uint64_t atual = atomic_load_explicit(&vitima->faixa, memory_order_acquire);
+
+        for (;;) {
+            uint32_t inicio = (uint32_t) (atual >> 32);
+            uint32_t fim = (uint32_t) atual;
+            if (inicio >= fim || fim - inicio < 2) {
+                break; // Nada que valha a pena roubar desta vítima
+            }
+            uint32_t meio = inicio + (fim - inicio) / 2;
+            uint64_t restante = ((uint64_t) inicio << 32) | meio;
+            if (atomic_compare_exchange_weak_explicit(&vitima->faixa, &atual, restante,
+                                                      memory_order_acq_rel,
+                                                      memory_order_acquire)) {
+                atomic_store_explicit(&pool->faixas[ladrao].faixa,
+                                      ((uint64_t) meio << 32) | fim,
+                                      memory_order_release);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * Função: lacoTrabalhador
+ * Executa tarefas da própria faixa e rouba de outros até tudo acabar
+ */
+static inline void* lacoTrabalhador(void* argumento) {
+    ArgumentoTrabalhador* arg = (ArgumentoTrabalhador*) argumento;
+    PoolTarefas* pool = arg->pool;
+    uint32_t indice;
+
+    do {
+        while (pegarPropria(&pool->faixas[arg->trabalhador], &indice)) {
+            pool->funcao(pool->contexto, arg->trabalhador, indice);
+        }
+    } while (roubarTrabalho(pool, arg->trabalhador));
+
+    return NULL;
+}
+
+/*
+ * Função: executarEmParalelo
+ * Executa funcao(contexto, trabalhador, i) para todo i em [0, total)
+ * Parâmetros:
+ *   - numTrabalhadores: threads a usar (<= 0 usa todos os núcleos)
+ * Retorna o número de threads usadas ou -1 em caso de erro
+ */
+static inline int executarEmParalelo(uint32_t total, int numTrabalhadores,
+                                     FuncaoTarefa funcao, void* contexto) {
+    if (numTrabalhadores <= 0) numTrabalhadores = contarNucleos();
+    if (numTrabalhadores > MAX_TRABALHADORES) numTrabalhadores = MAX_TRABALHADORES;
+
+    PoolTarefas pool;
+    pool.numTrabalhadores = numTrabalhadores;
+    pool.funcao = funcao;
+    pool.contexto = contexto;
+    pool.faixas = (FaixaTrabalho*) aligned_alloc(64, sizeof(FaixaTrabalho) * numTrabalhadores);
+    if (pool.faixas == NULL) {
+        return -1;
+    }
+
+    // Distribui faixas contíguas iguais entre os trabalhadores
+    for (int t = 0; t < numTrabalhadores; t++) {
+        uint32_t inicio = (uint32_t) ((uint64_t) total * t / numTrabalhadores);
+        uint32_t fim = (uint32_t) ((uint64_t) total * (t + 1) / numTrabalhadores);
+        atomic_init(&pool.faixas[t].faixa, ((uint64_t) inicio << 32) | fim);
+    }
+
+    pthread_t threads[MAX_TRABALHADORES];
+    ArgumentoTrabalhador argumentos[MAX_TRABALHADORES];
+    int criadas = 0;
+
+    // O trabalhador 0 é a própria thread chamadora
+    for (int t = 1; t < numTrabalhadores; t++) {
+        argumentos[t].pool = &pool;
+        argumentos[t].trabalhador = t;
+        if (pthread_create(&threads[t], NULL, lacoTrabalhador, &argumentos[t]) != 0) {
+            break; // As faixas restantes são esvaziadas pela chamadora
+        }
+        criadas = t;
+    }
+
+    argumentos[0].pool = &pool;
+    argumentos[0].trabalhador = 0;
+    lacoTrabalhador(&argumentos[0]);
+
+    // Faixas de threads que não puderam ser criadas ficam com a chamadora
+    for (int t = criadas + 1; t < numTrabalhadores; t++) {
+        uint32_t indice;
+        while (pegarPropria(&pool.faixas[t], &indice)) {
+            funcao(contexto, 0, indice);
+        }
+    }
+
+    for (int t = 1; t <= criadas; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    free(pool.faixas);
+    return criadas + 1;
+}
+
+#endif // WAR_TAREFAS_H
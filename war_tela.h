@@ -0,0 +1,292 @@
+/*
+ * Saída em Buffer do Sistema WAR
+ *
+ * Em vez de chamar printf várias vezes por território, as telas grandes
+ * (lista do mapa, seleção de ataque) são montadas em um único buffer
+ * reutilizado entre exibições e enviadas ao terminal com uma só chamada
+ * write(). Em mapas grandes, especialmente via SSH, isso troca milhares
+ * de escritas pequenas por uma grande.
+ *
+ * A tela também guarda o conjunto de territórios alterados desde a última
+ * exibição (um bit por território mais a contagem), marcado pelos ataques.
+ * O modo de diferenças mostra apenas esses territórios; a exibição
+ * completa limpa o conjunto.
+ *
+ * Os dois vetores podem vir de fora (por exemplo, da arena de uma sessão
+ * do servidor): nesse caso a tela nunca os libera, e um buffer que
+ * precisa crescer passa a ser uma cópia própria.
+ */
+
+#ifndef WAR_TELA_H
+#define WAR_TELA_H
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "war_metricas.h"  // Tempo e bytes das escritas
+
+// Capacidade inicial do buffer de saída (cresce conforme a necessidade)
+#define CAPACIDADE_INICIAL_TELA 4096
+
+typedef struct {
+    char* texto;              // Saída acumulada (não terminada em '\0')
+    size_t tamanho;
+    size_t capacidade;
+    uint64_t* alterados;      // 1 bit por território alterado desde a última exibição
+    int numTerritorios;
+    int numAlterados;
+    int redesenhar;           // 1 se a próxima exibição precisa mostrar todo o mapa
+    int textoExterno;         // 1 se "texto" não pertence à tela (não é liberado)
+    int alteradosExterno;     // 1 se "alterados" não pertence à tela
+} Tela;
+
+/*
+ * Função: tamanhoAlterados
+ * Bytes do conjunto de alterados de um mapa com "numTerritorios"
+ */
+static inline size_t tamanhoAlterados(int numTerritorios) {
+    return ((size_t) (numTerritorios + 63) / 64 + 1) * sizeof(uint64_t);
+}
+
+/*
+ * Função: criarTela
+ * Reserva o buffer de saída e o conjunto de alterados para "numTerritorios"
+ * A primeira exibição é sempre completa
+ * Retorna 1 em caso de sucesso, 0 se faltar memória
+ */
+static inline int criarTela(Tela* tela, int numTerritorios) {
+    memset(tela, 0, sizeof(*tela));
+    tela->texto = (char*) malloc(CAPACIDADE_INICIAL_TELA);
+    tela->alterados = (uint64_t*) calloc(1, tamanhoAlterados(numTerritorios));
+    if (tela->texto == NULL || tela->alterados == NULL) {
+        free(tela->texto);
+        free(tela->alterados);
+        memset(tela, 0, sizeof(*tela));
+        return 0;
+    }
+    tela->capacidade = CAPACIDADE_INICIAL_TELA;
+    tela->numTerritorios = numTerritorios;
+    tela->redesenhar = 1;
+    return 1;
+}
+
+/*
+ * Função: criarTelaEm
+ * Monta a tela sobre vetores já reservados: "texto" com "capacidade"
+ * bytes e "alterados" zerado com tamanhoAlterados(numTerritorios) bytes
+ */
+static inline void criarTelaEm(Tela* tela, int numTerritorios, char* texto, size_t capacidade,
+                               uint64_t* alterados) {
+    memset(tela, 0, sizeof(*tela));
+    tela->texto = texto;
+    tela->capacidade = capacidade;
+    tela->alterados = alterados;
+    tela->numTerritorios = numTerritorios;
+    tela->redesenhar = 1;
+    tela->textoExterno = 1;
+    tela->alteradosExterno = 1;
+}
+
+/*
+ * Função: liberarTela
+ * Libera a memória da tela (exceto os vetores externos)
+ */
+static inline void liberarTela(Tela* tela) {
+    if (!tela->textoExterno) {
+        free(tela->texto);
+    }
+    if (!tela->alteradosExterno) {
+        free(tela->alterados);
+    }
+    memset(tela, 0, sizeof(*tela));
+}
+
+/*
+ * Função: reservarTela
+ * Garante espaço para mais "bytes" bytes no buffer
+ * Retorna 1 em caso de sucesso, 0 se faltar memória
+ */
+static inline int reservarTela(Tela* tela, size_t bytes) {
+    if (tela->tamanho + bytes <= tela->capacidade) {
+        return 1;
+    }
+    size_t capacidade = tela->capacidade > 0 ? tela->capacidade : CAPACIDADE_INICIAL_TELA;
+    while (capacidade < tela->tamanho + bytes) {
+        capacidade *= 2;
+    }
+    char* texto;
+    if (tela->textoExterno) {
+        texto = (char*) malloc(capacidade);
+        if (texto != NULL) {
+            memcpy(texto, tela->texto, tela->tamanho);
+        }
+    } else {
+        texto = (char*) realloc(tela->texto, capacidade);
+    }
+    if (texto == NULL) {
+        return 0;
+    }
+    tela->texto = texto;
+    tela->textoExterno = 0;
+    tela->capacidade = capacidade;
+    return 1;
+}
+
+/*
+ * Função: anexarTela
+ * Acrescenta "bytes" bytes de texto ao buffer
+ * Retorna 1 em caso de sucesso, 0 se faltar memória
+ */
+static inline int anexarTela(Tela* tela, const char* texto, size_t bytes) {
+    if (!reservarTela(tela, bytes)) {
+        return 0;
+    }
+    memcpy(tela->texto + tela->tamanho, texto, bytes);
+    tela->tamanho += bytes;
+    return 1;
+}
+
+/*
+ * Função: escreverTela
+ * Formata como printf diretamente no espaço livre do buffer
+ * (só cresce e formata de novo quando o texto não coube)
+ * Retorna 1 em caso de sucesso, 0 se faltar memória
+ */
+__attribute__((format(printf, 2, 3)))
+static inline int escreverTela(Tela* tela, const char* formato, ...) {
+    va_list args;
+    va_start(args, formato);
+    int bytes = vsnprintf(tela->texto + tela->tamanho, tela->capacidade - tela->tamanho, formato, args);
+    va_end(args);
+    if (bytes < 0) {
+        return 0;
+    }
+    if ((size_t) bytes >= tela->capacidade - tela->tamanho) {
+        if (!reservarTela(tela, (size_t) bytes + 1)) {
+            return 0;
+        }
+        va_start(args, formato);
+        vsnprintf(tela->texto + tela->tamanho, tela->capacidade - tela->tamanho, formato, args);
+        va_end(args);
+    }
+    tela->tamanho += (size_t) bytes;
+    return 1;
+}
+
+/*
+ * Função: despejarTelaEm
+ * Envia o buffer ao descritor "fd" em uma única escrita e o esvazia
+ * Retorna 1 em caso de sucesso, 0 se a escrita falhar
+ */
+static inline int despejarTelaEm(Tela* tela, int fd) {
+    const char* p = tela->texto;
+    size_t restante = tela->tamanho;
+    uint64_t medida = iniciarMedida();
+
+    contarMetrica(CONTADOR_BYTES_SAIDA, restante);
+    tela->tamanho = 0;
+    while (restante > 0) {
+        ssize_t escrito = write(fd, p, restante);
+        if (escrito < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return 0;
+        }
+        p += escrito;
+        restante -= (size_t) escrito;
+    }
+    encerrarMedida(LATENCIA_SAIDA, medida);
+    return 1;
+}
+
+/*
+ * Função: despejarTela
+ * Envia o buffer ao terminal em uma única escrita e o esvazia
+ * (o que já estava no buffer do stdio sai antes, mantendo a ordem)
+ */
+static inline int despejarTela(Tela* tela) {
+    fflush(stdout);
+    return despejarTelaEm(tela, STDOUT_FILENO);
+}
+
+/*
+ * Função: redimensionarTela
+ * Ajusta o conjunto de alterados a um mapa com "numTerritorios" (após a
+ * troca do mapa); a próxima exibição volta a ser completa
+ * Retorna 1 em caso de sucesso, 0 se faltar memória
+ */
+static inline int redimensionarTela(Tela* tela, int numTerritorios) {
+    uint64_t* alterados = (uint64_t*) calloc(1, tamanhoAlterados(numTerritorios));
+    if (alterados == NULL) {
+        return 0;
+    }
+    if (!tela->alteradosExterno) {
+        free(tela->alterados);
+    }
+    tela->alterados = alterados;
+    tela->alteradosExterno = 0;
+    tela->numTerritorios = numTerritorios;
+    tela->numAlterados = 0;
+    tela->redesenhar = 1;
+    return 1;
+}
+
+/*
+ * Função: marcarAlterado
+ * Registra que o território "indice" mudou desde a última exibição
+ */
+static inline void marcarAlterado(Tela* tela, int indice) {
+    if (tela == NULL || indice < 0 || indice >= tela->numTerritorios) {
+        return;
+    }
+    uint64_t bit = 1ULL << (indice & 63);
+    if (!(tela->alterados[indice >> 6] & bit)) {
+        tela->alterados[indice >> 6] |= bit;
+        tela->numAlterados++;
+    }
+}
+
+/*
+ * Função: proximoAlterado
+ * Retorna o menor território alterado com índice >= "inicio", ou -1
+ * (salta palavras vazias do conjunto, 64 territórios por vez)
+ */
+static inline int proximoAlterado(const Tela* tela, int inicio) {
+    if (inicio < 0) {
+        inicio = 0;
+    }
+    if (inicio >= tela->numTerritorios) {
+        return -1;
+    }
+    int palavra = inicio >> 6;
+    int palavras = (tela->numTerritorios + 63) / 64;
+    uint64_t bits = tela->alterados[palavra] & (~0ULL << (inicio & 63));
+
+    while (bits == 0) {
+        if (++palavra >= palavras) {
+            return -1;
+        }
+        bits = tela->alterados[palavra];
+    }
+    return palavra * 64 + __builtin_ctzll(bits);
+}
+
+/*
+ * Função: limparAlterados
+ * Esvazia o conjunto de alterados após uma exibição
+ */
+static inline void limparAlterados(Tela* tela) {
+    if (tela->numAlterados > 0) {
+        memset(tela->alterados, 0, (size_t) (tela->numTerritorios + 63) / 64 * sizeof(uint64_t));
+    }
+    tela->numAlterados = 0;
+    tela->redesenhar = 0;
+}
+
+#endif
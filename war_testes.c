@@ -0,0 +1,1300 @@
+/*
+ * Testes do Sistema WAR
+ *
+ * Confere os módulos do jogo contra resultados conhecidos ou contra uma
+ * versão direta (escalar, força bruta) do mesmo cálculo. Cada teste
+ * conta as verificações que falharam; o programa retorna 1 se alguma
+ * falhou.
+ *
+ * Compilação: gcc -std=c11 -O2 -Wall -Wextra war_testes.c -o war_testes -lpthread -lm
+ */
+
+// Os módulos usam chamadas POSIX e extensões da glibc (ver war_mestre.c)
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "war_carregador.h"
+#include "war_chances.h"
+#include "war_colunas.h"
+#include "war_comandos.h"
+#include "war_combate.h"
+#include "war_dados.h"
+#include "war_gerador.h"
+#include "war_relampago.h"
+#include "war_salvamento.h"
+
+// Verificações feitas e falhas encontradas
+static int verificacoes = 0;
+static int falhas = 0;
+
+// Confere uma condição e informa onde ela falhou
+#define CONFERIR(condicao) conferir((condicao), #condicao, __FILE__, __LINE__)
+
+/*
+ * Função: conferir
+ * Conta uma verificação e informa a falha, se houver
+ */
+static void conferir(int condicao, const char* texto, const char* arquivo, int linha) {
+    verificacoes++;
+    if (!condicao) {
+        falhas++;
+        printf("FALHA %s:%d: %s\n", arquivo, linha, texto);
+    }
+}
+
+// Pasta temporária dos arquivos gravados pelos testes
+static char pastaTestes[] = "/tmp/war_testes_XXXXXX";
+
+/*
+ * Função: caminhoTeste
+ * Monta em "destino" o caminho do arquivo "nome" na pasta dos testes
+ */
+static const char* caminhoTeste(const char* nome, char* destino, size_t tamanho) {
+    snprintf(destino, tamanho, "%s/%s", pastaTestes, nome);
+    return destino;
+}
+
+/*
+ * Função: gravarArquivo
+ * Grava "tamanho" bytes no arquivo "nome" da pasta dos testes
+ * Retorna o caminho (em "caminho") ou NULL se a gravação falhar
+ */
+static const char* gravarArquivo(const char* nome, const void* dados, size_t tamanho, char* caminho) {
+    caminhoTeste(nome, caminho, 256);
+    FILE* arquivo = fopen(caminho, "wb");
+    if (arquivo == NULL) {
+        return NULL;
+    }
+    int ok = fwrite(dados, 1, tamanho, arquivo) == tamanho;
+    ok &= fclose(arquivo) == 0;
+    return ok ? caminho : NULL;
+}
+
+/*
+ * Função: gravarTexto
+ * Grava um texto no arquivo "nome" da pasta dos testes
+ */
+static const char* gravarTexto(const char* nome, const char* texto, char* caminho) {
+    return gravarArquivo(nome, texto, strlen(texto), caminho);
+}
+
+/*
+ * Função: cargaDoMapa
+ * Carrega o mapa do arquivo em uma partida nova, que é liberada em seguida
+ * Retorna o código da carga
+ */
+static CodigoCarga cargaDoMapa(const char* caminho) {
+    Jogo jogo;
+    inicializarJogo(&jogo, 1);
+    CodigoCarga codigo = carregarMapa(caminho, &jogo);
+    liberarMapa(&jogo);
+    return codigo;
+}
+
+/*
+ * Função: cargaDosJogadores
+ * Carrega os jogadores do arquivo e confere a quantidade lida
+ * Retorna o código da carga (CARGA_OK só se a quantidade conferir)
+ */
+static CodigoCarga cargaDosJogadores(const char* caminho, Jogo* jogo, const Missao catalogo[],
+                                     int quantidade) {
+    Jogador* jogadores = NULL;
+    int numJogadores = 0;
+    CodigoCarga codigo = carregarJogadoresCSV(caminho, &jogadores, &numJogadores, catalogo,
+                                              &jogo->dados, &jogo->cores, &jogo->continentes);
+    free(jogadores);
+    if (codigo == CARGA_OK && numJogadores != quantidade) {
+        return CARGA_ERRO_FORMATO;
+    }
+    return codigo;
+}
+
+// ==================== DADOS (PHILOX) ====================
+
+/*
+ * Função: testarPhilox
+ * Vetores de resposta conhecida do Philox4x32-10 (os mesmos da
+ * implementação de referência Random123) e a ordem dos bytes de um fluxo
+ */
+static void testarPhilox(void) {
+    static const uint32_t chaves[3][2] = {
+        { 0x00000000u, 0x00000000u },
+        { 0xFFFFFFFFu, 0xFFFFFFFFu },
+        { 0xA4093822u, 0x299F31D0u }
+    };
+    static const uint32_t contadores[3][4] = {
+        { 0x00000000u, 0x00000000u, 0x00000000u, 0x00000000u },
+        { 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu },
+        { 0x243F6A88u, 0x85A308D3u, 0x13198A2Eu, 0x03707344u }
+    };
+    static const uint32_t esperados[3][4] = {
+        { 0x6627E8D5u, 0xE169C58Du, 0xBC57AC4Cu, 0x9B00DBD8u },
+        { 0x408F276Du, 0x41C83B0Eu, 0xA20BC7C6u, 0x6D5451FDu },
+        { 0xD16CFE09u, 0x94FDCCEBu, 0x5001E420u, 0x24126EA1u }
+    };
+
+    for (int i = 0; i < 3; i++) {
+        uint32_t saida[4];
+        philox4x32(chaves[i], contadores[i], saida);
+        CONFERIR(memcmp(saida, esperados[i], sizeof(saida)) == 0);
+    }
+
+    // Semente 0, fluxo 0: o primeiro bloco é o primeiro vetor, em little-endian
+    GeradorDados gerador;
+    inicializarGerador(&gerador, 0, 0);
+    int iguais = 1;
+    for (int i = 0; i < BYTES_POR_BLOCO; i++) {
+        iguais &= proximoByte(&gerador) == (uint8_t) (esperados[0][i / 4] >> (8 * (i % 4)));
+    }
+    CONFERIR(iguais);
+    CONFERIR(gerador.contador == 1);
+
+    // A semente vira a chave e o fluxo ocupa a metade alta do contador
+    uint32_t chave[2] = { 0x299F31D0u, 0xA4093822u };
+    uint32_t entrada[4] = { 5, 0, 0x13198A2Eu, 0x03707344u };
+    uint32_t bloco[4];
+    philox4x32(chave, entrada, bloco);
+    inicializarGerador(&gerador, 0xA4093822299F31D0ull, 0x0370734413198A2Eull);
+    gerador.contador = 5;
+    CONFERIR(proximoU32(&gerador) == bloco[0]);
+    CONFERIR(proximoU32(&gerador) == bloco[1]);
+
+    // Um fluxo derivado é o mesmo que um inicializado com a semente
+    GeradorDados derivado, direto;
+    derivarGerador(&derivado, &gerador, 7);
+    inicializarGerador(&direto, 0xA4093822299F31D0ull, 7);
+    CONFERIR(proximoU32(&derivado) == proximoU32(&direto));
+}
+
+/*
+ * Função: testarPreencherDados
+ * preencherDados() dá a mesma sequência que rolarDado() um a um, começando
+ * em qualquer ponto do bloco e com qualquer quantidade
+ */
+static void testarPreencherDados(void) {
+    uint8_t lote[1000];
+    int iguais = 1, faixa = 1;
+
+    for (int inicio = 0; inicio < 40; inicio++) {
+        GeradorDados a, b;
+        inicializarGerador(&a, 1234, (uint64_t) inicio);
+        for (int i = 0; i < inicio; i++) {
+            rolarDado(&a);
+        }
+        b = a;
+
+        size_t quantidade = (size_t) (inicio * 23 + 1);
+        preencherDados(&a, lote, quantidade);
+        for (size_t i = 0; i < quantidade; i++) {
+            faixa &= lote[i] >= 1 && lote[i] <= 6;
+            iguais &= lote[i] == rolarDado(&b);
+        }
+        iguais &= rolarDado(&a) == rolarDado(&b);
+    }
+    CONFERIR(faixa);
+    CONFERIR(iguais);
+}
+
+// ==================== MAPAS E JOGADORES ====================
+
+// Mapa pequeno com fronteiras, usado nos testes de carga
+static const char* MAPA_TESTE = "nome,cor,tropas\n"
+                                "Brasil,azul,5\n"
+                                "Argentina,verde,3\n"
+                                "Chile,azul,2\n"
+                                "Peru,verde,4\n";
+static const char* FRONTEIRAS_TESTE = "1,2\n2,3\n3,4\n1,4\n";
+
+/*
+ * Função: testarMapasCSV
+ * Linhas incompletas, tropas inválidas e arquivos vazios são recusados;
+ * o cabeçalho e os comentários são ignorados
+ */
+static void testarMapasCSV(void) {
+    char caminho[256];
+
+    CONFERIR(cargaDoMapa(gravarTexto("m.csv", MAPA_TESTE, caminho)) == CARGA_OK);
+    CONFERIR(cargaDoMapa(gravarTexto("m.csv", "# mapa\nBrasil,azul,5\n\nChile,verde,1\n", caminho)) == CARGA_OK);
+    CONFERIR(cargaDoMapa(gravarTexto("m.csv", "", caminho)) == CARGA_ERRO_FORMATO);
+    CONFERIR(cargaDoMapa(gravarTexto("m.csv", "nome,cor,tropas\n", caminho)) == CARGA_ERRO_FORMATO);
+    CONFERIR(cargaDoMapa(gravarTexto("m.csv", "Brasil,azul,5\nChile,verde\n", caminho)) == CARGA_ERRO_FORMATO);
+    CONFERIR(cargaDoMapa(gravarTexto("m.csv", "Brasil,azul,5\nChile,verde,x\n", caminho)) == CARGA_ERRO_FORMATO);
+    CONFERIR(cargaDoMapa(gravarTexto("m.csv", "Brasil,azul,-1\n", caminho)) == CARGA_ERRO_FORMATO);
+    CONFERIR(cargaDoMapa(gravarTexto("m.csv", "Brasil,azul,3000000000\n", caminho)) == CARGA_ERRO_FORMATO);
+    CONFERIR(cargaDoMapa("/nao/existe.csv") == CARGA_ERRO_ARQUIVO);
+
+    // Fronteiras com território fora do mapa
+    Jogo jogo;
+    inicializarJogo(&jogo, 1);
+    CONFERIR(carregarMapa(gravarTexto("m.csv", MAPA_TESTE, caminho), &jogo) == CARGA_OK);
+    CONFERIR(carregarFronteirasCSV(gravarTexto("f.csv", "1,5\n", caminho), &jogo) == CARGA_ERRO_FORMATO);
+    CONFERIR(carregarFronteirasCSV(gravarTexto("f.csv", "1,0\n", caminho), &jogo) == CARGA_ERRO_FORMATO);
+    liberarMapa(&jogo);
+}
+
+/*
+ * Função: testarMapaBinario
+ * Um mapa binário gravado volta igual; qualquer truncamento e os campos
+ * adulterados (cor, tropas, nome, fronteiras, cabeçalho) são recusados
+ */
+static void testarMapaBinario(void) {
+    char caminho[256], caminhoBinario[256];
+    Jogo jogo;
+    inicializarJogo(&jogo, 1);
+    CONFERIR(carregarMapa(gravarTexto("m.csv", MAPA_TESTE, caminho), &jogo) == CARGA_OK);
+    CONFERIR(carregarFronteirasCSV(gravarTexto("f.csv", FRONTEIRAS_TESTE, caminho), &jogo) == CARGA_OK);
+    CONFERIR(salvarMapaBinario(caminhoTeste("m.bin", caminhoBinario, sizeof(caminhoBinario)), &jogo) == CARGA_OK);
+
+    Jogo lido;
+    inicializarJogo(&lido, 1);
+    CONFERIR(carregarMapa(caminhoBinario, &lido) == CARGA_OK);
+    CONFERIR(lido.numTerritorios == 4 && lido.grafo.numVizinhos == jogo.grafo.numVizinhos);
+    for (int i = 0; i < jogo.numTerritorios && i < lido.numTerritorios; i++) {
+        CONFERIR(strcmp(nomeTerritorio(&lido, i), nomeTerritorio(&jogo, i)) == 0 &&
+                 lido.mapa[i].tropas == jogo.mapa[i].tropas &&
+                 strcmp(lido.cores.nomes[lido.mapa[i].cor], jogo.cores.nomes[jogo.mapa[i].cor]) == 0);
+    }
+    liberarMapa(&lido);
+    liberarMapa(&jogo);
+
+    char* original;
+    size_t tamanho;
+    if (lerArquivoInteiro(caminhoBinario, &original, &tamanho) != CARGA_OK) {
+        CONFERIR(!"mapa binario ilegivel");
+        return;
+    }
+
+    int recusados = 1;
+    for (size_t corte = 0; corte < tamanho; corte++) {
+        recusados &= cargaDoMapa(gravarArquivo("t.bin", original, corte, caminho)) != CARGA_OK;
+    }
+    CONFERIR(recusados);
+
+    // Cada adulteração parte de uma cópia do original
+    char* copia = (char*) malloc(tamanho);
+    CabecalhoMapa* cabecalho = (CabecalhoMapa*) copia;
+    Territorio* mapa = (Territorio*) (copia + sizeof(CabecalhoMapa));
+    uint32_t* inicio = (uint32_t*) (mapa + 4);
+    uint32_t* vizinhos = inicio + 5;
+#define ADULTERADO(alteracao) \
+    (memcpy(copia, original, tamanho), (alteracao), cargaDoMapa(gravarArquivo("a.bin", copia, tamanho, caminho)))
+
+    CONFERIR(ADULTERADO((void) 0) == CARGA_OK);
+    CONFERIR(ADULTERADO(cabecalho->versao++) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO(cabecalho->tamanhoRegistro++) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO(cabecalho->numTerritorios = 5) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO(cabecalho->numTerritorios = 1ull << 40) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO(cabecalho->tamanhoNomes += 1000) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO(cabecalho->cores.total = MAX_CORES + 1) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO(mapa[1].cor = (IdCor) cabecalho->cores.total) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO(mapa[2].tropas = -1) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO(mapa[3].nome = (uint32_t) cabecalho->tamanhoNomes) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO(inicio[2] = 1000000) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO(inicio[4] = cabecalho->numVizinhos + 1) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO(vizinhos[0] = 4) == CARGA_ERRO_FORMATO);
+    // Sem a assinatura o arquivo é lido como CSV, que não tem linhas válidas
+    CONFERIR(ADULTERADO(cabecalho->magica[0] = 'X') == CARGA_ERRO_FORMATO);
+#undef ADULTERADO
+
+    free(copia);
+    free(original);
+}
+
+/*
+ * Função: testarJogadoresCSV
+ * Missões fora do catálogo e linhas sem cor são recusadas; o cabeçalho
+ * ("nome,cor" ou "nome,cor,missao") é ignorado
+ */
+static void testarJogadoresCSV(void) {
+    char caminho[256];
+    Jogo jogo;
+    Missao catalogo[TOTAL_MISSOES];
+    inicializarJogo(&jogo, 1);
+    compilarCatalogo(&jogo.cores, catalogo);
+
+#define JOGADORES(texto, quantidade) cargaDosJogadores(gravarTexto("j.csv", (texto), caminho), &jogo, catalogo, (quantidade))
+    CONFERIR(JOGADORES("Ana,azul,1\nBeto,verde,2\n", 2) == CARGA_OK);
+    CONFERIR(JOGADORES("nome,cor\nAna,azul\n", 1) == CARGA_OK);
+    CONFERIR(JOGADORES("nome,cor,missao\nAna,azul,3\nBeto,verde\n", 2) == CARGA_OK);
+    CONFERIR(JOGADORES("Ana,azul,0\n", 0) == CARGA_ERRO_FORMATO);
+    CONFERIR(JOGADORES("Ana,azul,1\nBeto,verde,99\n", 0) == CARGA_ERRO_FORMATO);
+    CONFERIR(JOGADORES("Ana,azul,1\nBeto\n", 0) == CARGA_ERRO_FORMATO);
+    CONFERIR(JOGADORES("Ana,azul,continente Sul\n", 0) == CARGA_ERRO_FORMATO);
+    CONFERIR(JOGADORES("nome,cor\n", 0) == CARGA_ERRO_FORMATO);
+#undef JOGADORES
+}
+
+// ==================== SALVAMENTO ====================
+
+/*
+ * Função: cargaDaPartida
+ * Restaura a partida do arquivo em uma partida nova, que é liberada em seguida
+ * Retorna o código da restauração
+ */
+static CodigoCarga cargaDaPartida(const char* caminho) {
+    Jogo jogo;
+    Jogador* jogadores = NULL;
+    int numJogadores = 0, turno = 0;
+    inicializarJogo(&jogo, 1);
+    CodigoCarga codigo = restaurarPartida(caminho, &jogo, &jogadores, &numJogadores, &turno);
+    free(jogadores);
+    liberarMapa(&jogo);
+    return codigo;
+}
+
+/*
+ * Função: montarPartidaTeste
+ * Partida do mapa de teste (com fronteiras e regra clássica) e dois jogadores
+ * Retorna 1 em caso de sucesso
+ */
+static int montarPartidaTeste(Jogo* jogo, Jogador jogadores[2]) {
+    char caminho[256];
+    Missao catalogo[TOTAL_MISSOES];
+    inicializarJogo(jogo, 99);
+    jogo->regra = REGRA_CLASSICA;
+    if (carregarMapa(gravarTexto("m.csv", MAPA_TESTE, caminho), jogo) != CARGA_OK ||
+        carregarFronteirasCSV(gravarTexto("f.csv", FRONTEIRAS_TESTE, caminho), jogo) != CARGA_OK ||
+        !compilarCatalogo(&jogo->cores, catalogo)) {
+        return 0;
+    }
+    memset(jogadores, 0, sizeof(Jogador) * 2);
+    strcpy(jogadores[0].nome, "Ana");
+    jogadores[0].cor = buscarCor(&jogo->cores, "azul");
+    jogadores[0].missao = catalogo[1];
+    strcpy(jogadores[1].nome, "Beto");
+    jogadores[1].cor = buscarCor(&jogo->cores, "verde");
+    jogadores[1].missao = catalogo[0];
+    rolarDado(&jogo->dados);  // O fluxo salvo não está no começo
+    return 1;
+}
+
+/*
+ * Função: testarSalvamento
+ * Uma partida salva volta igual (mapa, jogadores, turno, regra e o fluxo
+ * de dados onde parou); qualquer truncamento e os campos adulterados
+ * (jogadores, missões, territórios, cabeçalho) são recusados
+ */
+static void testarSalvamento(void) {
+    char caminho[256], caminhoSalvo[256];
+    Jogo jogo;
+    Jogador jogadores[2];
+    if (!montarPartidaTeste(&jogo, jogadores)) {
+        CONFERIR(!"partida de teste");
+        return;
+    }
+    CONFERIR(salvarPartida(caminhoTeste("p.sav", caminhoSalvo, sizeof(caminhoSalvo)), &jogo, jogadores, 2, 17) ==
+             CARGA_OK);
+
+    Jogo lido;
+    Jogador* lidos = NULL;
+    int numLidos = 0, turno = 0;
+    inicializarJogo(&lido, 1);
+    CONFERIR(restaurarPartida(caminhoSalvo, &lido, &lidos, &numLidos, &turno) == CARGA_OK);
+    CONFERIR(numLidos == 2 && turno == 17 && lido.regra == REGRA_CLASSICA);
+    CONFERIR(lidos != NULL && memcmp(lidos, jogadores, sizeof(jogadores)) == 0);
+    CONFERIR(lido.numTerritorios == jogo.numTerritorios &&
+             memcmp(lido.mapa, jogo.mapa, sizeof(Territorio) * (size_t) jogo.numTerritorios) == 0);
+    CONFERIR(lido.grafo.numVizinhos == jogo.grafo.numVizinhos);
+    CONFERIR(memcmp(&lido.agregados, &jogo.agregados, sizeof(AgregadosMapa)) == 0);
+    CONFERIR(proximoU32(&lido.dados) == proximoU32(&jogo.dados));
+    free(lidos);
+    liberarMapa(&lido);
+    liberarMapa(&jogo);
+
+    char* original;
+    size_t tamanho;
+    if (lerArquivoInteiro(caminhoSalvo, &original, &tamanho) != CARGA_OK) {
+        CONFERIR(!"salvamento ilegivel");
+        return;
+    }
+
+    int recusados = 1;
+    for (size_t corte = 0; corte < tamanho; corte++) {
+        recusados &= cargaDaPartida(gravarArquivo("t.sav", original, corte, caminho)) != CARGA_OK;
+    }
+    CONFERIR(recusados);
+
+    char* copia = (char*) malloc(tamanho);
+    CabecalhoSalvamento* cabecalho = (CabecalhoSalvamento*) copia;
+    Jogador* jogador = (Jogador*) (copia + sizeof(CabecalhoSalvamento));
+    Territorio* mapa = (Territorio*) (jogador + 2);
+#define ADULTERADO(alteracao) \
+    (memcpy(copia, original, tamanho), (alteracao), cargaDaPartida(gravarArquivo("a.sav", copia, tamanho, caminho)))
+
+    CONFERIR(ADULTERADO((void) 0) == CARGA_OK);
+    CONFERIR(ADULTERADO(cabecalho->magica[7]++) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO(cabecalho->versao++) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO(cabecalho->tamanhoJogador++) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO(cabecalho->numJogadores = 0) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO(cabecalho->numJogadores = 3) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO(cabecalho->deslocamentoMapa += 4) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO(cabecalho->numTerritorios = 0) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO(memset(jogador[0].nome, 'Z', sizeof(jogador[0].nome))) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO(jogador[1].cor = (IdCor) cabecalho->cores.total) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO(jogador[0].missao.tipo = TOTAL_TIPOS_MISSAO) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO((jogador[0].missao.tipo = MISSAO_ELIMINAR_COR,
+                         jogador[0].missao.cor = (IdCor) cabecalho->cores.total)) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO((jogador[0].missao.tipo = MISSAO_DOMINAR_CONTINENTE,
+                         jogador[0].missao.quantidade = -1)) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO(mapa[0].cor = (IdCor) cabecalho->cores.total) == CARGA_ERRO_FORMATO);
+    CONFERIR(ADULTERADO(mapa[3].tropas = -7) == CARGA_ERRO_FORMATO);
+#undef ADULTERADO
+
+    free(copia);
+    free(original);
+}
+
+/*
+ * Função: testarSalvamentoPeriodico
+ * Várias cópias agendadas em sequência: a última é a que fica no disco,
+ * e as que a thread não chegou a retirar são contadas como substituídas
+ */
+static void testarSalvamentoPeriodico(void) {
+    char caminho[256];
+    Jogo jogo;
+    Jogador jogadores[2];
+    SalvamentoPeriodico sp;
+    if (!montarPartidaTeste(&jogo, jogadores) ||
+        !iniciarSalvamentoPeriodico(&sp, caminhoTeste("auto.sav", caminho, sizeof(caminho)))) {
+        CONFERIR(!"salvamento periodico");
+        liberarMapa(&jogo);
+        return;
+    }
+
+    int agendados = 1;
+    for (int turno = 1; turno <= 50; turno++) {
+        jogo.mapa[turno % jogo.numTerritorios].tropas = turno;
+        agendados &= agendarSalvamento(&sp, &jogo, jogadores, 2, turno);
+    }
+    CONFERIR(agendados);
+    CONFERIR(encerrarSalvamentoPeriodico(&sp) == CARGA_OK);
+    CONFERIR(sp.ultimoTurno == 50 && sp.substituidos >= 0 && sp.substituidos < 50);
+
+    Jogo lido;
+    Jogador* lidos = NULL;
+    int numLidos = 0, turno = 0;
+    inicializarJogo(&lido, 1);
+    CONFERIR(restaurarPartida(caminho, &lido, &lidos, &numLidos, &turno) == CARGA_OK);
+    CONFERIR(turno == 50 && lido.numTerritorios == jogo.numTerritorios &&
+             memcmp(lido.mapa, jogo.mapa, sizeof(Territorio) * (size_t) jogo.numTerritorios) == 0);
+    free(lidos);
+    liberarMapa(&lido);
+    liberarMapa(&jogo);
+}
+
+// ==================== COLUNAS ====================
+
+/*
+ * Função: mesmoResumo
+ * Retorna 1 se os dois resumos são iguais
+ */
+static int mesmoResumo(const ResumoCor* a, const ResumoCor* b) {
+    return a->territorios == b->territorios && a->tropas == b->tropas &&
+           a->tropasMaximas == b->tropasMaximas && a->noMaximo == b->noMaximo;
+}
+
+/*
+ * Função: testarKernelsColunas
+ * Os kernels SSE2 e AVX2 (se o processador tiver) e resumirCores() dão o
+ * mesmo resumo que o laço escalar, em faixas e mapas de vários tamanhos,
+ * com tropas grandes (a soma passa de 32 bits), zeradas e repetidas
+ */
+static void testarKernelsColunas(void) {
+    GeradorDados dados;
+    inicializarGerador(&dados, 11, 0);
+    static const int tamanhos[] = { 1, 31, 32, 33, 100, 4096, 5000, 9001 };
+    int iguais = 1, iguaisCores = 1, iguaisB = 1;
+
+    for (size_t k = 0; k < sizeof(tamanhos) / sizeof(tamanhos[0]); k++) {
+        MapaColunar colunas;
+        if (!criarMapaColunar(&colunas, tamanhos[k])) {
+            CONFERIR(!"colunas");
+            return;
+        }
+        for (int i = 0; i < tamanhos[k]; i++) {
+            uint32_t sorteio = sortearIntervalo(&dados, 4);
+            int32_t tropas = sorteio == 0 ? INT32_MAX - (int32_t) sortearIntervalo(&dados, 3)
+                           : sorteio == 1 ? 0 : (int32_t) sortearIntervalo(&dados, 8);
+            atualizarColuna(&colunas, i, (IdCor) sortearIntervalo(&dados, 6), tropas);
+            colunas.iniciaisB[i] = (uint8_t) sortearIntervalo(&dados, 2);
+        }
+
+        ResumoCor resumos[7];
+        resumirCores(&colunas, 7, resumos);
+        for (int c = 0; c < 7; c++) {
+            ResumoCor escalar, vetorial;
+            resumirFaixaEscalar(colunas.donos, colunas.tropas, 0, colunas.numTerritorios, (IdCor) c, &escalar);
+            iguaisCores &= mesmoResumo(&resumos[c], &escalar);
+
+            // Faixas alinhadas em LARGURA_COLUNAS, como as usa resumirCores()
+            for (int inicio = 0; inicio < colunas.capacidade; inicio += 3 * LARGURA_COLUNAS) {
+                for (int fim = inicio + LARGURA_COLUNAS; fim <= colunas.capacidade; fim += 5 * LARGURA_COLUNAS) {
+                    resumirFaixaEscalar(colunas.donos, colunas.tropas, inicio, fim, (IdCor) c, &escalar);
+                    resumirFaixa(&colunas, inicio, fim, (IdCor) c, &vetorial);
+                    iguais &= mesmoResumo(&vetorial, &escalar);
+#ifdef __SSE2__
+                    resumirFaixaSSE2(colunas.donos, colunas.tropas, inicio, fim, (IdCor) c, &vetorial);
+                    iguais &= mesmoResumo(&vetorial, &escalar);
+#endif
+#ifdef WAR_COLUNAS_AVX2
+                    if (temAVX2()) {
+                        resumirFaixaAVX2(colunas.donos, colunas.tropas, inicio, fim, (IdCor) c, &vetorial);
+                        iguais &= mesmoResumo(&vetorial, &escalar);
+                    }
+#endif
+                }
+            }
+        }
+
+        int porCor[7], esperado[7] = { 0 }, totalEsperado = 0;
+        for (int i = 0; i < colunas.numTerritorios; i++) {
+            esperado[colunas.donos[i]] += colunas.iniciaisB[i];
+            totalEsperado += colunas.iniciaisB[i];
+        }
+        iguaisB &= contarIniciaisB(&colunas, 7, porCor) == totalEsperado &&
+                   memcmp(porCor, esperado, sizeof(porCor)) == 0;
+        liberarMapaColunar(&colunas);
+    }
+    CONFERIR(iguais);
+    CONFERIR(iguaisCores);
+    CONFERIR(iguaisB);
+}
+
+/*
+ * Função: testarAgregadosColunas
+ * recalcularAgregados() dá os mesmos totais pelas colunas e pelos registros
+ */
+static void testarAgregadosColunas(void) {
+    Jogo jogo;
+    inicializarJogo(&jogo, 5);
+    if (!gerarMapa(&jogo, 6000, 5, 1)) {
+        CONFERIR(!"mapa gerado");
+        return;
+    }
+    for (int i = 0; i < jogo.numTerritorios; i += 7) {
+        jogo.mapa[i].tropas = (int) sortearIntervalo(&jogo.dados, 3);  // Zeros e máximos repetidos
+    }
+
+    recalcularAgregados(&jogo);
+    AgregadosMapa registros = jogo.agregados;
+    CONFERIR(ativarColunas(&jogo));
+    recalcularAgregados(&jogo);
+    CONFERIR(memcmp(&registros, &jogo.agregados, sizeof(registros)) == 0);
+    liberarMapa(&jogo);
+}
+
+// ==================== COMBATE CLÁSSICO ====================
+
+/*
+ * Função: testarLoteRolagens
+ * Um lote sorteado e resolvido de uma vez (com qualquer kernel) dá os
+ * mesmos dados e perdas que rolarCombate() e compararDados() combate a
+ * combate, e deixa o fluxo no mesmo ponto; a folga do lote não perde nada
+ */
+static void testarLoteRolagens(void) {
+    static const int totais[] = { 1, 15, 16, 33, 1000 };
+    LoteRolagens lote;
+    if (!criarLoteRolagens(&lote, 1000)) {
+        CONFERIR(!"lote de rolagens");
+        return;
+    }
+    int iguais = 1, mesmoFluxo = 1, folgaZerada = 1;
+
+    for (int kernel = 0; kernel < 4; kernel++) {
+        for (size_t k = 0; k < sizeof(totais) / sizeof(totais[0]); k++) {
+            for (int a = 1; a <= DADOS_ATAQUE; a++) {
+                for (int d = 1; d <= DADOS_DEFESA; d++) {
+                    GeradorDados lotes, umAUm;
+                    inicializarGerador(&lotes, 3, (uint64_t) (kernel * 100 + a * 10 + d));
+                    umAUm = lotes;
+                    int total = totais[k];
+                    int fim = (total + LARGURA_COLUNAS - 1) / LARGURA_COLUNAS * LARGURA_COLUNAS;
+
+                    sortearLote(&lote, a, d, total, &lotes);
+                    if (kernel == 0) {
+                        resolverRolagens(&lote);
+                    } else if (kernel == 1) {
+                        resolverRolagensEscalar(&lote, 0, fim);
+                    } else if (kernel == 2) {
+#ifdef __SSE2__
+                        resolverRolagensSSE2(&lote, 0, fim);
+#else
+                        resolverRolagensEscalar(&lote, 0, fim);
+#endif
+                    } else {
+#ifdef WAR_COLUNAS_AVX2
+                        if (!temAVX2()) continue;
+                        resolverRolagensAVX2(&lote, 0, fim);
+#else
+                        continue;
+#endif
+                    }
+
+                    for (int i = 0; i < total; i++) {
+                        uint8_t ataque[DADOS_ATAQUE], defesa[DADOS_DEFESA];
+                        int perdasAtacante, perdasDefensor;
+                        rolarCombate(&umAUm, a, d, ataque, defesa);
+                        compararDados(ataque, defesa, &perdasAtacante, &perdasDefensor);
+                        for (int j = 0; j < DADOS_ATAQUE; j++) iguais &= lote.ataque[j][i] == ataque[j];
+                        for (int j = 0; j < DADOS_DEFESA; j++) iguais &= lote.defesa[j][i] == defesa[j];
+                        iguais &= lote.perdasAtacante[i] == perdasAtacante &&
+                                  lote.perdasDefensor[i] == perdasDefensor;
+                    }
+                    for (int i = total; i < fim; i++) {
+                        folgaZerada &= lote.perdasAtacante[i] == 0 && lote.perdasDefensor[i] == 0;
+                    }
+                    mesmoFluxo &= rolarDado(&lotes) == rolarDado(&umAUm) &&
+                                  lotes.contador == umAUm.contador && lotes.posicao == umAUm.posicao;
+                }
+            }
+        }
+    }
+    liberarLoteRolagens(&lote);
+    CONFERIR(iguais);
+    CONFERIR(mesmoFluxo);
+    CONFERIR(folgaZerada);
+}
+
+/*
+ * Função: testarChancesCombate
+ * A tabela exata de um combate soma 1 em cada combinação de dados e tem
+ * os valores conhecidos de 3 contra 2 (em 7776 jogadas possíveis)
+ */
+static void testarChancesCombate(void) {
+    double chances[DADOS_ATAQUE + 1][DADOS_DEFESA + 1][DADOS_DEFESA + 1];
+    calcularChancesCombate(chances);
+
+    int somamUm = 1;
+    for (int a = 1; a <= DADOS_ATAQUE; a++) {
+        for (int d = 1; d <= DADOS_DEFESA; d++) {
+            double soma = 0;
+            for (int p = 0; p <= DADOS_DEFESA; p++) soma += chances[a][d][p];
+            somamUm &= fabs(soma - 1.0) < 1e-12;
+        }
+    }
+    CONFERIR(somamUm);
+    CONFERIR(fabs(chances[3][2][2] - 2890.0 / 7776) < 1e-12);
+    CONFERIR(fabs(chances[3][2][1] - 2611.0 / 7776) < 1e-12);
+    CONFERIR(fabs(chances[3][2][0] - 2275.0 / 7776) < 1e-12);
+    CONFERIR(fabs(chances[1][1][1] - 15.0 / 36) < 1e-12);
+}
+
+// ==================== ATAQUE RELÂMPAGO ====================
+
+/*
+ * Função: desfechosForcaBruta
+ * Distribuição dos desfechos pela grade inteira (atacante + 1) × (defensor + 1),
+ * batalha a batalha, sem o rodízio de 3 linhas de montarTabelaRelampago()
+ * Preenche "desfechos" (na ordem de indiceDesfecho()) e retorna a soma
+ */
+static double desfechosForcaBruta(const CacheRelampago* cache, RegraBatalha regra, int atacante, int defensor,
+                                  double* desfechos) {
+    size_t largura = (size_t) defensor + 1;
+    double* grade = (double*) calloc(((size_t) atacante + 1) * largura, sizeof(double));
+    memset(desfechos, 0, sizeof(double) * (size_t) (atacante - 1 + defensor));
+    grade[(size_t) atacante * largura + (size_t) defensor] = 1.0;
+
+    for (int x = atacante; x >= 1; x--) {
+        for (int y = defensor; y >= 0; y--) {
+            double massa = grade[(size_t) x * largura + (size_t) y];
+            if (massa == 0.0) continue;
+            if (y == 0 || x == 1) {
+                desfechos[indiceDesfecho(atacante, x, y)] += massa;
+            } else if (regra == REGRA_SIMPLES) {
+                grade[(size_t) x * largura] += massa * (15.0 / 36.0);
+                grade[(size_t) (x - 1) * largura + (size_t) y] += massa * (21.0 / 36.0);
+            } else {
+                int na = dadosDoAtacante(x), nd = dadosDoDefensor(y);
+                int pares = na < nd ? na : nd;
+                for (int k = 0; k <= pares; k++) {
+                    grade[(size_t) (x - (pares - k)) * largura + (size_t) (y - k)] += massa * cache->chances[na][nd][k];
+                }
+            }
+        }
+    }
+    free(grade);
+
+    double soma = 0.0;
+    for (int i = 0; i < atacante - 1 + defensor; i++) soma += desfechos[i];
+    return soma;
+}
+
+/*
+ * Função: testarTabelaRelampago
+ * A distribuição da programação dinâmica soma 1 e bate com a da grade
+ * inteira; a acumulada é crescente e termina em 1, a guia aponta para o
+ * primeiro desfecho de cada faixa e o sorteio é o mesmo da busca linear
+ */
+static void testarTabelaRelampago(void) {
+    CacheRelampago cache;
+    inicializarCacheRelampago(&cache);
+    GeradorDados dados;
+    inicializarGerador(&dados, 21, 0);
+    double desfechos[200];
+    int somamUm = 1, iguais = 1, crescente = 1, guiaCerta = 1, mesmoSorteio = 1;
+
+    for (int regra = REGRA_SIMPLES; regra <= REGRA_CLASSICA; regra++) {
+        for (int atacante = 2; atacante <= 60; atacante += 3) {
+            for (int defensor = 1; defensor <= 60; defensor += 4) {
+                TabelaRelampago tabela;
+                if (!montarTabelaRelampago(&cache, &tabela, (RegraBatalha) regra, atacante, defensor)) {
+                    CONFERIR(!"tabela relampago");
+                    return;
+                }
+                int n = tabela.numDesfechos;
+                somamUm &= fabs(desfechosForcaBruta(&cache, (RegraBatalha) regra, atacante, defensor,
+                                                    desfechos) - 1.0) < 1e-9;
+
+                double anterior = 0.0;
+                for (int i = 0; i < n; i++) {
+                    iguais &= fabs((tabela.acumulada[i] - anterior) - desfechos[i]) < 1e-9;
+                    crescente &= tabela.acumulada[i] >= anterior;
+                    anterior = tabela.acumulada[i];
+                }
+                crescente &= tabela.acumulada[n - 1] == 1.0;
+
+                for (int k = 0; k < n; k++) {
+                    uint32_t g = tabela.guia[k];
+                    guiaCerta &= tabela.acumulada[g] > (double) k / n && (g == 0 || tabela.acumulada[g - 1] <= (double) k / n);
+                }
+                for (int amostra = 0; amostra < 50; amostra++) {
+                    GeradorDados copia = dados;
+                    double u = sortearUniforme(&copia);
+                    int linear = 0;
+                    while (tabela.acumulada[linear] <= u) linear++;
+                    mesmoSorteio &= sortearDesfecho(&tabela, &dados) == linear;
+                }
+                free(tabela.acumulada);
+            }
+        }
+    }
+    CONFERIR(somamUm);
+    CONFERIR(iguais);
+    CONFERIR(crescente);
+    CONFERIR(guiaCerta);
+    CONFERIR(mesmoSorteio);
+    liberarCacheRelampago(&cache);
+}
+
+/*
+ * Função: testarRelampagoContraDados
+ * A frequência dos desfechos sorteados de uma vez fica perto da de
+ * ataques rolados batalha a batalha (rolarAteOFim(), o caminho sem tabela)
+ */
+static void testarRelampagoContraDados(void) {
+    enum { AMOSTRAS = 40000, ATACANTE = 8, DEFENSOR = 5, DESFECHOS = ATACANTE - 1 + DEFENSOR };
+    CacheRelampago cache;
+    inicializarCacheRelampago(&cache);
+    GeradorDados dados;
+    inicializarGerador(&dados, 8, 5);
+    int perto = 1;
+
+    for (int regra = REGRA_SIMPLES; regra <= REGRA_CLASSICA; regra++) {
+        const TabelaRelampago* tabela = buscarTabelaRelampago(&cache, (RegraBatalha) regra, ATACANTE, DEFENSOR);
+        int sorteados[DESFECHOS] = { 0 }, rolados[DESFECHOS] = { 0 };
+        for (int i = 0; i < AMOSTRAS; i++) {
+            sorteados[sortearDesfecho(tabela, &dados)]++;
+            int a = ATACANTE, d = DEFENSOR;
+            rolarAteOFim((RegraBatalha) regra, &dados, &a, &d);
+            rolados[indiceDesfecho(ATACANTE, a, d)]++;
+        }
+        // Desvio padrão de uma frequência com 40000 amostras: no máximo 0,0025
+        for (int i = 0; i < DESFECHOS; i++) {
+            perto &= fabs((double) (sorteados[i] - rolados[i]) / AMOSTRAS) < 0.015;
+        }
+    }
+    CONFERIR(perto);
+    CONFERIR(cache.construidas == 2);
+    CONFERIR(buscarTabelaRelampago(&cache, REGRA_CLASSICA, ATACANTE, DEFENSOR) != NULL && cache.construidas == 2);
+    liberarCacheRelampago(&cache);
+}
+
+// ==================== CHANCES EXATAS ====================
+
+/*
+ * Função: mesmaChance
+ * Retorna 1 se as duas chances coincidem (até o arredondamento)
+ */
+static int mesmaChance(ChanceBatalha a, ChanceBatalha b) {
+    return fabs(a.vitoria - b.vitoria) < 1e-9 && fabs(a.perdasAtacante - b.perdasAtacante) < 1e-9 &&
+           fabs(a.perdasDefensor - b.perdasDefensor) < 1e-9;
+}
+
+/*
+ * Função: testarChancesConhecidas
+ * Células pequenas com valor conhecido e a concordância com a distribuição
+ * do ataque relâmpago (chance de conquista e perdas esperadas)
+ */
+static void testarChancesConhecidas(void) {
+    TabelaChances simples, classica;
+    CacheRelampago cache;
+    if (!criarTabelaChances(&simples, REGRA_SIMPLES, 100, 100) ||
+        !criarTabelaChances(&classica, REGRA_CLASSICA, 100, 100)) {
+        CONFERIR(!"tabelas de chances");
+        return;
+    }
+    inicializarCacheRelampago(&cache);
+
+    ChanceBatalha c;
+    CONFERIR(consultarChance(&simples, 2, 1, &c) && fabs(c.vitoria - 15.0 / 36) < 1e-12);
+    CONFERIR(consultarChance(&simples, 3, 4, &c) && fabs(c.vitoria - (1 - 21.0 / 36 * 21.0 / 36)) < 1e-12);
+    CONFERIR(consultarChance(&classica, 2, 1, &c) && fabs(c.vitoria - 15.0 / 36) < 1e-12);
+    CONFERIR(consultarChance(&classica, 3, 1, &c) &&
+             fabs(c.vitoria - (125.0 / 216 + 91.0 / 216 * 15.0 / 36)) < 1e-12);
+    CONFERIR(consultarChance(&classica, 1, 5, &c) && c.vitoria == 0.0);
+    CONFERIR(consultarChance(&classica, 5, 0, &c) && c.vitoria == 1.0);
+    CONFERIR(!consultarChance(&classica, 101, 5, &c));
+
+    int iguais = 1;
+    for (int regra = REGRA_SIMPLES; regra <= REGRA_CLASSICA; regra++) {
+        TabelaChances* tabela = regra == REGRA_SIMPLES ? &simples : &classica;
+        for (int atacante = 2; atacante <= 100; atacante += 7) {
+            for (int defensor = 1; defensor <= 100; defensor += 9) {
+                TabelaRelampago desfechos;
+                if (!consultarChance(tabela, atacante, defensor, &c) ||
+                    !montarTabelaRelampago(&cache, &desfechos, (RegraBatalha) regra, atacante, defensor)) {
+                    iguais = 0;
+                    continue;
+                }
+                ChanceBatalha esperado = { 0.0, 0.0, 0.0 };
+                double anterior = 0.0;
+                for (int i = 0; i < desfechos.numDesfechos; i++) {
+                    double p = desfechos.acumulada[i] - anterior;
+                    anterior = desfechos.acumulada[i];
+                    int conquista = i < atacante - 1;
+                    int atacanteFinal = conquista ? i + 2 : 1;
+                    int defensorFinal = conquista ? 0 : i - (atacante - 1) + 1;
+                    esperado.vitoria += conquista ? p : 0.0;
+                    esperado.perdasAtacante += p * (atacante - atacanteFinal);
+                    esperado.perdasDefensor += p * (defensor - defensorFinal);
+                }
+                iguais &= mesmaChance(c, esperado);
+                free(desfechos.acumulada);
+            }
+        }
+    }
+    CONFERIR(iguais);
+
+    liberarCacheRelampago(&cache);
+    liberarTabelaChances(&simples);
+    liberarTabelaChances(&classica);
+}
+
+// Tabela compartilhada e valores de referência para as threads do teste
+typedef struct {
+    TabelaChances* tabela;
+    const TabelaChances* referencia;
+    uint64_t fluxo;
+    int iguais;
+} ConsultaChances;
+
+/*
+ * Função: consultarEmThread
+ * Consulta células ao acaso (ampliando a tabela) e as compara com a referência
+ */
+static void* consultarEmThread(void* argumento) {
+    ConsultaChances* consulta = (ConsultaChances*) argumento;
+    GeradorDados dados;
+    inicializarGerador(&dados, 77, consulta->fluxo);
+    consulta->iguais = 1;
+    for (int i = 0; i < 2000; i++) {
+        int a = 2 + (int) sortearIntervalo(&dados, 299);
+        int d = 1 + (int) sortearIntervalo(&dados, 300);
+        ChanceBatalha c;
+        consulta->iguais &= consultarChance(consulta->tabela, a, d, &c) &&
+                            mesmaChance(c, *celulaChance(consulta->referencia, a, d));
+    }
+    return NULL;
+}
+
+/*
+ * Função: testarTabelaChances
+ * Uma tabela ampliada aos poucos (inclusive por várias threads ao mesmo
+ * tempo) dá os mesmos valores que uma calculada de uma vez, e o arquivo
+ * gravado volta igual (o de outra regra ou truncado é recusado)
+ */
+static void testarTabelaChances(void) {
+    TabelaChances referencia, tabela;
+    if (!criarTabelaChances(&referencia, REGRA_CLASSICA, 300, 300) ||
+        !criarTabelaChances(&tabela, REGRA_CLASSICA, 300, 300)) {
+        CONFERIR(!"tabelas de chances");
+        return;
+    }
+    ampliarTabelaChances(&referencia, 300, 300);
+
+    ConsultaChances consultas[4];
+    pthread_t threads[4];
+    for (int t = 0; t < 4; t++) {
+        consultas[t] = (ConsultaChances) { &tabela, &referencia, (uint64_t) t, 0 };
+        pthread_create(&threads[t], NULL, consultarEmThread, &consultas[t]);
+    }
+    int iguais = 1;
+    for (int t = 0; t < 4; t++) {
+        pthread_join(threads[t], NULL);
+        iguais &= consultas[t].iguais;
+    }
+    CONFERIR(iguais);
+
+    char caminho[256];
+    caminhoTeste("chances.bin", caminho, sizeof(caminho));
+    CONFERIR(salvarTabelaChances(&tabela, caminho));
+
+    TabelaChances lida, outraRegra;
+    criarTabelaChances(&lida, REGRA_CLASSICA, 300, 300);
+    criarTabelaChances(&outraRegra, REGRA_SIMPLES, 300, 300);
+    CONFERIR(carregarTabelaChances(&lida, caminho));
+    CONFERIR(atomic_load(&lida.limites) == atomic_load(&tabela.limites));
+    uint64_t limites = atomic_load(&lida.limites);
+    int mesmasCelulas = 1;
+    for (int a = 2; a <= (int) (limites >> 32); a++) {
+        for (int d = 1; d <= (int) (uint32_t) limites; d++) {
+            mesmasCelulas &= memcmp(celulaChance(&lida, a, d), celulaChance(&referencia, a, d),
+                                    sizeof(ChanceBatalha)) == 0;
+        }
+    }
+    CONFERIR(mesmasCelulas);
+    CONFERIR(!carregarTabelaChances(&outraRegra, caminho));
+
+    char* conteudo;
+    size_t tamanho;
+    char truncado[256];
+    if (lerArquivoInteiro(caminho, &conteudo, &tamanho) == CARGA_OK) {
+        TabelaChances vazia;
+        criarTabelaChances(&vazia, REGRA_CLASSICA, 300, 300);
+        CONFERIR(!carregarTabelaChances(&vazia, gravarArquivo("chances.bin", conteudo, tamanho - 8, truncado)));
+        CONFERIR(atomic_load(&vazia.limites) == 0);
+        liberarTabelaChances(&vazia);
+        free(conteudo);
+    }
+
+    liberarTabelaChances(&outraRegra);
+    liberarTabelaChances(&lida);
+    liberarTabelaChances(&tabela);
+    liberarTabelaChances(&referencia);
+}
+
+// ==================== PROTOCOLO DE COMANDOS ====================
+
+/*
+ * Função: testarPalavrasComando
+ * Separação em palavras, números sem sobras nem estouro e linhas maiores
+ * que o buffer externo do leitor (que passa a ter buffer próprio)
+ */
+static void testarPalavrasComando(void) {
+    char linha[] = "  atacar\tBrasil   2 ";
+    char* palavras[MAX_PALAVRAS_COMANDO];
+    CONFERIR(separarPalavras(linha, palavras, MAX_PALAVRAS_COMANDO) == 3);
+    CONFERIR(strcmp(palavras[0], "atacar") == 0 && strcmp(palavras[1], "Brasil") == 0 &&
+             strcmp(palavras[2], "2") == 0);
+    char vazia[] = " \t ";
+    CONFERIR(separarPalavras(vazia, palavras, MAX_PALAVRAS_COMANDO) == 0);
+    char longa[] = "a b c d";
+    CONFERIR(separarPalavras(longa, palavras, 2) == 2 && strcmp(palavras[1], "b") == 0);
+
+    int valor = 0;
+    CONFERIR(lerInteiroPalavra("+7", &valor) && valor == 7);
+    CONFERIR(lerInteiroPalavra("-3", &valor) && valor == -3);
+    CONFERIR(lerInteiroPalavra("2147483647", &valor) && valor == INT32_MAX);
+    CONFERIR(!lerInteiroPalavra("2147483648", &valor));
+    CONFERIR(!lerInteiroPalavra("", &valor) && !lerInteiroPalavra("-", &valor));
+    CONFERIR(!lerInteiroPalavra("12a", &valor) && !lerInteiroPalavra("1 2", &valor));
+
+    char caminho[256], comprida[200];
+    memset(comprida, 'x', sizeof(comprida) - 1);
+    comprida[sizeof(comprida) - 1] = '\0';
+    char texto[400];
+    snprintf(texto, sizeof(texto), "um\r\n%s\n\ndois", comprida);
+    int fd = open(gravarTexto("c.txt", texto, caminho), O_RDONLY);
+    char buffer[8];
+    LeitorLinhas leitor;
+    criarLeitorLinhasEm(&leitor, fd, buffer, sizeof(buffer));
+    char* lida;
+    CONFERIR(proximaLinha(&leitor, &lida) && strcmp(lida, "um") == 0);
+    CONFERIR(proximaLinha(&leitor, &lida) && strcmp(lida, comprida) == 0 && !leitor.bufferExterno);
+    CONFERIR(proximaLinha(&leitor, &lida) && lida[0] == '\0');
+    CONFERIR(proximaLinha(&leitor, &lida) && strcmp(lida, "dois") == 0);
+    CONFERIR(!proximaLinha(&leitor, &lida));
+    liberarLeitorLinhas(&leitor);
+    close(fd);
+}
+
+/*
+ * Função: respostasDoRoteiro
+ * Executa o roteiro em uma sessão nova sobre a partida e devolve as
+ * respostas (terminadas em '\0', a liberar com free) ou NULL
+ */
+static char* respostasDoRoteiro(Jogo* jogo, Jogador jogadores[2], const char* roteiro) {
+    char caminhoEntrada[256], caminhoSaida[256];
+    SessaoComandos sessao = { jogo, jogadores, 2, NULL, NULL, NULL, NULL, 0, 0 };
+    Tela tela;
+    char* respostas = NULL;
+    size_t tamanho;
+
+    int entrada = open(gravarTexto("roteiro.txt", roteiro, caminhoEntrada), O_RDONLY);
+    int saida = open(caminhoTeste("respostas.txt", caminhoSaida, sizeof(caminhoSaida)),
+                     O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (entrada >= 0 && saida >= 0 && criarTela(&tela, jogo->numTerritorios)) {
+        int ok = executarProtocolo(&sessao, entrada, saida, &tela);
+        liberarTela(&tela);
+        if (ok && lerArquivoInteiro(caminhoSaida, &respostas, &tamanho) == CARGA_OK) {
+            char* terminado = (char*) realloc(respostas, tamanho + 1);
+            if (terminado == NULL) {
+                free(respostas);
+                respostas = NULL;
+            } else {
+                respostas = terminado;
+                respostas[tamanho] = '\0';
+            }
+        }
+    }
+    if (entrada >= 0) close(entrada);
+    if (saida >= 0) close(saida);
+    return respostas;
+}
+
+/*
+ * Função: testarProtocoloComandos
+ * Um roteiro com comentários, linhas vazias, "\r\n", apelidos, comandos
+ * desconhecidos, argumentos a mais ou a menos e ataques recusados recebe
+ * exatamente as respostas esperadas; nada depois de "sair" é executado e
+ * a última linha vale mesmo sem '\n'
+ */
+static void testarProtocoloComandos(void) {
+    Jogo jogo, referencia;
+    Jogador jogadores[2], jogadoresReferencia[2];
+    if (!montarPartidaTeste(&jogo, jogadores) || !montarPartidaTeste(&referencia, jogadoresReferencia)) {
+        CONFERIR(!"partida de teste");
+        return;
+    }
+
+    // A mesma batalha na partida de referência dá a resposta do ataque
+    ResultadoBatalha resultado;
+    batalharNoJogo(&referencia, 0, 1, &resultado);
+    char esperado[1024];
+    int usados = snprintf(esperado, sizeof(esperado),
+                          "pronto territorios=4 jogadores=2 turno=0\n"
+                          "erro comando_desconhecido pular\n"
+                          "erro argumentos atacar A D\n"
+                          "erro argumentos atacar A D\n"
+                          "erro mesma_cor\n"
+                          "erro territorio_invalido\n"
+                          "erro territorio_invalido\n"
+                          "erro territorio_invalido\n"
+                          "erro argumentos mostrar\n"
+                          "ok 4\n"
+                          "1\tBrasil\tazul\t5\n"
+                          "2\tArgentina\tverde\t3\n"
+                          "3\tChile\tazul\t2\n"
+                          "4\tPeru\tverde\t4\n"
+                          "ok conquistou=%d perdas=%d,%d movidas=%d tropas=%d,%d\n"
+                          "ok 2\n",
+                          resultado.conquistou, resultado.perdasAtacante, resultado.perdasDefensor,
+                          resultado.tropasMovidas, referencia.mapa[0].tropas, referencia.mapa[1].tropas);
+    for (int i = 0; i < 2; i++) {
+        const Territorio* t = &referencia.mapa[i];
+        usados += snprintf(esperado + usados, sizeof(esperado) - (size_t) usados, "%d\t%s\t%s\t%d\n", i + 1,
+                           nomeTerritorio(&referencia, i), nomeCor(&referencia.cores, t->cor), t->tropas);
+    }
+    snprintf(esperado + usados, sizeof(esperado) - (size_t) usados, "ok turno=1 comandos=9\nok\n");
+
+    char* respostas = respostasDoRoteiro(&jogo, jogadores,
+                                         "# roteiro de teste\n"
+                                         "\n"
+                                         "pular 1 2\n"
+                                         "atacar 1\n"
+                                         "atacar 1 2 3 4 5 6 7 8 9\n"
+                                         "atacar 1 3\n"
+                                         "atacar 1 5\n"
+                                         "atacar Brasil Uruguai\n"
+                                         "attack 1 99999999999\n"
+                                         "mostrar tudo\n"
+                                         "show\r\n"
+                                         "  atacar\tBrasil Argentina\r\n"
+                                         "mostrar changed\n"
+                                         "turn\n"
+                                         "quit\n"
+                                         "atacar 1 2\n");
+    CONFERIR(respostas != NULL && strcmp(respostas, esperado) == 0);
+    CONFERIR(memcmp(jogo.mapa, referencia.mapa, sizeof(Territorio) * (size_t) jogo.numTerritorios) == 0);
+    free(respostas);
+
+    respostas = respostasDoRoteiro(&jogo, jogadores, "ajuda\nturno");
+    int linhasAjuda = 0;
+    for (const char* p = respostas; p != NULL && *p != '\0'; p++) {
+        linhasAjuda += *p == '\n';
+    }
+    char ajuda[64];
+    snprintf(ajuda, sizeof(ajuda), "ok %d\n", TOTAL_COMANDOS);
+    CONFERIR(respostas != NULL && strstr(respostas, ajuda) != NULL && linhasAjuda == TOTAL_COMANDOS + 3);
+    CONFERIR(respostas != NULL && strstr(respostas, "ok turno=0 comandos=2\n") != NULL);
+    free(respostas);
+
+    liberarMapa(&referencia);
+    liberarMapa(&jogo);
+}
+
+// ==================== JOGADAS LEGAIS ====================
+
+/*
+ * Função: jogadasForcaBruta
+ * Ataques legais da cor examinando todo par atacante/defensor com
+ * validarAtaqueNoJogo(); "marcas" (T*T) recebe 1 em cada par legal
+ * Retorna a quantidade escrita em "legais"
+ */
+static long jogadasForcaBruta(const Jogo* jogo, IdCor cor, ParAtaque* legais, char* marcas) {
+    int n = jogo->numTerritorios;
+    long total = 0;
+    memset(marcas, 0, (size_t) n * (size_t) n);
+    for (int a = 0; a < n; a++) {
+        for (int d = 0; d < n; d++) {
+            if (jogo->mapa[a].cor == cor && validarAtaqueNoJogo(jogo, a, d) == ATAQUE_OK) {
+                marcas[(size_t) a * n + d] = 1;
+                legais[total++] = (ParAtaque) { a, d };
+            }
+        }
+    }
+    return total;
+}
+
+/*
+ * Função: conferirJogadas
+ * Compara listarJogadas() e contarJogadas() da cor com a força bruta:
+ * cada par legal aparece exatamente uma vez, e uma lista curta é cortada
+ * Retorna 1 se coincidem
+ */
+static int conferirJogadas(const Jogo* jogo, IdCor cor, ParAtaque* legais, ParAtaque* lista, char* marcas) {
+    int n = jogo->numTerritorios;
+    long esperados = jogadasForcaBruta(jogo, cor, legais, marcas);
+    size_t listados = listarJogadas(jogo, cor, lista, (size_t) n * (size_t) n);
+    int iguais = (long) listados == esperados && contarJogadas(jogo, cor) == (uint64_t) esperados;
+    for (size_t k = 0; k < listados && iguais; k++) {
+        char* marca = &marcas[(size_t) lista[k].atacante * n + lista[k].defensor];
+        iguais = *marca == 1;   // Legal e ainda não listado
+        *marca = 2;
+    }
+    size_t curta = esperados < 3 ? (size_t) esperados : 3;
+    return iguais && listarJogadas(jogo, cor, lista, 3) == curta;
+}
+
+/*
+ * Função: batalhasConferidas
+ * Trava batalhas legais ao acaso (até "maximo" ou até acabarem), de uma
+ * cor sorteada a cada vez, conferindo as jogadas de todas as cores antes
+ * da primeira e depois de cada uma
+ * Retorna 1 se nenhuma conferência falhou
+ */
+static int batalhasConferidas(Jogo* jogo, int maximo, int* batalhas) {
+    size_t area = (size_t) jogo->numTerritorios * (size_t) jogo->numTerritorios;
+    ParAtaque* legais = (ParAtaque*) malloc(area * sizeof(ParAtaque));
+    ParAtaque* lista = (ParAtaque*) malloc(area * sizeof(ParAtaque));
+    char* marcas = (char*) malloc(area);
+    GeradorDados escolhas;
+    int iguais = legais != NULL && lista != NULL && marcas != NULL && ativarJogadas(jogo);
+
+    inicializarGerador(&escolhas, 5, 0);
+    *batalhas = 0;
+    while (iguais && *batalhas < maximo) {
+        for (int cor = 0; cor < jogo->cores.total && iguais; cor++) {
+            iguais = conferirJogadas(jogo, (IdCor) cor, legais, lista, marcas);
+        }
+        // A primeira cor com jogadas a partir da sorteada ataca
+        IdCor vez = (IdCor) sortearIntervalo(&escolhas, (uint32_t) jogo->cores.total);
+        long pares = 0;
+        for (int c = 0; c < jogo->cores.total && pares == 0; c++) {
+            pares = jogadasForcaBruta(jogo, (IdCor) ((vez + c) % jogo->cores.total), legais, marcas);
+        }
+        if (!iguais || pares == 0) {
+            break;
+        }
+        ParAtaque par = legais[sortearIntervalo(&escolhas, (uint32_t) pares)];
+        ResultadoBatalha resultado;
+        iguais = executarAtaque(jogo, par.atacante, par.defensor, &resultado) == ATAQUE_OK;
+        (*batalhas)++;
+    }
+
+    free(marcas);
+    free(lista);
+    free(legais);
+    return iguais;
+}
+
+/*
+ * Função: testarJogadasLegais
+ * As jogadas mantidas pelo motor batem com a força bruta ao longo de
+ * partidas inteiras, com fronteiras (mapa gerado) e sem elas
+ */
+static void testarJogadasLegais(void) {
+    Jogo jogo;
+    int batalhas;
+    inicializarJogo(&jogo, 31);
+    if (!gerarMapa(&jogo, 150, 3, 1)) {
+        CONFERIR(!"mapa gerado");
+        return;
+    }
+    CONFERIR(grafoAtivo(&jogo.grafo));
+    CONFERIR(batalhasConferidas(&jogo, 400, &batalhas) && batalhas > 50);
+    liberarMapa(&jogo);
+
+    const char* cores[] = { "azul", "verde", "preto" };
+    char texto[2048], caminho[256];
+    int usados = snprintf(texto, sizeof(texto), "nome,cor,tropas\n");
+    for (int i = 0; i < 40; i++) {
+        usados += snprintf(texto + usados, sizeof(texto) - (size_t) usados, "T%d,%s,%d\n", i + 1, cores[i % 3],
+                           1 + (i * 7) % 5);
+    }
+    inicializarJogo(&jogo, 32);
+    if (carregarMapa(gravarTexto("m.csv", texto, caminho), &jogo) != CARGA_OK) {
+        CONFERIR(!"mapa sem fronteiras");
+        return;
+    }
+    CONFERIR(!grafoAtivo(&jogo.grafo));
+    CONFERIR(batalhasConferidas(&jogo, 300, &batalhas) && batalhas > 20);
+    liberarMapa(&jogo);
+}
+
+// ==================== FUNÇÃO PRINCIPAL ====================
+
+int main(void) {
+    if (mkdtemp(pastaTestes) == NULL) {
+        printf("Erro ao criar a pasta dos testes!\n");
+        return 1;
+    }
+
+    testarPhilox();
+    testarPreencherDados();
+    testarMapasCSV();
+    testarMapaBinario();
+    testarJogadoresCSV();
+    testarSalvamento();
+    testarSalvamentoPeriodico();
+    testarKernelsColunas();
+    testarAgregadosColunas();
+    testarLoteRolagens();
+    testarChancesCombate();
+    testarTabelaRelampago();
+    testarRelampagoContraDados();
+    testarChancesConhecidas();
+    testarTabelaChances();
+    testarPalavrasComando();
+    testarProtocoloComandos();
+    testarJogadasLegais();
+
+    const char* arquivos[] = { "m.csv", "f.csv", "m.bin", "t.bin", "a.bin", "j.csv",
+                               "p.sav", "t.sav", "a.sav", "auto.sav", "chances.bin",
+                               "c.txt", "roteiro.txt", "respostas.txt" };
+    char caminho[256];
+    for (size_t i = 0; i < sizeof(arquivos) / sizeof(arquivos[0]); i++) {
+        unlink(caminhoTeste(arquivos[i], caminho, sizeof(caminho)));
+    }
+    rmdir(pastaTestes);
+
+    printf("%d verificacoes, %d falha(s)\n", verificacoes, falhas);
+    return falhas == 0 ? 0 : 1;
+}